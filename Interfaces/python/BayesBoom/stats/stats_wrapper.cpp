@@ -241,7 +241,7 @@ namespace BayesBoom {
                std::vector<int> values;
                values.reserve(table.nrow());
                for (int i = 0; i < table.nrow(); ++i) {
-                 values.push_back(var[i]->value());
+                 values.push_back(var.value(i));
                }
                return values;
              },
@@ -0,0 +1,78 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include "LinAlg/AlignedMatrix.hpp"
+#include <algorithm>
+#include "cpputil/report_error.hpp"
+
+namespace BOOM {
+
+  AlignedMatrix::AlignedMatrix() : nrow_(0), ncol_(0), leading_dimension_(0) {}
+
+  AlignedMatrix::AlignedMatrix(int nrow, int ncol, double initial_value)
+      : nrow_(0), ncol_(0), leading_dimension_(0) {
+    resize(nrow, ncol);
+    std::fill(data_.begin(), data_.end(), initial_value);
+  }
+
+  AlignedMatrix::AlignedMatrix(const Matrix &m)
+      : AlignedMatrix(ConstSubMatrix(m)) {}
+
+  AlignedMatrix::AlignedMatrix(const ConstSubMatrix &m)
+      : nrow_(0), ncol_(0), leading_dimension_(0) {
+    operator=(m);
+  }
+
+  void AlignedMatrix::resize(int nrow, int ncol) {
+    if (nrow < 0 || ncol < 0) {
+      report_error("AlignedMatrix dimensions must be non-negative.");
+    }
+    nrow_ = nrow;
+    ncol_ = ncol;
+    leading_dimension_ = padded_leading_dimension(nrow);
+    // The padding is zeroed so it holds finite values.
+    data_.assign(static_cast<size_t>(leading_dimension_) * ncol, 0.0);
+  }
+
+  SubMatrix AlignedMatrix::view() {
+    SubMatrix ans;
+    ans.reset(data(), nrow_, ncol_, leading_dimension_);
+    return ans;
+  }
+
+  ConstSubMatrix AlignedMatrix::view() const {
+    return ConstSubMatrix(data(), nrow_, ncol_, leading_dimension_);
+  }
+
+  AlignedMatrix &AlignedMatrix::operator=(const ConstSubMatrix &rhs) {
+    if (rhs.nrow() != nrow_ || rhs.ncol() != ncol_) {
+      resize(rhs.nrow(), rhs.ncol());
+    }
+    for (int j = 0; j < ncol_; ++j) {
+      std::copy(rhs.col_begin(j), rhs.col_end(j),
+                data() + j * leading_dimension_);
+    }
+    return *this;
+  }
+
+  int AlignedMatrix::padded_leading_dimension(int nrow) {
+    const int block = kSimdAlignment / sizeof(double);
+    return ((nrow + block - 1) / block) * block;
+  }
+
+}  // namespace BOOM
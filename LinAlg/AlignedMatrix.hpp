@@ -0,0 +1,89 @@
+#ifndef BOOM_LINALG_ALIGNED_MATRIX_HPP_
+#define BOOM_LINALG_ALIGNED_MATRIX_HPP_
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <vector>
+
+#include "LinAlg/Matrix.hpp"
+#include "LinAlg/SubMatrix.hpp"
+#include "cpputil/AlignedAllocator.hpp"
+
+namespace BOOM {
+
+  // A column major matrix intended for large workspaces in numerically
+  // intensive code.  The storage starts on a kSimdAlignment byte boundary,
+  // and each column is padded to a whole number of SIMD blocks, so every
+  // column starts on an aligned boundary as well.  The distance between
+  // the starts of adjacent columns is leading_dimension() >= nrow().
+  //
+  // The alignment and the padding both cost memory, so Matrix does
+  // neither.  Use an AlignedMatrix for buffers that are big enough, and
+  // used often enough, to repay the cost.  view() exposes the matrix to the
+  // rest of LinAlg, and EigenMap() in LinAlg/EigenMap.hpp exposes it to
+  // Eigen.
+  class AlignedMatrix {
+   public:
+    AlignedMatrix();
+    AlignedMatrix(int nrow, int ncol, double initial_value = 0.0);
+    explicit AlignedMatrix(const Matrix &m);
+    explicit AlignedMatrix(const ConstSubMatrix &m);
+
+    int nrow() const { return nrow_; }
+    int ncol() const { return ncol_; }
+
+    // The number of doubles from the start of one column to the start of
+    // the next.
+    int leading_dimension() const { return leading_dimension_; }
+
+    // Change the dimensions of the matrix.  The contents after a resize
+    // are unspecified.
+    void resize(int nrow, int ncol);
+
+    double *data() { return data_.data(); }
+    const double *data() const { return data_.data(); }
+
+    double &operator()(int i, int j) {
+      return data_[i + j * leading_dimension_];
+    }
+    const double &operator()(int i, int j) const {
+      return data_[i + j * leading_dimension_];
+    }
+
+    // Views of the nrow() x ncol() matrix, excluding the padding.
+    SubMatrix view();
+    ConstSubMatrix view() const;
+
+    // Copy the elements of rhs, resizing *this if needed.
+    AlignedMatrix &operator=(const ConstSubMatrix &rhs);
+
+    // The leading dimension of an AlignedMatrix with 'nrow' rows: nrow
+    // rounded up to a multiple of the number of doubles in kSimdAlignment
+    // bytes.
+    static int padded_leading_dimension(int nrow);
+
+   private:
+    int nrow_;
+    int ncol_;
+    int leading_dimension_;
+    std::vector<double, AlignedAllocator<double>> data_;
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_LINALG_ALIGNED_MATRIX_HPP_
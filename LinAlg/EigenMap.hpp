@@ -20,7 +20,9 @@
 */
 
 #include "Eigen/Core"
+#include "LinAlg/AlignedMatrix.hpp"
 #include "LinAlg/Matrix.hpp"
+#include "LinAlg/SubMatrix.hpp"
 #include "LinAlg/Vector.hpp"
 
 namespace BOOM {
@@ -36,6 +38,48 @@ namespace BOOM {
     return ::Eigen::Map<const ::Eigen::MatrixXd>(m.data(), m.nrow(), m.ncol());
   }
 
+  // Maps for SubMatrix and ConstSubMatrix, which are strided column major
+  // views.
+  inline ::Eigen::Map<::Eigen::MatrixXd, ::Eigen::Unaligned,
+                      ::Eigen::OuterStride<::Eigen::Dynamic>>
+  EigenMap(SubMatrix &m) {
+    return ::Eigen::Map<::Eigen::MatrixXd, ::Eigen::Unaligned,
+                        ::Eigen::OuterStride<::Eigen::Dynamic>>(
+        m.data(), m.nrow(), m.ncol(),
+        ::Eigen::OuterStride<::Eigen::Dynamic>(m.stride()));
+  }
+
+  inline ::Eigen::Map<const ::Eigen::MatrixXd, ::Eigen::Unaligned,
+                      ::Eigen::OuterStride<::Eigen::Dynamic>>
+  EigenMap(const ConstSubMatrix &m) {
+    return ::Eigen::Map<const ::Eigen::MatrixXd, ::Eigen::Unaligned,
+                        ::Eigen::OuterStride<::Eigen::Dynamic>>(
+        m.data(), m.nrow(), m.ncol(),
+        ::Eigen::OuterStride<::Eigen::Dynamic>(m.stride()));
+  }
+
+  // Maps for AlignedMatrix.  The data start on a kSimdAlignment byte
+  // boundary, so Eigen may use aligned loads and stores.
+  static_assert(kSimdAlignment == 64,
+                "The AlignedMatrix maps must match kSimdAlignment.");
+  inline ::Eigen::Map<::Eigen::MatrixXd, ::Eigen::Aligned64,
+                      ::Eigen::OuterStride<::Eigen::Dynamic>>
+  EigenMap(AlignedMatrix &m) {
+    return ::Eigen::Map<::Eigen::MatrixXd, ::Eigen::Aligned64,
+                        ::Eigen::OuterStride<::Eigen::Dynamic>>(
+        m.data(), m.nrow(), m.ncol(),
+        ::Eigen::OuterStride<::Eigen::Dynamic>(m.leading_dimension()));
+  }
+
+  inline ::Eigen::Map<const ::Eigen::MatrixXd, ::Eigen::Aligned64,
+                      ::Eigen::OuterStride<::Eigen::Dynamic>>
+  EigenMap(const AlignedMatrix &m) {
+    return ::Eigen::Map<const ::Eigen::MatrixXd, ::Eigen::Aligned64,
+                        ::Eigen::OuterStride<::Eigen::Dynamic>>(
+        m.data(), m.nrow(), m.ncol(),
+        ::Eigen::OuterStride<::Eigen::Dynamic>(m.leading_dimension()));
+  }
+
   // Maps for Vectors
   inline ::Eigen::Map<::Eigen::VectorXd> EigenMap(Vector &v) {
     return ::Eigen::Map<::Eigen::VectorXd>(v.data(), v.size());
@@ -0,0 +1,181 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include "LinAlg/IncrementalCholesky.hpp"
+#include <cmath>
+#include "cpputil/math_utils.hpp"
+#include "cpputil/report_error.hpp"
+
+namespace BOOM {
+
+  bool IncrementalCholesky::decompose(const SpdMatrix &A) {
+    clear();
+    int n = A.nrow();
+    packed_.reserve(offset(n));
+    // Appending the columns of A one at a time is the row-oriented Cholesky
+    // algorithm.
+    for (int i = 0; i < n; ++i) {
+      ConstVectorView column(A.col(i), 0, i);
+      if (!append(column, A(i, i))) {
+        clear();
+        pos_def_ = false;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void IncrementalCholesky::clear() {
+    dim_ = 0;
+    pos_def_ = true;
+    packed_.clear();
+  }
+
+  bool IncrementalCholesky::append(const ConstVectorView &off_diagonal,
+                                   double diagonal) {
+    if (off_diagonal.size() != dim_) {
+      report_error("Wrong size argument passed to "
+                   "IncrementalCholesky::append.");
+    }
+    // The new row of L is l = L^{-1} * off_diagonal, with diagonal element
+    // sqrt(diagonal - l.dot(l)).
+    std::size_t start = packed_.size();
+    packed_.resize(start + dim_ + 1);
+    double *row = packed_.data() + start;
+    double sumsq = 0;
+    for (int i = 0; i < dim_; ++i) {
+      const double *Li = packed_.data() + offset(i);
+      double value = off_diagonal[i];
+      for (int j = 0; j < i; ++j) {
+        value -= Li[j] * row[j];
+      }
+      value /= Li[i];
+      row[i] = value;
+      sumsq += value * value;
+    }
+    double residual_variance = diagonal - sumsq;
+    if (!(residual_variance > 0) || !std::isfinite(residual_variance)) {
+      packed_.resize(start);
+      return false;
+    }
+    row[dim_] = std::sqrt(residual_variance);
+    ++dim_;
+    return true;
+  }
+
+  void IncrementalCholesky::remove(int position) {
+    if (position < 0 || position >= dim_) {
+      report_error("Position out of range in IncrementalCholesky::remove.");
+    }
+    double *L = packed_.data();
+    // Rows below 'position' are updated so that the trailing block T
+    // satisfies T_new * T_new^T = T * T^T + x * x^T, where x holds the part
+    // of column 'position' below the diagonal.
+    std::vector<double> x(dim_ - position - 1);
+    for (int i = position + 1; i < dim_; ++i) {
+      x[i - position - 1] = L[offset(i) + position];
+    }
+    for (int k = position + 1; k < dim_; ++k) {
+      double &Lkk = L[offset(k) + k];
+      double xk = x[k - position - 1];
+      double r = std::hypot(Lkk, xk);
+      double c = r / Lkk;
+      double s = xk / Lkk;
+      Lkk = r;
+      for (int i = k + 1; i < dim_; ++i) {
+        double &Lik = L[offset(i) + k];
+        double &xi = x[i - position - 1];
+        Lik = (Lik + s * xi) / c;
+        xi = c * xi - s * Lik;
+      }
+    }
+
+    // Compact the storage, dropping row and column 'position'.  Each element
+    // moves toward the front of packed_, so copying in order is safe.
+    std::size_t destination = offset(position);
+    for (int i = position + 1; i < dim_; ++i) {
+      const double *source = L + offset(i);
+      for (int j = 0; j <= i; ++j) {
+        if (j != position) L[destination++] = source[j];
+      }
+    }
+    --dim_;
+    packed_.resize(offset(dim_));
+  }
+
+  Matrix IncrementalCholesky::getL() const {
+    Matrix ans(dim_, dim_, 0.0);
+    for (int i = 0; i < dim_; ++i) {
+      for (int j = 0; j <= i; ++j) {
+        ans(i, j) = (*this)(i, j);
+      }
+    }
+    return ans;
+  }
+
+  SpdMatrix IncrementalCholesky::original_matrix() const {
+    Matrix L = getL();
+    return SpdMatrix(L * L.transpose());
+  }
+
+  double IncrementalCholesky::logdet() const {
+    if (!pos_def_) return negative_infinity();
+    double ans = 0;
+    for (int i = 0; i < dim_; ++i) {
+      ans += std::log((*this)(i, i));
+    }
+    return 2 * ans;
+  }
+
+  void IncrementalCholesky::Lsolve_inplace(VectorView b) const {
+    if (b.size() != dim_) {
+      report_error("Wrong size argument to IncrementalCholesky::Lsolve.");
+    }
+    for (int i = 0; i < dim_; ++i) {
+      const double *Li = packed_.data() + offset(i);
+      double value = b[i];
+      for (int j = 0; j < i; ++j) {
+        value -= Li[j] * b[j];
+      }
+      b[i] = value / Li[i];
+    }
+  }
+
+  void IncrementalCholesky::LTsolve_inplace(VectorView b) const {
+    if (b.size() != dim_) {
+      report_error("Wrong size argument to IncrementalCholesky::LTsolve.");
+    }
+    // Column i of L^T is row i of L, so work backward through the rows.
+    for (int i = dim_ - 1; i >= 0; --i) {
+      const double *Li = packed_.data() + offset(i);
+      b[i] /= Li[i];
+      double value = b[i];
+      for (int j = 0; j < i; ++j) {
+        b[j] -= Li[j] * value;
+      }
+    }
+  }
+
+  Vector IncrementalCholesky::solve(const ConstVectorView &b) const {
+    Vector ans(b);
+    Lsolve_inplace(VectorView(ans));
+    LTsolve_inplace(VectorView(ans));
+    return ans;
+  }
+
+}  // namespace BOOM
@@ -0,0 +1,113 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+#ifndef BOOM_INCREMENTAL_CHOLESKY_HPP_
+#define BOOM_INCREMENTAL_CHOLESKY_HPP_
+
+#include <vector>
+#include "LinAlg/Matrix.hpp"
+#include "LinAlg/SpdMatrix.hpp"
+#include "LinAlg/Vector.hpp"
+#include "LinAlg/VectorView.hpp"
+
+namespace BOOM {
+
+  // The lower Cholesky triangle L of a symmetric positive definite matrix A,
+  // stored so that a row and column can be appended to A, or an arbitrary row
+  // and column deleted from A, in O(dim^2) time rather than the O(dim^3)
+  // needed to recompute the decomposition.  This is the operation needed
+  // when a variable enters or leaves a regression model.
+  //
+  // Appending solves a triangular system for the new row of L.  Deleting
+  // row/column j of A removes row j of L, and the trailing block of L
+  // receives a rank-one update (by Givens rotations) to absorb the deleted
+  // column.  Both operations are numerically stable.
+  //
+  // L is stored packed by rows, so that appending a row does not move the
+  // existing rows, and copying the object (e.g. to try out a change without
+  // committing to it) costs O(dim^2).
+  class IncrementalCholesky {
+   public:
+    // An empty (0 x 0) decomposition.
+    IncrementalCholesky() : dim_(0), pos_def_(true) {}
+
+    // Decompose the matrix A.  Check is_pos_def() to see whether the
+    // decomposition succeeded.
+    explicit IncrementalCholesky(const SpdMatrix &A) { decompose(A); }
+
+    // Compute and store the Cholesky factor of A, discarding any previous
+    // decomposition.  Returns true iff A is positive definite.  If A is not
+    // positive definite the decomposition is left empty.
+    bool decompose(const SpdMatrix &A);
+
+    // Remove all rows and columns.
+    void clear();
+
+    // Grow A by one row and column.
+    //
+    // Args:
+    //   off_diagonal: The new column of A, excluding the diagonal element.
+    //     Its size must equal dim().
+    //   diagonal:  The new diagonal element of A.
+    //
+    // Returns:
+    //   true if the enlarged matrix is positive definite, in which case the
+    //   decomposition is updated.  Otherwise the decomposition is unchanged.
+    bool append(const ConstVectorView &off_diagonal, double diagonal);
+
+    // Delete row and column 'position' of A.
+    void remove(int position);
+
+    int dim() const { return dim_; }
+    bool is_pos_def() const { return pos_def_; }
+
+    // Element (i, j) of L, for j <= i.
+    double operator()(int i, int j) const { return packed_[offset(i) + j]; }
+
+    // The lower Cholesky triangle L as a dense matrix.
+    Matrix getL() const;
+
+    // The represented matrix A = L * L^T.
+    SpdMatrix original_matrix() const;
+
+    // log |A|
+    double logdet() const;
+
+    // Replace b with L^{-1} b.
+    void Lsolve_inplace(VectorView b) const;
+
+    // Replace b with L^{-T} b.
+    void LTsolve_inplace(VectorView b) const;
+
+    // A^{-1} b.
+    Vector solve(const ConstVectorView &b) const;
+
+   private:
+    // The position in packed_ of the start of row i.
+    static std::size_t offset(int i) {
+      return static_cast<std::size_t>(i) * (i + 1) / 2;
+    }
+
+    int dim_;
+    bool pos_def_;
+    // Rows of L, stored one after the other.  Row i has i + 1 elements.
+    std::vector<double> packed_;
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_INCREMENTAL_CHOLESKY_HPP_
@@ -441,11 +441,42 @@ namespace BOOM {
 
   SpdMatrix &SpdMatrix::add_inner(const Matrix &X, const Vector &w,
                                   bool force_sym) {
-    assert(X.nrow() == w.size());
-    assert(X.ncol() == this->ncol());
-    uint n = w.size();
-    for (uint i = 0; i < n; ++i) {
-      this->add_outer(X.row(i), w[i], false);
+    return add_inner(ConstSubMatrix(X), ConstVectorView(w), force_sym);
+  }
+
+  SpdMatrix &SpdMatrix::add_inner(const ConstSubMatrix &X,
+                                  const ConstVectorView &w, bool force_sym) {
+    if (X.nrow() != w.size() || X.ncol() != this->ncol()) {
+      report_error("Wrong size arguments to SpdMatrix::add_inner.");
+    }
+    // Rows are processed in chunks.  Each row of a chunk is scaled by the
+    // square root of its absolute weight, so the chunk's contribution is a
+    // symmetric rank-k update of the upper triangle.  Rows with positive
+    // weights are gathered at the top of the scaled chunk and rows with
+    // negative weights at the bottom, so each sign needs one update.
+    const int chunk_size = 1024;
+    int n = X.nrow();
+    int dim = X.ncol();
+    auto sigma = EigenMap(*this);
+    Eigen::MatrixXd scaled(std::min(chunk_size, n), dim);
+    for (int begin = 0; begin < n; begin += chunk_size) {
+      int rows = std::min<int>(chunk_size, n - begin);
+      int positive = 0;
+      int negative = 0;
+      for (int i = begin; i < begin + rows; ++i) {
+        double weight = w[i];
+        if (weight == 0) continue;
+        int row = weight > 0 ? positive++ : scaled.rows() - ++negative;
+        scaled.row(row) = sqrt(fabs(weight)) * EigenMap(X.row(i)).transpose();
+      }
+      if (positive > 0) {
+        sigma.selfadjointView<Eigen::Upper>().rankUpdate(
+            scaled.topRows(positive).transpose(), 1.0);
+      }
+      if (negative > 0) {
+        sigma.selfadjointView<Eigen::Upper>().rankUpdate(
+            scaled.bottomRows(negative).transpose(), -1.0);
+      }
     }
     if (force_sym) reflect();
     return *this;
@@ -156,8 +156,15 @@ namespace BOOM {
                          bool force_sym = true);
 
     SpdMatrix &add_inner(const Matrix &x, double w = 1.0);
+
+    // *this += X^T diag(w) X, computed as a single blocked (SYRK-like)
+    // product.  If force_sym is false only the upper triangle is updated,
+    // and the caller is responsible for calling reflect() before using the
+    // lower triangle.
     SpdMatrix &add_inner(const Matrix &X, const Vector &w,
-                         bool force_sym = true);  // *this+= X^T w X
+                         bool force_sym = true);
+    SpdMatrix &add_inner(const ConstSubMatrix &X, const ConstVectorView &w,
+                         bool force_sym = true);
 
     // *this  += w x.t()*y + y.t()*x;
     SpdMatrix &add_inner2(const Matrix &x, const Matrix &y, double w = 1.0);
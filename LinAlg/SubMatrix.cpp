@@ -30,26 +30,26 @@ namespace BOOM {
       : start_(m.data() + rlo + clo * m.nrow()),
         nr_(rhi - rlo + 1),
         nc_(chi - clo + 1),
-        stride(m.nrow()) {
+        stride_(m.nrow()) {
     assert(nr_ >= 0);
     assert(nc_ >= 0);
     assert(rhi < m.nrow() && chi < m.ncol());
   }
 
   SM::SubMatrix(Matrix &m)
-      : start_(m.data()), nr_(m.nrow()), nc_(m.ncol()), stride(m.nrow()) {}
+      : start_(m.data()), nr_(m.nrow()), nc_(m.ncol()), stride_(m.nrow()) {}
 
   SM::SubMatrix(double *v, int nrow, int ncol)
-      : start_(v), nr_(nrow), nc_(ncol), stride(nrow) {}
+      : start_(v), nr_(nrow), nc_(ncol), stride_(nrow) {}
 
   SM::SubMatrix(SM &m, uint rlo, uint rhi, uint clo, uint chi)
-      : start_(m.start_ + rlo + clo * m.stride),
+      : start_(m.start_ + rlo + clo * m.stride_),
         nr_(rhi - rlo + 1),
         nc_(chi - clo + 1),
-        stride(m.stride) {}
+        stride_(m.stride_) {}
 
   SM::SubMatrix(const SM &rhs)
-      : start_(rhs.start_), nr_(rhs.nr_), nc_(rhs.nc_), stride(rhs.stride) {}
+      : start_(rhs.start_), nr_(rhs.nr_), nc_(rhs.nc_), stride_(rhs.stride_) {}
 
   SM &SM::operator=(const SM &rhs) {
     assert(rhs.nrow() == nr_ && rhs.ncol() == nc_);
@@ -64,7 +64,7 @@ namespace BOOM {
       start_ = rhs.start_;
       nr_ = rhs.nr_;
       nc_ = rhs.nc_;
-      stride = rhs.stride;
+      stride_ = rhs.stride_;
     }
     return *this;
   }
@@ -73,7 +73,7 @@ namespace BOOM {
     start_ = rhs.data() + rlo + clo * rhs.nrow();
     nr_ = (rhi - rlo + 1);
     nc_ = (chi - clo + 1);
-    stride = (rhs.nrow());
+    stride_ = (rhs.nrow());
     assert(nr_ >= 0);
     assert(nc_ >= 0);
     assert(rhi < rhs.nrow() && chi < rhs.ncol());
@@ -84,7 +84,7 @@ namespace BOOM {
     start_ = data;
     nr_ = nrow;
     nc_ = ncol;
-    stride = new_stride;
+    stride_ = new_stride;
     return *this;
   }
 
@@ -120,11 +120,11 @@ namespace BOOM {
 
   //------------------------------------------------------------
   VectorView SM::row(uint i) {
-    VectorView ans(cols(0) + i, nc_, stride);
+    VectorView ans(cols(0) + i, nc_, stride_);
     return ans;
   }
   ConstVectorView SM::row(uint i) const {
-    ConstVectorView ans(cols(0) + i, nc_, stride);
+    ConstVectorView ans(cols(0) + i, nc_, stride_);
     return ans;
   }
   VectorView SM::last_row() { return row(nr_ - 1); }
@@ -132,35 +132,35 @@ namespace BOOM {
 
   VectorView SM::diag() {
     int m = std::min(nr_, nc_);
-    return VectorView(cols(0), m, stride + 1);
+    return VectorView(cols(0), m, stride_ + 1);
   }
   ConstVectorView SM::diag() const {
     int m = std::min(nr_, nc_);
-    return ConstVectorView(cols(0), m, stride + 1);
+    return ConstVectorView(cols(0), m, stride_ + 1);
   }
 
   VectorView SM::subdiag(int i) {
     if (i < 0) return superdiag(-i);
     int m = std::min(nr_, nc_);
-    return VectorView(cols(0) + i, m - i, stride + 1);
+    return VectorView(cols(0) + i, m - i, stride_ + 1);
   }
 
   ConstVectorView SM::subdiag(int i) const {
     if (i < 0) return superdiag(-i);
     int m = std::min(nr_, nc_);
-    return ConstVectorView(cols(0) + i, m - i, stride + 1);
+    return ConstVectorView(cols(0) + i, m - i, stride_ + 1);
   }
 
   VectorView SM::superdiag(int i) {
     if (i < 0) return subdiag(-1);
     int m = std::min(nr_, nc_);
-    return VectorView(cols(i), m - i, stride + 1);
+    return VectorView(cols(i), m - i, stride_ + 1);
   }
 
   ConstVectorView SM::superdiag(int i) const {
     if (i < 0) return subdiag(-1);
     int m = std::min(nr_, nc_);
-    return ConstVectorView(cols(i), m - i, stride + 1);
+    return ConstVectorView(cols(i), m - i, stride_ + 1);
   }
 
   //------------------------------------------------------------
@@ -292,16 +292,16 @@ namespace BOOM {
 
   //======================================================================
   CSM::ConstSubMatrix(const Matrix &m)
-      : start_(m.data()), nr_(m.nrow()), nc_(m.ncol()), stride(m.nrow()) {}
+      : start_(m.data()), nr_(m.nrow()), nc_(m.ncol()), stride_(m.nrow()) {}
 
   CSM::ConstSubMatrix(const SubMatrix &m)
-      : start_(m.start_), nr_(m.nr_), nc_(m.nc_), stride(m.stride) {}
+      : start_(m.start_), nr_(m.nr_), nc_(m.nc_), stride_(m.stride_) {}
 
   CSM::ConstSubMatrix(const Matrix &m, uint rlo, uint rhi, uint clo, uint chi)
       : start_(m.data() + clo * m.nrow() + rlo),
         nr_(rhi - rlo + 1),
         nc_(chi - clo + 1),
-        stride(m.nrow()) {
+        stride_(m.nrow()) {
     if (rlo < 0 || clo < 0) {
       report_error("Row and column indices cannot be less than zero.");
     }
@@ -323,10 +323,10 @@ namespace BOOM {
       : start_(data),
         nr_(nrow),
         nc_(ncol),
-        stride(my_stride >= 1 ? my_stride : nr_) {
+        stride_(my_stride >= 1 ? my_stride : nr_) {
     assert(nr_ >= 0);
     assert(nc_ >= 0);
-    assert(stride >= 1);
+    assert(stride_ >= 1);
   }
 
   CSM & ConstSubMatrix::reset(const Matrix &rhs, int rlo, int rhi,
@@ -334,7 +334,7 @@ namespace BOOM {
     start_ = rhs.data() + rlo + clo * rhs.nrow();
     nr_ = (rhi - rlo + 1);
     nc_ = (chi - clo + 1);
-    stride = (rhs.nrow());
+    stride_ = (rhs.nrow());
     assert(nr_ >= 0);
     assert(nc_ >= 0);
     assert(rhi < rhs.nrow() && chi < rhs.ncol());
@@ -357,26 +357,26 @@ namespace BOOM {
   }
   ConstVectorView CSM::last_col() const { return col(nc_ - 1); }
   ConstVectorView CSM::row(uint i) const {
-    ConstVectorView ans(cols(0) + i, nc_, stride);
+    ConstVectorView ans(cols(0) + i, nc_, stride_);
     return ans;
   }
   ConstVectorView CSM::last_row() const { return row(nr_ - 1); }
 
   ConstVectorView CSM::diag() const {
     int m = std::min(nr_, nc_);
-    return ConstVectorView(cols(0), m, stride + 1);
+    return ConstVectorView(cols(0), m, stride_ + 1);
   }
 
   ConstVectorView CSM::subdiag(int i) const {
     if (i < 0) return superdiag(-i);
     int m = std::min(nr_, nc_);
-    return ConstVectorView(cols(0) + i, m - i, stride + 1);
+    return ConstVectorView(cols(0) + i, m - i, stride_ + 1);
   }
 
   ConstVectorView CSM::superdiag(int i) const {
     if (i < 0) return subdiag(-1);
     int m = std::min(nr_, nc_);
-    return ConstVectorView(cols(i), m - i, stride + 1);
+    return ConstVectorView(cols(i), m - i, stride_ + 1);
   }
 
   //------------------------------------------------------------
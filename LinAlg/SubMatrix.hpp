@@ -94,12 +94,18 @@ namespace BOOM {
     Matrix to_matrix() const;
     std::ostream &display(std::ostream &out, int precision) const;
 
+    // The address of the (0, 0) element, and the number of memory steps
+    // between adjacent columns.
+    double *data() { return start_; }
+    const double *data() const { return start_; }
+    int stride() const { return stride_; }
+
    private:
     double *start_;
     uint nr_, nc_;  // number of rows and columns in the SubMatrix
-    uint stride;    // number of rows in the parent matrix
-    double *cols(int i) { return start_ + stride * i; }
-    const double *cols(int i) const { return start_ + stride * i; }
+    uint stride_;   // number of rows in the parent matrix
+    double *cols(int i) { return start_ + stride_ * i; }
+    const double *cols(int i) const { return start_ + stride_ * i; }
 
     friend class ConstSubMatrix;
   };
@@ -155,11 +161,16 @@ namespace BOOM {
     Matrix transpose() const;
     std::ostream &display(std::ostream &out, int precision) const;
 
+    // The address of the (0, 0) element, and the number of memory steps
+    // between adjacent columns.
+    const double *data() const { return start_; }
+    int stride() const { return stride_; }
+
    private:
     const double *start_;
     uint nr_, nc_;
-    uint stride;
-    const double *cols(int i) const { return start_ + stride * i; }
+    uint stride_;
+    const double *cols(int i) const { return start_ + stride_ * i; }
   };
 
   std::ostream &operator<<(std::ostream &out, const ConstSubMatrix &m);
@@ -0,0 +1,335 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_LINALG_VECTOR_EXPRESSION_HPP_
+#define BOOM_LINALG_VECTOR_EXPRESSION_HPP_
+
+#include <sstream>
+#include "LinAlg/Vector.hpp"
+#include "LinAlg/VectorView.hpp"
+#include "cpputil/report_error.hpp"
+
+namespace BOOM {
+
+  // Lazy, element-wise arithmetic for Vector, VectorView, and
+  // ConstVectorView.
+  //
+  // The ordinary arithmetic operators on Vector return a newly allocated
+  // Vector, so an expression like beta + sigma * z allocates one temporary
+  // for sigma * z and another for the sum.  Wrapping the operands in lazy()
+  // builds an expression object instead.  Nothing is computed until the
+  // expression is assigned somewhere, at which point the whole expression is
+  // evaluated in a single loop with no intermediate storage.
+  //
+  //   Vector beta, z;
+  //   double sigma;
+  //   Vector draw = lazy(beta) + sigma * lazy(z);       // One allocation.
+  //   (lazy(beta) + sigma * lazy(z)).assign_to(draw);   // No allocations.
+  //   double ss = (lazy(y) - lazy(yhat)).normsq();      // No allocations.
+  //
+  // Any expression that contains at least one lazy() operand is lazy, so
+  // lazy(a) + b * c is evaluated eagerly for b * c and lazily for the sum.
+  // Wrap every operand to fuse the whole expression.
+  //
+  // Only element-wise Vector arithmetic is covered.  Matrix and SpdMatrix
+  // operators, and matrix-vector products, are still eager.  Compute a
+  // product into a workspace Vector (e.g. with Matrix::mult) and use the
+  // workspace as an operand, or accumulate it in place with
+  // EigenMap(y).noalias() += EigenMap(A) * EigenMap(x).
+  //
+  // Expressions hold pointers to the data of their operands, so an
+  // expression must not outlive the objects it refers to.  In particular, do
+  // not store an expression built from temporaries in an 'auto' variable.
+  // It is safe for the destination of assign_to() or add_to() to be one of
+  // the operands, as long as the two refer to exactly the same elements.
+  namespace VectorExpressions {
+
+    template <class EXPR>
+    class VectorExpression {
+     public:
+      const EXPR &derived() const { return static_cast<const EXPR &>(*this); }
+      int size() const { return derived().size(); }
+
+      // Evaluate the expression into a newly allocated Vector.
+      operator Vector() const {
+        Vector ans(size());
+        write(ans.data(), 1, false, 1.0);
+        return ans;
+      }
+
+      // Evaluate the expression, storing the result in 'out', which must
+      // be the same size as the expression.
+      void assign_to(VectorView out) const {
+        check_size(out.size());
+        write(out.data(), out.stride(), false, 1.0);
+      }
+      void assign_to(Vector &out) const {
+        out.resize(size());
+        write(out.data(), 1, false, 1.0);
+      }
+
+      // Add weight * (the value of the expression) to 'out'.
+      void add_to(VectorView out, double weight = 1.0) const {
+        check_size(out.size());
+        write(out.data(), out.stride(), true, weight);
+      }
+      void add_to(Vector &out, double weight = 1.0) const {
+        check_size(out.size());
+        write(out.data(), 1, true, weight);
+      }
+
+      // Reductions, computed without storing the expression.
+      double sum() const {
+        const EXPR &expr(derived());
+        double ans = 0;
+        for (int i = 0; i < expr.size(); ++i) ans += expr[i];
+        return ans;
+      }
+
+      double normsq() const {
+        const EXPR &expr(derived());
+        double ans = 0;
+        for (int i = 0; i < expr.size(); ++i) {
+          double value = expr[i];
+          ans += value * value;
+        }
+        return ans;
+      }
+
+     private:
+      void check_size(int n) const {
+        if (n != size()) {
+          std::ostringstream err;
+          err << "A vector expression of size " << size()
+              << " cannot be assigned to a vector of size " << n << ".";
+          report_error(err.str());
+        }
+      }
+
+      // The single loop that evaluates the expression.  The stride == 1
+      // case is split out so the compiler can vectorize it.
+      void write(double *data, int stride, bool accumulate,
+                 double weight) const {
+        const EXPR &expr(derived());
+        const int n = expr.size();
+        if (stride == 1) {
+          if (accumulate) {
+            for (int i = 0; i < n; ++i) data[i] += weight * expr[i];
+          } else {
+            for (int i = 0; i < n; ++i) data[i] = expr[i];
+          }
+        } else {
+          if (accumulate) {
+            for (int i = 0; i < n; ++i) data[i * stride] += weight * expr[i];
+          } else {
+            for (int i = 0; i < n; ++i) data[i * stride] = expr[i];
+          }
+        }
+      }
+    };
+
+    //---------------------------------------------------------------------
+    // Leaves of the expression tree.  A Vector is always contiguous, so it
+    // gets its own leaf type that avoids the stride multiplication.
+    class ContiguousOperand : public VectorExpression<ContiguousOperand> {
+     public:
+      ContiguousOperand(const double *data, int size)
+          : data_(data), size_(size) {}
+      int size() const { return size_; }
+      double operator[](int i) const { return data_[i]; }
+
+     private:
+      const double *data_;
+      int size_;
+    };
+
+    class StridedOperand : public VectorExpression<StridedOperand> {
+     public:
+      StridedOperand(const double *data, int size, int stride)
+          : data_(data), size_(size), stride_(stride) {}
+      int size() const { return size_; }
+      double operator[](int i) const { return data_[i * stride_]; }
+
+     private:
+      const double *data_;
+      int size_;
+      int stride_;
+    };
+
+    //---------------------------------------------------------------------
+    // Element-wise operations.
+    struct Plus {
+      static double apply(double a, double b) { return a + b; }
+    };
+    struct Minus {
+      static double apply(double a, double b) { return a - b; }
+    };
+    struct Times {
+      static double apply(double a, double b) { return a * b; }
+    };
+    struct Divide {
+      static double apply(double a, double b) { return a / b; }
+    };
+
+    // Interior nodes store their children by value.  Nodes are small (the
+    // leaves are a pointer and a size), and storing by value means an
+    // expression does not refer to the temporary nodes it was built from.
+    template <class LHS, class RHS, class OP>
+    class BinaryExpression
+        : public VectorExpression<BinaryExpression<LHS, RHS, OP>> {
+     public:
+      BinaryExpression(const LHS &lhs, const RHS &rhs) : lhs_(lhs), rhs_(rhs) {
+        if (lhs_.size() != rhs_.size()) {
+          std::ostringstream err;
+          err << "Vector expression operands have different sizes: "
+              << lhs_.size() << " and " << rhs_.size() << ".";
+          report_error(err.str());
+        }
+      }
+      int size() const { return lhs_.size(); }
+      double operator[](int i) const { return OP::apply(lhs_[i], rhs_[i]); }
+
+     private:
+      LHS lhs_;
+      RHS rhs_;
+    };
+
+    // expression OP scalar.
+    template <class EXPR, class OP>
+    class ScalarRightExpression
+        : public VectorExpression<ScalarRightExpression<EXPR, OP>> {
+     public:
+      ScalarRightExpression(const EXPR &expr, double scalar)
+          : expr_(expr), scalar_(scalar) {}
+      int size() const { return expr_.size(); }
+      double operator[](int i) const { return OP::apply(expr_[i], scalar_); }
+
+     private:
+      EXPR expr_;
+      double scalar_;
+    };
+
+    // scalar OP expression.
+    template <class EXPR, class OP>
+    class ScalarLeftExpression
+        : public VectorExpression<ScalarLeftExpression<EXPR, OP>> {
+     public:
+      ScalarLeftExpression(double scalar, const EXPR &expr)
+          : scalar_(scalar), expr_(expr) {}
+      int size() const { return expr_.size(); }
+      double operator[](int i) const { return OP::apply(scalar_, expr_[i]); }
+
+     private:
+      double scalar_;
+      EXPR expr_;
+    };
+
+    inline ContiguousOperand as_operand(const Vector &v) {
+      return ContiguousOperand(v.data(), v.size());
+    }
+    inline StridedOperand as_operand(const VectorView &v) {
+      return StridedOperand(v.data(), v.size(), v.stride());
+    }
+    inline StridedOperand as_operand(const ConstVectorView &v) {
+      return StridedOperand(v.data(), v.size(), v.stride());
+    }
+
+    // Each operator is defined for (expression, expression), (expression,
+    // scalar), (scalar, expression), and for an expression mixed with a
+    // Vector, VectorView, or ConstVectorView on either side.
+#define BOOM_VECTOR_EXPRESSION_OPERATOR(op, OP)                              \
+    template <class L, class R>                                              \
+    BinaryExpression<L, R, OP> operator op(const VectorExpression<L> &lhs,   \
+                                           const VectorExpression<R> &rhs) { \
+      return BinaryExpression<L, R, OP>(lhs.derived(), rhs.derived());       \
+    }                                                                        \
+    template <class L>                                                       \
+    ScalarRightExpression<L, OP> operator op(const VectorExpression<L> &lhs, \
+                                             double rhs) {                   \
+      return ScalarRightExpression<L, OP>(lhs.derived(), rhs);               \
+    }                                                                        \
+    template <class R>                                                       \
+    ScalarLeftExpression<R, OP> operator op(double lhs,                      \
+                                            const VectorExpression<R> &rhs) { \
+      return ScalarLeftExpression<R, OP>(lhs, rhs.derived());                \
+    }                                                                        \
+    template <class L>                                                       \
+    BinaryExpression<L, ContiguousOperand, OP> operator op(                  \
+        const VectorExpression<L> &lhs, const Vector &rhs) {                 \
+      return BinaryExpression<L, ContiguousOperand, OP>(lhs.derived(),       \
+                                                        as_operand(rhs));    \
+    }                                                                        \
+    template <class R>                                                       \
+    BinaryExpression<ContiguousOperand, R, OP> operator op(                  \
+        const Vector &lhs, const VectorExpression<R> &rhs) {                 \
+      return BinaryExpression<ContiguousOperand, R, OP>(as_operand(lhs),     \
+                                                        rhs.derived());      \
+    }                                                                        \
+    template <class L>                                                       \
+    BinaryExpression<L, StridedOperand, OP> operator op(                     \
+        const VectorExpression<L> &lhs, const VectorView &rhs) {             \
+      return BinaryExpression<L, StridedOperand, OP>(lhs.derived(),          \
+                                                     as_operand(rhs));       \
+    }                                                                        \
+    template <class R>                                                       \
+    BinaryExpression<StridedOperand, R, OP> operator op(                     \
+        const VectorView &lhs, const VectorExpression<R> &rhs) {             \
+      return BinaryExpression<StridedOperand, R, OP>(as_operand(lhs),        \
+                                                     rhs.derived());         \
+    }                                                                        \
+    template <class L>                                                       \
+    BinaryExpression<L, StridedOperand, OP> operator op(                     \
+        const VectorExpression<L> &lhs, const ConstVectorView &rhs) {        \
+      return BinaryExpression<L, StridedOperand, OP>(lhs.derived(),          \
+                                                     as_operand(rhs));       \
+    }                                                                        \
+    template <class R>                                                       \
+    BinaryExpression<StridedOperand, R, OP> operator op(                     \
+        const ConstVectorView &lhs, const VectorExpression<R> &rhs) {        \
+      return BinaryExpression<StridedOperand, R, OP>(as_operand(lhs),        \
+                                                     rhs.derived());         \
+    }
+
+    BOOM_VECTOR_EXPRESSION_OPERATOR(+, Plus)
+    BOOM_VECTOR_EXPRESSION_OPERATOR(-, Minus)
+    BOOM_VECTOR_EXPRESSION_OPERATOR(*, Times)
+    BOOM_VECTOR_EXPRESSION_OPERATOR(/, Divide)
+#undef BOOM_VECTOR_EXPRESSION_OPERATOR
+
+    template <class EXPR>
+    ScalarLeftExpression<EXPR, Times> operator-(
+        const VectorExpression<EXPR> &expr) {
+      return ScalarLeftExpression<EXPR, Times>(-1.0, expr.derived());
+    }
+
+  }  // namespace VectorExpressions
+
+  // Entry points to the lazy arithmetic described above.
+  inline VectorExpressions::ContiguousOperand lazy(const Vector &v) {
+    return VectorExpressions::as_operand(v);
+  }
+  inline VectorExpressions::StridedOperand lazy(const VectorView &v) {
+    return VectorExpressions::as_operand(v);
+  }
+  inline VectorExpressions::StridedOperand lazy(const ConstVectorView &v) {
+    return VectorExpressions::as_operand(v);
+  }
+
+}  // namespace BOOM
+
+#endif  // BOOM_LINALG_VECTOR_EXPRESSION_HPP_
@@ -4,6 +4,7 @@
 #include "LinAlg/Matrix.hpp"
 #include "LinAlg/Selector.hpp"
 #include "LinAlg/SpdMatrix.hpp"
+#include "LinAlg/SubMatrix.hpp"
 #include "LinAlg/Cholesky.hpp"
 #include "distributions.hpp"
 #include "cpputil/math_utils.hpp"
@@ -248,6 +249,44 @@ namespace {
         original_sigma + .3 * (X.transpose() * Y + Y.transpose() * X)));
   }
 
+  // The weighted add_inner processes rows in chunks.  Check that the result
+  // is correct when there are several chunks, when X is a view, and when
+  // some weights are negative or zero.
+  TEST_F(SpdMatrixTest, AddInnerBlocked) {
+    SpdMatrix Sigma(5);
+    Sigma.randomize();
+    Matrix X(3000, 5);
+    X.randomize();
+    Vector weights(X.nrow());
+    weights.randomize();
+
+    SpdMatrix original_sigma = Sigma;
+    SpdMatrix direct = original_sigma;
+    for (int i = 0; i < X.nrow(); ++i) {
+      direct.add_outer(X.row(i), weights[i]);
+    }
+    EXPECT_TRUE(MatrixEquals(Sigma.add_inner(X, weights), direct));
+
+    Sigma = original_sigma;
+    ConstSubMatrix rows(X, 100, 2099, 0, 4);
+    ConstVectorView row_weights(weights, 100, 2000);
+    direct = original_sigma;
+    for (int i = 100; i < 2100; ++i) {
+      direct.add_outer(X.row(i), weights[i]);
+    }
+    EXPECT_TRUE(MatrixEquals(Sigma.add_inner(rows, row_weights), direct));
+
+    // Weights can be negative or zero.
+    Vector signed_weights = weights - 0.5;
+    for (int i = 0; i < X.nrow(); i += 7) signed_weights[i] = 0.0;
+    Sigma = original_sigma;
+    direct = original_sigma;
+    for (int i = 0; i < X.nrow(); ++i) {
+      direct.add_outer(X.row(i), signed_weights[i]);
+    }
+    EXPECT_TRUE(MatrixEquals(Sigma.add_inner(X, signed_weights), direct));
+  }
+
   TEST_F(SpdMatrixTest, Chol2Inv) {
     SpdMatrix Sigma(4);
     Sigma.randomize();
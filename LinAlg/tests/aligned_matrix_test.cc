@@ -0,0 +1,79 @@
+#include "gtest/gtest.h"
+
+#include <cstdint>
+
+#include "LinAlg/AlignedMatrix.hpp"
+#include "LinAlg/EigenMap.hpp"
+#include "LinAlg/Matrix.hpp"
+#include "LinAlg/Vector.hpp"
+#include "distributions.hpp"
+#include "test_utils/test_utils.hpp"
+
+namespace {
+  using namespace BOOM;
+  using std::endl;
+
+  class AlignedMatrixTest : public ::testing::Test {
+   protected:
+    AlignedMatrixTest() { GlobalRng::rng.seed(8675309); }
+  };
+
+  bool is_aligned(const double *data) {
+    return reinterpret_cast<std::uintptr_t>(data) % kSimdAlignment == 0;
+  }
+
+  TEST_F(AlignedMatrixTest, ColumnsAreAlignedAndPadded) {
+    for (int nrow : {1, 3, 8, 17, 100}) {
+      AlignedMatrix m(nrow, 4, 2.5);
+      EXPECT_EQ(nrow, m.nrow());
+      EXPECT_EQ(4, m.ncol());
+      EXPECT_GE(m.leading_dimension(), nrow);
+      EXPECT_LT(m.leading_dimension(),
+                nrow + static_cast<int>(kSimdAlignment / sizeof(double)));
+      for (int j = 0; j < m.ncol(); ++j) {
+        EXPECT_TRUE(is_aligned(&m(0, j))) << "nrow = " << nrow
+                                          << ", column " << j;
+        for (int i = 0; i < nrow; ++i) {
+          EXPECT_DOUBLE_EQ(2.5, m(i, j));
+        }
+      }
+    }
+  }
+
+  TEST_F(AlignedMatrixTest, ViewsAndCopies) {
+    Matrix A(7, 5);
+    A.randomize();
+    AlignedMatrix aligned(A);
+    EXPECT_EQ(8, aligned.leading_dimension());
+    EXPECT_TRUE(MatrixEquals(A, aligned.view().to_matrix()));
+
+    aligned.view().col(2) = 3.0;
+    EXPECT_DOUBLE_EQ(3.0, aligned(4, 2));
+    EXPECT_DOUBLE_EQ(A(4, 3), aligned(4, 3));
+
+    Matrix B(3, 9);
+    B.randomize();
+    aligned = ConstSubMatrix(B);
+    EXPECT_EQ(3, aligned.nrow());
+    EXPECT_EQ(9, aligned.ncol());
+    EXPECT_TRUE(MatrixEquals(B, aligned.view().to_matrix()));
+  }
+
+  TEST_F(AlignedMatrixTest, EigenMapMatchesMatrix) {
+    Matrix A(13, 11);
+    A.randomize();
+    Vector x(11);
+    x.randomize();
+    AlignedMatrix aligned(A);
+
+    Vector y(13);
+    EigenMap(y) = EigenMap(aligned) * EigenMap(x);
+    EXPECT_TRUE(VectorEquals(A * x, y));
+
+    AlignedMatrix product(13, 13);
+    EigenMap(product).noalias() =
+        EigenMap(aligned) * EigenMap(aligned).transpose();
+    EXPECT_TRUE(MatrixEquals(A * A.transpose(), product.view().to_matrix()));
+  }
+
+}  // namespace
@@ -0,0 +1,93 @@
+// A benchmark measuring what AlignedMatrix buys.  Each operation is run
+// twice on the same data: once with the matrix stored in a Matrix, and
+// once with it stored in an AlignedMatrix, whose columns are aligned and
+// padded to a multiple of the SIMD width.  Reports the time per
+// evaluation for each.
+//
+// Usage:
+//   eigen_map_alignment_benchmark [dimension] [iterations]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "LinAlg/AlignedMatrix.hpp"
+#include "LinAlg/EigenMap.hpp"
+#include "LinAlg/Matrix.hpp"
+#include "LinAlg/Vector.hpp"
+#include "distributions.hpp"
+
+namespace {
+  using namespace BOOM;
+  using std::cout;
+  using std::endl;
+
+  // Run 'f' the requested number of times, and print the average time per
+  // call.
+  template <class F>
+  void benchmark(const std::string &name, int iterations, F f) {
+    f();  // Warm up.
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      f();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double nanoseconds =
+        std::chrono::duration<double, std::nano>(stop - start).count() /
+        iterations;
+    cout << name << ":" << endl
+         << "    nanoseconds per iteration:   " << nanoseconds << endl;
+  }
+
+  Vector random_vector(int n) {
+    Vector ans(n);
+    for (int i = 0; i < n; ++i) ans[i] = rnorm();
+    return ans;
+  }
+}  // namespace
+
+int main(int argc, char **argv) {
+  int dimension = argc > 1 ? std::atoi(argv[1]) : 100;
+  int iterations = argc > 2 ? std::atoi(argv[2]) : 10000;
+
+  GlobalRng::rng.seed(8675309);
+  Vector x = random_vector(dimension);
+  Vector out(dimension);
+  Matrix A(dimension, dimension);
+  A.randomize();
+  AlignedMatrix aligned_A(A);
+  Matrix B(dimension, dimension);
+  AlignedMatrix aligned_B(dimension, dimension);
+
+  cout << "dimension = " << dimension << ", iterations = " << iterations
+       << ", leading dimension = " << aligned_A.leading_dimension() << endl
+       << endl;
+
+  benchmark("Matrix * vector", iterations,
+            [&]() { EigenMap(out).noalias() = EigenMap(A) * EigenMap(x); });
+  benchmark("AlignedMatrix * vector", iterations, [&]() {
+    EigenMap(out).noalias() = EigenMap(aligned_A) * EigenMap(x);
+  });
+
+  // The rank-1 update behind SpdMatrix::add_outer.
+  benchmark("Matrix rank 1 update", iterations, [&]() {
+    EigenMap(B).noalias() += EigenMap(x) * EigenMap(x).transpose();
+  });
+  benchmark("AlignedMatrix rank 1 update", iterations, [&]() {
+    EigenMap(aligned_B).noalias() += EigenMap(x) * EigenMap(x).transpose();
+  });
+
+  // Fewer iterations for the O(dimension^3) matrix product.
+  int matrix_iterations = iterations / dimension + 1;
+  benchmark("Matrix * Matrix", matrix_iterations,
+            [&]() { EigenMap(B).noalias() = EigenMap(A) * EigenMap(A); });
+  benchmark("AlignedMatrix * AlignedMatrix", matrix_iterations, [&]() {
+    EigenMap(aligned_B).noalias() = EigenMap(aligned_A) * EigenMap(aligned_A);
+  });
+
+  // Keep the compiler from discarding the work.
+  cout << endl
+       << "checksum: " << out.sum() + B(0, 0) + aligned_B(0, 0) << endl;
+  return 0;
+}
@@ -0,0 +1,151 @@
+#include "gtest/gtest.h"
+#include "distributions.hpp"
+#include "LinAlg/Cholesky.hpp"
+#include "LinAlg/IncrementalCholesky.hpp"
+#include "LinAlg/Selector.hpp"
+#include "LinAlg/SpdMatrix.hpp"
+#include "Models/Glm/PosteriorSamplers/SpikeSlabCholeskyCache.hpp"
+#include "test_utils/test_utils.hpp"
+
+namespace {
+  using namespace BOOM;
+  using std::endl;
+
+  class IncrementalCholeskyTest : public ::testing::Test {
+   protected:
+    IncrementalCholeskyTest() {
+      GlobalRng::rng.seed(8675309);
+    }
+  };
+
+  TEST_F(IncrementalCholeskyTest, MatchesCholesky) {
+    SpdMatrix spd(6);
+    spd.randomize();
+    IncrementalCholesky incremental(spd);
+    EXPECT_TRUE(incremental.is_pos_def());
+    EXPECT_EQ(6, incremental.dim());
+
+    Cholesky cholesky(spd);
+    EXPECT_TRUE(MatrixEquals(incremental.getL(), cholesky.getL()));
+    EXPECT_TRUE(MatrixEquals(incremental.original_matrix(), spd));
+    EXPECT_NEAR(incremental.logdet(), cholesky.logdet(), 1e-8);
+
+    Vector v(6);
+    v.randomize();
+    EXPECT_TRUE(VectorEquals(spd * incremental.solve(v), v));
+  }
+
+  TEST_F(IncrementalCholeskyTest, AppendAndRemove) {
+    SpdMatrix spd(6);
+    spd.randomize();
+
+    // Build the decomposition by appending one column at a time.
+    IncrementalCholesky incremental;
+    for (int i = 0; i < 6; ++i) {
+      EXPECT_TRUE(incremental.append(ConstVectorView(spd.col(i), 0, i),
+                                     spd(i, i)));
+    }
+    EXPECT_TRUE(MatrixEquals(incremental.original_matrix(), spd));
+
+    // Remove an interior row/column and compare against the decomposition of
+    // the reduced matrix.
+    incremental.remove(2);
+    Selector keep("110111");
+    SpdMatrix reduced = keep.select(spd);
+    EXPECT_TRUE(MatrixEquals(incremental.original_matrix(), reduced))
+        << "incremental: " << endl << incremental.original_matrix()
+        << "reduced: " << endl << reduced;
+    EXPECT_TRUE(MatrixEquals(incremental.getL(), Cholesky(reduced).getL()));
+
+    // Removing the first and last elements exercises the edge cases.
+    incremental.remove(0);
+    incremental.remove(incremental.dim() - 1);
+    keep.drop(0);
+    keep.drop(5);
+    EXPECT_TRUE(MatrixEquals(incremental.original_matrix(), keep.select(spd)));
+
+    // A column that makes the matrix singular is rejected, leaving the
+    // decomposition unchanged.
+    SpdMatrix current = incremental.original_matrix();
+    Vector duplicate = current.col(0);
+    EXPECT_FALSE(incremental.append(duplicate, current(0, 0)));
+    EXPECT_EQ(3, incremental.dim());
+    EXPECT_TRUE(MatrixEquals(incremental.original_matrix(), current));
+  }
+
+  TEST_F(IncrementalCholeskyTest, NotPositiveDefinite) {
+    SpdMatrix spd(3, 1.0);
+    spd(2, 2) = -1.0;
+    IncrementalCholesky incremental(spd);
+    EXPECT_FALSE(incremental.is_pos_def());
+    EXPECT_EQ(0, incremental.dim());
+  }
+
+  // The spike and slab moments computed directly from the subsetted matrices.
+  SpikeSlabCholeskyCache::Moments direct_moments(
+      const Selector &model, const SpdMatrix &prior_precision,
+      const Vector &prior_mean, const SpdMatrix &xtx, const Vector &xty,
+      double sigsq) {
+    SpikeSlabCholeskyCache::Moments ans;
+    if (model.nvars() == 0) return ans;
+    SpdMatrix ominv = model.select(prior_precision);
+    Vector mu = model.select(prior_mean);
+    SpdMatrix posterior_precision = ominv + model.select(xtx) / sigsq;
+    Vector r = ominv * mu + model.select(xty) / sigsq;
+    Cholesky chol(posterior_precision);
+    ans.prior_precision_logdet = ominv.logdet();
+    ans.prior_mahalanobis_distance = ominv.Mdist(mu);
+    ans.posterior_precision_logdet = chol.logdet();
+    ans.posterior_mahalanobis_distance = r.dot(chol.solve(r));
+    return ans;
+  }
+
+  TEST_F(IncrementalCholeskyTest, SpikeSlabCache) {
+    int dim = 8;
+    SpdMatrix prior_precision(dim);
+    prior_precision.randomize();
+    Vector prior_mean(dim);
+    prior_mean.randomize();
+    Matrix X(50, dim);
+    X.randomize();
+    Vector y(50);
+    y.randomize();
+    SpdMatrix xtx(dim, 0.0);
+    xtx.add_inner(X);
+    Vector xty = X.Tmult(y);
+    double sigsq = 1.7;
+
+    SpikeSlabCholeskyCache cache(prior_precision, prior_mean, xtx, xty,
+                                 sigsq);
+    Selector model("10010000");
+    cache.set_model(model);
+    for (int iteration = 0; iteration < 40; ++iteration) {
+      int which = random_int(0, dim - 1);
+      const SpikeSlabCholeskyCache::Moments &moments(
+          cache.evaluate_flip(which));
+      Selector flipped = model;
+      flipped.flip(which);
+      SpikeSlabCholeskyCache::Moments direct = direct_moments(
+          flipped, prior_precision, prior_mean, xtx, xty, sigsq);
+      EXPECT_TRUE(moments.positive_definite);
+      EXPECT_NEAR(moments.prior_precision_logdet,
+                  direct.prior_precision_logdet, 1e-8);
+      EXPECT_NEAR(moments.prior_mahalanobis_distance,
+                  direct.prior_mahalanobis_distance, 1e-8);
+      EXPECT_NEAR(moments.posterior_precision_logdet,
+                  direct.posterior_precision_logdet, 1e-8);
+      EXPECT_NEAR(moments.posterior_mahalanobis_distance,
+                  direct.posterior_mahalanobis_distance, 1e-8);
+      EXPECT_NEAR(moments.log_integrated_likelihood(),
+                  direct.log_integrated_likelihood(), 1e-8);
+      // Accept about half the flips, so that both additions and deletions
+      // are applied to the current model.
+      if (runif(0, 1) < .5) {
+        cache.accept_flip();
+        model = flipped;
+      }
+      EXPECT_EQ(model, cache.model());
+    }
+  }
+
+}  // namespace
@@ -0,0 +1,119 @@
+// A benchmark comparing eager Vector arithmetic with the lazy expressions in
+// LinAlg/VectorExpression.hpp, for expressions typical of posterior
+// samplers.  Reports the time and number of heap allocations per
+// evaluation.
+//
+// Usage:
+//   vector_expression_benchmark [dimension] [iterations]
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include "LinAlg/Matrix.hpp"
+#include "LinAlg/Vector.hpp"
+#include "LinAlg/VectorExpression.hpp"
+#include "LinAlg/VectorView.hpp"
+#include "distributions.hpp"
+
+namespace {
+  std::atomic<long> allocation_count(0);
+}  // namespace
+
+// Count every allocation made through the global operator new.
+void *operator new(std::size_t size) {
+  ++allocation_count;
+  void *ans = std::malloc(size == 0 ? 1 : size);
+  if (!ans) throw std::bad_alloc();
+  return ans;
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace {
+  using namespace BOOM;
+  using std::cout;
+  using std::endl;
+
+  // Run 'f' the requested number of times, and print the average time and
+  // number of allocations per call.
+  template <class F>
+  void benchmark(const std::string &name, int iterations, F f) {
+    f();  // Warm up, so one-time sizing is not counted.
+    long allocations_before = allocation_count;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      f();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double allocations =
+        static_cast<double>(allocation_count - allocations_before) /
+        iterations;
+    double nanoseconds =
+        std::chrono::duration<double, std::nano>(stop - start).count() /
+        iterations;
+    cout << name << ":" << endl
+         << "    nanoseconds per iteration:   " << nanoseconds << endl
+         << "    allocations per iteration:   " << allocations << endl;
+  }
+
+  Vector random_vector(int n) {
+    Vector ans(n);
+    for (int i = 0; i < n; ++i) ans[i] = rnorm();
+    return ans;
+  }
+}  // namespace
+
+int main(int argc, char **argv) {
+  int dimension = argc > 1 ? std::atoi(argv[1]) : 100;
+  int iterations = argc > 2 ? std::atoi(argv[2]) : 100000;
+
+  GlobalRng::rng.seed(8675309);
+  Vector beta = random_vector(dimension);
+  Vector z = random_vector(dimension);
+  Vector a = random_vector(dimension);
+  Vector b = random_vector(dimension);
+  Vector c = random_vector(dimension);
+  Matrix rows(3, dimension);
+  rows.row(0) = a;
+  rows.row(1) = b;
+  double sigma = 1.3;
+  Vector out(dimension);
+  double total = 0;
+
+  cout << "dimension = " << dimension << ", iterations = " << iterations
+       << endl << endl;
+
+  // beta + sigma * z: a draw from a scaled Gaussian proposal.
+  benchmark("eager beta + sigma * z", iterations,
+            [&]() { out = beta + sigma * z; });
+  benchmark("lazy beta + sigma * z", iterations,
+            [&]() { (lazy(beta) + sigma * lazy(z)).assign_to(out); });
+
+  // a * b - c / sigma: a typical three-operand element-wise update.
+  benchmark("eager a * b - c / sigma", iterations,
+            [&]() { out = a * b - c / sigma; });
+  benchmark("lazy a * b - c / sigma", iterations,
+            [&]() { (lazy(a) * lazy(b) - lazy(c) / sigma).assign_to(out); });
+
+  // Sum of squared residuals.
+  benchmark("eager (a - b).normsq()", iterations,
+            [&]() { total += (a - b).normsq(); });
+  benchmark("lazy (a - b).normsq()", iterations,
+            [&]() { total += (lazy(a) - lazy(b)).normsq(); });
+
+  // Strided operands: rows of a column-major Matrix.
+  benchmark("eager row(0) + sigma * row(1)", iterations,
+            [&]() { rows.row(2) = rows.row(0) + sigma * rows.row(1); });
+  benchmark("lazy row(0) + sigma * row(1)", iterations, [&]() {
+    (lazy(rows.row(0)) + sigma * lazy(rows.row(1))).assign_to(rows.row(2));
+  });
+
+  // Keep the compiler from discarding the work.
+  cout << endl << "checksum: " << total + out.sum() + rows.row(2).sum()
+       << endl;
+  return 0;
+}
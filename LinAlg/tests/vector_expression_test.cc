@@ -0,0 +1,94 @@
+#include "gtest/gtest.h"
+#include "LinAlg/Vector.hpp"
+#include "LinAlg/VectorView.hpp"
+#include "LinAlg/VectorExpression.hpp"
+#include "LinAlg/Matrix.hpp"
+#include "distributions.hpp"
+#include "test_utils/test_utils.hpp"
+
+namespace {
+  using namespace BOOM;
+  using std::endl;
+  using std::cout;
+
+  class VectorExpressionTest : public ::testing::Test {
+   protected:
+    VectorExpressionTest() {
+      GlobalRng::rng.seed(8675309);
+    }
+
+    Vector random_vector(int n) {
+      Vector ans(n);
+      for (int i = 0; i < n; ++i) ans[i] = rnorm();
+      return ans;
+    }
+  };
+
+  TEST_F(VectorExpressionTest, MatchesEagerArithmetic) {
+    int n = 17;
+    Vector a = random_vector(n);
+    Vector b = random_vector(n);
+    Vector c = random_vector(n);
+    double sigma = 1.7;
+
+    Vector lazy_value = lazy(a) + sigma * lazy(b);
+    EXPECT_TRUE(VectorEquals(lazy_value, a + sigma * b));
+
+    lazy_value = lazy(a) * lazy(b) - lazy(c) / 2.0;
+    EXPECT_TRUE(VectorEquals(lazy_value, a * b - c / 2.0));
+
+    lazy_value = 3.0 - lazy(a) / lazy(c);
+    EXPECT_TRUE(VectorEquals(lazy_value, 3.0 - a / c));
+
+    lazy_value = -lazy(a) + b;
+    EXPECT_TRUE(VectorEquals(lazy_value, -a + b));
+
+    EXPECT_NEAR((lazy(a) - lazy(b)).normsq(), (a - b).normsq(), 1e-10);
+    EXPECT_NEAR((lazy(a) + 1.0).sum(), (a + 1.0).sum(), 1e-10);
+  }
+
+  TEST_F(VectorExpressionTest, Views) {
+    Matrix m(4, 3);
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 0; j < 3; ++j) m(i, j) = rnorm();
+    }
+    Vector v = random_vector(3);
+
+    // Rows of a Matrix are strided views.
+    Vector lazy_value = lazy(m.row(1)) + 2.0 * lazy(v);
+    EXPECT_TRUE(VectorEquals(lazy_value, m.row(1) + 2.0 * v));
+
+    ConstVectorView const_row(m.row(2));
+    lazy_value = lazy(const_row) - v;
+    EXPECT_TRUE(VectorEquals(lazy_value, const_row - v));
+
+    // Assign into a strided view.
+    Vector expected = m.row(0) * v + 1.0;
+    (lazy(m.row(0)) * lazy(v) + 1.0).assign_to(m.row(3));
+    EXPECT_TRUE(VectorEquals(Vector(m.row(3)), expected));
+  }
+
+  TEST_F(VectorExpressionTest, AssignAndAccumulate) {
+    int n = 9;
+    Vector a = random_vector(n);
+    Vector b = random_vector(n);
+
+    Vector out;
+    (lazy(a) + lazy(b)).assign_to(out);
+    EXPECT_TRUE(VectorEquals(out, a + b));
+
+    Vector total = a;
+    (lazy(b) * 2.0).add_to(total, .5);
+    EXPECT_TRUE(VectorEquals(total, a + b));
+
+    // The destination may also be an operand.
+    Vector x = a;
+    (lazy(x) * 3.0 - lazy(b)).assign_to(x);
+    EXPECT_TRUE(VectorEquals(x, 3.0 * a - b));
+
+    Vector too_short(n - 1);
+    EXPECT_THROW((lazy(a) + lazy(b)).add_to(too_short), std::exception);
+    EXPECT_THROW(Vector(lazy(a) + lazy(too_short)), std::exception);
+  }
+
+}  // namespace
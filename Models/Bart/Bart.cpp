@@ -21,9 +21,12 @@
 #include <cmath>
 #include <cstdlib>
 #include <iterator>
+#include <memory>
+#include <vector>
 
 #include "Models/Bart/Bart.hpp"
 #include "Models/Bart/ResidualRegressionData.hpp"
+#include "cpputil/Checkpoint.hpp"
 #include "cpputil/math_utils.hpp"
 #include "cpputil/report_error.hpp"
 #include "distributions.hpp"
@@ -33,7 +36,7 @@ namespace BOOM {
   namespace Bart {
     namespace {
       inline void remove_node_and_descendants_from_set(
-          TreeNode *node, std::set<TreeNode *> &set_of_nodes) {
+          TreeNode *node, Tree::NodeSet &set_of_nodes) {
         if (!node) {
           return;
         }
@@ -54,8 +57,7 @@ namespace BOOM {
       // Returns:
       //   If the set is non-empty a random element is returned.  If the
       //   set is empty then NULL is returned.
-      TreeNode *random_set_element(RNG &rng,
-                                   std::set<TreeNode *> &set_of_nodes) {
+      TreeNode *random_set_element(RNG &rng, Tree::NodeSet &set_of_nodes) {
         int n = set_of_nodes.size();
         if (n == 0) {
           return NULL;
@@ -65,6 +67,21 @@ namespace BOOM {
         return *it;
       }
 
+      // The number of observations handled by one task when a node's data
+      // is processed in parallel.  When the pool has worker threads,
+      // sufficient statistics are accumulated in chunks of this size
+      // regardless of the number of threads, so that the order of floating
+      // point operations (and hence the MCMC sample path) is the same for
+      // any positive thread count.
+      const int kDataChunkSize = 4096;
+
+      // Returns true if the work on 'n' observations should be split into
+      // chunks.  Samplers pass their pool even when it has no threads, and
+      // splitting the work is pure overhead in that case.
+      bool use_chunks(const ThreadWorkerPool *pool, int n) {
+        return pool && !pool->no_threads() && n > kDataChunkSize;
+      }
+
     }  // namespace
 
     //----------------------------------------------------------------------
@@ -92,6 +109,12 @@ namespace BOOM {
     void VariableSummary::finalize(int discrete_distribution_cutoff,
                                    ContinuousCutpointStrategy strategy) {
       observed_values_.sort();
+      // Quantiles need the sorted values with duplicates intact, which
+      // std::unique destroys.
+      Vector sorted_values;
+      if (strategy == DISCRETE_QUANTILES) {
+        sorted_values = observed_values_;
+      }
       Vector::iterator end =
           std::unique(observed_values_.begin(), observed_values_.end());
 
@@ -115,6 +138,23 @@ namespace BOOM {
             impl_.reset(new DiscreteVariableSummary(variable_number_,
                                                     observed_values_));
             break;
+          case DISCRETE_QUANTILES: {
+            // Use the values at quantiles 1/B, 2/B, ..., (B-1)/B as
+            // cutpoints, where B is the number of bins.  The largest value
+            // is included so that DiscreteVariableSummary, which discards
+            // the largest value it is given, keeps all B - 1 quantiles.
+            int number_of_bins = std::max(2, discrete_distribution_cutoff);
+            int n = sorted_values.size();
+            Vector quantiles;
+            quantiles.reserve(number_of_bins);
+            for (int k = 1; k < number_of_bins; ++k) {
+              quantiles.push_back(sorted_values[(k * n) / number_of_bins]);
+            }
+            quantiles.push_back(sorted_values.back());
+            impl_.reset(
+                new DiscreteVariableSummary(variable_number_, quantiles));
+            break;
+          }
           default:
             report_error(
                 "Unknown enum value passed to "
@@ -179,6 +219,16 @@ namespace BOOM {
       return impl_->is_continuous();
     }
 
+    //----------------------------------------------------------------------
+    Vector VariableSummary::discrete_cutpoints() const {
+      check_finalized("discrete_cutpoints");
+      if (impl_->is_continuous()) {
+        return Vector(0);
+      }
+      return dynamic_cast<const DiscreteVariableSummary &>(*impl_)
+          .cutpoint_values();
+    }
+
     //----------------------------------------------------------------------
     Vector VariableSummary::get_cutpoint_range(const TreeNode *node) const {
       check_finalized("get_cutpoint_range");
@@ -508,7 +558,8 @@ namespace BOOM {
     }
 
     //----------------------------------------------------------------------
-    void TreeNode::grow(double left_mean_value, double right_mean_value) {
+    void TreeNode::grow(double left_mean_value, double right_mean_value,
+                        ThreadWorkerPool *pool) {
       if (!is_leaf()) {
         ostringstream err;
         err << "TreeNode::grow() called on an interior node.  "
@@ -521,7 +572,7 @@ namespace BOOM {
         left_child_->populate_sufficient_statistics(suf_->create());
         right_child_->populate_sufficient_statistics(suf_->create());
       }
-      refresh_subtree_data();
+      refresh_subtree_data(pool);
     }
 
     //----------------------------------------------------------------------
@@ -580,6 +631,38 @@ namespace BOOM {
       return this == parent_->right_child_;
     }
 
+    //----------------------------------------------------------------------
+    bool TreeNodePositionLess::operator()(const TreeNode *lhs,
+                                          const TreeNode *rhs) const {
+      if (lhs == rhs) return false;
+      // Walk the deeper node up to the depth of the shallower one.  Each
+      // node is visited at most once, so the cost is linear in the depth.
+      const int lhs_depth = lhs->depth();
+      const int rhs_depth = rhs->depth();
+      const TreeNode *left = lhs;
+      const TreeNode *right = rhs;
+      for (int depth = lhs_depth; depth > rhs_depth; --depth) {
+        left = left->parent();
+      }
+      for (int depth = rhs_depth; depth > lhs_depth; --depth) {
+        right = right->parent();
+      }
+      if (left == right) {
+        // One node is an ancestor of the other.
+        return lhs_depth < rhs_depth;
+      }
+      // Walk both up to the children of their closest common ancestor.
+      while (left->parent() != right->parent()) {
+        left = left->parent();
+        right = right->parent();
+      }
+      if (!left->parent()) {
+        // The nodes belong to different trees.
+        return left < right;
+      }
+      return left->is_left_child();
+    }
+
     //----------------------------------------------------------------------
     TreeNode *TreeNode::parent() { return parent_; }
 
@@ -717,15 +800,37 @@ namespace BOOM {
     }
 
     //----------------------------------------------------------------------
-    void TreeNode::refresh_subtree_data() {
+    void TreeNode::refresh_subtree_data(ThreadWorkerPool *pool) {
       if (is_leaf()) {
         return;
       }
-      left_child_->clear_data_and_suf(true);
-      right_child_->clear_data_and_suf(true);
-      for (int i = 0; i < data_.size(); ++i) {
-        drop_data_to_subtree(data_[i]);
+      if (!use_chunks(pool, data_.size())) {
+        left_child_->clear_data_and_suf(true);
+        right_child_->clear_data_and_suf(true);
+        for (int i = 0; i < data_.size(); ++i) {
+          drop_data_to_subtree(data_[i]);
+        }
+        return;
       }
+
+      // Decide where each observation goes in parallel, then partition the
+      // data serially so that each child sees its data in the same order
+      // as it would from drop_data_to_subtree.  The children refresh their
+      // own subtrees the same way.
+      const int n = data_.size();
+      std::vector<unsigned char> goes_left(n);
+      pool->parallel_for(0, n, kDataChunkSize, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+          goes_left[i] = data_[i]->x()[which_variable_] <= cutpoint_;
+        }
+      });
+      left_child_->clear_data_and_suf(false);
+      right_child_->clear_data_and_suf(false);
+      for (int i = 0; i < n; ++i) {
+        (goes_left[i] ? left_child_ : right_child_)->data_.push_back(data_[i]);
+      }
+      left_child_->refresh_subtree_data(pool);
+      right_child_->refresh_subtree_data(pool);
     }
 
     //----------------------------------------------------------------------
@@ -735,14 +840,36 @@ namespace BOOM {
     }
 
     //----------------------------------------------------------------------
-    const SufficientStatisticsBase &TreeNode::compute_suf() {
+    const SufficientStatisticsBase &TreeNode::compute_suf(
+        ThreadWorkerPool *pool) {
       if (!!suf_) {
         suf_->clear();
       } else {
         report_error("Sufficient statistics object was never allocated.");
       }
-      for (int i = 0; i < data_.size(); ++i) {
-        suf_->update(*(data_[i]));
+      const int n = data_.size();
+      if (!use_chunks(pool, n)) {
+        for (int i = 0; i < n; ++i) {
+          suf_->update(*(data_[i]));
+        }
+        return *suf_;
+      }
+
+      const int number_of_chunks = (n + kDataChunkSize - 1) / kDataChunkSize;
+      std::vector<std::unique_ptr<SufficientStatisticsBase>> chunk_suf(
+          number_of_chunks);
+      pool->parallel_for(0, number_of_chunks, 1, [&](int begin, int end) {
+        for (int chunk = begin; chunk < end; ++chunk) {
+          chunk_suf[chunk].reset(suf_->create());
+          int lo = chunk * kDataChunkSize;
+          int hi = std::min(n, lo + kDataChunkSize);
+          for (int i = lo; i < hi; ++i) {
+            chunk_suf[chunk]->update(*(data_[i]));
+          }
+        }
+      });
+      for (int chunk = 0; chunk < number_of_chunks; ++chunk) {
+        suf_->combine(*chunk_suf[chunk]);
       }
       return *suf_;
     }
@@ -753,16 +880,30 @@ namespace BOOM {
     }
 
     //----------------------------------------------------------------------
-    void TreeNode::remove_mean_effect() {
-      for (int i = 0; i < data_.size(); ++i) {
-        data_[i]->add_to_residual(mean_);
+    void TreeNode::remove_mean_effect(ThreadWorkerPool *pool) {
+      auto body = [this](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+          data_[i]->add_to_residual(mean_);
+        }
+      };
+      if (use_chunks(pool, data_.size())) {
+        pool->parallel_for(0, data_.size(), kDataChunkSize, body);
+      } else {
+        body(0, data_.size());
       }
     }
 
     //----------------------------------------------------------------------
-    void TreeNode::replace_mean_effect() {
-      for (int i = 0; i < data_.size(); ++i) {
-        data_[i]->subtract_from_residual(mean_);
+    void TreeNode::replace_mean_effect(ThreadWorkerPool *pool) {
+      auto body = [this](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+          data_[i]->subtract_from_residual(mean_);
+        }
+      };
+      if (use_chunks(pool, data_.size())) {
+        pool->parallel_for(0, data_.size(), kDataChunkSize, body);
+      } else {
+        body(0, data_.size());
       }
     }
 
@@ -884,6 +1025,11 @@ namespace BOOM {
       return root_->predict(x);
     }
 
+    //----------------------------------------------------------------------
+    void Tree::predict(const Matrix &X, VectorView out) const {
+      FlatTree(*this).predict(X, out);
+    }
+
     //----------------------------------------------------------------------
     int Tree::number_of_nodes() const { return number_of_nodes_; }
 
@@ -969,7 +1115,8 @@ namespace BOOM {
     //----------------------------------------------------------------------
     // Grow the tree at the given leaf, and adjust the sets of special
     // nodes.
-    void Tree::grow(TreeNode *leaf, double left_mean, double right_mean) {
+    void Tree::grow(TreeNode *leaf, double left_mean, double right_mean,
+                    ThreadWorkerPool *pool) {
       if (!leaf->is_leaf()) {
         ostringstream err;
         err << "The node " << endl
@@ -1000,7 +1147,7 @@ namespace BOOM {
       }
 
       parents_of_leaves_.insert(leaf);
-      leaf->grow(left_mean, right_mean);
+      leaf->grow(left_mean, right_mean, pool);
       leaves_.insert(leaf->left_child());
       leaves_.insert(leaf->right_child());
       interior_nodes_.insert(leaf);
@@ -1016,11 +1163,13 @@ namespace BOOM {
       remove_node_and_descendants_from_set(node->right_child(), leaves_);
       remove_node_and_descendants_from_set(node, parents_of_leaves_);
       remove_node_and_descendants_from_set(node, interior_nodes_);
+      leaves_.insert(node);
+      number_of_nodes_ -= node->prune_descendants();
+      // The parent can only be a parent of leaves once node's
+      // descendants are gone.
       if (node->parent() && node->parent()->has_no_grandchildren()) {
         parents_of_leaves_.insert(node->parent());
       }
-      leaves_.insert(node);
-      number_of_nodes_ -= node->prune_descendants();
     }
 
     //----------------------------------------------------------------------
@@ -1039,16 +1188,16 @@ namespace BOOM {
     }
 
     //----------------------------------------------------------------------
-    void Tree::remove_mean_effect() {
+    void Tree::remove_mean_effect(ThreadWorkerPool *pool) {
       for (NodeSetIterator it = leaves_.begin(); it != leaves_.end(); ++it) {
-        (*it)->remove_mean_effect();
+        (*it)->remove_mean_effect(pool);
       }
     }
 
     //----------------------------------------------------------------------
-    void Tree::replace_mean_effect() {
+    void Tree::replace_mean_effect(ThreadWorkerPool *pool) {
       for (NodeSetIterator it = leaves_.begin(); it != leaves_.end(); ++it) {
-        (*it)->replace_mean_effect();
+        (*it)->replace_mean_effect(pool);
       }
     }
 
@@ -1143,6 +1292,25 @@ namespace BOOM {
     return ans;
   }
 
+  //----------------------------------------------------------------------
+  void BartModelBase::predict(const Matrix &X, VectorView out) const {
+    // Rows per chunk.  Each tree only touches the columns it splits on, so
+    // a chunk of this size comfortably fits in L2 for typical models.
+    const int chunk_size = 4096;
+    std::vector<Bart::FlatTree> flat_trees;
+    flat_trees.reserve(trees_.size());
+    for (int i = 0; i < trees_.size(); ++i) {
+      flat_trees.emplace_back(*trees_[i]);
+    }
+    out = 0.0;
+    for (int begin = 0; begin < X.nrow(); begin += chunk_size) {
+      int end = std::min<int>(begin + chunk_size, X.nrow());
+      for (int i = 0; i < flat_trees.size(); ++i) {
+        flat_trees[i].accumulate_predictions(X, out, begin, end);
+      }
+    }
+  }
+
   //----------------------------------------------------------------------
   int BartModelBase::number_of_variables() const {
     return variable_summaries_.size();
@@ -1181,6 +1349,26 @@ namespace BOOM {
     trees_[i]->from_matrix(matrix);
   }
 
+  //----------------------------------------------------------------------
+  void BartModelBase::save_state(CheckpointWriter &checkpoint) const {
+    checkpoint.write_uint64(number_of_trees());
+    for (int i = 0; i < number_of_trees(); ++i) {
+      checkpoint.write_matrix(trees_[i]->to_matrix());
+    }
+    Model::save_state(checkpoint);
+  }
+
+  //----------------------------------------------------------------------
+  void BartModelBase::restore_state(CheckpointReader &checkpoint) {
+    int number_of_trees = checkpoint.read_uint64();
+    set_number_of_trees(number_of_trees);
+    for (int i = 0; i < number_of_trees; ++i) {
+      Matrix tree_matrix = checkpoint.read_matrix();
+      rebuild_tree(i, ConstSubMatrix(tree_matrix));
+    }
+    Model::restore_state(checkpoint);
+  }
+
   //----------------------------------------------------------------------
   void BartModelBase::finalize_data(int discrete_distribution_cutoff,
                                     Bart::ContinuousCutpointStrategy strategy) {
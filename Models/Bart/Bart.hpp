@@ -23,11 +23,13 @@
 #include <set>
 
 #include "LinAlg/SubMatrix.hpp"
+#include "Models/Bart/FlatTree.hpp"
 #include "Models/GaussianModelBase.hpp"
 #include "Models/Glm/Glm.hpp"  // for RegressionData
 #include "Models/Policies/IID_DataPolicy.hpp"
 #include "Models/Policies/ParamPolicy_1.hpp"
 #include "Models/Policies/PriorPolicy.hpp"
+#include "cpputil/ThreadTools.hpp"
 #include "cpputil/math_utils.hpp"
 #include "distributions/rng.hpp"
 
@@ -67,6 +69,14 @@ namespace BOOM {
       // Add relevant functions of data to the sufficient statistics
       // being modeled.
       virtual void update(const ResidualRegressionData &data) = 0;
+
+      // Add the sufficient statistics in rhs to *this, as if the data
+      // summarized by rhs had been passed to update().  This allows
+      // sufficient statistics for disjoint subsets of the data to be
+      // accumulated in parallel.  It is an error to combine sufficient
+      // statistics of different concrete types.
+      virtual void combine(const SufficientStatisticsBase &rhs) = 0;
+
       virtual SufficientStatisticsBase *create() const {
         SufficientStatisticsBase *ans = clone();
         ans->clear();
@@ -86,7 +96,9 @@ namespace BOOM {
 
       // Choose cutpoints at random according to a discretization of
       // the empirical CDF.  This will put more cutpoints into regions
-      // where there is more data.
+      // where there is more data.  The variable is treated as discrete,
+      // with cutpoints at (roughly) equally spaced quantiles, which makes
+      // it eligible for BinnedPredictors.
       DISCRETE_QUANTILES
     };
 
@@ -154,6 +166,8 @@ namespace BOOM {
       // Args:
       //   discrete_distribution_cutoff: The number of unique values a
       //     numeric variable must have before it is considered continuous.
+      //     Under the DISCRETE_QUANTILES strategy this is also the
+      //     number of bins into which a continuous variable is divided.
       void finalize(int discrete_distribution_cutoff = 20,
                     ContinuousCutpointStrategy = UNIFORM_CONTINUOUS);
 
@@ -168,6 +182,11 @@ namespace BOOM {
       // manner.
       bool is_continuous() const;
 
+      // Returns the sorted set of all potential cutpoints for a discrete
+      // variable, ignoring restrictions imposed by any particular node.
+      // Returns an empty Vector if is_continuous() is true.
+      Vector discrete_cutpoints() const;
+
       // Returns a Vector of potential cutpoint values available to
       // node.  A value from this set can be assigned to node without
       // generating a mathematically dead branche at node or among its
@@ -225,6 +244,7 @@ namespace BOOM {
       bool is_continuous() const override { return false; }
       Vector get_cutpoint_range(const TreeNode *node) const override;
       bool is_legal_configuration(const TreeNode *node) const override;
+      const Vector &cutpoint_values() const { return cutpoint_values_; }
 
      private:
       Vector cutpoint_values_;
@@ -291,7 +311,10 @@ namespace BOOM {
       //     the left child.
       //   right_mean_value: The parameter to use as the mean value of
       //     the right child.
-      void grow(double left_mean_value = 0.0, double right_mean_value = 0.0);
+      //   pool: If non-NULL, the pool used to distribute the node's
+      //     data among the new children.  See refresh_subtree_data().
+      void grow(double left_mean_value = 0.0, double right_mean_value = 0.0,
+                ThreadWorkerPool *pool = nullptr);
 
       // Remove all descendants of this node, and make this node a
       // leaf.  Returns the number of nodes that are pruned.
@@ -383,7 +406,12 @@ namespace BOOM {
 
       // Clear the data below this node, and drop this node's data
       // down through the subtree formed by this node's descendants.
-      void refresh_subtree_data();
+      //
+      // If a pool is supplied, the test deciding which child each
+      // observation falls to is evaluated in parallel.  The data
+      // assigned to each node, and the order in which it is stored, are
+      // the same either way.
+      void refresh_subtree_data(ThreadWorkerPool *pool = nullptr);
 
       // Take this data point, and recursively distribute it to either
       // the left or right child.
@@ -405,20 +433,31 @@ namespace BOOM {
       // TODO: Check whether this is a bottleneck, and if
       // so whether it can be made more efficient using an
       // "is_current" observer.
-      const SufficientStatisticsBase &compute_suf();
+      //
+      // Args:
+      //   pool: If non-NULL and the pool has worker threads, the data are
+      //     split into fixed-size chunks that are summarized in parallel
+      //     and combined in order.  The chunks do not depend on the number
+      //     of threads in the pool, so the result is the same for any
+      //     positive number of threads.  It can differ by rounding error
+      //     from the serial result, which is used when there are no
+      //     threads.
+      const SufficientStatisticsBase &compute_suf(
+          ThreadWorkerPool *pool = nullptr);
 
       // The vector of data associated with this node.
       const std::vector<ResidualRegressionData *> &data() const;
 
       // Remove the effect of this node on the predicted values of the
       // data associated with it.  (I.e. adjust the predictions as if
-      // the mean of this node was zero).
-      void remove_mean_effect();
+      // the mean of this node was zero).  If a pool is supplied, the
+      // data are adjusted in parallel.
+      void remove_mean_effect(ThreadWorkerPool *pool = nullptr);
 
       // Replace the effect of this node in the predicted values of
       // the data associated it.  This is the inverse operation to
       // remove_mean_effect().
-      void replace_mean_effect();
+      void replace_mean_effect(ThreadWorkerPool *pool = nullptr);
 
       std::ostream &print(std::ostream &out) const;
 
@@ -462,6 +501,16 @@ namespace BOOM {
       return node.print(out);
     }
 
+    // Orders the nodes of a tree by their position in a depth first
+    // traversal: a node comes before its descendants, and a left subtree
+    // before the corresponding right subtree.  Unlike pointer comparison,
+    // the order depends only on the shape of the tree, so random draws from
+    // the node sets in Tree are reproducible from one run to the next (and
+    // across a checkpoint, which rebuilds the nodes).
+    struct TreeNodePositionLess {
+      bool operator()(const TreeNode *lhs, const TreeNode *rhs) const;
+    };
+
     //======================================================================
     // A Tree is just a collection of TreeNodes, handled through the
     // root.  The class is useful because it helps clarify tree-level
@@ -470,8 +519,9 @@ namespace BOOM {
     // leaf nodes).
     class Tree {
      public:
-      typedef std::set<TreeNode *>::iterator NodeSetIterator;
-      typedef std::set<TreeNode *>::const_iterator ConstNodeSetIterator;
+      typedef std::set<TreeNode *, TreeNodePositionLess> NodeSet;
+      typedef NodeSet::iterator NodeSetIterator;
+      typedef NodeSet::const_iterator ConstNodeSetIterator;
 
       // Build an empty tree consisting of a single node with mean zero.
       explicit Tree(double mean_value = 0);
@@ -513,6 +563,12 @@ namespace BOOM {
       double predict(const VectorView &x) const;
       double predict(const ConstVectorView &x) const;
 
+      // Fill 'out' with this tree's contribution to the prediction at
+      // each row of X.  The tree is flattened to a FlatTree for the
+      // duration of the call.  To score many matrices with the same tree,
+      // build a FlatTree once and use it directly.
+      void predict(const Matrix &X, VectorView out) const;
+
       TreeNode *root() { return root_.get(); }
       const TreeNode *root() const { return root_.get(); }
 
@@ -524,8 +580,7 @@ namespace BOOM {
       // The number of leaves this tree would have if it were pruned at node.
       int number_of_leaves_after_pruning(const TreeNode *node) const;
 
-      // Iterators for the set of leaves.  Not guaranteed to be in any
-      // particular order.
+      // Iterators for the set of leaves, in order from left to right.
       NodeSetIterator leaf_begin();
       ConstNodeSetIterator leaf_begin() const;
       NodeSetIterator leaf_end();
@@ -562,8 +617,11 @@ namespace BOOM {
       // have no grandchildren, it will be removed from the set of
       // leaves, and its parent (if it has one) will be removed from
       // the set of nodes with no grandchildren.
+      //
+      // If a pool is supplied, it is used to distribute the leaf's data
+      // among its new children.
       void grow(TreeNode *leaf, double left_mean = 0.0,
-                double right_mean = 0.0);
+                double right_mean = 0.0, ThreadWorkerPool *pool = nullptr);
 
       // Removes all descendants from node.  The node is kept (and
       // becomes a leaf).  The value of the mean parameter for *node
@@ -586,11 +644,11 @@ namespace BOOM {
       // Remove any contribution that this tree has made towards the
       // residuals by having each leaf add its mean back into the
       // residuals.
-      void remove_mean_effect();
+      void remove_mean_effect(ThreadWorkerPool *pool = nullptr);
 
       // Replace this tree's effect on the residuals by subtracting
       // each leaf's mean effect from the residuals for that leaf.
-      void replace_mean_effect();
+      void replace_mean_effect(ThreadWorkerPool *pool = nullptr);
 
       std::ostream &print(std::ostream &out) const;
 
@@ -613,9 +671,9 @@ namespace BOOM {
      private:
       std::shared_ptr<TreeNode> root_;
       int number_of_nodes_;
-      std::set<TreeNode *> leaves_;
-      std::set<TreeNode *> parents_of_leaves_;
-      std::set<TreeNode *> interior_nodes_;
+      NodeSet leaves_;
+      NodeSet parents_of_leaves_;
+      NodeSet interior_nodes_;
 
       // A function to be called by special constructors (e.g., copy,
       // deserialization).  Iterates through each node in the tree and
@@ -657,6 +715,15 @@ namespace BOOM {
     double predict(const VectorView &x) const;
     double predict(const ConstVectorView &x) const;
 
+    // Fill 'out' with the sum-of-trees prediction for each row of X.  The
+    // trees are flattened once per call, and the rows of X are scored in
+    // chunks so that each chunk stays in cache while all the trees visit
+    // it.
+    // Args:
+    //   X:  A matrix of predictors, with one observation per row.
+    //   out:  A vector with one element per row of X.
+    void predict(const Matrix &X, VectorView out) const;
+
     // The number of variables being modeled.  The dimension of 'x'.
     int number_of_variables() const;
 
@@ -675,6 +742,11 @@ namespace BOOM {
 
     // Rebuild an individual tree from its matrix representation.
     void rebuild_tree(int which_tree, const ConstSubMatrix &tree_matrix);
+
+    // The trees are not Params, so they are checkpointed separately from
+    // (and before) the parameters and samplers handled by Model.
+    void save_state(CheckpointWriter &checkpoint) const override;
+    void restore_state(CheckpointReader &checkpoint) override;
     // Rebuild the variable summaries from their serialized values.
     void set_variable_summaries(
         const std::vector<Bart::SerializedVariableSummary> &serialized);
@@ -0,0 +1,74 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include "Models/Bart/BinnedPredictors.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+#include "cpputil/report_error.hpp"
+
+namespace BOOM {
+  namespace Bart {
+
+    BinnedPredictors::BinnedPredictors(const std::vector<Vector> &cutpoints)
+        : cutpoints_(cutpoints),
+          code_width_(cutpoints.size(), UNBINNED),
+          small_codes_(cutpoints.size()),
+          large_codes_(cutpoints.size()),
+          sample_size_(0) {
+      for (int v = 0; v < cutpoints_.size(); ++v) {
+        int bins = number_of_bins(v);
+        if (bins <= 1) {
+          code_width_[v] = UNBINNED;
+        } else if (bins <= std::numeric_limits<std::uint8_t>::max() + 1) {
+          code_width_[v] = SMALL;
+        } else if (bins <= std::numeric_limits<std::uint16_t>::max() + 1) {
+          code_width_[v] = LARGE;
+        }
+      }
+    }
+
+    //----------------------------------------------------------------------
+    void BinnedPredictors::add(const ConstVectorView &x) {
+      if (x.size() != cutpoints_.size()) {
+        std::ostringstream err;
+        err << "BinnedPredictors expected an observation with "
+            << cutpoints_.size() << " predictors, but got one with "
+            << x.size() << ".";
+        report_error(err.str());
+      }
+      for (int v = 0; v < cutpoints_.size(); ++v) {
+        if (code_width_[v] == UNBINNED) {
+          continue;
+        }
+        const Vector &cutpoints(cutpoints_[v]);
+        int code = std::lower_bound(cutpoints.begin(), cutpoints.end(), x[v]) -
+                   cutpoints.begin();
+        if (code_width_[v] == SMALL) {
+          small_codes_[v].push_back(code);
+        } else {
+          large_codes_[v].push_back(code);
+        }
+      }
+      ++sample_size_;
+    }
+
+  }  // namespace Bart
+}  // namespace BOOM
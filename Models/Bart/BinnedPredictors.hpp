@@ -0,0 +1,103 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+#ifndef BOOM_BART_BINNED_PREDICTORS_HPP_
+#define BOOM_BART_BINNED_PREDICTORS_HPP_
+
+#include <cstdint>
+#include <vector>
+#include "LinAlg/Vector.hpp"
+#include "LinAlg/VectorView.hpp"
+
+namespace BOOM {
+  namespace Bart {
+
+    // A column-oriented copy of the predictors for a BART model, with each
+    // variable replaced by the index of the bin into which it falls.  The
+    // bins are defined by the variable's set of potential cutpoints
+    // c[0] < c[1] < ... < c[K-1].  An observation x is assigned bin code
+    // b = (number of cutpoints strictly less than x), so that x <= c[k] if
+    // and only if b <= k.
+    //
+    // Knowing the bin codes, the sufficient statistics for every potential
+    // split of a node on a given variable can be found with one pass
+    // through the node's data (building a histogram of sufficient
+    // statistics by bin) rather than one pass per cutpoint.
+    //
+    // Codes are stored as 8-bit integers for variables with fewer than
+    // 256 bins, and as 16-bit integers for variables with fewer than
+    // 65536.  Variables with no cutpoints (continuous variables, or
+    // constants) or with more bins than that are not binned.
+    class BinnedPredictors {
+     public:
+      // Args:
+      //   cutpoints: Element v contains the sorted potential cutpoints for
+      //     variable v.  An empty Vector means that variable v is not to
+      //     be binned.
+      explicit BinnedPredictors(const std::vector<Vector> &cutpoints);
+
+      // Append the bin codes for one observation.
+      // Args:
+      //   x: The vector of predictors for the observation.  Its
+      //     dimension must match the number of variables.
+      void add(const ConstVectorView &x);
+
+      int sample_size() const { return sample_size_; }
+      int number_of_variables() const { return cutpoints_.size(); }
+
+      // Returns true if codes are stored for the given variable.
+      bool is_binned(int variable) const {
+        return code_width_[variable] != UNBINNED;
+      }
+
+      // The number of distinct bin codes for the given variable, which is
+      // one more than the number of cutpoints.
+      int number_of_bins(int variable) const {
+        return cutpoints_[variable].size() + 1;
+      }
+
+      // The sorted cutpoints defining the bins for the given variable.
+      const Vector &cutpoints(int variable) const {
+        return cutpoints_[variable];
+      }
+
+      // The bin code for the given observation and variable.
+      // is_binned(variable) must be true.
+      int bin(int observation, int variable) const {
+        if (code_width_[variable] == SMALL) {
+          return small_codes_[variable][observation];
+        }
+        return large_codes_[variable][observation];
+      }
+
+     private:
+      enum CodeWidth { UNBINNED, SMALL, LARGE };
+
+      std::vector<Vector> cutpoints_;
+      std::vector<CodeWidth> code_width_;
+
+      // Codes for variable v are stored in small_codes_[v] or
+      // large_codes_[v], according to code_width_[v].  The other is empty.
+      std::vector<std::vector<std::uint8_t>> small_codes_;
+      std::vector<std::vector<std::uint16_t>> large_codes_;
+      int sample_size_;
+    };
+
+  }  // namespace Bart
+}  // namespace BOOM
+
+#endif  // BOOM_BART_BINNED_PREDICTORS_HPP_
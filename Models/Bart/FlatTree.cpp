@@ -0,0 +1,232 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include "Models/Bart/FlatTree.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include "Models/Bart/Bart.hpp"
+#include "cpputil/report_error.hpp"
+
+namespace BOOM {
+  namespace Bart {
+    namespace {
+      // The number of rows dropped through a tree together by the batch
+      // predictor.  Large enough to amortize the per-level loop overhead,
+      // small enough that the node indices stay in L1 cache.
+      const int kPredictionBlockSize = 256;
+    }  // namespace
+
+    FlatTree::FlatTree()
+        : variable_(1, 0),
+          value_(1, 0.0),
+          left_child_(1, 0),
+          right_child_(1, 0),
+          depth_(0),
+          max_variable_(-1) {}
+
+    FlatTree::FlatTree(const Tree &tree) { rebuild(tree); }
+
+    FlatTree::FlatTree(const ConstSubMatrix &tree_matrix) {
+      rebuild(tree_matrix);
+    }
+
+    FlatTree::FlatTree(const Matrix &tree_matrix) {
+      rebuild(ConstSubMatrix(tree_matrix));
+    }
+
+    //----------------------------------------------------------------------
+    void FlatTree::rebuild(const Tree &tree) {
+      int n = tree.number_of_nodes();
+      variable_.clear();
+      value_.clear();
+      left_child_.clear();
+      right_child_.clear();
+      variable_.reserve(n);
+      value_.reserve(n);
+      left_child_.reserve(n);
+      right_child_.reserve(n);
+      max_variable_ = -1;
+      depth_ = append_subtree(tree.root());
+    }
+
+    //----------------------------------------------------------------------
+    int FlatTree::append_subtree(const TreeNode *node) {
+      int id = variable_.size();
+      if (node->is_leaf()) {
+        variable_.push_back(0);
+        value_.push_back(node->mean());
+        left_child_.push_back(id);
+        right_child_.push_back(id);
+        return 0;
+      }
+      variable_.push_back(node->variable_index());
+      value_.push_back(node->cutpoint());
+      left_child_.push_back(id + 1);
+      right_child_.push_back(-1);
+      max_variable_ = std::max(max_variable_, node->variable_index());
+      int left_depth = append_subtree(node->left_child());
+      right_child_[id] = variable_.size();
+      int right_depth = append_subtree(node->right_child());
+      return 1 + std::max(left_depth, right_depth);
+    }
+
+    //----------------------------------------------------------------------
+    void FlatTree::rebuild(const ConstSubMatrix &tree_matrix) {
+      if (tree_matrix.ncol() != 3 || tree_matrix.nrow() == 0) {
+        report_error(
+            "A serialized Bart::Tree must be a non-empty matrix with 3 "
+            "columns.");
+      }
+      int n = tree_matrix.nrow();
+      variable_.assign(n, 0);
+      value_.assign(n, 0.0);
+      left_child_.resize(n);
+      right_child_.resize(n);
+      max_variable_ = -1;
+      depth_ = 0;
+      std::vector<int> node_depth(n, 0);
+      for (int id = 0; id < n; ++id) {
+        int parent_id = lround(tree_matrix(id, 0));
+        int variable_index = lround(tree_matrix(id, 1));
+        value_[id] = tree_matrix(id, 2);
+        // Until a node is shown to have children it is a leaf.
+        left_child_[id] = id;
+        right_child_[id] = id;
+        if (variable_index >= 0) {
+          variable_[id] = variable_index;
+          max_variable_ = std::max(max_variable_, variable_index);
+        }
+        if (parent_id >= 0) {
+          if (parent_id >= id) {
+            std::ostringstream err;
+            err << "Node " << id << " of a serialized Bart::Tree lists "
+                << parent_id << " as its parent.  Parents must come before "
+                << "their children.";
+            report_error(err.str());
+          }
+          if (id == parent_id + 1) {
+            left_child_[parent_id] = id;
+          } else {
+            right_child_[parent_id] = id;
+          }
+          node_depth[id] = node_depth[parent_id] + 1;
+          depth_ = std::max(depth_, node_depth[id]);
+        }
+      }
+    }
+
+    //----------------------------------------------------------------------
+    double FlatTree::predict(const ConstVectorView &x) const {
+      int node = 0;
+      for (int level = 0; level < depth_; ++level) {
+        node = x[variable_[node]] <= value_[node] ? left_child_[node]
+                                                  : right_child_[node];
+      }
+      return value_[node];
+    }
+
+    //----------------------------------------------------------------------
+    void FlatTree::predict(const Matrix &X, VectorView out) const {
+      check_dimensions(X, out);
+      int node[kPredictionBlockSize];
+      for (int begin = 0; begin < X.nrow(); begin += kPredictionBlockSize) {
+        int end = std::min<int>(begin + kPredictionBlockSize, X.nrow());
+        predict_block(X, begin, end, node, out, false);
+      }
+    }
+
+    //----------------------------------------------------------------------
+    void FlatTree::accumulate_predictions(const Matrix &X,
+                                          VectorView out) const {
+      accumulate_predictions(X, out, 0, X.nrow());
+    }
+
+    //----------------------------------------------------------------------
+    void FlatTree::accumulate_predictions(const Matrix &X, VectorView out,
+                                          int begin, int end) const {
+      check_dimensions(X, out);
+      if (begin < 0 || end > X.nrow() || begin > end) {
+        std::ostringstream err;
+        err << "Illegal row range [" << begin << ", " << end
+            << ") for a predictor matrix with " << X.nrow() << " rows.";
+        report_error(err.str());
+      }
+      int node[kPredictionBlockSize];
+      for (int lo = begin; lo < end; lo += kPredictionBlockSize) {
+        int hi = std::min<int>(lo + kPredictionBlockSize, end);
+        predict_block(X, lo, hi, node, out, true);
+      }
+    }
+
+    //----------------------------------------------------------------------
+    void FlatTree::predict_block(const Matrix &X, int begin, int end,
+                                 int *node, VectorView &out,
+                                 bool accumulate) const {
+      const int block_size = end - begin;
+      const int nrow = X.nrow();
+      // Matrix is stored by columns, so element (i, j) of X is at
+      // data[i + j * nrow].
+      const double *data = X.data() + begin;
+      const int *variable = variable_.data();
+      const double *value = value_.data();
+      const int *left = left_child_.data();
+      const int *right = right_child_.data();
+      std::fill(node, node + block_size, 0);
+      for (int level = 0; level < depth_; ++level) {
+        for (int i = 0; i < block_size; ++i) {
+          const int n = node[i];
+          const bool go_left =
+              data[i + static_cast<long>(variable[n]) * nrow] <= value[n];
+          node[i] = go_left ? left[n] : right[n];
+        }
+      }
+      if (accumulate) {
+        for (int i = 0; i < block_size; ++i) {
+          out[begin + i] += value[node[i]];
+        }
+      } else {
+        for (int i = 0; i < block_size; ++i) {
+          out[begin + i] = value[node[i]];
+        }
+      }
+    }
+
+    //----------------------------------------------------------------------
+    void FlatTree::check_dimensions(const Matrix &X,
+                                    const VectorView &out) const {
+      if (out.size() != X.nrow()) {
+        std::ostringstream err;
+        err << "The output vector has " << out.size()
+            << " elements, but the predictor matrix has " << X.nrow()
+            << " rows.";
+        report_error(err.str());
+      }
+      if (max_variable_ >= static_cast<int>(X.ncol())) {
+        std::ostringstream err;
+        err << "The tree splits on variable " << max_variable_
+            << " but the predictor matrix only has " << X.ncol()
+            << " columns.";
+        report_error(err.str());
+      }
+    }
+
+  }  // namespace Bart
+}  // namespace BOOM
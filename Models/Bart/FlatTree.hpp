@@ -0,0 +1,126 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+#ifndef BOOM_BART_FLAT_TREE_HPP_
+#define BOOM_BART_FLAT_TREE_HPP_
+
+#include <vector>
+#include "LinAlg/Matrix.hpp"
+#include "LinAlg/SubMatrix.hpp"
+#include "LinAlg/VectorView.hpp"
+
+namespace BOOM {
+  namespace Bart {
+    class Tree;
+    class TreeNode;
+
+    // A read-only copy of a Bart::Tree stored as parallel arrays indexed by
+    // node number, for fast prediction.  Tree keeps its nodes on the heap and
+    // makes a prediction by chasing pointers from the root, which is fine
+    // for sampling (where the structure changes constantly) but slow for
+    // scoring a large matrix of predictors against a stored posterior.
+    //
+    // Nodes are numbered in depth first order, with the left child of node i
+    // stored at i + 1.  This is the same numbering used by
+    // Tree::to_matrix().  A leaf is stored as a node whose children are both
+    // itself, so that a row can take a fixed number of steps (the depth of
+    // the tree) without checking whether it has already reached a leaf.
+    // That lets the batch predict() method move a block of rows down the
+    // tree one level at a time, with no data dependent branches.
+    class FlatTree {
+     public:
+      // A single leaf with mean zero.
+      FlatTree();
+
+      // Flatten the current state of 'tree'.  The FlatTree does not track
+      // later changes to 'tree'.
+      explicit FlatTree(const Tree &tree);
+
+      // Build the tree from its serialized form.
+      // Args:
+      //   tree_matrix: A 3-column matrix in the format produced by
+      //     Tree::to_matrix(): (parent id, variable index or -1 for a
+      //     leaf, cutpoint or mean).
+      explicit FlatTree(const ConstSubMatrix &tree_matrix);
+      explicit FlatTree(const Matrix &tree_matrix);
+
+      void rebuild(const Tree &tree);
+      void rebuild(const ConstSubMatrix &tree_matrix);
+
+      int number_of_nodes() const { return variable_.size(); }
+
+      // The number of splits between the root and the deepest leaf.
+      int depth() const { return depth_; }
+
+      // The tree's prediction at a single vector of predictors.
+      double predict(const ConstVectorView &x) const;
+
+      // Fill 'out' with the tree's predictions at each row of X.
+      // Args:
+      //   X: A matrix of predictors.  Each row is an observation.
+      //   out: A vector with one element per row of X.  On output
+      //     out[i] is the prediction for row i.
+      void predict(const Matrix &X, VectorView out) const;
+
+      // Like predict(), but the predictions are added to 'out', which
+      // makes it convenient to sum the predictions from several trees.
+      void accumulate_predictions(const Matrix &X, VectorView out) const;
+
+      // Add the predictions for rows [begin, end) of X to the
+      // corresponding elements of 'out'.  Callers summing many trees over
+      // a large matrix can work through it one range of rows at a time,
+      // so the rows stay in cache while each tree visits them.
+      void accumulate_predictions(const Matrix &X, VectorView out, int begin,
+                                  int end) const;
+
+     private:
+      // Append 'node' and its descendants to the arrays, starting at the
+      // end.  Returns the depth of the subtree rooted at node.
+      int append_subtree(const TreeNode *node);
+
+      // Drop rows [begin, end) of X through the tree together, and write
+      // (or add, if 'accumulate' is true) the mean of the leaf where each
+      // row lands to the corresponding element of 'out'.  'node' is
+      // workspace with room for end - begin indices.
+      void predict_block(const Matrix &X, int begin, int end, int *node,
+                         VectorView &out, bool accumulate) const;
+
+      // Throws an exception if X and out are not conformable with each
+      // other and with the variables used by the tree.
+      void check_dimensions(const Matrix &X, const VectorView &out) const;
+
+      // The variable and cutpoint for interior nodes.  Leaves have variable
+      // 0 (so that looking it up is always legal) and store their mean in
+      // value_.
+      std::vector<int> variable_;
+      std::vector<double> value_;
+
+      // Indices of the left and right children.  For leaves, both point to
+      // the leaf itself.
+      std::vector<int> left_child_;
+      std::vector<int> right_child_;
+      int depth_;
+
+      // The largest variable index used by any split, or -1 if the tree is
+      // a single leaf.
+      int max_variable_;
+    };
+
+  }  // namespace Bart
+}  // namespace BOOM
+
+#endif  // BOOM_BART_FLAT_TREE_HPP_
@@ -18,9 +18,11 @@
 */
 
 #include "Models/Bart/PosteriorSamplers/BartPosteriorSampler.hpp"
+#include <algorithm>
 #include "LinAlg/Selector.hpp"
 #include "Models/Bart/ResidualRegressionData.hpp"
 #include "Samplers/ScalarSliceSampler.hpp"
+#include "cpputil/Checkpoint.hpp"
 #include "cpputil/math_utils.hpp"
 #include "distributions.hpp"
 
@@ -253,7 +255,9 @@ namespace BOOM {
         prior_tree_depth_alpha_(prior_tree_depth_alpha),
         prior_tree_depth_beta_(prior_tree_depth_beta),
         total_prediction_variance_(square(total_prediction_sd)),
-        log_prior_number_of_trees_(log_prior_number_of_trees) {
+        log_prior_number_of_trees_(log_prior_number_of_trees),
+        use_histogram_cutpoint_search_(false),
+        data_is_current_(false) {
     if (prior_tree_depth_alpha <= 0 || prior_tree_depth_alpha >= 1) {
       report_error(
           "The prior_tree_depth_alpha parameter "
@@ -287,6 +291,11 @@ namespace BOOM {
     // destoyed).
   }
 
+  //----------------------------------------------------------------------
+  void BartPosteriorSamplerBase::set_number_of_threads(int number_of_threads) {
+    pool_.set_number_of_threads(number_of_threads);
+  }
+
   //----------------------------------------------------------------------
   void BartPosteriorSamplerBase::set_default_move_probabilities() {
     move_probabilities_.resize(6);
@@ -324,21 +333,52 @@ namespace BOOM {
   double BartPosteriorSamplerBase::subtree_log_integrated_likelihood(
       Bart::TreeNode *node) const {
     if (node->is_leaf()) {
-      return log_integrated_likelihood(node->compute_suf());
+      return log_integrated_likelihood(compute_suf(node));
     } else {
       return subtree_log_integrated_likelihood(node->left_child()) +
              subtree_log_integrated_likelihood(node->right_child());
     }
   }
 
+  //----------------------------------------------------------------------
+  const Bart::SufficientStatisticsBase &BartPosteriorSamplerBase::compute_suf(
+      Bart::TreeNode *node) const {
+    return node->compute_suf(&pool_);
+  }
+
+  //----------------------------------------------------------------------
+  void BartPosteriorSamplerBase::refresh_subtree_data(Bart::TreeNode *node) {
+    node->refresh_subtree_data(&pool_);
+  }
+
+  //----------------------------------------------------------------------
+  void BartPosteriorSamplerBase::save_state(
+      CheckpointWriter &checkpoint) const {
+    PosteriorSampler::save_state(checkpoint);
+    MH_accounting_.save_state(checkpoint);
+  }
+
+  //----------------------------------------------------------------------
+  void BartPosteriorSamplerBase::restore_state(CheckpointReader &checkpoint) {
+    PosteriorSampler::restore_state(checkpoint);
+    MH_accounting_.restore_state(checkpoint);
+    // The trees have been rebuilt, so the data they held is gone.  Forcing
+    // check_residuals() to start over recomputes the residuals and
+    // repopulates the trees.
+    clear_residuals();
+    binned_predictors_.reset();
+  }
+
   //----------------------------------------------------------------------
   // It should only be necessary to call check_residuals once.
   void BartPosteriorSamplerBase::check_residuals() {
-    if (residual_size() != model_->sample_size()) {
+    if (!data_is_current_ || residual_size() != model_->sample_size()) {
       clear_residuals();
       clear_data_from_trees();
+      binned_predictors_.reset();
       for (int i = 0; i < model_->sample_size(); ++i) {
         Bart::ResidualRegressionData *data = create_and_store_residual(i);
+        data->set_index(i);
         for (int j = 0; j < model_->number_of_trees(); ++j) {
           model_->tree(j)->populate_data(data);
         }
@@ -346,6 +386,7 @@ namespace BOOM {
       for (int i = 0; i < model_->number_of_trees(); ++i) {
         model_->tree(i)->populate_sufficient_statistics(create_suf());
       }
+      data_is_current_ = true;
     }
   }
 
@@ -358,7 +399,7 @@ namespace BOOM {
 
   //----------------------------------------------------------------------
   void BartPosteriorSamplerBase::modify_tree(Tree *tree) {
-    tree->remove_mean_effect();
+    tree->remove_mean_effect(&pool_);
     modify_tree_structure(tree);
     draw_terminal_means_and_adjust_residuals(tree);
   }
@@ -411,7 +452,7 @@ namespace BOOM {
     if (!can_split) {
       return false;
     }
-    tree->grow(leaf);
+    tree->grow(leaf, 0.0, 0.0, &pool_);
     return grow_branch_from_prior(tree, leaf->left_child()) &&
            grow_branch_from_prior(tree, leaf->right_child());
   }
@@ -473,7 +514,7 @@ namespace BOOM {
 
     double log_likelihood_ratio =
         subtree_log_integrated_likelihood(branch_root) -
-        log_integrated_likelihood(branch_root->compute_suf());
+        log_integrated_likelihood(compute_suf(branch_root));
 
     int depth = branch_root->depth();
     double log_prior_ratio = -log_probability_of_no_split(depth);
@@ -586,7 +627,7 @@ namespace BOOM {
     }
 
     // Step 2: Compute the MH ratio (on the log scale).
-    tree->grow(leaf);
+    tree->grow(leaf, 0.0, 0.0, &pool_);
     double log_alpha = split_move_log_metropolis_ratio(tree, leaf);
 
     double logu = log(runif_mt(rng()));
@@ -639,9 +680,9 @@ namespace BOOM {
     int depth = leaf->depth();
 
     double log_likelihood_ratio =
-        log_integrated_likelihood(leaf->left_child()->compute_suf()) +
-        log_integrated_likelihood(leaf->right_child()->compute_suf()) -
-        log_integrated_likelihood(leaf->compute_suf());
+        log_integrated_likelihood(compute_suf(leaf->left_child())) +
+        log_integrated_likelihood(compute_suf(leaf->right_child())) -
+        log_integrated_likelihood(compute_suf(leaf));
 
     // The prior_ratio omits a factor of p(variable, cutpoint) that
     // cancels with the transition distribution.
@@ -684,7 +725,7 @@ namespace BOOM {
         subtree_log_integrated_likelihood(node->parent());
 
     node->swap_splitting_rule(node->parent());
-    node->parent()->refresh_subtree_data();
+    refresh_subtree_data(node->parent());
     const VariableSummary &parent_variable_summary(
         model_->variable_summary(node->parent()->variable_index()));
     const VariableSummary &child_variable_summary(
@@ -692,7 +733,7 @@ namespace BOOM {
     if (!parent_variable_summary.is_legal_configuration(node->parent()) ||
         !child_variable_summary.is_legal_configuration(node)) {
       node->swap_splitting_rule(node->parent());
-      node->parent()->refresh_subtree_data();
+      refresh_subtree_data(node->parent());
       MH_accounting_.record_special("swap", "cant_split");
       return;
     }
@@ -707,7 +748,7 @@ namespace BOOM {
     } else {
       // Reject the proposal.  Switch back to the original tree.
       node->swap_splitting_rule(node->parent());
-      node->parent()->refresh_subtree_data();
+      refresh_subtree_data(node->parent());
       MH_accounting_.record_rejection("swap");
     }
   }
@@ -727,7 +768,7 @@ namespace BOOM {
     const VariableSummary &variable_summary(model_->variable_summary(variable));
     double candidate_cutpoint = variable_summary.random_cutpoint(rng(), node);
     node->set_variable_and_cutpoint(variable, candidate_cutpoint);
-    node->refresh_subtree_data();
+    refresh_subtree_data(node);
     double candidate_log_likelihood = subtree_log_integrated_likelihood(node);
 
     double log_alpha = candidate_log_likelihood - original_log_likelihood;
@@ -737,7 +778,7 @@ namespace BOOM {
     } else {
       MH_accounting_.record_rejection("change_cutpoint");
       node->set_variable_and_cutpoint(variable, original_cutpoint);
-      node->refresh_subtree_data();
+      refresh_subtree_data(node);
     }
   }
 
@@ -776,7 +817,7 @@ namespace BOOM {
         return negative_infinity();
       }
       node_->set_variable_and_cutpoint(node_->variable_index(), cutpoint);
-      node_->refresh_subtree_data();
+      sampler_->refresh_subtree_data(node_);
       return sampler_->subtree_log_integrated_likelihood(node_);
     }
 
@@ -793,11 +834,11 @@ namespace BOOM {
     const VariableSummary &variable_summary(model_->variable_summary(variable));
     Vector range = variable_summary.get_cutpoint_range(node);
     ContinuousCutpointLogLikelihood logf(this, node, range[0], range[1]);
-    ScalarSliceSampler slice(logf);
+    ScalarSliceSampler slice(logf, false, 1.0, &rng());
     slice.set_limits(range[0], range[1]);
     double cutpoint = slice.draw(node->cutpoint());
     node->set_variable_and_cutpoint(variable, cutpoint);
-    node->refresh_subtree_data();
+    refresh_subtree_data(node);
   }
 
   void BartPosteriorSamplerBase::slice_sample_discrete_cutpoint(
@@ -814,6 +855,11 @@ namespace BOOM {
       // There is only one choice.  We need to stay where we are.
       return;
     }
+    if (use_histogram_cutpoint_search_ &&
+        histogram_slice_sample_discrete_cutpoint(node,
+                                                 potential_cutpoint_values)) {
+      return;
+    }
 
     double logf_slice =
         subtree_log_integrated_likelihood(node) - rexp_mt(rng(), 1.0);
@@ -829,7 +875,7 @@ namespace BOOM {
       }
       double cutpoint = potential_cutpoint_values[pos];
       node->set_variable_and_cutpoint(variable, cutpoint);
-      node->refresh_subtree_data();
+      refresh_subtree_data(node);
       logp = subtree_log_integrated_likelihood(node);
       possible_cutpoint_positions.drop(pos);
     }
@@ -840,6 +886,130 @@ namespace BOOM {
     }
   }
 
+  //----------------------------------------------------------------------
+  // The rejection loop in slice_sample_discrete_cutpoint draws candidates
+  // uniformly without replacement until one lands above the slice, which
+  // is a uniform draw from the candidates above the slice.  When both
+  // children of node are leaves, the log likelihood of every candidate is
+  // available from a single pass through the data, so that draw can be
+  // made directly.
+  bool BartPosteriorSamplerBase::histogram_slice_sample_discrete_cutpoint(
+      TreeNode *node, const Vector &potential_cutpoint_values) {
+    const int number_of_candidates = potential_cutpoint_values.size();
+    int current = -1;
+    for (int j = 0; j < number_of_candidates; ++j) {
+      if (potential_cutpoint_values[j] == node->cutpoint()) {
+        current = j;
+      }
+    }
+    Vector logp;
+    if (current < 0 || !histogram_cutpoint_log_likelihoods(
+                           node, potential_cutpoint_values, logp)) {
+      return false;
+    }
+
+    double logf_slice = logp[current] - rexp_mt(rng(), 1.0);
+    std::vector<int> above_slice;
+    for (int j = 0; j < number_of_candidates; ++j) {
+      if (logp[j] >= logf_slice) {
+        above_slice.push_back(j);
+      }
+    }
+    int choice = above_slice[random_int_mt(rng(), 0, above_slice.size() - 1)];
+    node->set_variable_and_cutpoint(node->variable_index(),
+                                    potential_cutpoint_values[choice]);
+    refresh_subtree_data(node);
+    return true;
+  }
+
+  //----------------------------------------------------------------------
+  bool BartPosteriorSamplerBase::histogram_cutpoint_log_likelihoods(
+      TreeNode *node, const Vector &potential_cutpoint_values,
+      Vector &log_likelihoods) {
+    if (node->is_leaf() || !node->left_child()->is_leaf() ||
+        !node->right_child()->is_leaf()) {
+      return false;
+    }
+    int variable = node->variable_index();
+    const Bart::BinnedPredictors &bins(binned_predictors());
+    if (!bins.is_binned(variable)) {
+      return false;
+    }
+
+    // candidate_bin[j] is the bin code of candidate cutpoint j.  An
+    // observation with bin code b goes left under candidate j if and only
+    // if b <= candidate_bin[j].
+    const Vector &all_cutpoints(bins.cutpoints(variable));
+    const int number_of_candidates = potential_cutpoint_values.size();
+    std::vector<int> candidate_bin(number_of_candidates);
+    for (int j = 0; j < number_of_candidates; ++j) {
+      double cutpoint = potential_cutpoint_values[j];
+      candidate_bin[j] =
+          std::lower_bound(all_cutpoints.begin(), all_cutpoints.end(),
+                           cutpoint) -
+          all_cutpoints.begin();
+      if (candidate_bin[j] == all_cutpoints.size() ||
+          all_cutpoints[candidate_bin[j]] != cutpoint) {
+        return false;
+      }
+    }
+
+    // Observations in slot s go left under candidates s, s+1, ..., and
+    // right under the candidates before s.  Slot number_of_candidates
+    // holds observations that go right under every candidate.
+    std::vector<std::shared_ptr<Bart::SufficientStatisticsBase>> slot_suf;
+    slot_suf.reserve(number_of_candidates + 1);
+    for (int s = 0; s <= number_of_candidates; ++s) {
+      slot_suf.emplace_back(create_suf());
+    }
+    const std::vector<Bart::ResidualRegressionData *> &data(node->data());
+    for (int i = 0; i < data.size(); ++i) {
+      int index = data[i]->index();
+      if (index < 0 || index >= bins.sample_size()) {
+        report_error(
+            "A residual was not indexed in "
+            "histogram_cutpoint_log_likelihoods.");
+      }
+      int code = bins.bin(index, variable);
+      int slot = std::lower_bound(candidate_bin.begin(), candidate_bin.end(),
+                                  code) -
+                 candidate_bin.begin();
+      slot_suf[slot]->update(*data[i]);
+    }
+
+    // Accumulate the left children from the front, then add the right
+    // children from the back.
+    log_likelihoods.resize(number_of_candidates);
+    std::shared_ptr<Bart::SufficientStatisticsBase> running(create_suf());
+    for (int j = 0; j < number_of_candidates; ++j) {
+      running->combine(*slot_suf[j]);
+      log_likelihoods[j] = log_integrated_likelihood(*running);
+    }
+    running->clear();
+    for (int j = number_of_candidates - 1; j >= 0; --j) {
+      running->combine(*slot_suf[j + 1]);
+      log_likelihoods[j] += log_integrated_likelihood(*running);
+    }
+    return true;
+  }
+
+  //----------------------------------------------------------------------
+  const Bart::BinnedPredictors &
+  BartPosteriorSamplerBase::binned_predictors() {
+    if (!binned_predictors_) {
+      std::vector<Vector> cutpoints;
+      cutpoints.reserve(model_->number_of_variables());
+      for (int v = 0; v < model_->number_of_variables(); ++v) {
+        cutpoints.push_back(model_->variable_summary(v).discrete_cutpoints());
+      }
+      binned_predictors_.reset(new Bart::BinnedPredictors(cutpoints));
+      for (int i = 0; i < residual_size(); ++i) {
+        binned_predictors_->add(residual(i)->x());
+      }
+    }
+    return *binned_predictors_;
+  }
+
   //----------------------------------------------------------------------
   void BartPosteriorSamplerBase::draw_terminal_means_and_adjust_residuals(
       Bart::Tree *tree) {
@@ -848,7 +1018,7 @@ namespace BOOM {
       Bart::TreeNode *leaf = *it;
       double mean = draw_mean(leaf);
       leaf->set_mean(mean);
-      leaf->replace_mean_effect();
+      leaf->replace_mean_effect(&pool_);
     }
   }
 
@@ -886,7 +1056,7 @@ namespace BOOM {
     // the moment so the split does not affect the residuals from the
     // current model.
     if (log(runif_mt(rng())) < log_probability_of_split(0)) {
-      proposal->grow(root);
+      proposal->grow(root, 0.0, 0.0, &pool_);
     }
 
     double logu = log(runif_mt(rng()));
@@ -1001,13 +1171,13 @@ namespace BOOM {
     double proposal_loglike = 0;
     for (Bart::Tree::ConstNodeSetIterator it = proposal->leaf_begin();
          it != proposal->leaf_end(); ++it) {
-      proposal_loglike += log_integrated_likelihood((*it)->compute_suf());
+      proposal_loglike += log_integrated_likelihood(compute_suf(*it));
     }
 
     // Any root will do here, since they all start with the same set
     // of data.
     double current_loglike =
-        complete_data_log_likelihood(proposal->root()->compute_suf());
+        complete_data_log_likelihood(compute_suf(proposal->root()));
 
     double log_numerator = proposal_loglike + proposal_log_prior -
                            log_proposal_transition_probability;
@@ -1134,11 +1304,11 @@ namespace BOOM {
     // current model.
 
     double current_loglike =
-        complete_data_log_likelihood(stump->root()->compute_suf());
+        complete_data_log_likelihood(compute_suf(stump->root()));
 
-    stump->remove_mean_effect();
+    stump->remove_mean_effect(&pool_);
     double proposal_loglike =
-        complete_data_log_likelihood(stump->root()->compute_suf());
+        complete_data_log_likelihood(compute_suf(stump->root()));
 
     double log_numerator = proposal_loglike + proposal_log_prior -
                            log_proposal_transition_probability;
@@ -1150,7 +1320,7 @@ namespace BOOM {
     if (log(runif_mt(rng())) < log_acceptance_probability) {
       model_->remove_tree(stump);
     } else {
-      stump->replace_mean_effect();
+      stump->replace_mean_effect(&pool_);
     }
   }
 
@@ -20,10 +20,13 @@
 #ifndef BART_POSTERIOR_SAMPLER_BASE_HPP_
 #define BART_POSTERIOR_SAMPLER_BASE_HPP_
 
+#include <memory>
 #include "Models/Bart/Bart.hpp"
+#include "Models/Bart/BinnedPredictors.hpp"
 #include "Models/GaussianModel.hpp"
 #include "Models/PosteriorSamplers/PosteriorSampler.hpp"
 #include "Samplers/MoveAccounting.hpp"
+#include "cpputil/ThreadTools.hpp"
 #include "cpputil/math_utils.hpp"
 
 namespace BOOM {
@@ -118,6 +121,32 @@ namespace BOOM {
     // trees in the model.
     ~BartPosteriorSamplerBase() override;
 
+    // Sets the number of worker threads used to process the data
+    // assigned to a tree node: computing sufficient statistics,
+    // assigning data to children when a splitting rule changes, and
+    // adjusting residuals.  The default is zero (all work is done by the
+    // calling thread).
+    //
+    // Work is split into chunks that do not depend on the number of
+    // threads, so the sufficient statistics seen by the MH moves (and
+    // hence the posterior) are the same for any setting.  Threads only
+    // help with nodes holding many thousands of observations, so this is
+    // worth setting for large data sets.
+    void set_number_of_threads(int number_of_threads);
+    int number_of_threads() const { return pool_.number_of_threads(); }
+
+    // If true, slice sampling the cutpoint of a node whose children are
+    // both leaves, and which splits on a discrete variable (including
+    // continuous variables finalized with the DISCRETE_QUANTILES
+    // strategy), evaluates every candidate cutpoint at once from a
+    // histogram of sufficient statistics indexed by the bin of each
+    // observation.  This replaces one pass through the node's data per
+    // candidate cutpoint with a single pass.  The predictors are binned
+    // the first time they are needed.  The default is false.
+    void use_histogram_cutpoint_search(bool use = true) {
+      use_histogram_cutpoint_search_ = use;
+    }
+
     // Sets the vector of move probabilities to the uniform
     // distribution.
     void set_default_move_probabilities();
@@ -160,6 +189,16 @@ namespace BOOM {
     // the log integrated likelihoods for all the leaves under *node.
     double subtree_log_integrated_likelihood(Bart::TreeNode *node) const;
 
+    // Recompute and return the sufficient statistics for the data
+    // currently assigned to node, using the sampler's thread pool.
+    const Bart::SufficientStatisticsBase &compute_suf(
+        Bart::TreeNode *node) const;
+
+    // Reassign the data below 'node' after its splitting rule (or that of
+    // one of its descendants) has changed, using the sampler's thread
+    // pool.
+    void refresh_subtree_data(Bart::TreeNode *node);
+
     // Returns the log likelihood associated with the given set of
     // complete data sufficient statistics.  ***NOTE*** the outupt of
     // this function will be compared to the output of
@@ -197,6 +236,12 @@ namespace BOOM {
     // function once (it is designed to be a no-op most of the time).
     void check_residuals();
 
+    // Marks the residuals, and the data held by the trees, as out of date
+    // so that the next call to check_residuals rebuilds them.  Derived
+    // classes register this as an observer of the model's data, so it is
+    // called whenever data are added, cleared, or replaced.
+    void invalidate_data() { data_is_current_ = false; }
+
     // To be called with a new tree.
     void fill_tree_with_residual_data(Bart::Tree *tree);
 
@@ -234,6 +279,17 @@ namespace BOOM {
     void slice_sample_continuous_cutpoint(Bart::TreeNode *node);
     void slice_sample_discrete_cutpoint(Bart::TreeNode *node);
 
+    // Fill 'log_likelihoods' with the subtree log integrated likelihood of
+    // 'node' under each of its potential cutpoints, computed from a single
+    // pass through the node's data.  Element j matches the value of
+    // subtree_log_integrated_likelihood(node) after node's cutpoint is set
+    // to potential_cutpoint_values[j].  Returns false, leaving the
+    // arguments unchanged, if the histogram search does not apply to node
+    // (its children are not both leaves, or its variable is not binned).
+    bool histogram_cutpoint_log_likelihoods(
+        Bart::TreeNode *node, const Vector &potential_cutpoint_values,
+        Vector &log_likelihoods);
+
     // Conditional on the tree structure and sigma, sample the mean
     // parameters at the leaves.
     void draw_terminal_means_and_adjust_residuals(Bart::Tree *tree);
@@ -265,6 +321,12 @@ namespace BOOM {
 
     const MoveAccounting &move_accounting() const { return MH_accounting_; }
 
+    // In addition to the RNG, the checkpoint holds the move accounting.
+    // Restoring discards the residuals, which are rebuilt from the
+    // restored trees on the next call to draw().
+    void save_state(CheckpointWriter &checkpoint) const override;
+    void restore_state(CheckpointReader &checkpoint) override;
+
     // Grow a new branch on tree, starting from 'leaf', which must be
     // a leaf node owned by 'tree'.  An exception will be thrown if
     // 'leaf' is not really a leaf.  If the tree is fully saturated,
@@ -288,6 +350,21 @@ namespace BOOM {
     // model_.
     void clear_data_from_trees();
 
+    // The binned copy of the predictors used by the histogram cutpoint
+    // search.  Built on first use, and discarded by check_residuals when
+    // the residuals are rebuilt, which happens whenever the model's data
+    // change.
+    const Bart::BinnedPredictors &binned_predictors();
+
+    // The histogram version of slice_sample_discrete_cutpoint.  Returns
+    // false, leaving node unchanged, if the histogram search does not
+    // apply to node.
+    // Args:
+    //   node: The interior node whose cutpoint is to be sampled.
+    //   potential_cutpoint_values: The legal cutpoints for node.
+    bool histogram_slice_sample_discrete_cutpoint(
+        Bart::TreeNode *node, const Vector &potential_cutpoint_values);
+
     //----------------------------------------------------------------------
     // Compute the log of the Metropolis-Hastings ratio for the split
     // move.  The log ratio for the prune_split move is -1 times this
@@ -334,6 +411,17 @@ namespace BOOM {
     // The vector of move_probabilities_ must be the same length as
     // the number of elements in the MoveType enum.
     Vector move_probabilities_;
+
+    // Worker threads for processing node data.  Mutable because
+    // sufficient statistics are computed inside const member functions.
+    mutable ThreadWorkerPool pool_;
+
+    bool use_histogram_cutpoint_search_;
+    std::shared_ptr<Bart::BinnedPredictors> binned_predictors_;
+
+    // False if the model's data have changed since the residuals were
+    // last built.
+    bool data_is_current_;
   };
 
 }  // namespace BOOM
@@ -19,6 +19,7 @@
 
 #include "Models/Bart/PosteriorSamplers/GaussianBartPosteriorSampler.hpp"
 #include "cpputil/math_utils.hpp"
+#include "cpputil/report_error.hpp"
 #include "distributions.hpp"
 
 namespace BOOM {
@@ -35,6 +36,19 @@ namespace BOOM {
       suf.update(*this);
     }
 
+    void GaussianBartSufficientStatistics::combine(
+        const SufficientStatisticsBase &abstract_rhs) {
+      const GaussianBartSufficientStatistics *rhs =
+          dynamic_cast<const GaussianBartSufficientStatistics *>(
+              &abstract_rhs);
+      if (!rhs) {
+        report_error(
+            "GaussianBartSufficientStatistics can only be combined with "
+            "GaussianBartSufficientStatistics.");
+      }
+      suf_.combine(rhs->suf_);
+    }
+
   }  // namespace Bart
 
   const double GaussianBartPosteriorSampler::log_2_pi(1.83787706640935);
@@ -50,7 +64,9 @@ namespace BOOM {
                                  log_prior_on_number_of_trees, seeding_rng),
         model_(model),
         sigsq_sampler_(new ChisqModel(prior_residual_sd_weight,
-                                      prior_residual_sd_guess)) {}
+                                      prior_residual_sd_guess)) {
+    model_->add_observer([this]() { this->invalidate_data(); });
+  }
 
   void GaussianBartPosteriorSampler::draw() {
     BartPosteriorSamplerBase::draw();
@@ -61,7 +77,7 @@ namespace BOOM {
     double sigsq = model_->sigsq();
     const Bart::GaussianBartSufficientStatistics &suf(
         dynamic_cast<const Bart::GaussianBartSufficientStatistics &>(
-            leaf->compute_suf()));
+            compute_suf(leaf)));
     double ivar = suf.n() / sigsq + 1.0 / mean_prior_variance();
     double mean = (suf.sum() / sigsq) / ivar;
     double sd = sqrt(1.0 / ivar);
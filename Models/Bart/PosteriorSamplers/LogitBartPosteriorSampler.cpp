@@ -85,6 +85,24 @@ namespace BOOM {
       information_weighted_sum_of_squared_predictions_ += info * pred * pred;
     }
 
+    void LogitSufficientStatistics::combine(
+        const SufficientStatisticsBase &abstract_rhs) {
+      const LogitSufficientStatistics *rhs =
+          dynamic_cast<const LogitSufficientStatistics *>(&abstract_rhs);
+      if (!rhs) {
+        report_error(
+            "LogitSufficientStatistics can only be combined with "
+            "LogitSufficientStatistics.");
+      }
+      sum_of_information_ += rhs->sum_of_information_;
+      information_weighted_prediction_ += rhs->information_weighted_prediction_;
+      information_weighted_sum_ += rhs->information_weighted_sum_;
+      information_weighted_sum_of_observation_times_prediction_ +=
+          rhs->information_weighted_sum_of_observation_times_prediction_;
+      information_weighted_sum_of_squared_predictions_ +=
+          rhs->information_weighted_sum_of_squared_predictions_;
+    }
+
     double LogitSufficientStatistics::sum_of_information() const {
       return sum_of_information_;
     }
@@ -121,7 +139,9 @@ namespace BOOM {
                                  prior_tree_depth_alpha, prior_tree_depth_beta,
                                  log_prior_on_number_of_trees, seeding_rng),
         model_(model),
-        data_imputer_(new BinomialLogitCltDataImputer(10)) {}
+        data_imputer_(new BinomialLogitCltDataImputer(10)) {
+    model_->add_observer([this]() { this->invalidate_data(); });
+  }
 
   //----------------------------------------------------------------------
   void LogitBartPosteriorSampler::draw() {
@@ -147,7 +167,7 @@ namespace BOOM {
   double LogitBartPosteriorSampler::draw_mean(Bart::TreeNode *leaf) {
     const Bart::LogitSufficientStatistics &suf(
         dynamic_cast<const Bart::LogitSufficientStatistics &>(
-            leaf->compute_suf()));
+            compute_suf(leaf)));
     double prior_variance = mean_prior_variance();
     double ivar = (1.0 / prior_variance) + suf.sum_of_information();
     double posterior_mean = suf.information_weighted_residual_sum() / ivar;
@@ -20,6 +20,7 @@
 #include "Models/Bart/PosteriorSamplers/PoissonBartPosteriorSampler.hpp"
 #include "Models/Glm/PosteriorSamplers/poisson_mixture_approximation_table.hpp"
 #include "cpputil/math_utils.hpp"
+#include "cpputil/report_error.hpp"
 #include "distributions.hpp"
 
 namespace BOOM {
@@ -121,6 +122,22 @@ namespace BOOM {
         weighted_sum_of_squared_residuals_ += weight * square(residual);
       }
     }
+
+    //----------------------------------------------------------------------
+    void PoissonSufficientStatistics::combine(
+        const SufficientStatisticsBase &abstract_rhs) {
+      const PoissonSufficientStatistics *rhs =
+          dynamic_cast<const PoissonSufficientStatistics *>(&abstract_rhs);
+      if (!rhs) {
+        report_error(
+            "PoissonSufficientStatistics can only be combined with "
+            "PoissonSufficientStatistics.");
+      }
+      sum_of_weights_ += rhs->sum_of_weights_;
+      weighted_sum_of_residuals_ += rhs->weighted_sum_of_residuals_;
+      weighted_sum_of_squared_residuals_ +=
+          rhs->weighted_sum_of_squared_residuals_;
+    }
   }  // namespace Bart
 
   //======================================================================
@@ -134,7 +151,9 @@ namespace BOOM {
                                  prior_tree_depth_alpha, prior_tree_depth_beta,
                                  log_prior_on_number_of_trees, seeding_rng),
         model_(model),
-        data_imputer_(new PoissonDataImputer) {}
+        data_imputer_(new PoissonDataImputer) {
+    model_->add_observer([this]() { this->invalidate_data(); });
+  }
 
   //----------------------------------------------------------------------
   void PoissonBartPosteriorSampler::draw() {
@@ -146,7 +165,7 @@ namespace BOOM {
   double PoissonBartPosteriorSampler::draw_mean(Bart::TreeNode *leaf) {
     const Bart::PoissonSufficientStatistics &suf(
         dynamic_cast<const Bart::PoissonSufficientStatistics &>(
-            leaf->compute_suf()));
+            compute_suf(leaf)));
     double ivar = suf.sum_of_weights() + 1.0 / mean_prior_variance();
     double posterior_mean = suf.weighted_sum_of_residuals() / ivar;
     double posterior_sd = sqrt(1.0 / ivar);
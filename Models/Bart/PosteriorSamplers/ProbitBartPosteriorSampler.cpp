@@ -76,6 +76,19 @@ namespace BOOM {
       sum_ += data.sum_of_residuals();
     }
 
+    void ProbitSufficientStatistics::combine(
+        const SufficientStatisticsBase &abstract_rhs) {
+      const ProbitSufficientStatistics *rhs =
+          dynamic_cast<const ProbitSufficientStatistics *>(&abstract_rhs);
+      if (!rhs) {
+        report_error(
+            "ProbitSufficientStatistics can only be combined with "
+            "ProbitSufficientStatistics.");
+      }
+      n_ += rhs->n_;
+      sum_ += rhs->sum_;
+    }
+
     int ProbitSufficientStatistics::sample_size() const { return n_; }
 
     double ProbitSufficientStatistics::sum() const { return sum_; }
@@ -91,7 +104,9 @@ namespace BOOM {
       : BartPosteriorSamplerBase(model, total_prediction_sd,
                                  prior_tree_depth_alpha, prior_tree_depth_beta,
                                  log_prior_on_number_of_trees, seeding_rng),
-        model_(model) {}
+        model_(model) {
+    model_->add_observer([this]() { this->invalidate_data(); });
+  }
 
   //----------------------------------------------------------------------
   void ProbitBartPosteriorSampler::draw() {
@@ -104,7 +119,7 @@ namespace BOOM {
   double ProbitBartPosteriorSampler::draw_mean(Bart::TreeNode *leaf) {
     const Bart::ProbitSufficientStatistics &suf(
         dynamic_cast<const Bart::ProbitSufficientStatistics &>(
-            leaf->compute_suf()));
+            compute_suf(leaf)));
     double prior_variance = mean_prior_variance();
     double ivar = suf.sample_size() + (1.0 / prior_variance);
     double posterior_mean = suf.sum() / ivar;
@@ -50,6 +50,13 @@ namespace BOOM {
       // The vector of predictors associated with this observation.
       const Vector &x() const;
 
+      // The position of this observation in the posterior sampler's
+      // vector of residuals, or -1 if it has not been set.  Used to look
+      // up column-oriented summaries of the predictors, such as
+      // BinnedPredictors.
+      int index() const { return index_; }
+      void set_index(int index) { index_ = index; }
+
       // Adjust the residual at this data point by the specified
       // value.  The notion is
       //
@@ -76,6 +83,7 @@ namespace BOOM {
 
      private:
       const VectorData *predictor_;
+      int index_;
     };
 
   }  // namespace Bart
@@ -0,0 +1,431 @@
+#include "gtest/gtest.h"
+
+#include "Models/Bart/Bart.hpp"
+#include "Models/Bart/GaussianBartModel.hpp"
+#include "Models/Bart/PosteriorSamplers/GaussianBartPosteriorSampler.hpp"
+#include "cpputil/Checkpoint.hpp"
+#include "cpputil/ThreadTools.hpp"
+#include "distributions.hpp"
+#include "stats/moments.hpp"
+
+#include "test_utils/test_utils.hpp"
+
+namespace {
+  using namespace BOOM;
+  using std::endl;
+
+  class BartTest : public ::testing::Test {
+   protected:
+    BartTest() {
+      GlobalRng::rng.seed(8675309);
+    }
+  };
+
+  // Append the leaves of the subtree rooted at 'node' to 'leaves', in depth
+  // first order.  Unlike Tree::leaf_begin(), the order does not depend on
+  // where the nodes were allocated, so two copies of a tree can be compared
+  // leaf by leaf.
+  void collect_leaves(Bart::TreeNode *node,
+                      std::vector<Bart::TreeNode *> &leaves) {
+    if (node->is_leaf()) {
+      leaves.push_back(node);
+    } else {
+      collect_leaves(node->left_child(), leaves);
+      collect_leaves(node->right_child(), leaves);
+    }
+  }
+
+  // Grow the same random splits on two trees, using 'pool' to refresh the
+  // data in the first one and no pool in the second.
+  void grow_random_trees(Bart::Tree &threaded, Bart::Tree &serial,
+                         ThreadWorkerPool &pool, int number_of_splits,
+                         int xdim) {
+    for (int i = 0; i < number_of_splits; ++i) {
+      std::vector<Bart::TreeNode *> threaded_leaves;
+      std::vector<Bart::TreeNode *> serial_leaves;
+      collect_leaves(threaded.root(), threaded_leaves);
+      collect_leaves(serial.root(), serial_leaves);
+      int which_leaf = random_int(0, threaded_leaves.size() - 1);
+      int variable = random_int(0, xdim - 1);
+      double cutpoint = rnorm();
+      threaded_leaves[which_leaf]->set_variable_and_cutpoint(variable,
+                                                             cutpoint);
+      serial_leaves[which_leaf]->set_variable_and_cutpoint(variable,
+                                                           cutpoint);
+      threaded.grow(threaded_leaves[which_leaf], 0.0, 0.0, &pool);
+      serial.grow(serial_leaves[which_leaf], 0.0, 0.0, nullptr);
+    }
+  }
+
+  // Nodes with more than one chunk of data (4096 observations) are
+  // processed in parallel when the pool has threads.  The threaded path
+  // must send the same data to each node, and produce the same sufficient
+  // statistics up to rounding.
+  TEST_F(BartTest, ThreadedSufficientStatistics) {
+    int nobs = 3 * 4096 + 17;
+    int xdim = 3;
+    std::vector<Ptr<RegressionData>> data;
+    std::vector<std::unique_ptr<Bart::GaussianResidualRegressionData>>
+        residuals;
+    Bart::Tree threaded;
+    Bart::Tree serial;
+    threaded.populate_sufficient_statistics(
+        new Bart::GaussianBartSufficientStatistics);
+    serial.populate_sufficient_statistics(
+        new Bart::GaussianBartSufficientStatistics);
+    for (int i = 0; i < nobs; ++i) {
+      Vector x(xdim);
+      x.randomize();
+      x -= 0.5;
+      data.push_back(new RegressionData(rnorm(3, 2), x));
+      residuals.emplace_back(
+          new Bart::GaussianResidualRegressionData(data.back(), 0.0));
+      threaded.populate_data(residuals.back().get());
+      serial.populate_data(residuals.back().get());
+    }
+
+    ThreadWorkerPool pool(3);
+    // A root split near the median keeps more than one chunk of data on
+    // each side, so the children are refreshed in parallel as well.
+    threaded.root()->set_variable_and_cutpoint(0, 0.0);
+    serial.root()->set_variable_and_cutpoint(0, 0.0);
+    threaded.grow(threaded.root(), 0.0, 0.0, &pool);
+    serial.grow(serial.root(), 0.0, 0.0, nullptr);
+    grow_random_trees(threaded, serial, pool, 6, xdim);
+
+    // Compare the nodes near the root, which hold more than one chunk of
+    // data, as well as the leaves.
+    std::vector<Bart::TreeNode *> threaded_nodes = {
+        threaded.root(), threaded.root()->left_child(),
+        threaded.root()->right_child()};
+    std::vector<Bart::TreeNode *> serial_nodes = {
+        serial.root(), serial.root()->left_child(),
+        serial.root()->right_child()};
+    collect_leaves(threaded.root(), threaded_nodes);
+    collect_leaves(serial.root(), serial_nodes);
+    ASSERT_EQ(threaded_nodes.size(), serial_nodes.size());
+
+    // Accumulating in chunks only changes the order of the floating point
+    // additions, so the sums agree up to a relative error of a few
+    // multiples of n * epsilon, well inside 1e-12 for these sizes.
+    const double relative_tolerance = 1e-12;
+    ThreadWorkerPool no_threads;
+    for (int i = 0; i < threaded_nodes.size(); ++i) {
+      EXPECT_TRUE(threaded_nodes[i]->data() == serial_nodes[i]->data());
+      const Bart::GaussianBartSufficientStatistics &threaded_suf(
+          dynamic_cast<const Bart::GaussianBartSufficientStatistics &>(
+              threaded_nodes[i]->compute_suf(&pool)));
+      const Bart::GaussianBartSufficientStatistics &serial_suf(
+          dynamic_cast<const Bart::GaussianBartSufficientStatistics &>(
+              serial_nodes[i]->compute_suf(nullptr)));
+      EXPECT_DOUBLE_EQ(serial_suf.n(), threaded_suf.n());
+      EXPECT_NEAR(serial_suf.sum(), threaded_suf.sum(),
+                  relative_tolerance * fabs(serial_suf.sum()));
+      EXPECT_NEAR(serial_suf.sumsq(), threaded_suf.sumsq(),
+                  relative_tolerance * serial_suf.sumsq());
+
+      // A pool without threads takes the serial path, so the result is
+      // identical.
+      const Bart::GaussianBartSufficientStatistics &empty_pool_suf(
+          dynamic_cast<const Bart::GaussianBartSufficientStatistics &>(
+              threaded_nodes[i]->compute_suf(&no_threads)));
+      EXPECT_EQ(serial_suf.sum(), empty_pool_suf.sum());
+      EXPECT_EQ(serial_suf.sumsq(), empty_pool_suf.sumsq());
+    }
+
+    // Check that the data at the root were actually processed in chunks.
+    EXPECT_GT(threaded.root()->left_child()->data().size(), 4096);
+    EXPECT_GT(threaded.root()->right_child()->data().size(), 4096);
+  }
+
+  // The leaf set is ordered by position in the tree, so iterating over it
+  // visits the leaves from left to right no matter where the nodes were
+  // allocated.
+  TEST_F(BartTest, LeavesAreOrderedByPosition) {
+    Bart::Tree tree;
+    for (int i = 0; i < 20; ++i) {
+      std::vector<Bart::TreeNode *> leaves;
+      collect_leaves(tree.root(), leaves);
+      Bart::TreeNode *leaf = leaves[random_int(0, leaves.size() - 1)];
+      leaf->set_variable_and_cutpoint(0, rnorm());
+      tree.grow(leaf, 0.0, 0.0, nullptr);
+      if (i % 4 == 3) {
+        // Prune a random subtree now and then, so that nodes allocated at
+        // different times end up next to each other.
+        std::vector<Bart::TreeNode *> parents(tree.parents_of_leaves_begin(),
+                                              tree.parents_of_leaves_end());
+        tree.prune_descendants(parents[random_int(0, parents.size() - 1)]);
+      }
+    }
+
+    std::vector<Bart::TreeNode *> expected;
+    collect_leaves(tree.root(), expected);
+    std::vector<Bart::TreeNode *> leaves(tree.leaf_begin(), tree.leaf_end());
+    EXPECT_EQ(expected, leaves);
+
+    // The parents of leaves are kept in the same order, including the
+    // parents of nodes that were pruned back to leaves.
+    std::vector<Bart::TreeNode *> expected_parents;
+    for (Bart::TreeNode *leaf : expected) {
+      Bart::TreeNode *parent = leaf->parent();
+      if (parent && parent->has_no_grandchildren() &&
+          (expected_parents.empty() || expected_parents.back() != parent)) {
+        expected_parents.push_back(parent);
+      }
+    }
+    std::vector<Bart::TreeNode *> parents(tree.parents_of_leaves_begin(),
+                                          tree.parents_of_leaves_end());
+    EXPECT_EQ(expected_parents, parents);
+
+    Bart::TreeNodePositionLess less;
+    EXPECT_TRUE(less(tree.root(), expected[0]));
+    EXPECT_FALSE(less(expected[0], tree.root()));
+    EXPECT_FALSE(less(tree.root(), tree.root()));
+  }
+
+  // Run a short chain with the given number of threads, and return the
+  // trees and the residual variance at the end of it.
+  Matrix run_gaussian_bart(const Vector &y, const Matrix &X,
+                           int number_of_threads, double &sigsq) {
+    int number_of_trees = 10;
+    NEW(GaussianBartModel, model)(number_of_trees, y, X);
+    model->finalize_data();
+    RNG seeding_rng(31415);
+    NEW(GaussianBartPosteriorSampler, sampler)(
+        model.get(), sd(y), 1.0, 2 * sd(y), .95, 2.0,
+        [](int) { return 0.0; }, seeding_rng);
+    sampler->set_number_of_threads(number_of_threads);
+    model->set_method(sampler);
+    for (int i = 0; i < 5; ++i) {
+      model->sample_posterior();
+    }
+    sigsq = model->sigsq();
+    Matrix ans;
+    for (int i = 0; i < model->number_of_trees(); ++i) {
+      ans.rbind(model->tree(i)->to_matrix());
+    }
+    return ans;
+  }
+
+  // With a pool that has threads the sample path does not depend on the
+  // number of threads.
+  TEST_F(BartTest, SamplePathDoesNotDependOnThreadCount) {
+    int nobs = 10000;
+    int xdim = 3;
+    Matrix X(nobs, xdim);
+    X.randomize();
+    Vector y(nobs);
+    for (int i = 0; i < nobs; ++i) {
+      y[i] = (X(i, 0) > .5 ? 3.0 : -1.0) + 2 * X(i, 1) + rnorm(0, .5);
+    }
+
+    double sigsq_1 = 0;
+    double sigsq_3 = 0;
+    Matrix trees_1 = run_gaussian_bart(y, X, 1, sigsq_1);
+    Matrix trees_3 = run_gaussian_bart(y, X, 3, sigsq_3);
+    EXPECT_TRUE(MatrixEquals(trees_1, trees_3));
+    EXPECT_EQ(sigsq_1, sigsq_3);
+  }
+
+
+  // The histogram cutpoint search computes the subtree likelihood of every
+  // candidate cutpoint in one pass through the data.  Each element must
+  // match the likelihood computed by moving the cutpoint and refreshing the
+  // data in the subtree.
+  TEST_F(BartTest, HistogramCutpointSearchMatchesUnbinned) {
+    int nobs = 500;
+    int xdim = 2;
+    Matrix X(nobs, xdim);
+    Vector y(nobs);
+    for (int i = 0; i < nobs; ++i) {
+      X(i, 0) = random_int(0, 9);
+      X(i, 1) = random_int(0, 4);
+      y[i] = (X(i, 0) > 4 ? 2.0 : -1.0) + X(i, 1) + rnorm(0, .5);
+    }
+    NEW(GaussianBartModel, model)(3, y, X);
+    model->finalize_data();
+    RNG seeding_rng(27);
+    NEW(GaussianBartPosteriorSampler, sampler)(
+        model.get(), sd(y), 1.0, 2 * sd(y), .95, 2.0,
+        [](int) { return 0.0; }, seeding_rng);
+    sampler->use_histogram_cutpoint_search(true);
+    model->set_method(sampler);
+    sampler->check_residuals();
+
+    for (int variable = 0; variable < xdim; ++variable) {
+      const Bart::VariableSummary &summary(
+          model->variable_summary(variable));
+      ASSERT_FALSE(summary.is_continuous());
+      Bart::Tree *tree = model->tree(variable);
+      Bart::TreeNode *root = tree->root();
+      Vector cutpoints = summary.discrete_cutpoints();
+      root->set_variable_and_cutpoint(variable, cutpoints[0]);
+      tree->grow(root, 0.0, 0.0, nullptr);
+      sampler->refresh_subtree_data(root);
+
+      Vector candidates = summary.get_cutpoint_range(root);
+      ASSERT_GT(candidates.size(), 1);
+      Vector logp;
+      ASSERT_TRUE(sampler->histogram_cutpoint_log_likelihoods(
+          root, candidates, logp));
+      ASSERT_EQ(candidates.size(), logp.size());
+      for (int j = 0; j < candidates.size(); ++j) {
+        root->set_variable_and_cutpoint(variable, candidates[j]);
+        sampler->refresh_subtree_data(root);
+        EXPECT_NEAR(sampler->subtree_log_integrated_likelihood(root),
+                    logp[j], 1e-6)
+            << "variable " << variable << " candidate " << j;
+      }
+    }
+  }
+
+
+  // Replacing the model's data after the sampler has binned the predictors
+  // must rebuild the bins and the residuals, even when the sample size is
+  // unchanged.  The sampler that saw the old data should then agree with
+  // one that only ever saw the new data.
+  TEST_F(BartTest, HistogramCutpointSearchFollowsDataChanges) {
+    int nobs = 300;
+    int xdim = 2;
+    auto simulate = [&](Matrix &X, Vector &y) {
+      X.resize(nobs, xdim);
+      y.resize(nobs);
+      for (int i = 0; i < nobs; ++i) {
+        X(i, 0) = random_int(0, 9);
+        X(i, 1) = random_int(0, 4);
+        y[i] = (X(i, 0) > 4 ? 2.0 : -1.0) + X(i, 1) + rnorm(0, .5);
+      }
+    };
+    Matrix X1, X2;
+    Vector y1, y2;
+    simulate(X1, y1);
+    simulate(X2, y2);
+
+    auto build = [&](Ptr<GaussianBartPosteriorSampler> &sampler) {
+      NEW(GaussianBartModel, model)(3, y1, X1);
+      model->finalize_data();
+      RNG seeding_rng(27);
+      sampler = new GaussianBartPosteriorSampler(
+          model.get(), sd(y1), 1.0, 2 * sd(y1), .95, 2.0,
+          [](int) { return 0.0; }, seeding_rng);
+      sampler->use_histogram_cutpoint_search(true);
+      model->set_method(sampler);
+      return model;
+    };
+    auto replace_data = [&](const Ptr<GaussianBartModel> &model) {
+      model->clear_data();
+      for (int i = 0; i < nobs; ++i) {
+        NEW(RegressionData, data_point)(y2[i], X2.row(i));
+        model->add_data(data_point);
+      }
+    };
+    int variable = 0;
+    auto root_log_likelihoods = [&](const Ptr<GaussianBartModel> &model,
+                                    GaussianBartPosteriorSampler *sampler) {
+      Bart::Tree *tree = model->tree(0);
+      Bart::TreeNode *root = tree->root();
+      const Bart::VariableSummary &summary(
+          model->variable_summary(variable));
+      Vector candidates = summary.get_cutpoint_range(root);
+      if (root->is_leaf()) {
+        root->set_variable_and_cutpoint(variable, candidates[0]);
+        tree->grow(root, 0.0, 0.0, nullptr);
+      }
+      sampler->check_residuals();
+      sampler->refresh_subtree_data(root);
+      Vector logp;
+      EXPECT_TRUE(sampler->histogram_cutpoint_log_likelihoods(
+          root, candidates, logp));
+      return logp;
+    };
+
+    // The first sampler bins the original data before the data change.
+    Ptr<GaussianBartPosteriorSampler> stale_sampler;
+    Ptr<GaussianBartModel> stale_model = build(stale_sampler);
+    Vector original_logp = root_log_likelihoods(stale_model,
+                                                stale_sampler.get());
+    replace_data(stale_model);
+    Vector logp = root_log_likelihoods(stale_model, stale_sampler.get());
+
+    // The second sampler sees only the new data.
+    Ptr<GaussianBartPosteriorSampler> fresh_sampler;
+    Ptr<GaussianBartModel> fresh_model = build(fresh_sampler);
+    replace_data(fresh_model);
+    Vector fresh_logp = root_log_likelihoods(fresh_model, fresh_sampler.get());
+
+    ASSERT_EQ(fresh_logp.size(), logp.size());
+    EXPECT_TRUE(VectorEquals(fresh_logp, logp));
+    EXPECT_FALSE(VectorEquals(original_logp, logp));
+
+    // The binned likelihoods also match the unbinned ones on the new data.
+    Bart::TreeNode *root = stale_model->tree(0)->root();
+    Vector candidates =
+        stale_model->variable_summary(variable).get_cutpoint_range(root);
+    for (int j = 0; j < candidates.size(); ++j) {
+      root->set_variable_and_cutpoint(variable, candidates[j]);
+      stale_sampler->refresh_subtree_data(root);
+      EXPECT_NEAR(stale_sampler->subtree_log_integrated_likelihood(root),
+                  logp[j], 1e-6)
+          << "candidate " << j;
+    }
+  }
+
+
+  // A BART chain restored from a checkpoint resumes where the original
+  // chain left off.  The residuals are recomputed from the restored trees,
+  // so they can differ from the uninterrupted chain's by rounding.
+  TEST_F(BartTest, CheckpointRoundTrip) {
+    int nobs = 200;
+    int xdim = 3;
+    Matrix X(nobs, xdim);
+    X.randomize();
+    Vector y(nobs);
+    for (int i = 0; i < nobs; ++i) {
+      y[i] = (X(i, 0) > .5 ? 3.0 : -1.0) + 2 * X(i, 1) + rnorm(0, .5);
+    }
+    int number_of_trees = 5;
+    auto build = [&](unsigned long seed) {
+      NEW(GaussianBartModel, model)(number_of_trees, y, X);
+      model->finalize_data();
+      RNG seeding_rng(seed);
+      NEW(GaussianBartPosteriorSampler, sampler)(
+          model.get(), sd(y), 1.0, 2 * sd(y), .95, 2.0,
+          [](int) { return 0.0; }, seeding_rng);
+      model->set_method(sampler);
+      return model;
+    };
+    // The sampler can add and remove trees, so the number of trees is
+    // part of the state being compared.
+    auto trees = [](const Ptr<GaussianBartModel> &model) {
+      Matrix ans;
+      for (int i = 0; i < model->number_of_trees(); ++i) {
+        ans.rbind(model->tree(i)->to_matrix());
+      }
+      return ans;
+    };
+
+    Ptr<GaussianBartModel> model = build(31415);
+    for (int i = 0; i < 10; ++i) {
+      model->sample_posterior();
+    }
+    CheckpointWriter writer;
+    model->save_state(writer);
+    Matrix saved_trees = trees(model);
+    double saved_sigsq = model->sigsq();
+
+    Ptr<GaussianBartModel> resumed = build(27);
+    CheckpointReader reader(writer.bytes());
+    resumed->restore_state(reader);
+    EXPECT_TRUE(reader.at_end());
+    EXPECT_TRUE(MatrixEquals(saved_trees, trees(resumed)));
+    EXPECT_EQ(saved_sigsq, resumed->sigsq());
+
+    for (int i = 0; i < 5; ++i) {
+      model->sample_posterior();
+      resumed->sample_posterior();
+    }
+    EXPECT_TRUE(MatrixEquals(trees(model), trees(resumed)));
+    EXPECT_NEAR(model->sigsq(), resumed->sigsq(), 1e-8);
+  }
+
+}  // namespace
@@ -0,0 +1,123 @@
+#include "gtest/gtest.h"
+
+#include "Models/Bart/Bart.hpp"
+#include "Models/Bart/FlatTree.hpp"
+#include "Models/Bart/GaussianBartModel.hpp"
+#include "distributions.hpp"
+
+#include "test_utils/test_utils.hpp"
+
+namespace {
+  using namespace BOOM;
+  using std::endl;
+
+  class FlatTreeTest : public ::testing::Test {
+   protected:
+    FlatTreeTest() {
+      GlobalRng::rng.seed(8675309);
+    }
+  };
+
+  // Grow 'number_of_splits' random splits on 'tree'.  Variables are chosen
+  // uniformly from [0, xdim), and cutpoints are small integers, so that
+  // integer valued predictors land exactly on a cutpoint some of the time.
+  void grow_random_tree(Bart::Tree &tree, int number_of_splits, int xdim) {
+    for (int i = 0; i < number_of_splits; ++i) {
+      Bart::TreeNode *leaf = tree.random_leaf(GlobalRng::rng);
+      leaf->set_variable_and_cutpoint(random_int(0, xdim - 1),
+                                      random_int(-2, 2));
+      tree.grow(leaf, rnorm(), rnorm());
+    }
+  }
+
+  // The number of splits on the longest path from the root to a leaf.
+  int tree_depth(const Bart::Tree &tree) {
+    int ans = 0;
+    for (auto it = tree.leaf_begin(); it != tree.leaf_end(); ++it) {
+      ans = std::max(ans, (*it)->depth());
+    }
+    return ans;
+  }
+
+  // A matrix of integer valued predictors, so ties with the cutpoints
+  // exercise the "go left if x <= cutpoint" rule.
+  Matrix random_predictors(int nrow, int ncol) {
+    Matrix X(nrow, ncol);
+    for (int i = 0; i < nrow; ++i) {
+      for (int j = 0; j < ncol; ++j) {
+        X(i, j) = random_int(-3, 3);
+      }
+    }
+    return X;
+  }
+
+  TEST_F(FlatTreeTest, SingleLeaf) {
+    Bart::Tree tree(1.7);
+    Bart::FlatTree flat(tree);
+    EXPECT_EQ(1, flat.number_of_nodes());
+    EXPECT_EQ(0, flat.depth());
+
+    Matrix X = random_predictors(5, 3);
+    Vector out(5);
+    flat.predict(X, VectorView(out));
+    for (int i = 0; i < 5; ++i) {
+      EXPECT_DOUBLE_EQ(1.7, out[i]);
+      EXPECT_DOUBLE_EQ(1.7, flat.predict(ConstVectorView(X.row(i))));
+    }
+  }
+
+  TEST_F(FlatTreeTest, MatchesTreeOnRandomTrees) {
+    int xdim = 4;
+    int nobs = 200;
+    Matrix X = random_predictors(nobs, xdim);
+    for (int rep = 0; rep < 20; ++rep) {
+      Bart::Tree tree(rnorm());
+      grow_random_tree(tree, random_int(1, 15), xdim);
+      Bart::FlatTree flat(tree);
+      EXPECT_EQ(tree.number_of_nodes(), flat.number_of_nodes());
+      EXPECT_EQ(tree_depth(tree), flat.depth());
+
+      // The serialized form produces the same flat tree.
+      Bart::FlatTree from_matrix(tree.to_matrix());
+      EXPECT_EQ(flat.number_of_nodes(), from_matrix.number_of_nodes());
+
+      Vector batch(nobs);
+      flat.predict(X, VectorView(batch));
+      Vector accumulated(nobs, 1.0);
+      flat.accumulate_predictions(X, VectorView(accumulated), 10, 50);
+      for (int i = 0; i < nobs; ++i) {
+        ConstVectorView x(X.row(i));
+        double expected = tree.predict(x);
+        EXPECT_DOUBLE_EQ(expected, flat.predict(x))
+            << "rep " << rep << " row " << i << endl << tree;
+        EXPECT_DOUBLE_EQ(expected, from_matrix.predict(x));
+        EXPECT_DOUBLE_EQ(expected, batch[i]);
+        if (i >= 10 && i < 50) {
+          EXPECT_DOUBLE_EQ(1.0 + expected, accumulated[i]);
+        } else {
+          EXPECT_DOUBLE_EQ(1.0, accumulated[i]);
+        }
+      }
+    }
+  }
+
+  // The matrix form of BartModelBase::predict scores the rows in chunks,
+  // so use enough rows to span more than one chunk.
+  TEST_F(FlatTreeTest, BartModelMatrixPrediction) {
+    int xdim = 5;
+    int nobs = 5000;
+    int number_of_trees = 7;
+    GaussianBartModel model(number_of_trees);
+    for (int i = 0; i < number_of_trees; ++i) {
+      grow_random_tree(*model.tree(i), random_int(0, 10), xdim);
+    }
+    Matrix X = random_predictors(nobs, xdim);
+    Vector predictions(nobs);
+    model.predict(X, VectorView(predictions));
+    for (int i = 0; i < nobs; ++i) {
+      EXPECT_NEAR(model.predict(ConstVectorView(X.row(i))), predictions[i],
+                  1e-10);
+    }
+  }
+
+}  // namespace
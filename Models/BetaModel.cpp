@@ -251,6 +251,30 @@ namespace BOOM {
     return ans;
   }
 
+  void BM::fill_logp(const ConstVectorView &x, VectorView log_density) const {
+    double inf = BOOM::infinity();
+    double a = this->a();
+    double b = this->b();
+    if (a == inf || b == inf || a <= 0 || b <= 0) {
+      DoubleModel::fill_logp(x, log_density);
+      return;
+    }
+    if (log_density.size() != x.size()) {
+      report_error("x and log_density must be the same size in fill_logp.");
+    }
+    const double normalizing_constant = lgamma(a + b) - lgamma(a) - lgamma(b);
+    const double A = a - 1;
+    const double B = b - 1;
+    for (int i = 0; i < x.size(); ++i) {
+      double y = x[i];
+      if (y > 0 && y < 1) {
+        log_density[i] = normalizing_constant + A * log(y) + B * log1p(-y);
+      } else {
+        log_density[i] = logp(y);
+      }
+    }
+  }
+
   double BM::Logp_degenerate(double x, double &d1, double &d2, uint nd) const {
     double inf = BOOM::infinity();
     double a_inf = static_cast<double>(a() == inf);
@@ -102,6 +102,8 @@ namespace BOOM {
     using LoglikeModel::log_likelihood;
 
     double Logp(double x, double &d1, double &d2, uint nd) const override;
+    void fill_logp(const ConstVectorView &x,
+                   VectorView log_density) const override;
     double sim(RNG &rng = GlobalRng::rng) const override;
 
     int number_of_observations() const override { return dat().size(); }
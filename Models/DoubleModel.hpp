@@ -30,6 +30,22 @@ namespace BOOM {
     DoubleModel *clone() const override = 0;
     virtual double pdf(const Ptr<Data> &dp, bool logscale) const;
     double pdf(const Data *dp, bool logscale) const override;
+
+    // Evaluate the log density at each element of x.
+    // Args:
+    //   x:  The values where the density is to be evaluated.
+    //   log_density: On output log_density[i] is logp(x[i]).  Must have the
+    //     same size as x.
+    //
+    // The default implementation calls logp() once per element.  The
+    // common families override it with a loop that reads the parameters
+    // once and has no virtual calls, which the compiler can vectorize.
+    virtual void fill_logp(const ConstVectorView &x,
+                           VectorView log_density) const;
+
+    // Copies the values out of 'data' and evaluates them with fill_logp().
+    void fill_log_pdf(const std::vector<Ptr<Data>> &data,
+                      VectorView log_density) const override;
   };
 
   class LocationScaleDoubleModel : virtual public DoubleModel {
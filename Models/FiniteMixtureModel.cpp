@@ -21,6 +21,7 @@
 #include "cpputil/lse.hpp"
 #include "distributions.hpp"
 
+#include <algorithm>
 #include <functional>
 #include <stdexcept>
 
@@ -28,7 +29,12 @@ namespace BOOM {
 
   namespace {
     using FMM = BOOM::FiniteMixtureModel;
-  }
+
+    // The number of observations whose log densities are evaluated together
+    // during data augmentation.  Each mixture component evaluates a block
+    // with a single call to fill_log_pdf.
+    const int kDensityBlockSize = 256;
+  }  // namespace
 
   FMM::FiniteMixtureModel(const Ptr<MixtureComponent> &mixture_component,
                           uint S)
@@ -77,45 +83,102 @@ namespace BOOM {
   }
 
   void FMM::impute_latent_data(RNG &rng) {
-    const std::vector<Ptr<Data> > &d(dat());
-    std::vector<Ptr<CategoricalData> > hvec(latent_data());
-
-    uint n = d.size();
-    uint S = number_of_mixture_components();
-    class_membership_probabilities_.resize(n, S);
+    prepare_to_impute_latent_data();
+    last_loglike_ = impute_latent_data_range(0, dat().size(),
+                                             mixture_components_,
+                                             *mixing_dist_, rng);
+  }
 
-    wsp_.resize(S);
+  void FMM::prepare_to_impute_latent_data() {
+    const std::vector<Ptr<Data>> &data(dat());
+    int S = number_of_mixture_components();
+    class_membership_probabilities_.resize(data.size(), S);
     set_logpi();
     last_loglike_ = 0;
-    const std::vector<Ptr<MixtureComponent> > &mod(mixture_components_);
-    Ptr<MultinomialModel> mix(mixing_dist_);
     clear_component_data();
-    for (uint i = 0; i < n; ++i) {
-      Ptr<Data> dp = d[i];
-      Ptr<CategoricalData> cd = hvec[i];
-      if (dp->missing() != 0u) {
-        wsp_ = logpi_;
-      } else if (which_mixture_component(i) > 0) {
+  }
+
+  void FMM::copy_parameters_to(
+      const std::vector<Ptr<MixtureComponent>> &components) const {
+    int S = number_of_mixture_components();
+    if (components.size() != S) {
+      report_error("Wrong number of mixture components passed to "
+                   "copy_parameters_to.");
+    }
+    for (int s = 0; s < S; ++s) {
+      components[s]->unvectorize_params(
+          mixture_components_[s]->vectorize_params());
+    }
+  }
+
+  double FMM::impute_latent_data_range(
+      int begin, int end, const std::vector<Ptr<MixtureComponent>> &components,
+      MultinomialModel &mixing_distribution, RNG &rng) {
+    const std::vector<Ptr<Data>> &data(dat());
+    const std::vector<Ptr<CategoricalData>> &latent(latent_data());
+    int S = number_of_mixture_components();
+    if (components.size() != S) {
+      report_error("Wrong number of mixture components passed to "
+                   "impute_latent_data_range.");
+    }
+    std::vector<Ptr<Data>> block;
+    Matrix log_density;
+    Vector wsp(S);
+    double loglike = 0;
+    for (int block_begin = begin; block_begin < end;
+         block_begin += kDensityBlockSize) {
+      int block_end = std::min(block_begin + kDensityBlockSize, end);
+      fill_log_densities(block_begin, block_end, components, block,
+                         log_density);
+      for (int i = block_begin; i < block_end; ++i) {
+        const Ptr<Data> &dp(data[i]);
+        const Ptr<CategoricalData> &cd(latent[i]);
+        int row = i - block_begin;
         int source = which_mixture_component(i);
-        last_loglike_ += mod[source]->pdf(dp.get(), true);
-        class_membership_probabilities_.row(i) = 0;
-        class_membership_probabilities_(i, source) = 1.0;
-        cd->set(source);
-        mix->add_data(cd);
-        mod[source]->add_data(dp);
-        continue;
-      } else {
-        for (uint s = 0; s < S; ++s) {
-          wsp_[s] = logpi_[s] + mod[s]->pdf(dp.get(), true);
+        if (!dp->missing() && source >= 0) {
+          loglike += log_density(row, source);
+          class_membership_probabilities_.row(i) = 0;
+          class_membership_probabilities_(i, source) = 1.0;
+          cd->set(source);
+          mixing_distribution.add_data(cd);
+          components[source]->add_data(dp);
+          continue;
         }
+        // Missing observations have log density 0 under each component, so
+        // their class membership probabilities are the mixing weights.
+        wsp = logpi_;
+        wsp += log_density.row(row);
+        loglike += lse(wsp);
+        wsp.normalize_logprob();
+        class_membership_probabilities_.row(i) = wsp;
+        int h = rmulti_mt(rng, wsp);
+        cd->set(h);
+        components[h]->add_data(dp);
+        mixing_distribution.add_data(cd);
       }
-      last_loglike_ += lse(wsp_);
-      wsp_.normalize_logprob();
-      class_membership_probabilities_.row(i) = wsp_;
-      uint h = rmulti_mt(rng, wsp_);
-      cd->set(h);
-      mod[h]->add_data(dp);
-      mix->add_data(cd);
+    }
+    return loglike;
+  }
+
+  void FMM::combine_complete_data(
+      const std::vector<Ptr<MixtureComponent>> &components,
+      const MultinomialModel &mixing_distribution, double loglike) {
+    for (int s = 0; s < mixture_components_.size(); ++s) {
+      mixture_components_[s]->combine_data(*components[s], false);
+    }
+    mixing_dist_->combine_data(mixing_distribution, false);
+    last_loglike_ += loglike;
+  }
+
+  void FMM::fill_log_densities(
+      int begin, int end, const std::vector<Ptr<MixtureComponent>> &components,
+      std::vector<Ptr<Data>> &workspace, Matrix &log_density) const {
+    const std::vector<Ptr<Data>> &data(dat());
+    workspace.assign(data.begin() + begin, data.begin() + end);
+    int S = number_of_mixture_components();
+    log_density.resize(end - begin, S);
+    for (int s = 0; s < S; ++s) {
+      components[s]->fill_log_pdf(workspace, log_density.col(s));
     }
   }
 
@@ -293,33 +356,97 @@ namespace BOOM {
   }
 
   double EmFiniteMixtureModel::EStep() {
-    clear_component_data();
-    Vector &wsp(wsp_);
-    wsp.resize(number_of_mixture_components());
-    const std::vector<Ptr<Data> > &data(dat());
-    double ans = 0;
+    if (estep_workers_.empty()) {
+      clear_component_data();
+      return EStep(0, dat().size(), em_mixture_components_,
+                   *mixing_distribution()->suf());
+    }
+    prepare_to_impute_latent_data();
+    if (estep_imputer_.number_of_observations_managed() != dat().size()) {
+      assign_data_to_workers();
+    }
+    for (auto &worker : estep_workers_) {
+      worker->refresh_parameters();
+    }
+    estep_loglike_ = 0;
+    estep_imputer_.impute_latent_data();
+    return estep_loglike_;
+  }
+
+  double EmFiniteMixtureModel::EStep(
+      int begin, int end,
+      const std::vector<Ptr<EmMixtureComponent>> &components,
+      MultinomialSuf &mixing_suf) const {
+    int S = number_of_mixture_components();
+    if (components.size() != S) {
+      report_error("Wrong number of mixture components passed to EStep.");
+    }
+    const std::vector<Ptr<Data>> &data(dat());
     const Vector &log_pi(logpi());
-    for (int i = 0; i < data.size(); ++i) {
-      for (int s = 0; s < number_of_mixture_components(); ++s) {
-        wsp[s] = log_pi[s] + mixture_component(s)->pdf(data[i].get(), true);
-      }
-      double total = lse(wsp);
-      ans += total;
-      double normalizing_constant = 0;
-      for (int s = 0; s < number_of_mixture_components(); ++s) {
-        wsp[s] = exp(wsp[s] - total);
-        normalizing_constant += wsp[s];
-      }
-      for (int s = 0; s < number_of_mixture_components(); ++s) {
-        em_mixture_components_[s]->add_mixture_data(
-            data[i], wsp[s] / normalizing_constant);
+    const std::vector<Ptr<MixtureComponent>> density_components(
+        components.begin(), components.end());
+    std::vector<Ptr<Data>> block;
+    Matrix log_density;
+    Vector wsp(S);
+    double ans = 0;
+    for (int block_begin = begin; block_begin < end;
+         block_begin += kDensityBlockSize) {
+      int block_end = std::min(block_begin + kDensityBlockSize, end);
+      fill_log_densities(block_begin, block_end, density_components, block,
+                         log_density);
+      for (int i = block_begin; i < block_end; ++i) {
+        wsp = log_pi;
+        wsp += log_density.row(i - block_begin);
+        double total = lse(wsp);
+        ans += total;
+        double normalizing_constant = 0;
+        for (int s = 0; s < S; ++s) {
+          wsp[s] = exp(wsp[s] - total);
+          normalizing_constant += wsp[s];
+        }
+        wsp /= normalizing_constant;
+        for (int s = 0; s < S; ++s) {
+          components[s]->add_mixture_data(data[i], wsp[s]);
+        }
+        mixing_suf.add_mixture_data(wsp);
       }
-      mixing_distribution()->suf()->add_mixture_data(wsp /
-                                                     normalizing_constant);
     }
     return ans;
   }
 
+  void EmFiniteMixtureModel::combine_complete_data(
+      const std::vector<Ptr<EmMixtureComponent>> &components,
+      const MultinomialSuf &mixing_suf, double loglike) {
+    for (int s = 0; s < em_mixture_components_.size(); ++s) {
+      em_mixture_components_[s]->combine_data(*components[s], true);
+    }
+    mixing_distribution()->suf()->combine(mixing_suf);
+    estep_loglike_ += loglike;
+  }
+
+  void EmFiniteMixtureModel::set_number_of_threads(int n) {
+    estep_imputer_.clear_workers();
+    estep_workers_.clear();
+    if (n > 1) {
+      for (int i = 0; i < n; ++i) {
+        NEW(FiniteMixtureEStepWorker, worker)(this, estep_mutex_);
+        estep_workers_.push_back(worker);
+        estep_imputer_.add_worker(worker);
+      }
+    }
+    estep_imputer_.set_number_of_threads(n > 1 ? n : 0);
+    assign_data_to_workers();
+  }
+
+  void EmFiniteMixtureModel::assign_data_to_workers() {
+    int number_of_workers = estep_workers_.size();
+    long nobs = dat().size();
+    for (int i = 0; i < number_of_workers; ++i) {
+      estep_workers_[i]->set_range(nobs * i / number_of_workers,
+                                   nobs * (i + 1) / number_of_workers);
+    }
+  }
+
   void EmFiniteMixtureModel::MStep(bool posterior_mode) {
     for (int s = 0; s < number_of_mixture_components(); ++s) {
       if (posterior_mode) {
@@ -340,4 +467,38 @@ namespace BOOM {
     return em_mixture_components_[s].get();
   }
 
+  //======================================================================
+  FiniteMixtureEStepWorker::FiniteMixtureEStepWorker(
+      EmFiniteMixtureModel *model, std::mutex &mutex)
+      : LatentDataImputerWorker(mutex),
+        model_(model),
+        begin_(0),
+        end_(0),
+        mixing_suf_(model->number_of_mixture_components()),
+        loglike_(0) {
+    for (int s = 0; s < model_->number_of_mixture_components(); ++s) {
+      Ptr<EmMixtureComponent> component =
+          model_->em_mixture_component(s)->clone();
+      component->clear_data();
+      components_.push_back(component);
+    }
+  }
+
+  void FiniteMixtureEStepWorker::refresh_parameters() {
+    model_->copy_parameters_to(std::vector<Ptr<MixtureComponent>>(
+        components_.begin(), components_.end()));
+  }
+
+  void FiniteMixtureEStepWorker::impute_latent_data() {
+    for (auto &component : components_) {
+      component->clear_data();
+    }
+    mixing_suf_.clear();
+    loglike_ = model_->EStep(begin_, end_, components_, mixing_suf_);
+  }
+
+  void FiniteMixtureEStepWorker::combine_complete_data() {
+    model_->combine_complete_data(components_, mixing_suf_, loglike_);
+  }
+
 }  // namespace BOOM
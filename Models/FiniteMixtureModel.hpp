@@ -26,6 +26,7 @@
 #include "Models/ParamTypes.hpp"
 #include "Models/Policies/CompositeParamPolicy.hpp"
 #include "Models/Policies/MixtureDataPolicy.hpp"
+#include "Models/PosteriorSamplers/Imputer.hpp"
 
 namespace BOOM {
 
@@ -59,6 +60,55 @@ namespace BOOM {
                             bool update_complete_data_suf);
     double last_loglike() const;
 
+    // Data augmentation can be split across threads.  The caller first
+    //   calls prepare_to_impute_latent_data(), and copies the current
+    //   parameters to each thread's copies of the mixture components with
+    //   copy_parameters_to().  Then each thread calls
+    //   impute_latent_data_range() on its own range of observations, using
+    //   its own copies of the mixture components and mixing distribution.
+    //   Finally the copies are merged into the model, one at a time, with
+    //   combine_complete_data().  impute_latent_data(rng) does the same work
+    //   in a single thread, using the model's own mixture components.
+    //
+    // Each thread evaluates densities with its own copies of the mixture
+    // components, so components are free to cache values (e.g. a Cholesky
+    // factor of a variance matrix) when they are evaluated.
+
+    // Clear the complete data and size the table of class membership
+    // probabilities.
+    void prepare_to_impute_latent_data();
+
+    // Set the parameters of each element of 'components' to those of the
+    // corresponding mixture component.  This function is not thread safe.
+    void copy_parameters_to(
+        const std::vector<Ptr<MixtureComponent>> &components) const;
+
+    // Impute the latent class of observations [begin, end).
+    // Args:
+    //   begin, end:  The range of observations to impute.
+    //   components: Copies of the mixture components, holding the current
+    //     parameters.  They are used to evaluate the densities of the
+    //     observations, and each observation is added to the element of
+    //     'components' for its imputed class.  Densities do not depend on
+    //     the data assigned to a component.
+    //   mixing_distribution:  The imputed classes are added to this model.
+    //   rng:  The random number generator used to make the imputations.
+    //
+    // Returns:
+    //   The contribution of observations [begin, end) to the observed data
+    //   log likelihood.
+    double impute_latent_data_range(
+        int begin, int end,
+        const std::vector<Ptr<MixtureComponent>> &components,
+        MultinomialModel &mixing_distribution, RNG &rng);
+
+    // Add the complete data from a call to impute_latent_data_range() to
+    // the model, and add 'loglike' to last_loglike().  This function is not
+    // thread safe.
+    void combine_complete_data(
+        const std::vector<Ptr<MixtureComponent>> &components,
+        const MultinomialModel &mixing_distribution, double loglike);
+
     double pdf(const Ptr<Data> &dp, bool logscale) const;
     uint number_of_mixture_components() const;
 
@@ -85,6 +135,19 @@ namespace BOOM {
     void set_logpi() const;
     mutable Vector wsp_;
 
+    // Fill the rows of log_density with the log density of observations
+    // [begin, end) under each mixture component.
+    // Args:
+    //   begin, end:  The range of observations to evaluate.
+    //   components:  The mixture components used to evaluate the densities.
+    //   workspace:  Holds the observations in the range.
+    //   log_density: Resized to have end - begin rows and one column per
+    //     mixture component.
+    void fill_log_densities(
+        int begin, int end,
+        const std::vector<Ptr<MixtureComponent>> &components,
+        std::vector<Ptr<Data>> &workspace, Matrix &log_density) const;
+
     // Save the class membership probabilities for user i.
     void update_class_membership_probabilities(int i, const Vector &probs);
 
@@ -122,6 +185,40 @@ namespace BOOM {
     set_observers();
   }
 
+  //======================================================================
+  // Runs part of the E-step for an EmFiniteMixtureModel.  Each worker
+  // accumulates the complete data sufficient statistics for a range of
+  // observations in its own copies of the mixture components.
+  class EmFiniteMixtureModel;
+  class FiniteMixtureEStepWorker : public LatentDataImputerWorker {
+   public:
+    FiniteMixtureEStepWorker(EmFiniteMixtureModel *model, std::mutex &mutex);
+
+    void set_range(int begin, int end) {
+      begin_ = begin;
+      end_ = end;
+    }
+    int number_of_observations_managed() const override {
+      return end_ - begin_;
+    }
+
+    // Copy the model's current parameters to this worker's mixture
+    // components.  Call from the thread that owns the model before the
+    // workers start.
+    void refresh_parameters();
+
+    void impute_latent_data() override;
+    void combine_complete_data() override;
+
+   private:
+    EmFiniteMixtureModel *model_;
+    int begin_;
+    int end_;
+    std::vector<Ptr<EmMixtureComponent>> components_;
+    MultinomialSuf mixing_suf_;
+    double loglike_;
+  };
+
   //======================================================================
   class EmFiniteMixtureModel : public FiniteMixtureModel {
    public:
@@ -156,12 +253,43 @@ namespace BOOM {
     double EStep();
     void MStep(bool posterior_mode);
 
+    // Run the E-step in up to n threads.  If n <= 1 the E-step runs in the
+    // calling thread.
+    void set_number_of_threads(int n);
+
+    // Run the E-step for observations [begin, end), adding the expected
+    // complete data sufficient statistics to 'components' and
+    // 'mixing_suf'.  Returns the contribution of these observations to the
+    // observed data log likelihood.  Concurrent calls on different ranges
+    // are safe provided each caller supplies its own 'components' and
+    // 'mixing_suf'.
+    double EStep(int begin, int end,
+                 const std::vector<Ptr<EmMixtureComponent>> &components,
+                 MultinomialSuf &mixing_suf) const;
+
+    // Add the output of a partial E-step to the model's complete data
+    // sufficient statistics.  Not thread safe.
+    void combine_complete_data(
+        const std::vector<Ptr<EmMixtureComponent>> &components,
+        const MultinomialSuf &mixing_suf, double loglike);
+    using FiniteMixtureModel::combine_complete_data;
+
     Ptr<EmMixtureComponent> em_mixture_component(int s);
     const EmMixtureComponent *em_mixture_component(int s) const;
 
    private:
     std::vector<Ptr<EmMixtureComponent>> em_mixture_components_;
     void populate_em_mixture_components();
+
+    // Divide the observations evenly among the E-step workers.
+    void assign_data_to_workers();
+
+    // Workers for a multi-threaded E-step.  The workers are not copied
+    // when the model is copied.
+    std::mutex estep_mutex_;
+    std::vector<Ptr<FiniteMixtureEStepWorker>> estep_workers_;
+    ParallelLatentDataImputer estep_imputer_;
+    double estep_loglike_;
   };
 
 }  // namespace BOOM
@@ -171,6 +171,30 @@ namespace BOOM {
     return ans;
   }
 
+  void GammaModelBase::fill_logp(const ConstVectorView &x,
+                                 VectorView log_density) const {
+    if (log_density.size() != x.size()) {
+      report_error("x and log_density must be the same size in fill_logp.");
+    }
+    const double a = alpha();
+    const double b = beta();
+    if (a <= 0 || b <= 0) {
+      DoubleModel::fill_logp(x, log_density);
+      return;
+    }
+    const double normalizing_constant = a * log(b) - lgamma(a);
+    for (int i = 0; i < x.size(); ++i) {
+      double y = x[i];
+      if (y > 0 && std::isfinite(y)) {
+        log_density[i] = normalizing_constant + (a - 1) * log(y) - b * y;
+      } else {
+        // Boundary and out of support values are rare enough that dgamma
+        // can handle them.
+        log_density[i] = logp(y);
+      }
+    }
+  }
+
   double GammaModelBase::sim(RNG &rng) const {
     return rgamma_mt(rng, alpha(), beta());
   }
@@ -94,6 +94,8 @@ namespace BOOM {
     int number_of_observations() const override { return dat().size(); }
 
     double Logp(double x, double &g, double &h, uint nd) const override;
+    void fill_logp(const ConstVectorView &x,
+                   VectorView log_density) const override;
     double sim(RNG &rng = GlobalRng::rng) const override;
 
     //  p(1/sigsq) = beta^alpha * (1/sigsq)^(alpha - 1) * exp(-beta/sigsq)
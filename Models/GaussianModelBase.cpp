@@ -171,6 +171,30 @@ namespace BOOM {
     return ans;
   }
 
+  void GaussianModelBase::fill_logp(const ConstVectorView &x,
+                                    VectorView log_density) const {
+    double variance = sigsq();
+    if (variance <= 0) {
+      DoubleModel::fill_logp(x, log_density);
+      return;
+    }
+    if (log_density.size() != x.size()) {
+      report_error("x and log_density must be the same size in fill_logp.");
+    }
+    const double m = mu();
+    const double precision = 1.0 / variance;
+    const double normalizing_constant =
+        -0.5 * (Constants::log_2pi + log(variance));
+    const double *xp = x.data();
+    double *out = log_density.data();
+    const int xstride = x.stride();
+    const int ostride = log_density.stride();
+    for (int i = 0; i < x.size(); ++i) {
+      double z = xp[i * xstride] - m;
+      out[i * ostride] = normalizing_constant - 0.5 * precision * z * z;
+    }
+  }
+
   double GaussianModelBase::Logp(const Vector &x, Vector &g, Matrix &h,
                                  uint nd) const {
     double X = x[0];
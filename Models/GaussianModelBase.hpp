@@ -109,6 +109,8 @@ namespace BOOM {
     double pdf(const Data *dp, bool logscale) const override;
     double Logp(double x, double &g, double &h, uint nd) const override;
     double Logp(const Vector &x, Vector &g, Matrix &h, uint nd) const;
+    void fill_logp(const ConstVectorView &x,
+                   VectorView log_density) const override;
 
     int number_of_observations() const override { return dat().size(); }
 
@@ -56,7 +56,8 @@ namespace BOOM {
         ParamPolicy(rhs),
         DataPolicy(rhs),
         PriorPolicy(rhs),
-        log_alpha_(rhs.log_alpha_) {}
+        log_alpha_(rhs.log_alpha_),
+        columnar_data_(rhs.columnar_data_) {}
 
   BLM *BinomialLogitModel::clone() const {
     return new BinomialLogitModel(*this);
@@ -180,6 +181,33 @@ namespace BOOM {
         }
       }
     }
+
+    if (columnar_data_) {
+      const ColumnarRegressionData &columns(*columnar_data_);
+      Vector full_beta = all_coefficients_included ? beta : inc.expand(beta);
+      columns.for_each_block(-1, [&](int begin, int end) {
+        Vector eta = columns.linear_predictor(full_beta, begin, end);
+        for (int i = begin; i < end; ++i) {
+          double y = columns.y(i);
+          double n = columns.weight(i);
+          double p = logit_inv(eta[i - begin] - log_alpha_);
+          ans += dbinom(y, n, p, true);
+          if (g) {
+            Vector reduced_x;
+            if (!all_coefficients_included) {
+              reduced_x = inc.select(columns.x(i));
+            }
+            ConstVectorView X(all_coefficients_included
+                                  ? columns.x(i)
+                                  : ConstVectorView(reduced_x));
+            g->axpy(X, y - n * p);
+            if (h) {
+              h->add_outer(X, X, -n * p * (1 - p));
+            }
+          }
+        }
+      });
+    }
     return ans;
   }
 
@@ -193,16 +221,32 @@ namespace BOOM {
   SpdMatrix BLM::xtx() const {
     const std::vector<Ptr<BinomialRegressionData> > &d(dat());
     uint n = d.size();
-    uint p = d[0]->xdim();
+    uint p = xdim();
     SpdMatrix ans(p);
     for (uint i = 0; i < n; ++i) {
       double n = d[i]->n();
       ans.add_outer(d[i]->x(), n, false);
     }
+    if (columnar_data_) {
+      for (int i = 0; i < columnar_data_->sample_size(); ++i) {
+        ans.add_outer(columnar_data_->x(i), columnar_data_->weight(i), false);
+      }
+    }
     ans.reflect();
     return ans;
   }
 
+  void BLM::set_columnar_data(const Ptr<ColumnarRegressionData> &data) {
+    if (data && data->xdim() != xdim()) {
+      report_error("Columnar data has the wrong number of predictors.");
+    }
+    if (data && !data->has_weights()) {
+      report_error("Columnar binomial data must store the number of trials "
+                   "as weights.");
+    }
+    columnar_data_ = data;
+  }
+
   void BLM::set_nonevent_sampling_prob(double alpha) {
     if (alpha <= 0 || alpha > 1) {
       ostringstream err;
@@ -21,6 +21,7 @@
 #include "uint.hpp"
 #include "Models/EmMixtureComponent.hpp"
 #include "Models/Glm/BinomialRegressionData.hpp"
+#include "Models/Glm/ColumnarRegressionData.hpp"
 #include "Models/Glm/Glm.hpp"
 #include "Models/Policies/IID_DataPolicy.hpp"
 #include "Models/Policies/ParamPolicy_1.hpp"
@@ -66,7 +67,23 @@ namespace BOOM {
     virtual double logp(double y, double n, const Vector &x,
                         bool logscale) const;
     virtual double logp_1(bool y, const Vector &x, bool logscale) const;
-    int number_of_observations() const override { return dat().size(); }
+    int number_of_observations() const override {
+      return dat().size() +
+             (columnar_data_ ? columnar_data_->sample_size() : 0);
+    }
+
+    // Columnar data is an opt-in alternative to storing each observation as
+    // a separate BinomialRegressionData object, intended for large data
+    // sets.  The y() column holds the number of successes, and the weights
+    // hold the number of trials.  The columnar data is shared (not copied)
+    // when the model is copied.  It contributes to the likelihood, but it is
+    // not visible through dat().  Passing a null pointer removes any
+    // existing columnar data.
+    void set_columnar_data(const Ptr<ColumnarRegressionData> &data);
+    const Ptr<ColumnarRegressionData> &columnar_data() const {
+      return columnar_data_;
+    }
+    bool has_columnar_data() const { return !!columnar_data_; }
 
     // In the following, beta refers to the set of nonzero "included"
     // coefficients.
@@ -85,6 +102,7 @@ namespace BOOM {
 
    private:
     double log_alpha_;  // see comments in logistic_regression_model
+    Ptr<ColumnarRegressionData> columnar_data_;
   };
 
 }  // namespace BOOM
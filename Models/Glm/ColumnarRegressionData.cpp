@@ -0,0 +1,118 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include "Models/Glm/ColumnarRegressionData.hpp"
+#include "Models/Glm/BinomialRegressionData.hpp"
+#include "cpputil/report_error.hpp"
+
+namespace BOOM {
+
+  typedef ColumnarRegressionData CRD;
+
+  CRD::ColumnarRegressionData(const Matrix &X, const Vector &y,
+                              const Vector &weights)
+      : X_(X), y_(y), weights_(weights) {
+    check_sizes();
+  }
+
+  CRD::ColumnarRegressionData(const std::vector<Ptr<RegressionData>> &data) {
+    if (data.empty()) return;
+    int n = data.size();
+    int p = data[0]->xdim();
+    X_.resize(n, p);
+    y_.resize(n);
+    for (int i = 0; i < n; ++i) {
+      if (data[i]->xdim() != p) {
+        report_error("All data points must have the same dimension.");
+      }
+      X_.set_row(i, data[i]->x());
+      y_[i] = data[i]->y();
+    }
+  }
+
+  CRD::ColumnarRegressionData(
+      const std::vector<Ptr<BinomialRegressionData>> &data) {
+    if (data.empty()) return;
+    int n = data.size();
+    int p = data[0]->xdim();
+    X_.resize(n, p);
+    y_.resize(n);
+    weights_.resize(n);
+    for (int i = 0; i < n; ++i) {
+      if (data[i]->xdim() != p) {
+        report_error("All data points must have the same dimension.");
+      }
+      X_.set_row(i, data[i]->x());
+      y_[i] = data[i]->y();
+      weights_[i] = data[i]->n();
+    }
+  }
+
+  void CRD::check_sizes() const {
+    if (X_.nrow() != y_.size()) {
+      report_error("The number of rows in X must match the length of y.");
+    }
+    if (!weights_.empty() && weights_.size() != y_.size()) {
+      report_error("The vector of weights must either be empty or match "
+                   "the length of y.");
+    }
+  }
+
+  ConstSubMatrix CRD::X_block(int begin, int end) const {
+    return ConstSubMatrix(X_, begin, end - 1, 0, X_.ncol() - 1);
+  }
+
+  ConstVectorView CRD::y_block(int begin, int end) const {
+    return ConstVectorView(y_, begin, end - begin);
+  }
+
+  ConstVectorView CRD::weight_block(int begin, int end) const {
+    if (weights_.empty()) {
+      return ConstVectorView(weights_);
+    }
+    return ConstVectorView(weights_, begin, end - begin);
+  }
+
+  Vector CRD::linear_predictor(const Vector &beta, int begin,
+                               int end) const {
+    if (beta.size() != xdim()) {
+      report_error("Coefficient vector has the wrong dimension in "
+                   "ColumnarRegressionData::linear_predictor.");
+    }
+    // Accumulate one column at a time, which streams through contiguous
+    // memory in the column major design matrix.
+    Vector ans(end - begin, 0.0);
+    for (int j = 0; j < xdim(); ++j) {
+      if (beta[j] != 0.0) {
+        ans.axpy(ConstVectorView(X_.col(j), begin, end - begin), beta[j]);
+      }
+    }
+    return ans;
+  }
+
+  int CRD::default_block_size() const {
+    // Aim for roughly 256KB of predictors per block.
+    int p = std::max<int>(1, xdim());
+    return std::max<int>(64, (1 << 15) / p);
+  }
+
+  Ptr<RegressionData> CRD::materialize(int i) const {
+    return new RegressionData(y_[i], Vector(x(i)));
+  }
+
+}  // namespace BOOM
@@ -0,0 +1,160 @@
+#ifndef BOOM_GLM_COLUMNAR_REGRESSION_DATA_HPP_
+#define BOOM_GLM_COLUMNAR_REGRESSION_DATA_HPP_
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <algorithm>
+#include <vector>
+#include "LinAlg/Matrix.hpp"
+#include "LinAlg/SubMatrix.hpp"
+#include "LinAlg/Vector.hpp"
+#include "LinAlg/VectorView.hpp"
+#include "Models/Glm/Glm.hpp"
+#include "cpputil/Ptr.hpp"
+#include "cpputil/RefCounted.hpp"
+
+namespace BOOM {
+
+  class BinomialRegressionData;
+
+  // A regression data set stored as one contiguous design matrix X, a
+  // response vector y, and an optional vector of per-observation weights.
+  // This is an alternative to storing each observation as its own
+  // Ptr<RegressionData>, which costs a heap allocation (several, in fact)
+  // and a pointer dereference per observation.  Large data sets should
+  // prefer this representation, and algorithms that need to visit every
+  // observation should process it in blocks of rows.
+  //
+  // The design matrix is stored in the usual BOOM (column major) order, so
+  // that a block of consecutive rows is a ConstSubMatrix suitable for
+  // matrix-matrix operations.  Individual rows are available as strided
+  // ConstVectorView's for code that works one observation at a time.
+  //
+  // The meaning of the weights depends on the model consuming the data.
+  // Weighted regression models treat them as observation weights.  Binomial
+  // models treat them as the number of trials.  If no weights are supplied
+  // every observation has weight 1.
+  class ColumnarRegressionData : private RefCounted {
+   public:
+    // A lightweight view of a single observation.  Views are only valid as
+    // long as the ColumnarRegressionData that produced them.
+    class Row {
+     public:
+      Row(const ColumnarRegressionData *data, int index)
+          : data_(data), index_(index) {}
+      double y() const { return data_->y(index_); }
+      ConstVectorView x() const { return data_->x(index_); }
+      double weight() const { return data_->weight(index_); }
+      int index() const { return index_; }
+
+     private:
+      const ColumnarRegressionData *data_;
+      int index_;
+    };
+
+    // Args:
+    //   X: The design matrix.  Each row is an observation.  If an intercept
+    //     term is desired it must be included explicitly.
+    //   y:  The vector of responses.  y.size() must match X.nrow().
+    //   weights: Per-observation weights.  Either empty (in which case all
+    //     weights are 1) or of size X.nrow().
+    ColumnarRegressionData(const Matrix &X, const Vector &y,
+                           const Vector &weights = Vector());
+
+    // Copy the contents of a legacy data set.  All data points must have the
+    // same dimension.
+    explicit ColumnarRegressionData(
+        const std::vector<Ptr<RegressionData>> &data);
+
+    // Copy the contents of a binomial data set.  The number of trials for
+    // each observation is stored as its weight.
+    explicit ColumnarRegressionData(
+        const std::vector<Ptr<BinomialRegressionData>> &data);
+
+    // The number of observations.
+    int sample_size() const { return y_.size(); }
+
+    // The number of predictor variables.
+    int xdim() const { return X_.ncol(); }
+
+    const Matrix &X() const { return X_; }
+    const Vector &y() const { return y_; }
+
+    bool has_weights() const { return !weights_.empty(); }
+    // The vector of weights.  Empty if has_weights() is false.
+    const Vector &weights() const { return weights_; }
+
+    double y(int i) const { return y_[i]; }
+    ConstVectorView x(int i) const { return X_.row(i); }
+    double weight(int i) const {
+      return weights_.empty() ? 1.0 : weights_[i];
+    }
+    Row row(int i) const { return Row(this, i); }
+
+    // Replace the response for observation i.  This is intended for data
+    // augmentation algorithms that impute a latent response.
+    void set_y(int i, double y) { y_[i] = y; }
+
+    // Views of the observations in the half open range [begin, end).
+    ConstSubMatrix X_block(int begin, int end) const;
+    ConstVectorView y_block(int begin, int end) const;
+    // If has_weights() is false the weight block is empty.
+    ConstVectorView weight_block(int begin, int end) const;
+
+    // The linear predictor X * beta for the rows in [begin, end).  The
+    // dimension of beta must match xdim().
+    Vector linear_predictor(const Vector &beta, int begin, int end) const;
+
+    // Visit the data in blocks of consecutive rows.
+    // Args:
+    //   block_size: The maximum number of rows in each block.
+    //   f:  A functor with signature void(int begin, int end).
+    template <class F>
+    void for_each_block(int block_size, F f) const {
+      if (block_size <= 0) block_size = default_block_size();
+      for (int begin = 0; begin < sample_size(); begin += block_size) {
+        f(begin, std::min<int>(begin + block_size, sample_size()));
+      }
+    }
+
+    // A block size that keeps a block of X comfortably inside the cache.
+    int default_block_size() const;
+
+    // Create a stand-alone RegressionData object containing a copy of
+    // observation i, for legacy code that needs one.
+    Ptr<RegressionData> materialize(int i) const;
+
+   private:
+    Matrix X_;
+    Vector y_;
+    Vector weights_;
+
+    void check_sizes() const;
+
+    friend void intrusive_ptr_add_ref(ColumnarRegressionData *d) {
+      d->up_count();
+    }
+    friend void intrusive_ptr_release(ColumnarRegressionData *d) {
+      d->down_count();
+      if (d->ref_count() == 0) delete d;
+    }
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_GLM_COLUMNAR_REGRESSION_DATA_HPP_
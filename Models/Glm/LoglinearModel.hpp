@@ -342,7 +342,7 @@ namespace BOOM {
 
     void add_interaction(const std::vector<int> &variable_postiions);
 
-    void refresh_suf();
+    void refresh_suf() override;
 
     const GlmCoefs &coef() const {return prm_ref();}
 
@@ -18,6 +18,7 @@
 */
 
 #include "Models/Glm/PosteriorSamplers/BinomialLogitAuxmixSampler.hpp"
+#include "LinAlg/EigenMap.hpp"
 #include "cpputil/report_error.hpp"
 #include "distributions.hpp"
 
@@ -66,13 +67,34 @@ namespace BOOM {
       ++sample_size_;
     }
 
+    void SufficientStatistics::update(const ConstVectorView &x,
+                                      double weighted_value, double weight) {
+      sym_ = false;
+      xtx_.add_outer(x, weight, false);
+      xty_.axpy(x, weighted_value);
+      ++sample_size_;
+    }
+
+    void SufficientStatistics::update(const ConstSubMatrix &X,
+                                      const Vector &weighted_values,
+                                      const Vector &weights) {
+      if (X.nrow() == 0) return;
+      sym_ = false;
+      xtx_.add_inner(X, weights, false);
+      EigenMap(xty_) += EigenMap(X).transpose() * EigenMap(weighted_values);
+      sample_size_ += X.nrow();
+    }
+
     ImputeWorker::ImputeWorker(SufficientStatistics &global_suf,
                                std::mutex &global_suf_mutex, int clt_threshold,
                                const GlmCoefs *coef, RNG *rng, RNG &seeding_rng)
         : SufstatImputeWorker<BinomialRegressionData, SufficientStatistics>(
               global_suf, global_suf_mutex, rng, seeding_rng),
           binomial_data_imputer_(clt_threshold),
-          coefficients_(coef) {}
+          coefficients_(coef),
+          columnar_data_(nullptr),
+          columnar_begin_(0),
+          columnar_end_(0) {}
 
     void ImputeWorker::impute_latent_data_point(
         const BinomialRegressionData &observation, SufficientStatistics *suf,
@@ -95,6 +117,61 @@ namespace BOOM {
         report_error(err.str());
       }
     }
+
+    void ImputeWorker::set_columnar_data(const ColumnarRegressionData *data,
+                                         int begin, int end) {
+      columnar_data_ = data;
+      columnar_begin_ = data ? begin : 0;
+      columnar_end_ = data ? end : 0;
+    }
+
+    int ImputeWorker::number_of_observations_managed() const {
+      return SufstatImputeWorker<BinomialRegressionData, SufficientStatistics>::
+                 number_of_observations_managed() +
+             columnar_end_ - columnar_begin_;
+    }
+
+    void ImputeWorker::impute_latent_data() {
+      SufstatImputeWorker<BinomialRegressionData,
+                          SufficientStatistics>::impute_latent_data();
+      if (!columnar_data_ || columnar_end_ <= columnar_begin_) return;
+      const Vector &beta(coefficients_->Beta());
+      int block_size = columnar_data_->default_block_size();
+      for (int begin = columnar_begin_; begin < columnar_end_;
+           begin += block_size) {
+        int end = std::min<int>(begin + block_size, columnar_end_);
+        Vector eta = columnar_data_->linear_predictor(beta, begin, end);
+        Vector weighted_sums(end - begin);
+        Vector weights(end - begin);
+        for (int i = begin; i < end; ++i) {
+          std::pair<double, double> imputed =
+              impute_columnar_row(i, eta[i - begin], local_rng());
+          weighted_sums[i - begin] = imputed.first;
+          weights[i - begin] = imputed.second;
+        }
+        local_suf()->update(columnar_data_->X_block(begin, end),
+                            weighted_sums, weights);
+      }
+    }
+
+    std::pair<double, double> ImputeWorker::impute_columnar_row(
+        int row, double eta, RNG &rng) {
+      double n = columnar_data_->weight(row);
+      double y = columnar_data_->y(row);
+      try {
+        return binomial_data_imputer_.impute(rng, n, y, eta);
+      } catch (std::exception &e) {
+        ostringstream err;
+        err << "caught an exception "
+            << "with the following message:" << e.what() << endl
+            << "row = " << row << endl
+            << "n   = " << n << endl
+            << "y   = " << y << endl
+            << "eta = " << eta << endl;
+        report_error(err.str());
+      }
+      return std::make_pair(0.0, 0.0);
+    }
   }  // namespace BinomialLogit
 
   using namespace BinomialLogit;
@@ -139,6 +216,15 @@ namespace BOOM {
 
   void BLAMS::assign_data_to_workers() {
     BOOM::assign_data_to_workers(model_->dat(), workers());
+    const ColumnarRegressionData *columns = model_->columnar_data().get();
+    int number_of_workers = workers().size();
+    int nobs = columns ? columns->sample_size() : 0;
+    for (int i = 0; i < number_of_workers; ++i) {
+      // Worker i gets rows [i * nobs / W, (i + 1) * nobs / W).
+      int begin = (static_cast<long>(i) * nobs) / number_of_workers;
+      int end = (static_cast<long>(i + 1) * nobs) / number_of_workers;
+      workers()[i]->set_columnar_data(columns, begin, end);
+    }
   }
 
 }  // namespace BOOM
@@ -48,6 +48,13 @@ namespace BOOM {
       void combine(const SufficientStatistics &rhs);
 
       void update(const Vector &x, double weighted_value, double weight);
+      void update(const ConstVectorView &x, double weighted_value,
+                  double weight);
+      // Add a block of observations in one rank-k update.  Row i of X is
+      // the predictor for an observation with the given weighted_value[i]
+      // and weight[i].
+      void update(const ConstSubMatrix &X, const Vector &weighted_values,
+                  const Vector &weights);
       const SpdMatrix &xtx() const;
       const Vector &xty() const;
       int sample_size() const { return sample_size_; }
@@ -99,9 +106,30 @@ namespace BOOM {
                                     SufficientStatistics *suf,
                                     RNG &rng) override;
 
+      // Assign the rows [begin, end) of a columnar data set to this worker,
+      // in addition to any data assigned through set_data().  The columnar
+      // data must outlive the assignment.
+      void set_columnar_data(const ColumnarRegressionData *data, int begin,
+                             int end);
+
+      // Imputes latent data for the observations assigned by set_data(),
+      // then for the assigned columnar rows, which are processed in blocks.
+      void impute_latent_data() override;
+
+      int number_of_observations_managed() const override;
+
      private:
       BinomialLogitCltDataImputer binomial_data_imputer_;
       const GlmCoefs *coefficients_;
+      const ColumnarRegressionData *columnar_data_;
+      int columnar_begin_;
+      int columnar_end_;
+
+      // Impute the latent data for a single columnar observation with linear
+      // predictor eta.  Returns the (information weighted sum, information)
+      // pair produced by the data imputer.
+      std::pair<double, double> impute_columnar_row(int row, double eta,
+                                                    RNG &rng);
     };
   }  // namespace BinomialLogit
 
@@ -18,6 +18,7 @@
 */
 
 #include "Models/Glm/PosteriorSamplers/BinomialLogitSamplerRwm.hpp"
+#include "cpputil/Checkpoint.hpp"
 #include "distributions.hpp"
 
 namespace BOOM {
@@ -66,5 +67,16 @@ namespace BOOM {
   double BinomialLogitSamplerRwm::logpri() const {
     return pri_->logp(m_->Beta());
   }
+
+  void BinomialLogitSamplerRwm::save_state(
+      CheckpointWriter &checkpoint) const {
+    PosteriorSampler::save_state(checkpoint);
+    sam_.save_state(checkpoint);
+  }
+
+  void BinomialLogitSamplerRwm::restore_state(CheckpointReader &checkpoint) {
+    PosteriorSampler::restore_state(checkpoint);
+    sam_.restore_state(checkpoint);
+  }
   //======================================================================
 }  // namespace BOOM
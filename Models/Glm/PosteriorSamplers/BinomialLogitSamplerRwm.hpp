@@ -42,6 +42,10 @@ namespace BOOM {
 
     void draw() override;
     double logpri() const override;
+
+    // The checkpoint includes the scale of the random walk proposal.
+    void save_state(CheckpointWriter &checkpoint) const override;
+    void restore_state(CheckpointReader &checkpoint) override;
     MvtRwmProposal *proposal() { return proposal_.get(); }
     const MvtRwmProposal *proposal() const { return proposal_.get(); }
 
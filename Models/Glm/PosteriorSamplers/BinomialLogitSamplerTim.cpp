@@ -18,6 +18,7 @@
 */
 #include "Models/Glm/PosteriorSamplers/BinomialLogitSamplerTim.hpp"
 #include <functional>
+#include "cpputil/Checkpoint.hpp"
 
 namespace BOOM {
 
@@ -54,6 +55,16 @@ namespace BOOM {
     return pri_->logp(m_->included_coefficients());
   }
 
+  void BLST::save_state(CheckpointWriter &checkpoint) const {
+    PosteriorSampler::save_state(checkpoint);
+    sam_.save_state(checkpoint);
+  }
+
+  void BLST::restore_state(CheckpointReader &checkpoint) {
+    PosteriorSampler::restore_state(checkpoint);
+    sam_.restore_state(checkpoint);
+  }
+
   double BLST::Logp(const Vector &beta, Vector &g, Matrix &h, int nd) const {
     double ans = pri_->Logp(beta, g, h, nd);
     Vector *gp = nd > 0 ? &g : 0;
@@ -64,6 +64,11 @@ namespace BOOM {
     void draw() override;
     double logpri() const override;
 
+    // The checkpoint includes the TIM proposal, so a sampler with a stable
+    // mode resumes without locating the mode again.
+    void save_state(CheckpointWriter &checkpoint) const override;
+    void restore_state(CheckpointReader &checkpoint) override;
+
     double logp(const Vector &beta) const;
     double dlogp(const Vector &beta, Vector &g) const;
     double d2logp(const Vector &beta, Vector &g, Matrix &H) const;
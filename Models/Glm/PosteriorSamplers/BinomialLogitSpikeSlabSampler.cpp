@@ -18,6 +18,7 @@
 */
 #include "Models/Glm/PosteriorSamplers/BinomialLogitSpikeSlabSampler.hpp"
 #include "LinAlg/Cholesky.hpp"
+#include "Models/Glm/PosteriorSamplers/SpikeSlabCholeskyCache.hpp"
 #include "cpputil/math_utils.hpp"
 #include "cpputil/seq.hpp"
 #include "distributions.hpp"
@@ -193,22 +194,31 @@ namespace BOOM {
       report_error(err.str());
     }
 
+    SpikeSlabCholeskyCache cache(slab_->siginv(), slab_->mu(), suf().xtx(),
+                                 suf().xty());
+    cache.set_model(g);
     uint n = g.nvars_possible();
     if (max_flips_ > 0) n = std::min<int>(n, max_flips_);
     for (uint i = 0; i < n; ++i) {
-      logp = mcmc_one_flip(g, indx[i], logp);
+      logp = mcmc_one_flip(g, indx[i], logp, cache);
     }
     model_->coef().set_inc(g);
   }
 
-  double BLSSS::mcmc_one_flip(Selector &mod, uint which_var, double logp_old) {
+  double BLSSS::mcmc_one_flip(Selector &mod, uint which_var, double logp_old,
+                              SpikeSlabCholeskyCache &cache) {
     mod.flip(which_var);
-    double logp_new = log_model_prob(mod);
+    double logp_new = spike_->logp(mod);
+    if (logp_new > BOOM::negative_infinity()) {
+      logp_new += cache.evaluate_flip(which_var).log_integrated_likelihood();
+    }
     double u = runif_mt(rng(), 0, 1);
-    if (log(u) > logp_new - logp_old) {
+    if (logp_new == BOOM::negative_infinity() ||
+        log(u) > logp_new - logp_old) {
       mod.flip(which_var);  // reject draw
       return logp_old;
     }
+    cache.accept_flip();
     return logp_new;
   }
 
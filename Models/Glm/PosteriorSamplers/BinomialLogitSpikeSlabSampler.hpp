@@ -24,6 +24,8 @@
 #include "Models/Glm/VariableSelectionPrior.hpp"
 
 namespace BOOM {
+  class SpikeSlabCholeskyCache;
+
   class BinomialLogitSpikeSlabSampler : public BinomialLogitAuxmixSampler {
    public:
     BinomialLogitSpikeSlabSampler(BinomialLogitModel *model,
@@ -72,7 +74,11 @@ namespace BOOM {
     }
 
    private:
-    double mcmc_one_flip(Selector &mod, uint which_var, double logp_old);
+    // Propose flipping inclusion indicator 'which_var' in 'mod', evaluating
+    // the proposal by updating the Cholesky factors in 'cache'.  Returns the
+    // log model probability of 'mod' after the accept/reject decision.
+    double mcmc_one_flip(Selector &mod, uint which_var, double logp_old,
+                         SpikeSlabCholeskyCache &cache);
     BinomialLogitModel *model_;
     Ptr<MvnBase> slab_;
     Ptr<VariableSelectionPrior> spike_;
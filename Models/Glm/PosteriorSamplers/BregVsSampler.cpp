@@ -19,6 +19,7 @@
 
 #include "Models/ChisqModel.hpp"
 #include "Models/Glm/PosteriorSamplers/BregVsSampler.hpp"
+#include "Models/Glm/PosteriorSamplers/SpikeSlabCholeskyCache.hpp"
 #include "Models/MvnGivenScalarSigma.hpp"
 #include "cpputil/math_utils.hpp"
 #include "cpputil/report_error.hpp"
@@ -247,6 +248,37 @@ namespace BOOM {
     return logp_new;
   }
   //----------------------------------------------------------------------
+  double BVS::mcmc_one_flip(Selector &model, uint which_var, double logp_old,
+                            SpikeSlabCholeskyCache &cache) {
+    model.flip(which_var);
+    double logp_new = spike_->logp(model);
+    if (logp_new > negative_infinity()) {
+      // The same calculation as log_model_prob(), with sigma integrated out.
+      // The residual sum of squares is yty + mu' Ominv mu - r' V r, where r
+      // and V are the posterior moments defined in SpikeSlabCholeskyCache.
+      const SpikeSlabCholeskyCache::Moments &moments(
+          cache.evaluate_flip(which_var));
+      double ss = prior_ss() + model_->suf()->yty() +
+          moments.prior_mahalanobis_distance -
+          moments.posterior_mahalanobis_distance;
+      double df = model_->suf()->n() + prior_df();
+      if (!moments.positive_definite || !(ss > 0)) {
+        logp_new = negative_infinity();
+      } else {
+        logp_new += .5 * (moments.prior_precision_logdet -
+                          moments.posterior_precision_logdet) -
+            (.5 * df - 1) * log(ss);
+      }
+    }
+    double u = runif_mt(rng(), 0, 1);
+    if (logp_new == negative_infinity() || log(u) > logp_new - logp_old) {
+      model.flip(which_var);  // reject draw
+      return logp_old;
+    }
+    cache.accept_flip();
+    return logp_new;
+  }
+  //----------------------------------------------------------------------
   void BVS::draw() {
     if (max_nflips_ > 0) {
       draw_model_indicators();
@@ -365,9 +397,14 @@ namespace BOOM {
       report_error(err.str());
     }
 
+    const SpdMatrix xtx = model_->suf()->xtx();
+    const Vector xty = model_->suf()->xty();
+    SpikeSlabCholeskyCache cache(slab_->unscaled_precision(), slab_->mu(),
+                                 xtx, xty);
+    cache.set_model(g);
     uint n = std::min<uint>(max_nflips_, g.nvars_possible());
     for (uint i = 0; i < n; ++i) {
-      logp = mcmc_one_flip(g, indx[i], logp);
+      logp = mcmc_one_flip(g, indx[i], logp, cache);
     }
     model_->coef().set_inc(g);
     attempt_swap();
@@ -30,6 +30,7 @@
 #include "Models/PosteriorSamplers/PosteriorSampler.hpp"
 
 namespace BOOM {
+  class SpikeSlabCholeskyCache;
   struct ZellnerPriorParameters {
     Vector prior_inclusion_probabilities;
     Vector prior_beta_guess;
@@ -199,6 +200,12 @@ namespace BOOM {
                          double current_logp);
 
    private:
+    // Same as the public version, but the proposal is evaluated by updating
+    // the Cholesky factors in 'cache', which must describe
+    // inclusion_indicators.  The cache is updated if the flip is accepted.
+    double mcmc_one_flip(Selector &inclusion_indicators, uint which_var,
+                         double current_logp, SpikeSlabCholeskyCache &cache);
+
     // The model whose paramaters are to be drawn.
     RegressionModel *model_;
 
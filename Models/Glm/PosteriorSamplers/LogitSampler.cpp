@@ -18,14 +18,23 @@
 */
 
 #include "Models/Glm/PosteriorSamplers/LogitSampler.hpp"
+#include <cmath>
 #include "Models/Glm/PosteriorSamplers/draw_logit_lambda.hpp"
 #include "Models/Glm/WeightedRegressionModel.hpp"
 #include "TargetFun/LogPost.hpp"
 #include "TargetFun/Loglike.hpp"
+#include "cpputil/report_error.hpp"
 #include "distributions.hpp"
+#include "numopt.hpp"
 
 namespace BOOM {
 
+  namespace {
+    // Newton's method needs a dense Hessian, which costs O(dim^2) memory and
+    // O(dim^3) time per iteration.  Larger problems find the mode with LBFGS.
+    const uint kMaxNewtonDimension = 1000;
+  }  // namespace
+
   typedef LogitSampler LS;
   LS::LogitSampler(LogisticRegressionModel *mod, const Ptr<MvnBase> &pri,
                    RNG &seeding_rng)
@@ -81,10 +90,23 @@ namespace BOOM {
     d2LogPostTF logpost(log_likelihood, pri_);
     Vector b = mod_->Beta();
     uint dim = b.size();
-    Vector g(dim);
-    Matrix h(dim, dim);
-    logpost_at_mode_ = max_nd2(b, g, h, Target(logpost), dTarget(logpost),
-                               d2Target(logpost), epsilon);
+    if (dim > kMaxNewtonDimension) {
+      std::string error_message;
+      bool ok = max_nd1_careful(b, logpost_at_mode_, Target(logpost),
+                                dTarget(logpost), error_message, epsilon, 500,
+                                LBFGS);
+      // LBFGS only accepts steps that improve the target, so if it stops
+      // early (e.g. at the iteration limit) b is the best point it found.
+      // That is no worse than max_nd2, which does not check convergence.
+      if (!ok && (!std::isfinite(logpost_at_mode_) || !b.all_finite())) {
+        report_error(error_message);
+      }
+    } else {
+      Vector g(dim);
+      Matrix h(dim, dim);
+      logpost_at_mode_ = max_nd2(b, g, h, Target(logpost), dTarget(logpost),
+                                 d2Target(logpost), epsilon);
+    }
     mod_->set_Beta(b);
   }
 }  // namespace BOOM
@@ -28,6 +28,7 @@
 #include "Models/Glm/ChoiceData.hpp"
 #include "Models/Glm/MultinomialLogitModel.hpp"
 #include "Models/Glm/PosteriorSamplers/MLVS_data_imputer.hpp"
+#include "Models/Glm/PosteriorSamplers/SpikeSlabCholeskyCache.hpp"
 #include "Models/MvnBase.hpp"
 #include "cpputil/math_utils.hpp"
 #include "cpputil/seq.hpp"
@@ -140,14 +141,26 @@ namespace BOOM {
     std::vector<uint> flips = seq<uint>(0, nv - 1);
     std::shuffle(flips.begin(), flips.end(), std::default_random_engine());
     uint hi = std::min<uint>(nv, max_nflips());
+    // Proposals are evaluated by updating the Cholesky factors of the
+    // current model, rather than calling log_model_prob().
+    SpikeSlabCholeskyCache cache(pri->siginv(), pri->mu(), suf_.xtwx(),
+                                 suf_.xtwu());
+    cache.set_model(inc);
     for (uint i = 0; i < hi; ++i) {
       uint I = flips[i];
       inc.flip(I);
-      double logp_new = log_model_prob(inc);
-      if (keep_flip(rng(), logp, logp_new))
+      double logp_new = vpri->logp(inc);
+      if (logp_new > BOOM::negative_infinity()) {
+        logp_new += cache.evaluate_flip(I).log_integrated_likelihood();
+        // Matches the treatment of the empty model in log_model_prob().
+        if (inc.nvars() == 0) logp_new += .5 * suf_.weighted_sum_of_squares();
+      }
+      if (keep_flip(rng(), logp, logp_new)) {
         logp = logp_new;
-      else
+        cache.accept_flip();
+      } else {
         inc.flip(I);  // reject the flip, so flip back
+      }
     }
     mod_->coef().set_inc(inc);
   }
@@ -29,6 +29,17 @@
 
 namespace BOOM {
 
+  namespace {
+    // If E is a standard exponential draw then log(E) - loglam has the
+    // distribution of rlexp_mt(rng, loglam).  E is zero with probability
+    // 2^-53, in which case take a fresh draw.
+    inline double log_exponential(RNG &rng, double exponential_draw,
+                                  double loglam) {
+      return exponential_draw > 0 ? log(exponential_draw) - loglam
+                                  : rlexp_mt(rng, loglam);
+    }
+  }  // namespace
+
   MlvsDataImputer::MlvsDataImputer(SufficientStatistics &global_suf,
                                    std::mutex &global_suf_mutex,
                                    MultinomialLogitModel *model, RNG *rng,
@@ -46,7 +57,8 @@ namespace BOOM {
         post_prob_(log_mixing_weights_),
         u(model_->Nchoices()),
         eta(u),
-        wgts(u) {}
+        wgts(u),
+        exponential_draws_(u) {}
 
   void MlvsDataImputer::impute_latent_data_point(const ChoiceData &dp,
                                                  SufficientStatistics *suf,
@@ -57,11 +69,14 @@ namespace BOOM {
     uint y = dp.value();
     assert(y < M);
     double loglam = lse(eta);
-    double logzmin = rlexp_mt(rng, loglam);
+    // Each observation needs one exponential draw per choice, so draw them
+    // as a block.
+    fill_exponential(rng, exponential_draws_);
+    double logzmin = log_exponential(rng, exponential_draws_[y], loglam);
     u[y] = -logzmin;
     for (uint m = 0; m < M; ++m) {
       if (m != y) {
-        double tmp = rlexp_mt(rng, eta[m]);
+        double tmp = log_exponential(rng, exponential_draws_[m], eta[m]);
         double logz = lse2(logzmin, tmp);
         u[m] = -logz;
       }
@@ -0,0 +1,58 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include "Models/Glm/PosteriorSamplers/PoissonRegressionHmcSampler.hpp"
+#include "cpputil/report_error.hpp"
+
+namespace BOOM {
+
+  PoissonRegressionHmcSampler::PoissonRegressionHmcSampler(
+      PoissonRegressionModel *model, const Ptr<MvnBase> &prior,
+      int number_of_warmup_iterations, RNG &seeding_rng)
+      : PosteriorSampler(seeding_rng),
+        model_(model),
+        prior_(prior),
+        sampler_(
+            [this](const Vector &beta, Vector &gradient) {
+              return this->log_posterior(beta, gradient);
+            },
+            number_of_warmup_iterations, &rng()) {
+    if (model_->xdim() != prior_->dim()) {
+      report_error(
+          "Prior and model are incompatible in "
+          "PoissonRegressionHmcSampler constructor.");
+    }
+  }
+
+  void PoissonRegressionHmcSampler::draw() {
+    model_->set_Beta(sampler_.draw(model_->Beta()));
+  }
+
+  double PoissonRegressionHmcSampler::logpri() const {
+    return prior_->logp(model_->Beta());
+  }
+
+  double PoissonRegressionHmcSampler::log_posterior(const Vector &beta,
+                                                    Vector &gradient) const {
+    Matrix unused;
+    double ans = prior_->Logp(beta, gradient, unused, 1);
+    ans += model_->log_likelihood(beta, &gradient, nullptr, false);
+    return ans;
+  }
+
+}  // namespace BOOM
@@ -0,0 +1,55 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_POISSON_REGRESSION_HMC_SAMPLER_HPP_
+#define BOOM_POISSON_REGRESSION_HMC_SAMPLER_HPP_
+
+#include "Models/Glm/PoissonRegressionModel.hpp"
+#include "Models/MvnBase.hpp"
+#include "Models/PosteriorSamplers/PosteriorSampler.hpp"
+#include "Samplers/HamiltonianMonteCarlo.hpp"
+
+namespace BOOM {
+
+  // Draws the coefficients of a Poisson regression model using the No-U-Turn
+  // sampler.  The step size and metric are adapted during the first
+  // 'number_of_warmup_iterations' draws, which should be discarded as
+  // burn-in.
+  class PoissonRegressionHmcSampler : public PosteriorSampler {
+   public:
+    PoissonRegressionHmcSampler(PoissonRegressionModel *model,
+                                const Ptr<MvnBase> &prior,
+                                int number_of_warmup_iterations = 200,
+                                RNG &seeding_rng = GlobalRng::rng);
+    void draw() override;
+    double logpri() const override;
+
+    // The log posterior density (up to a constant) and its gradient.
+    double log_posterior(const Vector &beta, Vector &gradient) const;
+
+    HamiltonianMonteCarloSampler &sampler() { return sampler_; }
+
+   private:
+    PoissonRegressionModel *model_;
+    Ptr<MvnBase> prior_;
+    HamiltonianMonteCarloSampler sampler_;
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_POISSON_REGRESSION_HMC_SAMPLER_HPP_
@@ -0,0 +1,207 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include "Models/Glm/PosteriorSamplers/SpikeSlabCholeskyCache.hpp"
+#include <algorithm>
+#include "cpputil/math_utils.hpp"
+#include "cpputil/report_error.hpp"
+
+namespace BOOM {
+
+  namespace {
+    typedef SpikeSlabCholeskyCache SSCC;
+  }  // namespace
+
+  SSCC::Moments::Moments()
+      : positive_definite(true),
+        prior_precision_logdet(0.0),
+        prior_mahalanobis_distance(0.0),
+        posterior_precision_logdet(0.0),
+        posterior_mahalanobis_distance(0.0) {}
+
+  double SSCC::Moments::log_integrated_likelihood() const {
+    if (!positive_definite) return negative_infinity();
+    return .5 * (prior_precision_logdet - posterior_precision_logdet -
+                 prior_mahalanobis_distance + posterior_mahalanobis_distance);
+  }
+
+  SSCC::SpikeSlabCholeskyCache(const SpdMatrix &prior_precision,
+                               const Vector &prior_mean,
+                               const SpdMatrix &xtx,
+                               const Vector &xty,
+                               double sigsq)
+      : prior_precision_(prior_precision),
+        prior_mean_(prior_mean),
+        xtx_(xtx),
+        xty_(xty),
+        sigsq_(sigsq),
+        proposed_variable_(-1) {
+    int dim = prior_mean_.size();
+    if (prior_precision_.nrow() != dim || xtx_.nrow() != dim ||
+        xty_.size() != dim) {
+      report_error("Arguments to SpikeSlabCholeskyCache have "
+                   "inconsistent dimensions.");
+    }
+    current_.model = Selector(dim, false);
+  }
+
+  void SSCC::set_model(const Selector &inclusion_indicators) {
+    factor_model(current_, inclusion_indicators);
+    proposed_variable_ = -1;
+  }
+
+  const SSCC::Moments &SSCC::evaluate_flip(int which_variable) {
+    proposed_variable_ = which_variable;
+    if (!current_.moments.positive_definite) {
+      // There are no usable factors to update, so factor the flipped model
+      // from scratch.
+      Selector flipped = current_.model;
+      flipped.flip(which_variable);
+      factor_model(proposal_, flipped);
+      return proposal_.moments;
+    }
+
+    // Copy assignment reuses the storage held by proposal_, so this does not
+    // allocate once the proposal has reached its working size.
+    proposal_ = current_;
+    if (proposal_.model[which_variable]) {
+      remove_variable(proposal_, which_variable);
+    } else if (!add_variable(proposal_, which_variable)) {
+      proposal_.moments.positive_definite = false;
+      return proposal_.moments;
+    }
+    compute_moments(proposal_);
+    return proposal_.moments;
+  }
+
+  void SSCC::accept_flip() {
+    if (proposed_variable_ < 0) {
+      report_error("accept_flip() called without a matching call to "
+                   "evaluate_flip().");
+    }
+    if (!proposal_.moments.positive_definite) {
+      report_error("Can't accept a model whose precision is not "
+                   "positive definite.");
+    }
+    std::swap(current_, proposal_);
+    proposed_variable_ = -1;
+  }
+
+  void SSCC::factor_model(State &state,
+                          const Selector &inclusion_indicators) const {
+    state.model = Selector(inclusion_indicators.nvars_possible(), false);
+    state.variables.clear();
+    state.prior_precision_cholesky.clear();
+    state.posterior_precision_cholesky.clear();
+    state.prior_precision_times_mean.clear();
+    for (int i = 0; i < inclusion_indicators.nvars(); ++i) {
+      if (!add_variable(state, inclusion_indicators.indx(i))) {
+        // Record the requested model, even though it can't be factored.
+        state.model = inclusion_indicators;
+        state.moments.positive_definite = false;
+        return;
+      }
+    }
+    compute_moments(state);
+  }
+
+  bool SSCC::add_variable(State &state, int which_variable) const {
+    int k = state.variables.size();
+    prior_column_.resize(k);
+    posterior_column_.resize(k);
+    double mean = prior_mean_[which_variable];
+    double new_prior_precision_times_mean =
+        prior_precision_(which_variable, which_variable) * mean;
+    for (int j = 0; j < k; ++j) {
+      int other = state.variables[j];
+      double prior_precision = prior_precision_(other, which_variable);
+      prior_column_[j] = prior_precision;
+      posterior_column_[j] =
+          prior_precision + xtx_(other, which_variable) / sigsq_;
+      new_prior_precision_times_mean += prior_precision * prior_mean_[other];
+    }
+    if (!state.prior_precision_cholesky.append(
+            prior_column_, prior_precision_(which_variable, which_variable))) {
+      return false;
+    }
+    if (!state.posterior_precision_cholesky.append(
+            posterior_column_,
+            prior_precision_(which_variable, which_variable) +
+                xtx_(which_variable, which_variable) / sigsq_)) {
+      // Undo the prior update so the state remains consistent.
+      state.prior_precision_cholesky.remove(k);
+      return false;
+    }
+    for (int j = 0; j < k; ++j) {
+      state.prior_precision_times_mean[j] += prior_column_[j] * mean;
+    }
+    state.prior_precision_times_mean.push_back(
+        new_prior_precision_times_mean);
+    state.variables.push_back(which_variable);
+    state.model.add(which_variable);
+    return true;
+  }
+
+  void SSCC::remove_variable(State &state, int which_variable) const {
+    auto it = std::find(state.variables.begin(), state.variables.end(),
+                        which_variable);
+    if (it == state.variables.end()) {
+      report_error("Variable to be removed is not in the model.");
+    }
+    int position = it - state.variables.begin();
+    state.prior_precision_cholesky.remove(position);
+    state.posterior_precision_cholesky.remove(position);
+    double mean = prior_mean_[which_variable];
+    Vector &prior_precision_times_mean(state.prior_precision_times_mean);
+    for (int j = 0; j < state.variables.size(); ++j) {
+      prior_precision_times_mean[j] -=
+          prior_precision_(state.variables[j], which_variable) * mean;
+    }
+    prior_precision_times_mean.erase(prior_precision_times_mean.begin() +
+                                     position);
+    state.variables.erase(it);
+    state.model.drop(which_variable);
+  }
+
+  void SSCC::compute_moments(State &state) const {
+    Moments &moments(state.moments);
+    moments.positive_definite = true;
+    int k = state.variables.size();
+    if (k == 0) {
+      moments = Moments();
+      return;
+    }
+    moments.prior_precision_logdet = state.prior_precision_cholesky.logdet();
+    moments.posterior_precision_logdet =
+        state.posterior_precision_cholesky.logdet();
+
+    workspace_.resize(k);
+    double prior_distance = 0;
+    for (int j = 0; j < k; ++j) {
+      int variable = state.variables[j];
+      prior_distance +=
+          prior_mean_[variable] * state.prior_precision_times_mean[j];
+      workspace_[j] = state.prior_precision_times_mean[j] +
+          xty_[variable] / sigsq_;
+    }
+    moments.prior_mahalanobis_distance = prior_distance;
+    state.posterior_precision_cholesky.Lsolve_inplace(VectorView(workspace_));
+    moments.posterior_mahalanobis_distance = workspace_.normsq();
+  }
+
+}  // namespace BOOM
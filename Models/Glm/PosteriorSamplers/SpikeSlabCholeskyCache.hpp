@@ -0,0 +1,156 @@
+#ifndef BOOM_GLM_SPIKE_SLAB_CHOLESKY_CACHE_HPP_
+#define BOOM_GLM_SPIKE_SLAB_CHOLESKY_CACHE_HPP_
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <vector>
+#include "LinAlg/IncrementalCholesky.hpp"
+#include "LinAlg/Selector.hpp"
+#include "LinAlg/SpdMatrix.hpp"
+#include "LinAlg/Vector.hpp"
+
+namespace BOOM {
+
+  // The spike and slab samplers for regression-like models (SpikeSlabSampler,
+  // BregVsSampler, MLVS, BinomialLogitSpikeSlabSampler) integrate the
+  // coefficients out of a conjugate Gaussian model to get the posterior
+  // probability of a set of inclusion indicators g.  With prior
+  // beta_g ~ N(mu_g, Ominv_g^{-1}) and "data" contributing precision
+  // xtx_g / sigsq and information weighted mean xty_g / sigsq, the
+  // quantities involved are
+  //   * log |Ominv_g|,
+  //   * mu_g' Ominv_g mu_g,
+  //   * log |P_g|, where P_g = Ominv_g + xtx_g / sigsq, and
+  //   * r_g' P_g^{-1} r_g, where r_g = Ominv_g mu_g + xty_g / sigsq.
+  //
+  // Computing these from scratch costs O(k^3) for a model with k included
+  // variables.  A SpikeSlabCholeskyCache keeps Cholesky factors of Ominv_g
+  // and P_g for the current model, so the model obtained by flipping one
+  // inclusion indicator can be evaluated in O(k^2).  The evaluation does not
+  // change the current model unless the flip is accepted, which is what an
+  // MCMC sweep over the inclusion indicators needs.
+  //
+  // The cache holds references to the matrices and vectors passed to its
+  // constructor, which must remain valid (and unchanged) while it is in use.
+  // Nothing is copied, so building a cache costs nothing beyond its
+  // workspace.  Pass sufficient statistics by reference where the class
+  // offers it (e.g. WeightedRegSuf::xtwx()).  Those returned by value
+  // (e.g. RegSuf::xtx()) must be stored in a local variable rather than
+  // passed as temporaries.
+  class SpikeSlabCholeskyCache {
+   public:
+    struct Moments {
+      Moments();
+
+      // True if Ominv_g and P_g are both positive definite.  If false the
+      // remaining fields are meaningless.
+      bool positive_definite;
+
+      // log |Ominv_g|
+      double prior_precision_logdet;
+      // mu_g' Ominv_g mu_g
+      double prior_mahalanobis_distance;
+      // log |P_g|
+      double posterior_precision_logdet;
+      // r_g' P_g^{-1} r_g
+      double posterior_mahalanobis_distance;
+
+      // The log of the marginal likelihood of the model, when sigsq is known,
+      // omitting terms that do not depend on g.  Negative infinity if the
+      // moments are not positive definite.
+      double log_integrated_likelihood() const;
+    };
+
+    // Args:
+    //   prior_precision: The full (all variables included) prior precision
+    //     matrix Ominv.
+    //   prior_mean:  The full prior mean mu.
+    //   xtx: The full cross product matrix, or its generalization (e.g. the
+    //     weighted cross product matrix).
+    //   xty:  The full cross product between the predictors and the response.
+    //   sigsq: The residual variance used to scale xtx and xty.
+    SpikeSlabCholeskyCache(const SpdMatrix &prior_precision,
+                           const Vector &prior_mean,
+                           const SpdMatrix &xtx,
+                           const Vector &xty,
+                           double sigsq = 1.0);
+
+    // Factor the matrices for the model with the given inclusion indicators,
+    // which becomes the current model.  This costs O(k^3).
+    void set_model(const Selector &inclusion_indicators);
+
+    // The current model and its moments.
+    const Selector &model() const { return current_.model; }
+    const Moments &moments() const { return current_.moments; }
+
+    // Compute the moments of the model obtained by flipping the inclusion
+    // indicator for 'which_variable' in the current model.  The current model
+    // is not changed.
+    const Moments &evaluate_flip(int which_variable);
+
+    // Make the model from the most recent call to evaluate_flip() the current
+    // model.  It is an error to call accept_flip() if the flipped model was
+    // not positive definite.
+    void accept_flip();
+
+   private:
+    // The factors for one model.  The rows and columns of the factors follow
+    // the order in which variables were added, which need not match the order
+    // of the variables in 'model'.
+    struct State {
+      Selector model;
+      std::vector<int> variables;
+      IncrementalCholesky prior_precision_cholesky;
+      IncrementalCholesky posterior_precision_cholesky;
+      // Ominv_g * mu_g, with elements in the order of 'variables'.
+      Vector prior_precision_times_mean;
+      Moments moments;
+    };
+
+    // Factor the model with the given inclusion indicators from scratch.
+    void factor_model(State &state,
+                      const Selector &inclusion_indicators) const;
+
+    // Add variable 'which_variable' to 'state' or remove it, keeping the
+    // factors up to date.  Returns false if the new model is not positive
+    // definite.
+    bool add_variable(State &state, int which_variable) const;
+    void remove_variable(State &state, int which_variable) const;
+
+    // Fill state.moments from the factors in 'state'.
+    void compute_moments(State &state) const;
+
+    const SpdMatrix &prior_precision_;
+    const Vector &prior_mean_;
+    const SpdMatrix &xtx_;
+    const Vector &xty_;
+    double sigsq_;
+
+    State current_;
+    State proposal_;
+    int proposed_variable_;
+
+    // Workspace for computing r_g and the columns added to the factors.
+    mutable Vector workspace_;
+    mutable Vector prior_column_;
+    mutable Vector posterior_column_;
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_GLM_SPIKE_SLAB_CHOLESKY_CACHE_HPP_
@@ -18,6 +18,7 @@
 */
 
 #include "Models/Glm/PosteriorSamplers/SpikeSlabSampler.hpp"
+#include "Models/Glm/PosteriorSamplers/SpikeSlabCholeskyCache.hpp"
 #include "cpputil/math_utils.hpp"
 #include "cpputil/seq.hpp"
 #include "distributions.hpp"
@@ -71,11 +72,15 @@ namespace BOOM {
       report_error(err.str());
     }
 
+    // Each proposal changes one variable, so the Cholesky factors of the
+    // current model can be updated instead of recomputed.
+    SpikeSlabCholeskyCache cache(slab_prior_->siginv(), slab_prior_->mu(),
+                                 suf.xtwx(), suf.xtwy(), sigsq);
+    cache.set_model(inclusion_indicators);
     uint n = inclusion_indicators.nvars_possible();
     if (max_flips_ > 0) n = std::min<int>(n, max_flips_);
     for (int i = 0; i < n; ++i) {
-      logp = mcmc_one_flip(
-          rng, inclusion_indicators, indx[i], logp, suf, sigsq);
+      logp = mcmc_one_flip(rng, inclusion_indicators, indx[i], logp, cache);
     }
   }
 
@@ -189,15 +194,20 @@ namespace BOOM {
   }
 
   double SSS::mcmc_one_flip(RNG &rng, Selector &mod, int which_var,
-                            double logp_old, const WeightedRegSuf &suf,
-                            double sigsq) const {
+                            double logp_old,
+                            SpikeSlabCholeskyCache &cache) const {
     mod.flip(which_var);
-    double logp_new = log_model_prob(mod, suf, sigsq);
+    double logp_new = spike_prior_->logp(mod);
+    if (logp_new > BOOM::negative_infinity()) {
+      logp_new += cache.evaluate_flip(which_var).log_integrated_likelihood();
+    }
     double u = runif_mt(rng, 0, 1);
-    if (log(u) > logp_new - logp_old) {
+    if (logp_new == BOOM::negative_infinity() ||
+        log(u) > logp_new - logp_old) {
       mod.flip(which_var);  // reject draw
       return logp_old;
     }
+    cache.accept_flip();
     return logp_new;
   }
 
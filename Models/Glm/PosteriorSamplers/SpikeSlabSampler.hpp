@@ -27,6 +27,8 @@
 
 namespace BOOM {
 
+  class SpikeSlabCholeskyCache;
+
   // A class to manage the elements of spike-and-slab posterior sampling common
   // to GlmModel objects.  This class does not inherit from PosteriorSampler
   // because it is intended to be an element of a model-specific
@@ -133,14 +135,12 @@ namespace BOOM {
     //   which_variable:  The position in 'g' to consider changing.
     //   logp_old: The value of log_model_prob(g) prior to calling
     //     this function.
-    //   suf:  The set of complete data sufficient statistics.
-    //   sigsq: If the model has a residual variance parameter that is
-    //     not reflected in 'suf' provide it here.  Models that do not
-    //     have a separate residual variance parameter should use
-    //     sigsq = 1.0.
+    //   cache: Cholesky factors for model 'g', built from the sufficient
+    //     statistics and residual variance.  The proposed model is
+    //     evaluated by updating the factors, and the cache is kept in sync
+    //     with 'g' if the flip is accepted.
     double mcmc_one_flip(RNG &rng, Selector &g, int which_variable,
-                         double logp_old, const WeightedRegSuf &suf,
-                         double sigsq = 1.0) const;
+                         double logp_old, SpikeSlabCholeskyCache &cache) const;
 
     GlmModel *model_;
     Ptr<MvnBase> slab_prior_;
@@ -21,6 +21,7 @@
 
 #include <cmath>
 #include <sstream>
+#include "LinAlg/EigenMap.hpp"
 #include "Models/SufstatAbstractCombineImpl.hpp"
 #include "distributions.hpp"
 
@@ -107,6 +108,26 @@ namespace BOOM {
     return out;
   }
   //======================================================================
+  void RegSuf::add_mixture_data(const ConstVectorView &y,
+                                const ConstSubMatrix &X,
+                                const ConstVectorView &prob) {
+    for (int i = 0; i < y.size(); ++i) {
+      add_mixture_data(y[i], X.row(i), prob[i]);
+    }
+  }
+
+  void RegSuf::add_columnar_data(const ColumnarRegressionData &data,
+                                 int begin, int end) {
+    if (data.has_weights()) {
+      add_mixture_data(data.y_block(begin, end), data.X_block(begin, end),
+                       data.weight_block(begin, end));
+    } else {
+      Vector weights(end - begin, 1.0);
+      add_mixture_data(data.y_block(begin, end), data.X_block(begin, end),
+                       ConstVectorView(weights));
+    }
+  }
+
   std::ostream &RegSuf::print(std::ostream &out) const {
     out << "sample size: " << n() << endl
         << "xty: " << xty() << endl
@@ -349,6 +370,37 @@ namespace BOOM {
     x_column_sums_.axpy(x, prob);
   }
 
+  void NeRegSuf::add_mixture_data(const ConstVectorView &y,
+                                  const ConstSubMatrix &X,
+                                  const ConstVectorView &prob) {
+    int n = y.size();
+    if (X.nrow() != n || prob.size() != n) {
+      report_error("The number of rows in X must match the lengths of y and "
+                   "prob in NeRegSuf::add_mixture_data.");
+    }
+    if (X.ncol() != xty_.size()) {
+      report_error("Wrong size predictor passed to "
+                   "NeRegSuf::add_mixture_data.");
+    }
+    if (n == 0) return;
+    if (!xtx_is_fixed_) {
+      xtx_.add_inner(X, prob, false);
+      needs_to_reflect_ = true;
+    }
+    Vector weighted_y(n);
+    for (int i = 0; i < n; ++i) {
+      if (!std::isfinite(y[i])) {
+        report_error("Non-finite response variable in add_mixture_data.");
+      }
+      weighted_y[i] = y[i] * prob[i];
+      sumsqy_ += weighted_y[i] * y[i];
+      sumy_ += weighted_y[i];
+      n_ += prob[i];
+    }
+    EigenMap(xty_) += EigenMap(X).transpose() * EigenMap(weighted_y);
+    EigenMap(x_column_sums_) += EigenMap(X).transpose() * EigenMap(prob);
+  }
+
   void NeRegSuf::clear() {
     if (!xtx_is_fixed_) xtx_ = 0.0;
     xty_ = 0.0;
@@ -492,14 +544,51 @@ namespace BOOM {
   RDP::RegressionDataPolicy(const Ptr<RegSuf> &s, const DatasetType &d)
       : DPBase(s, d) {}
 
+  // The DPBase copy constructor has already rebuilt suf() from dat(), so only
+  // the columnar data needs to be added.
   RDP::RegressionDataPolicy(const RegressionDataPolicy &rhs)
-      : Model(rhs), DPBase(rhs) {}
+      : Model(rhs), DPBase(rhs), columnar_data_(rhs.columnar_data_) {
+    if (is_raw_data_kept()) add_columnar_data_to_suf();
+  }
 
+  // DPBase::operator= calls the virtual refresh_suf(), so columnar_data_ must
+  // be in place before it is called.
   RegressionDataPolicy &RDP::operator=(const RegressionDataPolicy &rhs) {
-    if (&rhs != this) DPBase::operator=(rhs);
+    if (&rhs != this) {
+      columnar_data_ = rhs.columnar_data_;
+      DPBase::operator=(rhs);
+    }
     return *this;
   }
 
+  void RDP::set_columnar_data(const Ptr<ColumnarRegressionData> &data) {
+    if (data && data->xdim() != suf()->size()) {
+      report_error("Columnar data has the wrong number of predictors.");
+    }
+    columnar_data_ = data;
+    refresh_suf();
+  }
+
+  int RDP::total_sample_size() const {
+    return dat().size() + (columnar_data_ ? columnar_data_->sample_size() : 0);
+  }
+
+  void RDP::refresh_suf() {
+    if (!is_raw_data_kept()) return;
+    DPBase::refresh_suf();
+    add_columnar_data_to_suf();
+  }
+
+  void RDP::add_columnar_data_to_suf() {
+    if (columnar_data_) {
+      const ColumnarRegressionData &data(*columnar_data_);
+      RegSuf &regression_suf(*suf());
+      data.for_each_block(-1, [&data, &regression_suf](int begin, int end) {
+        regression_suf.add_columnar_data(data, begin, end);
+      });
+    }
+  }
+
   //======================================================================
   typedef RegressionModel RM;
 
@@ -584,8 +673,8 @@ namespace BOOM {
   void RM::make_X_y(Matrix &X, Vector &Y) const {
     uint p = xdim();
     uint n = dat().size();
-    X = Matrix(n, p);
-    Y = Vector(n);
+    X = Matrix(total_sample_size(), p);
+    Y = Vector(total_sample_size());
     for (uint i = 0; i < n; ++i) {
       Ptr<RegressionData> rdp = dat()[i];
       const Vector &x(rdp->x());
@@ -593,6 +682,13 @@ namespace BOOM {
       X.set_row(i, x);
       Y[i] = rdp->y();
     }
+    if (has_columnar_data()) {
+      const ColumnarRegressionData &columns(*columnar_data());
+      for (int i = 0; i < columns.sample_size(); ++i) {
+        X.row(n + i) = columns.x(i);
+        Y[n + i] = columns.y(i);
+      }
+    }
   }
 
   void RM::mle() {
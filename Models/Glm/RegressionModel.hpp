@@ -23,6 +23,7 @@
 #include "uint.hpp"
 #include "LinAlg/QR.hpp"
 #include "Models/EmMixtureComponent.hpp"
+#include "Models/Glm/ColumnarRegressionData.hpp"
 #include "Models/Glm/Glm.hpp"
 #include "Models/ParamTypes.hpp"
 #include "Models/Policies/IID_DataPolicy.hpp"
@@ -87,6 +88,25 @@ namespace BOOM {
     virtual void add_mixture_data(double y, const Vector &x, double prob) = 0;
     virtual void add_mixture_data(double y, const ConstVectorView &x,
                                   double prob) = 0;
+
+    // Add a batch of observations, where row i of X has response y[i] and
+    // weight prob[i].  Derived classes should override this with a blocked
+    // implementation.  The default implementation adds one row at a time.
+    virtual void add_mixture_data(const ConstVectorView &y,
+                                  const ConstSubMatrix &X,
+                                  const ConstVectorView &prob);
+    void add_mixture_data(const Vector &y, const Matrix &X,
+                          const Vector &prob) {
+      add_mixture_data(ConstVectorView(y), ConstSubMatrix(X),
+                       ConstVectorView(prob));
+    }
+
+    // Add the observations in rows [begin, end) of a columnar data set, with
+    // each observation weighted by data.weight(i).  The rows are added as a
+    // single batch.
+    virtual void add_columnar_data(const ColumnarRegressionData &data,
+                                   int begin, int end);
+
     virtual void combine(const Ptr<RegSuf> &) = 0;
 
     std::ostream &print(std::ostream &out) const override;
@@ -102,6 +122,7 @@ namespace BOOM {
     QrRegSuf *clone() const override;
     void clear() override;
     void Update(const DataType &) override;
+    using RegSuf::add_mixture_data;
     void add_mixture_data(double y, const Vector &x, double prob) override;
     void add_mixture_data(double y, const ConstVectorView &x,
                           double prob) override;
@@ -171,6 +192,13 @@ namespace BOOM {
     void add_mixture_data(double y, const Vector &x, double prob) override;
     void add_mixture_data(double y, const ConstVectorView &x,
                           double prob) override;
+
+    // Accumulates X'WX with one blocked rank-k update of the upper triangle.
+    // The lower triangle is filled in by reflect() when xtx is next read.
+    void add_mixture_data(const ConstVectorView &y, const ConstSubMatrix &X,
+                          const ConstVectorView &prob) override;
+    using RegSuf::add_mixture_data;
+
     void Update(const RegressionData &rdp) override;
     uint size() const override;  // dimension of beta
     double yty() const override;
@@ -250,6 +278,32 @@ namespace BOOM {
     RegressionDataPolicy(const RegressionDataPolicy &);
     RegressionDataPolicy *clone() const override = 0;
     RegressionDataPolicy &operator=(const RegressionDataPolicy &);
+
+    // Columnar data is an opt-in alternative to storing each observation as
+    // a separate RegressionData object, intended for large data sets.  The
+    // columnar data is shared (not copied) when the model is copied.  It
+    // contributes to suf(), but it is not visible through dat().  Setting
+    // columnar data replaces any columnar data set previously, but leaves
+    // dat() alone.  Passing a null pointer removes the columnar data.
+    void set_columnar_data(const Ptr<ColumnarRegressionData> &data);
+    const Ptr<ColumnarRegressionData> &columnar_data() const {
+      return columnar_data_;
+    }
+    bool has_columnar_data() const { return !!columnar_data_; }
+
+    // The number of observations in dat() plus the number in the columnar
+    // data store.
+    int total_sample_size() const;
+
+    // Rebuild suf() from the data in dat() and the columnar data store.
+    // The columnar data is added in blocks of rows.
+    void refresh_suf() override;
+
+   private:
+    // Add the columnar data (if any) to suf().
+    void add_columnar_data_to_suf();
+
+    Ptr<ColumnarRegressionData> columnar_data_;
   };
   template <class Fwd>
   RegressionDataPolicy::RegressionDataPolicy(const Ptr<RegSuf> &s, Fwd b, Fwd e)
@@ -396,7 +450,9 @@ namespace BOOM {
     virtual double pdf(const Ptr<Data> &, bool) const;
     double pdf(const Data *, bool) const override;
 
-    int number_of_observations() const override { return dat().size(); }
+    int number_of_observations() const override {
+      return total_sample_size();
+    }
 
     // The log likelihood when beta is empty (i.e. all coefficients,
     // including the intercept, are zero).
@@ -21,9 +21,11 @@
 #include "distributions.hpp"
 
 #include <cmath>
+#include "LinAlg/EigenMap.hpp"
 #include "Models/PosteriorSamplers/PosteriorSampler.hpp"
 #include "Models/SufstatAbstractCombineImpl.hpp"
 #include "cpputil/math_utils.hpp"
+#include "cpputil/report_error.hpp"
 
 namespace BOOM {
   typedef WeightedRegressionData WRD;
@@ -132,7 +134,7 @@ namespace BOOM {
     uint n = w.size();
     assert(y.size() == n && X.nrow() == n);
     clear();
-    for (uint i = 0; i < n; ++i) add_data(X.row(i), y[i], w[i]);
+    add_data(X, y, w);
   }
 
   void WRS::recompute(const std::vector<Ptr<WeightedRegressionData>> &data) {
@@ -168,6 +170,22 @@ namespace BOOM {
     sym_ = false;
   }
 
+  void WRS::add_data(const Matrix &X, const Vector &y, const Vector &w) {
+    if (X.nrow() != y.size() || w.size() != y.size()) {
+      report_error("The number of rows in X must match the lengths of y and "
+                   "w in WeightedRegSuf::add_data.");
+    }
+    if (y.empty()) return;
+    Vector wy = w * y;
+    n_ += y.size();
+    yt_w_y_ += wy.dot(y);
+    sumw_ += w.sum();
+    for (double weight : w) sumlogw_ += log(weight);
+    xtwx_.add_inner(X, w, false);
+    EigenMap(xtwy_) += EigenMap(X).transpose() * EigenMap(wy);
+    sym_ = false;
+  }
+
   void WRS::clear() {
     xtwx_ = 0.0;
     xtwy_ = 0.0;
@@ -181,7 +199,9 @@ namespace BOOM {
   uint WRS::size() const { return xtwx_.nrow(); }
   double WRS::yty() const { return yt_w_y_; }
   Vector WRS::xty() const { return xtwy_; }
-  SpdMatrix WRS::xtx() const {
+  SpdMatrix WRS::xtx() const { return xtwx(); }
+  const Vector &WRS::xtwy() const { return xtwy_; }
+  const SpdMatrix &WRS::xtwx() const {
     if (!sym_) make_symmetric();
     return xtwx_;
   }
@@ -72,6 +72,9 @@ namespace BOOM {
 
     void Update(const WeightedRegressionData &) override;
     void add_data(const Vector &x, double y, double w);
+    // Add a block of observations (rows of X) at once, using a blocked
+    // rank-k update for X'WX.
+    void add_data(const Matrix &X, const Vector &y, const Vector &w);
 
     void clear() override;
     virtual uint size() const;                      // dimension of beta
@@ -81,6 +84,14 @@ namespace BOOM {
     virtual Vector xty(const Selector &) const;     // X^T W Y
     virtual SpdMatrix xtx(const Selector &) const;  // X^T W X
     virtual Vector beta_hat() const;                // WLS estimate
+
+    // References to the stored X^T W X and X^T W Y, for callers that keep
+    // them for a while (e.g. SpikeSlabCholeskyCache) and would otherwise
+    // copy a p x p matrix.  The referenced values change whenever the
+    // sufficient statistics do.
+    const SpdMatrix &xtwx() const;
+    const Vector &xtwy() const;
+
     double weighted_sum_of_squared_errors(const Vector &beta) const;
     virtual double SSE() const;   //
     virtual double SST() const;   // weighted sum of squares
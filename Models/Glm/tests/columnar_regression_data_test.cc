@@ -0,0 +1,172 @@
+#include "gtest/gtest.h"
+
+#include "Models/Glm/BinomialLogitModel.hpp"
+#include "Models/Glm/ColumnarRegressionData.hpp"
+#include "Models/Glm/RegressionModel.hpp"
+#include "Models/Glm/PosteriorSamplers/BinomialLogitAuxmixSampler.hpp"
+#include "Models/MvnModel.hpp"
+#include "distributions.hpp"
+
+#include "test_utils/test_utils.hpp"
+
+namespace {
+  using namespace BOOM;
+  using std::endl;
+
+  class ColumnarRegressionDataTest : public ::testing::Test {
+   protected:
+    ColumnarRegressionDataTest() {
+      GlobalRng::rng.seed(8675309);
+    }
+  };
+
+  TEST_F(ColumnarRegressionDataTest, Accessors) {
+    Matrix X(7, 3);
+    X.randomize();
+    Vector y(7);
+    y.randomize();
+    NEW(ColumnarRegressionData, data)(X, y);
+    EXPECT_EQ(7, data->sample_size());
+    EXPECT_EQ(3, data->xdim());
+    EXPECT_FALSE(data->has_weights());
+    EXPECT_DOUBLE_EQ(1.0, data->weight(4));
+    EXPECT_TRUE(VectorEquals(data->x(2), X.row(2)));
+    EXPECT_DOUBLE_EQ(y[5], data->row(5).y());
+
+    EXPECT_TRUE(MatrixEquals(data->X_block(2, 5).to_matrix(),
+                             ConstSubMatrix(X, 2, 4, 0, 2).to_matrix()));
+    EXPECT_EQ(3, data->y_block(2, 5).size());
+    EXPECT_DOUBLE_EQ(y[2], data->y_block(2, 5)[0]);
+
+    Vector beta(3);
+    beta.randomize();
+    Vector eta = data->linear_predictor(beta, 1, 6);
+    EXPECT_EQ(5, eta.size());
+    for (int i = 1; i < 6; ++i) {
+      EXPECT_NEAR(X.row(i).dot(beta), eta[i - 1], 1e-10);
+    }
+
+    Ptr<RegressionData> dp = data->materialize(3);
+    EXPECT_DOUBLE_EQ(y[3], dp->y());
+    EXPECT_TRUE(VectorEquals(dp->x(), X.row(3)));
+
+    int rows_visited = 0;
+    data->for_each_block(3, [&rows_visited](int begin, int end) {
+      EXPECT_LE(end - begin, 3);
+      rows_visited += end - begin;
+    });
+    EXPECT_EQ(7, rows_visited);
+  }
+
+  TEST_F(ColumnarRegressionDataTest, RegressionSufficientStatistics) {
+    int nobs = 1000;
+    int nvars = 4;
+    Matrix X(nobs, nvars);
+    X.randomize();
+    X.col(0) = 1.0;
+    Vector y(nobs);
+    y.randomize();
+
+    RegressionModel legacy(nvars);
+    for (int i = 0; i < nobs; ++i) {
+      NEW(RegressionData, dp)(y[i], X.row(i));
+      legacy.add_data(dp);
+    }
+
+    RegressionModel columnar(nvars);
+    columnar.set_columnar_data(new ColumnarRegressionData(X, y));
+    EXPECT_TRUE(columnar.dat().empty());
+    EXPECT_EQ(nobs, columnar.number_of_observations());
+    EXPECT_NEAR(legacy.suf()->n(), columnar.suf()->n(), 1e-8);
+    EXPECT_NEAR(legacy.suf()->yty(), columnar.suf()->yty(), 1e-8);
+    EXPECT_TRUE(VectorEquals(legacy.suf()->xty(), columnar.suf()->xty(),
+                             1e-8));
+    EXPECT_TRUE(MatrixEquals(legacy.suf()->xtx(), columnar.suf()->xtx(),
+                             1e-8));
+
+    // Copies share the columnar data and rebuild the sufficient statistics.
+    Ptr<RegressionModel> copy = columnar.clone();
+    EXPECT_EQ(columnar.columnar_data().get(), copy->columnar_data().get());
+    EXPECT_NEAR(columnar.suf()->yty(), copy->suf()->yty(), 1e-8);
+    EXPECT_NEAR(columnar.suf()->n(), copy->suf()->n(), 1e-8);
+
+    // Assignment picks up the columnar data of the right hand side.
+    RegressionModel assigned(nvars);
+    RegressionDataPolicy &assigned_data(assigned);
+    assigned_data = columnar;
+    EXPECT_NEAR(columnar.suf()->n(), assigned.suf()->n(), 1e-8);
+    EXPECT_NEAR(columnar.suf()->yty(), assigned.suf()->yty(), 1e-8);
+  }
+
+  // set_data() refreshes suf() through the virtual refresh_suf(), so the
+  // columnar data must still be counted afterwards.
+  TEST_F(ColumnarRegressionDataTest, SetDataKeepsColumnarData) {
+    int nobs = 200;
+    int nvars = 3;
+    Matrix X(nobs, nvars);
+    X.randomize();
+    Vector y(nobs);
+    y.randomize();
+
+    int nrows = 20;
+    std::vector<Ptr<RegressionData>> rows;
+    Matrix all_X = X;
+    Vector all_y = y;
+    for (int i = 0; i < nrows; ++i) {
+      Vector x(nvars);
+      x.randomize();
+      double yi = rnorm();
+      rows.push_back(new RegressionData(yi, x));
+      all_X.rbind(x);
+      all_y.push_back(yi);
+    }
+
+    RegressionModel model(nvars);
+    model.set_columnar_data(new ColumnarRegressionData(X, y));
+    model.set_data(rows);
+    EXPECT_EQ(nrows, model.dat().size());
+
+    RegressionModel reference(nvars);
+    reference.set_columnar_data(new ColumnarRegressionData(all_X, all_y));
+    EXPECT_NEAR(reference.suf()->n(), model.suf()->n(), 1e-8);
+    EXPECT_NEAR(reference.suf()->yty(), model.suf()->yty(), 1e-8);
+    EXPECT_TRUE(VectorEquals(reference.suf()->xty(), model.suf()->xty(),
+                             1e-8));
+    EXPECT_TRUE(MatrixEquals(reference.suf()->xtx(), model.suf()->xtx(),
+                             1e-8));
+  }
+
+  TEST_F(ColumnarRegressionDataTest, BinomialLogit) {
+    int nobs = 500;
+    int nvars = 3;
+    Matrix X(nobs, nvars);
+    X.randomize();
+    X.col(0) = 1.0;
+    Vector beta = {-.5, 1.0, 2.0};
+    Vector trials(nobs);
+    Vector successes(nobs);
+    for (int i = 0; i < nobs; ++i) {
+      trials[i] = 1 + rpois(3);
+      successes[i] = rbinom(trials[i], plogis(X.row(i).dot(beta)));
+    }
+
+    BinomialLogitModel legacy(X, successes, trials);
+    legacy.set_Beta(beta);
+    NEW(BinomialLogitModel, columnar)(nvars);
+    columnar->set_Beta(beta);
+    columnar->set_columnar_data(
+        new ColumnarRegressionData(X, successes, trials));
+    EXPECT_EQ(nobs, columnar->number_of_observations());
+    EXPECT_NEAR(legacy.log_likelihood(), columnar->log_likelihood(), 1e-6);
+    EXPECT_TRUE(MatrixEquals(legacy.xtx(), columnar->xtx(), 1e-8));
+
+    // The auxiliary mixture sampler streams over the columnar data.
+    NEW(MvnModel, prior)(nvars);
+    NEW(BinomialLogitAuxmixSampler, sampler)(columnar.get(), prior);
+    columnar->set_method(sampler);
+    sampler->set_number_of_workers(3);
+    sampler->impute_latent_data();
+    EXPECT_EQ(nobs, sampler->suf().sample_size());
+  }
+
+}  // namespace
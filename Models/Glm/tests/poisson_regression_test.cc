@@ -0,0 +1,65 @@
+#include "gtest/gtest.h"
+
+#include "Models/Glm/PoissonRegressionModel.hpp"
+#include "Models/Glm/PosteriorSamplers/PoissonRegressionHmcSampler.hpp"
+#include "Models/MvnModel.hpp"
+#include "distributions.hpp"
+#include "stats/moments.hpp"
+
+#include "test_utils/test_utils.hpp"
+
+namespace {
+  using namespace BOOM;
+  using std::endl;
+  using std::cout;
+
+  class PoissonRegressionTest : public ::testing::Test {
+   protected:
+    PoissonRegressionTest() {
+      GlobalRng::rng.seed(8675309);
+    }
+  };
+
+  TEST_F(PoissonRegressionTest, HmcSampler) {
+    int xdim = 6;
+    int sample_size = 500;
+    Vector beta(xdim);
+    for (int i = 0; i < xdim; ++i) beta[i] = rnorm(0, .3);
+    NEW(PoissonRegressionModel, model)(xdim);
+    for (int i = 0; i < sample_size; ++i) {
+      Vector x(xdim);
+      x[0] = 1.0;
+      for (int j = 1; j < xdim; ++j) x[j] = rnorm();
+      model->add_data(new PoissonRegressionData(rpois(exp(x.dot(beta))), x));
+    }
+    NEW(MvnModel, prior)(Vector(xdim, 0.0), SpdMatrix(xdim, 100.0));
+    int warmup = 200;
+    NEW(PoissonRegressionHmcSampler, sampler)(model.get(), prior, warmup);
+    model->set_method(sampler);
+
+    for (int i = 0; i < warmup; ++i) {
+      model->sample_posterior();
+    }
+    EXPECT_FALSE(sampler->sampler().in_warmup());
+    int niter = 500;
+    Matrix draws(niter, xdim);
+    double acceptance = 0;
+    for (int i = 0; i < niter; ++i) {
+      model->sample_posterior();
+      draws.row(i) = model->Beta();
+      acceptance += sampler->sampler().acceptance_probability();
+    }
+    // Dual averaging targets an average acceptance probability of 0.8.
+    EXPECT_GT(acceptance / niter, .6);
+
+    Vector posterior_mean = mean(draws);
+    Vector posterior_sd = sqrt(var(draws).diag());
+    for (int i = 0; i < xdim; ++i) {
+      EXPECT_LT(fabs(posterior_mean[i] - beta[i]), 4 * posterior_sd[i])
+          << "coefficient " << i << endl
+          << "truth: " << beta << endl
+          << "posterior mean: " << posterior_mean << endl;
+    }
+  }
+
+}  // namespace
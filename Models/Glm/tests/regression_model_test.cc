@@ -151,4 +151,31 @@ namespace {
     EXPECT_NEAR(marginal_loglike, monte_carlo_marginal_loglike, 3.0);
   }
 
+  // Adding a batch of observations should produce the same sufficient
+  // statistics as adding them one at a time.
+  TEST_F(RegressionModelTest, BatchedSufstatUpdate) {
+    int nobs = 2500;
+    int nvars = 4;
+    Matrix X(nobs, nvars);
+    X.randomize();
+    Vector y(nobs);
+    y.randomize();
+    Vector w(nobs);
+    w.randomize();
+
+    NeRegSuf one_at_a_time(nvars);
+    for (int i = 0; i < nobs; ++i) {
+      one_at_a_time.add_mixture_data(y[i], ConstVectorView(X.row(i)), w[i]);
+    }
+    NeRegSuf batched(nvars);
+    batched.add_mixture_data(y, X, w);
+
+    EXPECT_TRUE(MatrixEquals(one_at_a_time.xtx(), batched.xtx()));
+    EXPECT_TRUE(VectorEquals(one_at_a_time.xty(), batched.xty()));
+    EXPECT_NEAR(one_at_a_time.yty(), batched.yty(), 1e-8);
+    EXPECT_NEAR(one_at_a_time.n(), batched.n(), 1e-8);
+    EXPECT_NEAR(one_at_a_time.ybar(), batched.ybar(), 1e-8);
+    EXPECT_TRUE(VectorEquals(one_at_a_time.xbar(), batched.xbar()));
+  }
+
 }  // namespace
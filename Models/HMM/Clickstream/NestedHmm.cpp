@@ -61,8 +61,8 @@ namespace BOOM {
         logpi0_(S1 * S2),
         logd_(S1 * S2),
         one_(S1 * S2, 1.0),
-        logQ1_(S1 * S2, S1 * S2),
-        logQ2_(S1 * S2, S1 * S2) {
+        Q1_(S1 * S2, S1 * S2),
+        Q2_(S1 * S2, S1 * S2) {
     setup();
   }
 
@@ -78,8 +78,8 @@ namespace BOOM {
         logpi0_(S1 * S2),
         logd_(S1 * S2),
         one_(S1 * S2, 1.0),
-        logQ1_(S1 * S2, S1 * S2),
-        logQ2_(S1 * S2, S1 * S2) {
+        Q1_(S1 * S2, S1 * S2),
+        Q2_(S1 * S2, S1 * S2) {
     setup();
   }
 
@@ -201,10 +201,10 @@ namespace BOOM {
           }
         } else {
           fill_logd(event);
-          // use logQ1_ if the first event in a session.
-          // use logQ2_ otherwise
-          const Matrix &logQ(j == 0 ? logQ1_ : logQ2_);
-          ans += fwd_1(pi_, P[event_num], logQ, logd_, one_);
+          // use Q1_ if the first event in a session.
+          // use Q2_ otherwise
+          const Matrix &Q(j == 0 ? Q1_ : Q2_);
+          ans += scaled_fwd_1(pi_, P[event_num], Q, logd_);
           if (!std::isfinite(ans) || !std::isfinite(pi_[0])) {
             ostringstream err;
             print_event(err, "found an infinity in NestedHmm::fwd", u, session,
@@ -713,8 +713,8 @@ namespace BOOM {
   //----------------------------------------------------------------------
   void NestedHmm::fill_big_Q() const {
     // fills logpi0_ (for first event ever)
-    //       logQ1_  (for transitions to the first event in a new session)
-    //       logQ2_  (for transitions within a session)
+    //       Q1_  (for transitions to the first event in a new session)
+    //       Q2_  (for transitions within a session)
 
     // pi0_ looks like:     phi2[1] * vector( phi1[H=1] )
     //                      phi2[2] * vector( phi1[H=2] )
@@ -735,11 +735,11 @@ namespace BOOM {
     if (logpi0_.size() != S) logpi0_.resize(S);
     if (logd_.size() != S) logd_.resize(S);
 
-    if (logQ1_.nrow() != S || logQ1_.ncol() != S) logQ1_.resize(S, S);
-    logQ1_ = 0;
+    if (Q1_.nrow() != S || Q1_.ncol() != S) Q1_.resize(S, S);
+    Q1_ = 0;
 
-    if (logQ2_.nrow() != S || logQ2_.ncol() != S) logQ2_.resize(S, S);
-    logQ2_ = 0;
+    if (Q2_.nrow() != S || Q2_.ncol() != S) Q2_.resize(S, S);
+    Q2_ = 0;
 
     int i = 0;
     const Vector &phi2(session_model()->pi0());
@@ -757,20 +757,19 @@ namespace BOOM {
       VectorView pi_H(logpi0_, i, S1_);
       pi_H = phi2[H] * event_model(H)->pi0();
 
-      SubMatrix Q2(logQ2_, i, i + S1_ - 1, i, i + S1_ - 1);
+      SubMatrix Q2(Q2_, i, i + S1_ - 1, i, i + S1_ - 1);
       Q2 = event_model(H)->Q();
 
       int j = 0;
       for (int HH = 0; HH < S2_; ++HH) {
-        SubMatrix Q1(logQ1_, i, i + S1_ - 1, j, j + S1_ - 1);
+        SubMatrix Q1(Q1_, i, i + S1_ - 1, j, j + S1_ - 1);
         Q1 = Phi2(H, HH) * stacked_phi1[HH];  // scalar times matrix
         j += S1_;
       }
       i += S1_;
     }
 
-    logQ1_ = log(logQ1_);
-    logQ2_ = log(logQ2_);
+    // Q1_ and Q2_ stay on the probability scale for scaled_fwd_1.
     logpi0_ = log(logpi0_);
   }
   //----------------------------------------------------------------------
@@ -178,8 +178,8 @@ namespace BOOM {
     mutable Vector logpi0_;
     mutable Vector logd_;
     const Vector one_;      // A vector of 1's
-    mutable Matrix logQ1_;  // for the first obs in a session
-    mutable Matrix logQ2_;  // for the subsequent observations
+    mutable Matrix Q1_;  // for the first obs in a session
+    mutable Matrix Q2_;  // for the subsequent observations
 
     RNG rng_;
 
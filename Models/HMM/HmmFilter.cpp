@@ -55,19 +55,26 @@ namespace BOOM {
         logp(mix.size()),
         logpi(mix.size()),
         one(mix.size(), 1.0),
-        logQ(mix.size(), mix.size()),
+        wsp(mix.size()),
+        Q(mix.size(), mix.size()),
         markov_(mark) {}
 
   uint HmmFilter::state_space_size() const { return models_.size(); }
 
   double HmmFilter::initialize(const Data *dp) {
     uint S = state_space_size();
-    pi = markov_->pi0();
+    if (logp.size() != S) logp.resize(S);
     if (dp->missing())
       logp = 0;
     else
       for (uint s = 0; s < S; ++s) logp[s] = models_[s]->pdf(dp, true);
-    pi = log(pi) + logp;
+    return initialize(ConstVectorView(logp));
+  }
+
+  double HmmFilter::initialize(const ConstVectorView &logd) {
+    pi = markov_->pi0();
+    pi = log(pi);
+    pi += logd;
     double m = max(pi);
     pi = exp(pi - m);
     double nc = sum(pi);
@@ -76,39 +83,44 @@ namespace BOOM {
     return loglike;
   }
 
+  void HmmFilter::fill_log_likelihood(const std::vector<Ptr<Data>> &data,
+                                      Matrix &log_likelihood) const {
+    uint n = data.size();
+    uint S = state_space_size();
+    if (log_likelihood.nrow() != n || log_likelihood.ncol() != S) {
+      log_likelihood.resize(n, S);
+    }
+    for (uint s = 0; s < S; ++s) {
+      models_[s]->fill_log_pdf(data, log_likelihood.col(s));
+    }
+    for (uint i = 0; i < n; ++i) {
+      if (data[i]->missing()) log_likelihood.row(i) = 0;
+    }
+  }
+  //------------------------------------------------------------
+
   double HmmFilter::fwd(const std::vector<Ptr<Data>> &dv) {
-    logQ = log(markov_->Q());
+    Q = markov_->Q();
     uint n = dv.size();
     uint S = state_space_size();
     if (logp.size() != S) logp.resize(S);
     if (P.size() < n) P.resize(n);
-    double loglike = initialize(dv[0].get());
+    fill_log_likelihood(dv, log_likelihood_);
+    double loglike = initialize(log_likelihood_.row(0));
     for (uint i = 1; i < n; ++i) {
-      if (dv[i]->missing())
-        logp = 0;
-      else
-        for (uint s = 0; s < S; ++s)
-          logp[s] = models_[s]->pdf(dv[i].get(), true);
-      loglike += fwd_1(pi, P[i], logQ, logp, one);
+      loglike += scaled_fwd_1(pi, P[i], Q, log_likelihood_.row(i));
     }
     return loglike;
   }
   //------------------------------------------------------------
 
   double HmmFilter::loglike(const std::vector<Ptr<Data>> &dv) {
-    logQ = log(markov_->Q());
-    pi = markov_->pi0();
-    uint S = pi.size();
+    Q = markov_->Q();
     uint n = dv.size();
-    Matrix P(logQ);
-    double ans = initialize(dv[0].get());
+    fill_log_likelihood(dv, log_likelihood_);
+    double ans = initialize(log_likelihood_.row(0));
     for (uint i = 1; i < n; ++i) {
-      if (dv[i]->missing())
-        logp = 0;
-      else
-        for (uint s = 0; s < S; ++s)
-          logp[s] = models_[s]->pdf(dv[i].get(), true);
-      ans += fwd_1(pi, P, logQ, logp, one);
+      ans += scaled_fwd_loglike_1(pi, Q, log_likelihood_.row(i), wsp);
     }
     return ans;
   }
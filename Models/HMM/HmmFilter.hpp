@@ -46,6 +46,16 @@ namespace BOOM {
     uint state_space_size() const;
 
     double initialize(const Data *);
+
+    // Fill log_likelihood(i, s) with log p(data[i] | state s), using one
+    // batch call to each state's model.  Rows for missing data are zero.
+    // log_likelihood is resized to data.size() x state_space_size().
+    void fill_log_likelihood(const std::vector<Ptr<Data>> &data,
+                             Matrix &log_likelihood) const;
+
+    // The log likelihood of a sequence, computed by a forward filter that
+    // keeps only O(S) state between time steps.  Unlike fwd(), this does
+    // not store the information needed for backward sampling.
     double loglike(const std::vector<Ptr<Data>> &);
     double fwd(const std::vector<Ptr<Data>> &);
     void bkwd_sampling(const std::vector<Ptr<Data>> &);
@@ -58,10 +68,17 @@ namespace BOOM {
     std::vector<int> imputed_state(const std::vector<Ptr<Data>> &data) const;
     
    protected:
+    // Set pi to the distribution of the first hidden state given the first
+    // observation, whose log density under each state is logd.  Returns
+    // the log likelihood of the first observation.
+    double initialize(const ConstVectorView &logd);
+
     std::vector<Ptr<MixtureComponent>> models_;
     std::vector<Matrix> P;
-    Vector pi, logp, logpi, one;
-    Matrix logQ;
+    Vector pi, logp, logpi, one, wsp;
+    Matrix Q;
+    // Row i is the log density of observation i under each state.
+    Matrix log_likelihood_;
     Ptr<MarkovModel> markov_;
     std::map<std::vector<Ptr<Data>>, std::vector<int>> imputed_state_map_;
   };
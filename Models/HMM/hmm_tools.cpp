@@ -18,6 +18,7 @@
 */
 
 #include "Models/HMM/hmm_tools.hpp"
+#include <cmath>
 #include "LinAlg/Matrix.hpp"
 #include "LinAlg/Vector.hpp"
 #include "uint.hpp"
@@ -69,4 +70,71 @@ namespace BOOM {
     pi = P * one;
   }
 
+  namespace {
+    // Returns the largest element of logd.
+    inline double max_log_density(const ConstVectorView &logd) {
+      double ans = logd[0];
+      for (int s = 1; s < logd.size(); ++s) {
+        if (logd[s] > ans) ans = logd[s];
+      }
+      return ans;
+    }
+  }  // namespace
+
+  double scaled_fwd_1(Vector &pi, Matrix &P, const Matrix &Q,
+                      const ConstVectorView &logd) {
+    /*----------------------------------------------------------------------
+     * P(r,s) is proportional to pi[r] * Q(r,s) * exp(logd[s] - m), where m
+     * is the largest logd.  Matrices are stored by columns, so column s of
+     * Q and P is contiguous.
+     * --------------------------------------------------------------------*/
+    const int S = pi.size();
+    if (P.nrow() != S || P.ncol() != S) P.resize(S, S);
+    const double m = max_log_density(logd);
+    const double *prior = pi.data();
+    for (int s = 0; s < S; ++s) {
+      const double weight = std::exp(logd[s] - m);
+      const double *q = Q.data() + s * S;
+      double *p = P.data() + s * S;
+      for (int r = 0; r < S; ++r) {
+        p[r] = prior[r] * q[r] * weight;
+      }
+    }
+    double nc = 0;
+    for (int s = 0; s < S; ++s) {
+      const double *p = P.data() + s * S;
+      double column_sum = 0;
+      for (int r = 0; r < S; ++r) {
+        column_sum += p[r];
+      }
+      pi[s] = column_sum;
+      nc += column_sum;
+    }
+    P /= nc;
+    pi /= nc;
+    return m + std::log(nc);
+  }
+
+  double scaled_fwd_loglike_1(Vector &pi, const Matrix &Q,
+                              const ConstVectorView &logd, Vector &wsp) {
+    const int S = pi.size();
+    if (wsp.size() != S) wsp.resize(S);
+    const double m = max_log_density(logd);
+    const double *prior = pi.data();
+    double nc = 0;
+    for (int s = 0; s < S; ++s) {
+      const double *q = Q.data() + s * S;
+      double predicted = 0;
+      for (int r = 0; r < S; ++r) {
+        predicted += prior[r] * q[r];
+      }
+      wsp[s] = predicted * std::exp(logd[s] - m);
+      nc += wsp[s];
+    }
+    for (int s = 0; s < S; ++s) {
+      pi[s] = wsp[s] / nc;
+    }
+    return m + std::log(nc);
+  }
+
 }  // namespace BOOM
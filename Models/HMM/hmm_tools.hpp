@@ -21,6 +21,7 @@
 
 #include "LinAlg/Matrix.hpp"
 #include "LinAlg/Vector.hpp"
+#include "LinAlg/VectorView.hpp"
 
 namespace BOOM {
 
@@ -28,5 +29,26 @@ namespace BOOM {
                const Vector &one);
   void bkwd_1(Vector &pi, Matrix &P, Vector &wsp, const Vector &one);
 
+  // A version of fwd_1 that works with the transition probabilities Q
+  // rather than their logs.  Only the S emission densities are
+  // exponentiated (after subtracting their max), instead of all S^2
+  // elements of P, and the loops run down the columns of Q and P, which
+  // are contiguous.  The inputs and outputs are otherwise the same as
+  // fwd_1, and the P it produces can be passed to bkwd_1.
+  double scaled_fwd_1(Vector &pi, Matrix &P, const Matrix &Q,
+                      const ConstVectorView &logd);
+
+  // Advance the forward filter by one step when only the likelihood is
+  // needed.  Uses O(S) memory instead of the S x S matrix P.
+  // Args:
+  //   pi: On input, p(h[t-1] | Y[t-1]).  On output, p(h[t] | Y[t]).
+  //   Q: The transition probability matrix.  Rows sum to 1.
+  //   logd: logd[s] is log p(y[t] | h[t] = s).
+  //   wsp: Workspace.  Resized if needed.
+  // Returns:
+  //   log p(y[t] | Y[t-1]).
+  double scaled_fwd_loglike_1(Vector &pi, const Matrix &Q,
+                              const ConstVectorView &logd, Vector &wsp);
+
 }  // namespace BOOM
 #endif  // BOOM_HMM_TOOLS_HPP
@@ -7,6 +7,9 @@
 #include "Models/PosteriorSamplers/PoissonGammaSampler.hpp"
 #include "Models/PosteriorSamplers/MarkovConjSampler.hpp"
 #include "Models/HMM/PosteriorSamplers/HmmPosteriorSampler.hpp"
+#include "Models/HMM/HmmFilter.hpp"
+#include "Models/HMM/hmm_tools.hpp"
+#include "distributions.hpp"
 
 #include "test_utils/test_utils.hpp"
 #include <fstream>
@@ -52,6 +55,43 @@ namespace {
   TEST_F(HmmTest, Basics) {
   }
 
+  // The scaled forward step should agree with the log scale version, even
+  // when the emission densities are far out in the tails.
+  TEST_F(HmmTest, ScaledForwardStep) {
+    int S = 4;
+    Matrix Q(S, S);
+    for (int r = 0; r < S; ++r) {
+      for (int s = 0; s < S; ++s) {
+        Q(r, s) = runif(0.1, 1.0);
+      }
+      Q.row(r) /= Q.row(r).sum();
+    }
+    Vector pi(S);
+    pi.randomize();
+    pi /= pi.sum();
+    Vector logd = {-702.3, -700.1, -715.0, -699.8};
+    Vector one(S, 1.0);
+
+    Vector log_scale_pi = pi;
+    Matrix log_scale_P;
+    double log_scale_loglike =
+        fwd_1(log_scale_pi, log_scale_P, log(Q), logd, one);
+
+    Vector scaled_pi = pi;
+    Matrix scaled_P;
+    double scaled_loglike = scaled_fwd_1(scaled_pi, scaled_P, Q, logd);
+    EXPECT_NEAR(log_scale_loglike, scaled_loglike, 1e-8);
+    EXPECT_TRUE(VectorEquals(log_scale_pi, scaled_pi));
+    EXPECT_TRUE(MatrixEquals(log_scale_P, scaled_P));
+
+    Vector likelihood_only_pi = pi;
+    Vector wsp;
+    double likelihood_only_loglike =
+        scaled_fwd_loglike_1(likelihood_only_pi, Q, logd, wsp);
+    EXPECT_NEAR(log_scale_loglike, likelihood_only_loglike, 1e-8);
+    EXPECT_TRUE(VectorEquals(log_scale_pi, likelihood_only_pi));
+  }
+
   TEST_F(HmmTest, Poisson) {
     std::vector<Ptr<PoissonModel>> mixture_components;
     mixture_components.push_back(new PoissonModel(1.0));
@@ -89,11 +129,20 @@ namespace {
     model->set_method(sampler);
 
     EXPECT_EQ(lamb_data.size(), 240);
+    std::vector<Ptr<Data>> series;
     for (int i = 0; i < lamb_data.size(); ++i) {
       NEW(IntData, dp)(lamb_data[i]);
       model->add_data(dp);
+      series.push_back(dp);
     }
 
+    // The likelihood-only filter must agree with the full forward filter.
+    Ptr<HmmFilter> filter(new HmmFilter(
+        std::vector<Ptr<MixtureComponent>>(mixture_components.begin(),
+                                           mixture_components.end()),
+        mark));
+    EXPECT_NEAR(filter->fwd(series), filter->loglike(series), 1e-8);
+
     int niter = 1000;
     Matrix lambda_draws(niter, 3);
     Matrix transition_probablity_draws(niter, 3 * 3);
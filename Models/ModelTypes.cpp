@@ -23,6 +23,7 @@
 #include "Models/PosteriorSamplers/PosteriorSampler.hpp"
 #include "Models/VectorModel.hpp"
 #include "TargetFun/Loglike.hpp"
+#include "cpputil/Checkpoint.hpp"
 #include "cpputil/math_utils.hpp"
 #include "cpputil/report_error.hpp"
 #include "numopt.hpp"
@@ -58,6 +59,34 @@ namespace BOOM {
     for (uint i = 0; i < prm.size(); ++i) b = prm[i]->unvectorize(b, minimal);
   }
 
+  void Model::save_state(CheckpointWriter &checkpoint) const {
+    checkpoint.write_vector(vectorize_params(false));
+    int number_of_samplers = number_of_sampling_methods();
+    checkpoint.write_uint64(number_of_samplers);
+    for (int i = 0; i < number_of_samplers; ++i) {
+      sampler(i)->save_state(checkpoint);
+    }
+  }
+
+  void Model::restore_state(CheckpointReader &checkpoint) {
+    Vector params = checkpoint.read_vector();
+    if (params.size() != vectorize_params(false).size()) {
+      report_error(
+          "The parameter vector in the checkpoint does not match the "
+          "dimension of the model.");
+    }
+    unvectorize_params(params, false);
+    int number_of_samplers = checkpoint.read_uint64();
+    if (number_of_samplers != number_of_sampling_methods()) {
+      report_error(
+          "The checkpoint was saved from a model with a different number "
+          "of posterior samplers.");
+    }
+    for (int i = 0; i < number_of_samplers; ++i) {
+      sampler(i)->restore_state(checkpoint);
+    }
+  }
+
   //============================================================
   void PosteriorModeModel::find_posterior_mode(double epsilon) {
     if (number_of_sampling_methods() != 1) {
@@ -203,6 +232,60 @@ namespace BOOM {
     return logscale ? ans : exp(ans);
   }
 
+  void DoubleModel::fill_logp(const ConstVectorView &x,
+                              VectorView log_density) const {
+    if (log_density.size() != x.size()) {
+      report_error("x and log_density must be the same size in fill_logp.");
+    }
+    for (int i = 0; i < x.size(); ++i) {
+      log_density[i] = logp(x[i]);
+    }
+  }
+
+  void DoubleModel::fill_log_pdf(const std::vector<Ptr<Data>> &data,
+                                 VectorView log_density) const {
+    if (log_density.size() != data.size()) {
+      report_error(
+          "The log_density argument to fill_log_pdf must have one element "
+          "per data point.");
+    }
+    Vector x(data.size());
+    for (int i = 0; i < data.size(); ++i) {
+      const DoubleData *dp = dynamic_cast<const DoubleData *>(data[i].get());
+      if (!dp) {
+        report_error("DoubleModel::fill_log_pdf requires DoubleData.");
+      }
+      x[i] = dp->value();
+    }
+    fill_logp(x, log_density);
+    for (int i = 0; i < data.size(); ++i) {
+      if (data[i]->missing()) log_density[i] = 0.0;
+    }
+  }
+
+  void VectorModel::fill_logp(const Matrix &X, VectorView log_density) const {
+    if (log_density.size() != X.nrow()) {
+      report_error("log_density must have one element per row of X in "
+                   "fill_logp.");
+    }
+    for (int i = 0; i < X.nrow(); ++i) {
+      log_density[i] = logp(X.row(i));
+    }
+  }
+
+  //======================================================================
+  void MixtureComponent::fill_log_pdf(const std::vector<Ptr<Data>> &data,
+                                      VectorView log_density) const {
+    if (log_density.size() != data.size()) {
+      report_error(
+          "The log_density argument to fill_log_pdf must have one element "
+          "per data point.");
+    }
+    for (int i = 0; i < data.size(); ++i) {
+      const Data *dp = data[i].get();
+      log_density[i] = dp->missing() ? 0.0 : pdf(dp, true);
+    }
+  }
   //======================================================================
   double DiffDoubleModel::logp(double x) const {
     double g(0), h(0);
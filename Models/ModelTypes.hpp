@@ -31,6 +31,8 @@
 namespace BOOM {
 
   class PosteriorSampler;
+  class CheckpointWriter;
+  class CheckpointReader;
 
   // A Model is the basic unit of operation in statistical learning.
   // In BOOM, each Model manages Params, Data, and learning methods.
@@ -95,6 +97,17 @@ namespace BOOM {
     virtual int number_of_sampling_methods() const = 0;
     virtual PosteriorSampler *sampler(int i) = 0;
     virtual PosteriorSampler const *const sampler(int i) const = 0;
+
+    //------------ checkpointing ---------------------------
+    // Write everything needed to resume an MCMC run: the (non-minimal)
+    // parameter vector, followed by the state of each posterior sampler.
+    // Models with state that is not part of their Params (e.g. the trees
+    // in a Bart model) should override both functions and call the base
+    // class versions.  restore_state() must read exactly what
+    // save_state() wrote.  The model must have the same structure (and
+    // the same samplers) when it is restored as when it was saved.
+    virtual void save_state(CheckpointWriter &checkpoint) const;
+    virtual void restore_state(CheckpointReader &checkpoint);
   };
 
   //============= mix-in classes =========================================
@@ -267,6 +280,19 @@ namespace BOOM {
 
     virtual double pdf(const Data *, bool logscale) const = 0;
 
+    // Evaluate the log density of each element of 'data' in a single call,
+    // so that callers filtering long sequences (e.g. hidden Markov models)
+    // pay one virtual call per sequence rather than one per observation.
+    // Args:
+    //   data:  The data points to evaluate.
+    //   log_density: On output, log_density[i] is pdf(data[i], true), or 0
+    //     if data[i] is missing.  Must have the same size as 'data'.
+    //
+    // The default implementation calls pdf() once per observation.  Models
+    // with a cheaper vectorized density may override it.
+    virtual void fill_log_pdf(const std::vector<Ptr<Data>> &data,
+                              VectorView log_density) const;
+
     // The number of data points that have been allocated to this model.  This
     // might have been called "sample_size", but that sometimes refers to
     // certain model parameters, such as the beta distribution.
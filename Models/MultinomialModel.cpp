@@ -221,6 +221,28 @@ namespace BOOM {
     return logscale ? logp_[i] : pi(i);
   }
 
+  void MM::fill_log_pdf(const std::vector<Ptr<Data>> &data,
+                        VectorView log_density) const {
+    if (log_density.size() != data.size()) {
+      report_error(
+          "The log_density argument to fill_log_pdf must have one element "
+          "per data point.");
+    }
+    check_logp();
+    const uint nlevels = dim();
+    for (int i = 0; i < data.size(); ++i) {
+      if (data[i]->missing()) {
+        log_density[i] = 0.0;
+        continue;
+      }
+      uint level = DAT(data[i])->value();
+      if (level >= nlevels) {
+        report_error("too large a value passed to MultinomialModel::pdf");
+      }
+      log_density[i] = logp_[level];
+    }
+  }
+
   uint MM::sim(RNG &rng) const { return rmulti_mt(rng, pi()); }
 
   void MM::add_mixture_data(const Ptr<Data> &dp, double prob) {
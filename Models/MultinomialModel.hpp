@@ -97,6 +97,8 @@ namespace BOOM {
     void mle() override;
     double pdf(const Data *dp, bool logscale) const override;
     double pdf(const Ptr<Data> &dp, bool logscale) const;
+    void fill_log_pdf(const std::vector<Ptr<Data>> &data,
+                      VectorView log_density) const override;
     void add_mixture_data(const Ptr<Data> &, double prob);
     int number_of_observations() const override { return suf()->n().sum(); }
 
@@ -19,6 +19,7 @@
 
 #include "Models/MvnBase.hpp"
 #include "Models/SufstatAbstractCombineImpl.hpp"
+#include "cpputil/Constants.hpp"
 #include "distributions.hpp"
 #include "numopt/initialize_derivatives.hpp"
 
@@ -220,6 +221,29 @@ namespace BOOM {
     return ans;
   }
 
+  void MvnBase::fill_logp(const Matrix &X, VectorView log_density) const {
+    if (log_density.size() != X.nrow()) {
+      report_error("log_density must have one element per row of X in "
+                   "fill_logp.");
+    }
+    const int p = dim();
+    if (X.ncol() != p) {
+      report_error("X has the wrong number of columns in MvnBase::fill_logp.");
+    }
+    const Vector &mean(mu());
+    Matrix centered(X);
+    for (int j = 0; j < p; ++j) {
+      centered.col(j) -= mean[j];
+    }
+    Matrix scaled = centered * siginv();
+    const double normalizing_constant =
+        0.5 * (ldsi() - p * Constants::log_2pi);
+    for (int i = 0; i < X.nrow(); ++i) {
+      log_density[i] =
+          normalizing_constant - 0.5 * centered.row(i).dot(scaled.row(i));
+    }
+  }
+
   double MvnBase::logp_given_inclusion(const Vector &x_subset, Vector *gradient,
                                        Matrix *Hessian,
                                        const Selector &included,
@@ -95,6 +95,11 @@ namespace BOOM {
     virtual uint dim() const;
     double Logp(const Vector &x_subset, Vector &gradient, Matrix &Hessian,
                 uint nderiv) const override;
+
+    // Evaluates the log density at each row of X with a single matrix
+    // multiplication, rather than one quadratic form per row.
+    void fill_logp(const Matrix &X, VectorView log_density) const override;
+
     // Args:
     //   x_subset: A subset (determined by 'inclusion') of the vector of random
     //     variables measured by this model.
@@ -58,6 +58,25 @@ namespace BOOM {
     return logscale ? ans : exp(ans);
   }
 
+  void MvnModel::fill_log_pdf(const std::vector<Ptr<Data>> &data,
+                              VectorView log_density) const {
+    if (log_density.size() != data.size()) {
+      report_error(
+          "The log_density argument to fill_log_pdf must have one element "
+          "per data point.");
+    }
+    Matrix X(data.size(), dim());
+    for (int i = 0; i < data.size(); ++i) {
+      // Missing rows are filled with the mean so that they are harmless in
+      // the matrix multiplication, then given log density 0 below.
+      X.row(i) = data[i]->missing() ? mu() : DAT(data[i])->value();
+    }
+    fill_logp(X, log_density);
+    for (int i = 0; i < data.size(); ++i) {
+      if (data[i]->missing()) log_density[i] = 0.0;
+    }
+  }
+
   Vector MvnModel::sim(RNG &rng) const {
     return rmvn_L_mt(rng, mu(), Sigma_chol());
   }
@@ -77,6 +77,8 @@ namespace BOOM {
     double pdf(const Ptr<Data> &dp, bool logscale) const;
     double pdf(const Data *, bool logscale) const override;
     double pdf(const Vector &x, bool logscale) const;
+    void fill_log_pdf(const std::vector<Ptr<Data>> &data,
+                      VectorView log_density) const override;
     int number_of_observations() const override { return dat().size(); }
 
     Vector sim(RNG &rng = GlobalRng::rng) const override;
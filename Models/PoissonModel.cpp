@@ -188,6 +188,30 @@ namespace BOOM {
   double PoissonModel::pdf(const Data *dp, bool logscale) const {
     return dpois(DAT(dp)->value(), lam(), logscale);
   }
+  void PoissonModel::fill_log_pdf(const std::vector<Ptr<Data>> &data,
+                                  VectorView log_density) const {
+    const double lambda = lam();
+    if (lambda <= 0) {
+      MixtureComponent::fill_log_pdf(data, log_density);
+      return;
+    }
+    if (log_density.size() != data.size()) {
+      report_error(
+          "The log_density argument to fill_log_pdf must have one element "
+          "per data point.");
+    }
+    const double log_lambda = log(lambda);
+    for (int i = 0; i < data.size(); ++i) {
+      if (data[i]->missing()) {
+        log_density[i] = 0.0;
+        continue;
+      }
+      int y = DAT(data[i])->value();
+      log_density[i] = y < 0 ? negative_infinity()
+                             : y * log_lambda - lambda - lgamma(y + 1.0);
+    }
+  }
+
   double PoissonModel::mean() const { return lam(); }
   double PoissonModel::var() const { return lam(); }
   double PoissonModel::sd() const { return sqrt(lam()); }
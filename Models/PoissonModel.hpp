@@ -103,6 +103,8 @@ namespace BOOM {
     double pdf(const Data *x, bool logscale) const override;
     double pdf(uint x, bool logscale) const;
     double logp(int x) const override;
+    void fill_log_pdf(const std::vector<Ptr<Data>> &data,
+                      VectorView log_density) const override;
     int number_of_observations() const override { return dat().size(); }
 
     // moments and summaries:
@@ -67,7 +67,13 @@ namespace BOOM {
     Ptr<S> suf() {return suf_;}
     void clear_suf() { suf_->clear(); }
     void update_suf(const Ptr<DataType> &d) { suf_->update(d); }
-    void refresh_suf();
+
+    // Rebuild suf() from dat().  This is virtual so that set_data(),
+    // operator=, and the other entry points that refresh the sufficient
+    // statistics pick up the behavior of child classes that keep data
+    // outside of dat().  As usual, a call made from a constructor of this
+    // class does not dispatch to the child.
+    virtual void refresh_suf();
     void set_suf(const Ptr<S> &s) { suf_ = s; }
 
    private:
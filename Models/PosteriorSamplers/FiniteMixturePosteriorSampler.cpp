@@ -0,0 +1,119 @@
+// Copyright 2018 Google LLC. All Rights Reserved.
+/*
+  Copyright (C) 2005-2012 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include "Models/PosteriorSamplers/FiniteMixturePosteriorSampler.hpp"
+
+namespace BOOM {
+
+  namespace {
+    using FMPS = FiniteMixturePosteriorSampler;
+  }  // namespace
+
+  FiniteMixtureDataImputer::FiniteMixtureDataImputer(
+      FiniteMixtureModel *model, std::mutex &mutex, RNG &seeding_rng)
+      : LatentDataImputerWorker(mutex),
+        model_(model),
+        begin_(0),
+        end_(0),
+        mixing_distribution_(
+            new MultinomialModel(model->number_of_mixture_components())),
+        loglike_(0),
+        rng_(seeding_rng.spawn()) {
+    for (int s = 0; s < model_->number_of_mixture_components(); ++s) {
+      Ptr<MixtureComponent> component = model_->mixture_component(s)->clone();
+      component->clear_data();
+      components_.push_back(component);
+    }
+  }
+
+  void FiniteMixtureDataImputer::refresh_parameters() {
+    model_->copy_parameters_to(components_);
+  }
+
+  void FiniteMixtureDataImputer::impute_latent_data() {
+    for (auto &component : components_) {
+      component->clear_data();
+    }
+    mixing_distribution_->clear_data();
+    loglike_ = model_->impute_latent_data_range(
+        begin_, end_, components_, *mixing_distribution_, rng_);
+  }
+
+  void FiniteMixtureDataImputer::combine_complete_data() {
+    model_->combine_complete_data(components_, *mixing_distribution_,
+                                  loglike_);
+  }
+
+  //======================================================================
+  FMPS::FiniteMixturePosteriorSampler(FiniteMixtureModel *model,
+                                      RNG &seeding_rng,
+                                      int number_of_threads)
+      : PosteriorSampler(seeding_rng), model_(model) {
+    // Assigning ranges of observations to workers is cheap, so do it each
+    // time in case data have been added to the model.
+    reassign_data_each_time(true);
+    if (number_of_threads > 1) {
+      set_number_of_workers(number_of_threads);
+    }
+  }
+
+  double FMPS::logpri() const {
+    double ans = model_->mixing_distribution()->logpri();
+    int S = model_->number_of_mixture_components();
+    for (int s = 0; s < S; ++s) {
+      ans += model_->mixture_component(s)->logpri();
+    }
+    return ans;
+  }
+
+  void FMPS::draw() {
+    impute_latent_data();
+    model_->mixing_distribution()->sample_posterior();
+    for (int s = 0; s < model_->number_of_mixture_components(); ++s) {
+      model_->mixture_component(s)->sample_posterior();
+    }
+  }
+
+  void FMPS::impute_latent_data() {
+    if (workers().empty()) {
+      model_->impute_latent_data(rng());
+    } else {
+      for (auto &worker : workers()) {
+        worker->refresh_parameters();
+      }
+      LatentDataSampler<FiniteMixtureDataImputer>::impute_latent_data();
+    }
+  }
+
+  Ptr<FiniteMixtureDataImputer> FMPS::create_worker(std::mutex &m) {
+    return new FiniteMixtureDataImputer(model_, m, rng());
+  }
+
+  void FMPS::assign_data_to_workers() {
+    int number_of_workers = workers().size();
+    long nobs = model_->dat().size();
+    for (int i = 0; i < number_of_workers; ++i) {
+      workers()[i]->set_range(nobs * i / number_of_workers,
+                              nobs * (i + 1) / number_of_workers);
+    }
+  }
+
+  void FMPS::clear_latent_data() { model_->prepare_to_impute_latent_data(); }
+
+}  // namespace BOOM
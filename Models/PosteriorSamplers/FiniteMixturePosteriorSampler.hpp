@@ -21,32 +21,71 @@
 #define BOOM_FINITE_MIXTURE_POSTERIOR_SAMPLER_HPP_
 
 #include "Models/FiniteMixtureModel.hpp"
+#include "Models/PosteriorSamplers/Imputer.hpp"
 #include "Models/PosteriorSamplers/PosteriorSampler.hpp"
 
 namespace BOOM {
-  class FiniteMixturePosteriorSampler : public PosteriorSampler {
+
+  // Imputes the latent class for a range of observations in a
+  // FiniteMixtureModel.  Densities are evaluated, and the complete data are
+  // stored, in the worker's own copies of the mixture components and mixing
+  // distribution.  The complete data are merged with the model's complete
+  // data after imputation.
+  class FiniteMixtureDataImputer : public LatentDataImputerWorker {
    public:
-    explicit FiniteMixturePosteriorSampler(FiniteMixtureModel *model,
-                                           RNG &seeding_rng = GlobalRng::rng)
-        : PosteriorSampler(seeding_rng), model_(model) {}
-
-    double logpri() const override {
-      double ans = model_->mixing_distribution()->logpri();
-      int S = model_->number_of_mixture_components();
-      for (int s = 0; s < S; ++s) {
-        ans += model_->mixture_component(s)->logpri();
-      }
-      return ans;
-    }
+    FiniteMixtureDataImputer(FiniteMixtureModel *model, std::mutex &mutex,
+                             RNG &seeding_rng = GlobalRng::rng);
 
-    void draw() override {
-      model_->impute_latent_data(rng());
-      model_->mixing_distribution()->sample_posterior();
-      for (int s = 0; s < model_->number_of_mixture_components(); ++s) {
-        model_->mixture_component(s)->sample_posterior();
-      }
+    void set_range(int begin, int end) {
+      begin_ = begin;
+      end_ = end;
+    }
+    int number_of_observations_managed() const override {
+      return end_ - begin_;
     }
 
+    // Copy the model's current parameters to this worker's mixture
+    // components.  Call from the thread that owns the model before the
+    // workers start.
+    void refresh_parameters();
+
+    void impute_latent_data() override;
+    void combine_complete_data() override;
+
+   private:
+    FiniteMixtureModel *model_;
+    int begin_;
+    int end_;
+    std::vector<Ptr<MixtureComponent>> components_;
+    Ptr<MultinomialModel> mixing_distribution_;
+    double loglike_;
+    RNG rng_;
+  };
+
+  //======================================================================
+  class FiniteMixturePosteriorSampler
+      : public PosteriorSampler,
+        public LatentDataSampler<FiniteMixtureDataImputer> {
+   public:
+    // Args:
+    //   model:  The model to be sampled.
+    //   seeding_rng: The RNG used to seed this sampler's RNG and the RNG's
+    //     used by the imputation workers.
+    //   number_of_threads: The number of threads to use for data
+    //     augmentation.  If this is 1 the latent data are imputed by the
+    //     model, using the sampler's RNG.
+    explicit FiniteMixturePosteriorSampler(FiniteMixtureModel *model,
+                                           RNG &seeding_rng = GlobalRng::rng,
+                                           int number_of_threads = 1);
+
+    double logpri() const override;
+    void draw() override;
+
+    void impute_latent_data() override;
+    Ptr<FiniteMixtureDataImputer> create_worker(std::mutex &m) override;
+    void assign_data_to_workers() override;
+    void clear_latent_data() override;
+
    private:
     FiniteMixtureModel *model_;
   };
@@ -130,7 +130,7 @@ namespace BOOM {
     //     generator is provided it will be used as the source of randomness.
     //     Otherwise a new RNG will be created.
     //   seeding_rng: If a new random number generator must be created, then
-    //     this RNG will be used to seed it with an initial value.
+    //     this RNG will be split to give the new generator its own stream.
     SufstatImputeWorker(SUFFICIENT_STATISTICS &global_suf,
                         std::mutex &global_suf_mutex, RNG *rng = nullptr,
                         RNG &seeding_rng = GlobalRng::rng)
@@ -138,7 +138,7 @@ namespace BOOM {
           suf_(global_suf.clone()),
           global_suf_(global_suf) {
       if (!rng) {
-        rng_storage_.reset(new RNG(seed_rng(seeding_rng)));
+        rng_storage_.reset(new RNG(seeding_rng.spawn()));
         rng_ = rng_storage_.get();
       } else {
         rng_ = rng;
@@ -181,6 +181,13 @@ namespace BOOM {
 
     void combine_complete_data() override { global_suf_.combine(*suf_); }
 
+   protected:
+    // Access to the worker-local sufficient statistics and RNG, for child
+    // classes that impute latent data from sources other than the observed
+    // data range.
+    SUFFICIENT_STATISTICS *local_suf() { return suf_.get(); }
+    RNG &local_rng() { return *rng_; }
+
    private:
     Ptr<SUFFICIENT_STATISTICS> suf_;
     SUFFICIENT_STATISTICS &global_suf_;
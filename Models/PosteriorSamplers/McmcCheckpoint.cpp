@@ -0,0 +1,214 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include "Models/PosteriorSamplers/McmcCheckpoint.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+#include "cpputil/Checkpoint.hpp"
+#include "cpputil/report_error.hpp"
+#include "distributions/rng.hpp"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace BOOM {
+
+  namespace {
+    const char kMagic[8] = {'B', 'O', 'O', 'M', 'C', 'K', 'P', 'T'};
+    const std::uint32_t kVersion = 1;
+    const std::uint32_t kByteOrderMark = 0x01020304;
+
+    // The 64-bit FNV-1a hash of 'data'.
+    std::uint64_t checksum(const std::vector<char> &data) {
+      std::uint64_t ans = 14695981039346656037ULL;
+      for (char c : data) {
+        ans ^= static_cast<unsigned char>(c);
+        ans *= 1099511628211ULL;
+      }
+      return ans;
+    }
+
+    template <class T>
+    bool write_value(std::FILE *file, const T &value) {
+      return std::fwrite(&value, sizeof(T), 1, file) == 1;
+    }
+
+    template <class T>
+    T read_value(std::istream &in, const std::string &filename) {
+      T ans;
+      if (!in.read(reinterpret_cast<char *>(&ans), sizeof(T))) {
+        report_error("Unexpected end of checkpoint file " + filename + ".");
+      }
+      return ans;
+    }
+
+    // Flushes 'file' and asks the operating system to commit it to disk,
+    // so a crash after the file is renamed cannot leave a truncated
+    // checkpoint in place of a good one.
+    bool sync_file(std::FILE *file) {
+      if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+      return _commit(_fileno(file)) == 0;
+#else
+      return fsync(fileno(file)) == 0;
+#endif
+    }
+  }  // namespace
+
+  McmcCheckpoint::McmcCheckpoint(const std::string &filename,
+                                 bool include_global_rng)
+      : filename_(filename), include_global_rng_(include_global_rng) {}
+
+  McmcCheckpoint::~McmcCheckpoint() {
+    // Exceptions must not escape the destructor.  A failed final write is
+    // indistinguishable from being interrupted before it.
+    if (writer_.joinable()) writer_.join();
+  }
+
+  void McmcCheckpoint::add_model(const Ptr<Model> &model) {
+    models_.push_back(model);
+  }
+
+  //----------------------------------------------------------------------
+  void McmcCheckpoint::save(std::int64_t iteration) {
+    wait();
+    CheckpointWriter checkpoint;
+    if (include_global_rng_) {
+      checkpoint.write_uint64_vector(GlobalRng::rng.state());
+    }
+    checkpoint.write_uint64(models_.size());
+    for (const auto &model : models_) {
+      model->save_state(checkpoint);
+    }
+    std::vector<char> payload(checkpoint.bytes());
+    writer_ = std::thread(&McmcCheckpoint::write_file, this, iteration,
+                          std::move(payload));
+  }
+
+  //----------------------------------------------------------------------
+  void McmcCheckpoint::wait() {
+    if (writer_.joinable()) writer_.join();
+    if (!write_error_.empty()) {
+      std::string err;
+      std::swap(err, write_error_);
+      report_error(err);
+    }
+  }
+
+  //----------------------------------------------------------------------
+  void McmcCheckpoint::write_file(std::int64_t iteration,
+                                  std::vector<char> payload) {
+    std::string temp_filename = filename_ + ".tmp";
+    std::FILE *file = std::fopen(temp_filename.c_str(), "wb");
+    if (!file) {
+      write_error_ = "Could not open " + temp_filename + " for writing.";
+      return;
+    }
+    bool ok = std::fwrite(kMagic, 1, 8, file) == 8 &&
+              write_value(file, kVersion) &&
+              write_value(file, kByteOrderMark) &&
+              write_value(file, iteration) &&
+              write_value<std::uint64_t>(file, payload.size()) &&
+              write_value(file, checksum(payload)) &&
+              std::fwrite(payload.data(), 1, payload.size(), file) ==
+                  payload.size();
+    ok = ok && sync_file(file);
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok) {
+      std::remove(temp_filename.c_str());
+      write_error_ = "Error writing checkpoint file " + temp_filename + ".";
+      return;
+    }
+#ifdef _WIN32
+    // rename() will not replace an existing file on Windows.
+    std::remove(filename_.c_str());
+#endif
+    if (std::rename(temp_filename.c_str(), filename_.c_str()) != 0) {
+      write_error_ = "Could not rename " + temp_filename + " to " +
+                     filename_ + ".";
+    }
+  }
+
+  //----------------------------------------------------------------------
+  std::int64_t McmcCheckpoint::restore() {
+    wait();
+    std::ifstream in(filename_, std::ios::binary);
+    if (!in) {
+      return -1;
+    }
+    char magic[8];
+    if (!in.read(magic, 8) || std::memcmp(magic, kMagic, 8) != 0) {
+      report_error(filename_ + " is not a BOOM checkpoint file.");
+    }
+    std::uint32_t version = read_value<std::uint32_t>(in, filename_);
+    if (version != kVersion) {
+      std::ostringstream err;
+      err << "Unsupported checkpoint version " << version << " in "
+          << filename_ << ".";
+      report_error(err.str());
+    }
+    if (read_value<std::uint32_t>(in, filename_) != kByteOrderMark) {
+      report_error(filename_ + " was written with a different byte order.");
+    }
+    std::int64_t iteration = read_value<std::int64_t>(in, filename_);
+    std::uint64_t payload_size = read_value<std::uint64_t>(in, filename_);
+    std::uint64_t expected_checksum = read_value<std::uint64_t>(in, filename_);
+    // Check the recorded size against the file before allocating, so a
+    // corrupt header cannot ask for an enormous buffer.
+    std::streampos payload_start = in.tellg();
+    in.seekg(0, std::ios::end);
+    std::streamoff bytes_remaining = in.tellg() - payload_start;
+    in.seekg(payload_start);
+    if (!in || payload_size > static_cast<std::uint64_t>(bytes_remaining)) {
+      report_error("Checkpoint file " + filename_ + " is truncated.");
+    }
+    std::vector<char> payload(payload_size);
+    if (!in.read(payload.data(), payload_size)) {
+      report_error("Checkpoint file " + filename_ + " is truncated.");
+    }
+    if (checksum(payload) != expected_checksum) {
+      report_error("Checkpoint file " + filename_ + " is corrupt.");
+    }
+
+    CheckpointReader checkpoint(std::move(payload));
+    if (include_global_rng_) {
+      GlobalRng::rng.set_state(checkpoint.read_uint64_vector());
+    }
+    if (checkpoint.read_uint64() != models_.size()) {
+      report_error("The checkpoint in " + filename_ +
+                   " was saved with a different number of models.");
+    }
+    for (const auto &model : models_) {
+      model->restore_state(checkpoint);
+    }
+    if (!checkpoint.at_end()) {
+      report_error("The checkpoint in " + filename_ +
+                   " has more data than the models could restore.");
+    }
+    return iteration;
+  }
+
+}  // namespace BOOM
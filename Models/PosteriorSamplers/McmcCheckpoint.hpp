@@ -0,0 +1,123 @@
+#ifndef BOOM_POSTERIOR_SAMPLERS_MCMC_CHECKPOINT_HPP_
+#define BOOM_POSTERIOR_SAMPLERS_MCMC_CHECKPOINT_HPP_
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Models/ModelTypes.hpp"
+#include "cpputil/Ptr.hpp"
+
+namespace BOOM {
+
+  // Saves the complete state of a running MCMC simulation to a file, so
+  // that a job that is interrupted can resume where it left off instead of
+  // starting over.  The state consists of each registered model's
+  // Model::save_state() (its parameters, the state of its posterior
+  // samplers including their RNGs, and anything else the model chooses to
+  // save), along with GlobalRng::rng, which some samplers use.
+  //
+  // For samplers whose state is fully captured this way, a restored run
+  // produces exactly the same draws as an uninterrupted run.  (Samplers
+  // holding state that affects future draws must override
+  // PosteriorSampler::save_state() for this to hold.)
+  //
+  // Saving happens in two stages.  The state is serialized to memory in the
+  // calling thread, which is fast, and then written to disk by a
+  // background thread while the chain continues.  Files are written to
+  // "<filename>.tmp" and then renamed to <filename>, so a crash during a
+  // write leaves the previous checkpoint intact.
+  //
+  // File format (native byte order):
+  //   * The 8 characters "BOOMCKPT".
+  //   * uint32: the format version (currently 1).
+  //   * uint32: 0x01020304, used to detect a byte order mismatch.
+  //   * int64: the iteration number passed to save().
+  //   * uint64: the number of bytes in the payload.
+  //   * uint64: a checksum (64-bit FNV-1a) of the payload.
+  //   * The payload, as written by CheckpointWriter.
+  //
+  // Typical use:
+  //   McmcCheckpoint checkpoint("my_model.ckpt");
+  //   checkpoint.add_model(model);
+  //   int start = checkpoint.restore() + 1;  // 0 if there is no checkpoint.
+  //   for (int i = start; i < niter; ++i) {
+  //     model->sample_posterior();
+  //     if (i % 100 == 0) checkpoint.save(i);
+  //   }
+  class McmcCheckpoint {
+   public:
+    // Args:
+    //   filename:  The name of the checkpoint file.
+    //   include_global_rng: If true the state of GlobalRng::rng is saved and
+    //     restored along with the models.
+    explicit McmcCheckpoint(const std::string &filename,
+                            bool include_global_rng = true);
+
+    // Waits for any pending write to finish.
+    ~McmcCheckpoint();
+
+    McmcCheckpoint(const McmcCheckpoint &rhs) = delete;
+    McmcCheckpoint &operator=(const McmcCheckpoint &rhs) = delete;
+
+    // Adds a model to the set of models being checkpointed.  Models are
+    // saved in the order they are added, and must be added in the same
+    // order (with the same structure) before calling restore().  Composite
+    // models whose components have their own samplers should add each
+    // component.
+    void add_model(const Ptr<Model> &model);
+
+    // Record the state of every model, tagged with 'iteration'.  Returns as
+    // soon as the state has been copied to memory.  The file is written in
+    // the background.  If an earlier write is still in progress this waits
+    // for it to finish first.
+    void save(std::int64_t iteration);
+
+    // Block until any background write has finished.  Throws an exception
+    // if the write failed.
+    void wait();
+
+    // Restore the state of every model from the checkpoint file.
+    // Returns:
+    //   The iteration number passed to save() when the checkpoint was
+    //   written, or -1 if the checkpoint file does not exist (in which
+    //   case nothing is changed).
+    std::int64_t restore();
+
+    const std::string &filename() const { return filename_; }
+
+   private:
+    // Write the checkpoint to disk.  Runs in writer_.
+    void write_file(std::int64_t iteration, std::vector<char> payload);
+
+    std::string filename_;
+    bool include_global_rng_;
+    std::vector<Ptr<Model>> models_;
+
+    std::thread writer_;
+    // Set by writer_ if the write fails.  Only read after writer_ has been
+    // joined.
+    std::string write_error_;
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_POSTERIOR_SAMPLERS_MCMC_CHECKPOINT_HPP_
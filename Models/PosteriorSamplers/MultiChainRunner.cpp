@@ -0,0 +1,216 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include "Models/PosteriorSamplers/MultiChainRunner.hpp"
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <future>
+#include "cpputil/math_utils.hpp"
+#include "cpputil/ThreadTools.hpp"
+#include "cpputil/report_error.hpp"
+
+namespace BOOM {
+
+  MultiChainRunner::MultiChainRunner(int number_of_chains,
+                                     const ModelBuilder &builder,
+                                     const RNG &seeding_rng)
+      : parameter_dimension_(-1), number_of_draws_(0) {
+    if (number_of_chains <= 0) {
+      report_error("MultiChainRunner needs at least one chain.");
+    }
+    chains_.resize(number_of_chains);
+    for (int i = 0; i < number_of_chains; ++i) {
+      RNG chain_rng = seeding_rng.split(i);
+      chains_[i].model = builder(i, chain_rng);
+      if (!chains_[i].model) {
+        report_error("The model builder returned a null model.");
+      }
+      int dim = chains_[i].model->vectorize_params(true).size();
+      if (i == 0) {
+        parameter_dimension_ = dim;
+      } else if (dim != parameter_dimension_) {
+        report_error("All chains must have the same number of parameters.");
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------
+  void MultiChainRunner::run(int niter, int burn, int number_of_threads) {
+    if (niter < 0 || burn < 0) {
+      report_error("Iteration counts must be non-negative.");
+    }
+    number_of_draws_ = niter;
+    for (auto &chain : chains_) {
+      chain.draws.resize(niter, parameter_dimension_);
+      chain.mean.resize(parameter_dimension_);
+      chain.mean = 0.0;
+      chain.sum_of_squares.resize(parameter_dimension_);
+      chain.sum_of_squares = 0.0;
+    }
+
+    if (number_of_threads <= 0) {
+      number_of_threads = number_of_chains();
+    }
+    if (number_of_threads == 1) {
+      for (int i = 0; i < number_of_chains(); ++i) {
+        run_chain(i, niter, burn);
+      }
+      return;
+    }
+
+    ThreadWorkerPool pool(number_of_threads);
+    std::vector<std::future<void>> futures;
+    futures.reserve(number_of_chains());
+    for (int i = 0; i < number_of_chains(); ++i) {
+      futures.emplace_back(pool.submit(
+          [this, i, niter, burn]() { run_chain(i, niter, burn); }));
+    }
+    // get() passes exceptions thrown by a chain back to this thread.  Every
+    // future is waited on before any exception propagates, so no chain is
+    // left running against a destroyed pool.
+    std::exception_ptr error;
+    for (auto &future : futures) {
+      try {
+        future.get();
+      } catch (...) {
+        if (!error) error = std::current_exception();
+      }
+    }
+    if (error) std::rethrow_exception(error);
+  }
+
+  //----------------------------------------------------------------------
+  void MultiChainRunner::run_chain(int chain_index, int niter, int burn) {
+    Chain &chain(chains_[chain_index]);
+    for (int i = 0; i < burn; ++i) {
+      chain.model->sample_posterior();
+    }
+    for (int i = 0; i < niter; ++i) {
+      chain.model->sample_posterior();
+      chain.draws.row(i) = chain.model->vectorize_params(true);
+      ConstVectorView draw(chain.draws.row(i));
+      double n = i + 1;
+      for (int j = 0; j < parameter_dimension_; ++j) {
+        double delta = draw[j] - chain.mean[j];
+        chain.mean[j] += delta / n;
+        chain.sum_of_squares[j] += delta * (draw[j] - chain.mean[j]);
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------
+  void MultiChainRunner::variance_components(int j, double &within,
+                                             double &between) const {
+    int nchains = number_of_chains();
+    double n = number_of_draws_;
+    within = 0;
+    double grand_mean = 0;
+    for (const auto &chain : chains_) {
+      within += chain.sum_of_squares[j] / (n - 1);
+      grand_mean += chain.mean[j];
+    }
+    within /= nchains;
+    grand_mean /= nchains;
+    between = 0;
+    if (nchains > 1) {
+      for (const auto &chain : chains_) {
+        double delta = chain.mean[j] - grand_mean;
+        between += delta * delta;
+      }
+      between /= nchains - 1;
+    }
+  }
+
+  //----------------------------------------------------------------------
+  Vector MultiChainRunner::rhat() const {
+    if (number_of_chains() < 2 || number_of_draws_ < 2) {
+      report_error("R-hat requires at least two chains with two draws each.");
+    }
+    double n = number_of_draws_;
+    Vector ans(parameter_dimension_);
+    for (int j = 0; j < parameter_dimension_; ++j) {
+      double within, between;
+      variance_components(j, within, between);
+      if (within <= 0) {
+        ans[j] = between > 0 ? infinity() : 1.0;
+      } else {
+        double pooled_variance = (n - 1) * within / n + between;
+        ans[j] = std::sqrt(pooled_variance / within);
+      }
+    }
+    return ans;
+  }
+
+  //----------------------------------------------------------------------
+  Vector MultiChainRunner::effective_sample_size() const {
+    int n = number_of_draws_;
+    int nchains = number_of_chains();
+    double total_draws = static_cast<double>(n) * nchains;
+    if (n < 4) {
+      report_error("Effective sample size requires at least 4 draws.");
+    }
+    Vector ans(parameter_dimension_);
+    for (int j = 0; j < parameter_dimension_; ++j) {
+      double within, between;
+      variance_components(j, within, between);
+      double pooled_variance = (n - 1.0) * within / n + between;
+      if (pooled_variance <= 0) {
+        ans[j] = total_draws;
+        continue;
+      }
+
+      // Returns the autocorrelation at the given lag, pooled across chains.
+      auto autocorrelation = [&](int lag) {
+        double autocovariance = 0;
+        for (const auto &chain : chains_) {
+          ConstVectorView x(chain.draws.col(j));
+          double mean = chain.mean[j];
+          double sum = 0;
+          for (int i = 0; i + lag < n; ++i) {
+            sum += (x[i] - mean) * (x[i + lag] - mean);
+          }
+          autocovariance += sum / n;
+        }
+        autocovariance /= nchains;
+        return 1.0 - (within - autocovariance) / pooled_variance;
+      };
+
+      // Geyer's initial monotone sequence: sum pairs of autocorrelations
+      // until a pair sum becomes negative, forcing the pair sums to be
+      // non-increasing.
+      double previous_pair = autocorrelation(0) + autocorrelation(1);
+      double sum_of_pairs = previous_pair;
+      for (int lag = 2; lag + 1 < n; lag += 2) {
+        double pair = autocorrelation(lag) + autocorrelation(lag + 1);
+        if (pair < 0) break;
+        pair = std::min(pair, previous_pair);
+        sum_of_pairs += pair;
+        previous_pair = pair;
+      }
+      double integrated_autocorrelation_time = -1 + 2 * sum_of_pairs;
+      // Anticorrelated chains can produce more effective draws than actual
+      // draws, but the estimate is unstable, so it is capped as in Stan.
+      double min_time = 1.0 / std::log10(total_draws);
+      ans[j] = total_draws /
+          std::max(integrated_autocorrelation_time, min_time);
+    }
+    return ans;
+  }
+
+}  // namespace BOOM
@@ -0,0 +1,156 @@
+#ifndef BOOM_POSTERIOR_SAMPLERS_MULTI_CHAIN_RUNNER_HPP_
+#define BOOM_POSTERIOR_SAMPLERS_MULTI_CHAIN_RUNNER_HPP_
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <functional>
+#include <vector>
+
+#include "LinAlg/Matrix.hpp"
+#include "LinAlg/Vector.hpp"
+#include "Models/ModelTypes.hpp"
+#include "cpputil/Ptr.hpp"
+#include "distributions/rng.hpp"
+
+namespace BOOM {
+
+  // Runs several independent MCMC chains for the same model in parallel, one
+  // chain per task on a ThreadWorkerPool.  Each chain has its own Model
+  // object (and thus its own parameters and posterior samplers), but the
+  // chains can share their data.  Data objects are held by Ptr, so the
+  // builder that creates each chain's model can pass the same Ptr<Data> (or
+  // the same columnar data store) to every chain instead of copying it.
+  // Shared data must be treated as read-only by the samplers.
+  //
+  // Each chain's model is seeded from its own RNG stream, obtained by
+  // splitting the seeding RNG on the chain index, so a run is reproducible
+  // regardless of the number of threads.  Samplers that draw from
+  // GlobalRng::rng are not thread safe, and should not be used here.
+  //
+  // Draws of model->vectorize_params(true) are stored in preallocated
+  // matrices, one per chain.  Running means and variances are updated as
+  // each draw is stored, so the potential scale reduction factor (R-hat)
+  // costs O(chains) per parameter at any point after a run.  The effective
+  // sample size is more expensive (see effective_sample_size()).
+  //
+  // Typical use:
+  //   std::vector<Ptr<DoubleData>> data = ...;
+  //   MultiChainRunner runner(4, [&data](int chain, RNG &seeding_rng) {
+  //       NEW(GaussianModel, model)();
+  //       for (const auto &dp : data) model->add_data(dp);  // shared
+  //       model->set_method(new GaussianConjSampler(
+  //           model.get(), mean_prior, precision_prior, seeding_rng));
+  //       return Ptr<Model>(model);
+  //   });
+  //   runner.run(1000, 100);
+  //   Vector rhat = runner.rhat();
+  class MultiChainRunner {
+   public:
+    // Args:
+    //   chain: The index of the chain being built.
+    //   seeding_rng: An RNG stream unique to this chain.  It should be used
+    //     to seed the posterior samplers for the chain's model.
+    //
+    // Returns:
+    //   A model, with data assigned and posterior sampler(s) set.
+    typedef std::function<Ptr<Model>(int chain, RNG &seeding_rng)>
+        ModelBuilder;
+
+    // Args:
+    //   number_of_chains:  The number of chains to run.
+    //   builder: Called once for each chain, in order, in the calling thread,
+    //     to create the chain's model.  Every model must have the same
+    //     number of parameters.
+    //   seeding_rng: The parent of each chain's RNG stream.  It is not
+    //     modified.
+    MultiChainRunner(int number_of_chains, const ModelBuilder &builder,
+                     const RNG &seeding_rng = GlobalRng::rng);
+
+    int number_of_chains() const { return chains_.size(); }
+
+    // The length of the vector of parameters recorded at each iteration.
+    int parameter_dimension() const { return parameter_dimension_; }
+
+    Ptr<Model> model(int chain) { return chains_[chain].model; }
+
+    // Run each chain for 'burn' iterations, discarding the draws, followed by
+    // 'niter' iterations that are stored.  Draws from any earlier run are
+    // discarded, but each chain continues from where the previous run left
+    // it.
+    //
+    // Args:
+    //   niter:  The number of draws to store for each chain.
+    //   burn:  The number of initial draws to discard.
+    //   number_of_threads: The number of worker threads to use.  If
+    //     non-positive, one thread per chain is used.  If 1, the chains are
+    //     run in sequence in the calling thread.
+    void run(int niter, int burn = 0, int number_of_threads = 0);
+
+    // The number of draws stored for each chain by the most recent run.
+    int number_of_draws() const { return number_of_draws_; }
+
+    // The draws for the given chain.  Row i contains the parameters from
+    // iteration i (after burn-in).
+    const Matrix &draws(int chain) const { return chains_[chain].draws; }
+
+    // The Gelman-Rubin potential scale reduction factor for each parameter,
+    // computed from the running means and variances of each chain.  Values
+    // near 1 indicate the chains have mixed.  Parameters with no variation
+    // within or between chains have an R-hat of 1.  Requires at least two
+    // chains with at least two draws each.
+    Vector rhat() const;
+
+    // The effective sample size for each parameter, pooled across chains.
+    // Autocorrelations are combined across chains as in Gelman et al.
+    // (2013, Bayesian Data Analysis, 3rd edition, section 11.5), and the sum
+    // of autocorrelations is truncated using Geyer's initial monotone
+    // sequence estimator.  Parameters with no variation have an effective
+    // sample size equal to the total number of draws.
+    //
+    // Autocorrelations are computed directly, lag by lag, until the Geyer
+    // sequence is truncated.  The cost per parameter is O(n * L) for n draws
+    // per chain, where L is the truncation lag.  L is small for chains that
+    // mix well, but it can approach n for chains that mix poorly, in which
+    // case the cost is O(n^2).
+    Vector effective_sample_size() const;
+
+   private:
+    struct Chain {
+      Ptr<Model> model;
+      Matrix draws;
+      // Running mean and sum of squared deviations (Welford's algorithm) of
+      // the stored draws.
+      Vector mean;
+      Vector sum_of_squares;
+    };
+
+    // Run the given chain, storing the results in chains_[chain].
+    void run_chain(int chain, int niter, int burn);
+
+    // The average of the within chain variances, and the variance of the
+    // chain means, for parameter j.
+    void variance_components(int j, double &within, double &between) const;
+
+    std::vector<Chain> chains_;
+    int parameter_dimension_;
+    int number_of_draws_;
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_POSTERIOR_SAMPLERS_MULTI_CHAIN_RUNNER_HPP_
@@ -18,6 +18,7 @@
 */
 
 #include "Models/PosteriorSamplers/PosteriorSampler.hpp"
+#include "cpputil/Checkpoint.hpp"
 #include "cpputil/math_utils.hpp"
 #include "cpputil/report_error.hpp"
 
@@ -40,6 +41,14 @@ namespace BOOM {
 
   void PosteriorSampler::set_seed(unsigned long s) { rng_.seed(s); }
 
+  void PosteriorSampler::save_state(CheckpointWriter &checkpoint) const {
+    checkpoint.write_uint64_vector(rng_.state());
+  }
+
+  void PosteriorSampler::restore_state(CheckpointReader &checkpoint) {
+    rng_.set_state(checkpoint.read_uint64_vector());
+  }
+
   void PosteriorSampler::find_posterior_mode(double epsilon) {
     report_error("Sampler class does not implement find_posterior_mode.");
   }
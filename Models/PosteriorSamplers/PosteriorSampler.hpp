@@ -28,6 +28,9 @@
 
 namespace BOOM {
 
+  class CheckpointWriter;
+  class CheckpointReader;
+
   // The job of a PosteriorSampler is primarily to simulate a set of
   // model parameters from their posterior distribution.  Concrete
   // instances of a PosteriorSampler should contain a "dumb" pointer
@@ -90,6 +93,15 @@ namespace BOOM {
     virtual double increment_log_prior_gradient(
         const ConstVectorView &parameters, VectorView gradient) const;
 
+    // Save and restore any state that affects future draws, so that an
+    // interrupted MCMC run can be resumed exactly.  The default
+    // implementations handle the sampler's RNG.  Samplers with adaptive
+    // tuning parameters or other internal state should override both
+    // functions, calling the base class versions first.  restore_state()
+    // must read exactly what save_state() wrote.
+    virtual void save_state(CheckpointWriter &checkpoint) const;
+    virtual void restore_state(CheckpointReader &checkpoint);
+
     friend void intrusive_ptr_add_ref(PosteriorSampler *m);
     friend void intrusive_ptr_release(PosteriorSampler *m);
 
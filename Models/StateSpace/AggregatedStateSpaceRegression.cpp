@@ -545,17 +545,14 @@ namespace BOOM {
     state0[state_dimension() - 1] = 0;
   }
 
-  Vector ASSR::simulate_state_error(RNG &rng, int t) const {
+  void ASSR::simulate_state_error(RNG &rng, VectorView eta, int t) const {
     int state_dim = state_dimension();
-    Vector ans(state_dim, 0);
-    VectorView client_state_error(ans, 0, state_dim - 2);
-    client_state_error =
-        ScalarStateSpaceModelBase::simulate_state_error(rng, t);
-    ans[state_dim - 2] =
+    VectorView client_state_error(eta, 0, state_dim - 2);
+    ScalarStateSpaceModelBase::simulate_state_error(rng, client_state_error, t);
+    eta[state_dim - 2] =
         SSSMB::observation_matrix(t).dot(client_state_error) +
         rnorm_mt(rng, 0, regression_->sigma());
-    ans.back() = 0;
-    return ans;
+    eta[state_dim - 1] = 0;
   }
 
   Vector ASSR::initial_state_mean() const {
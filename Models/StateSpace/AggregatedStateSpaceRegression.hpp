@@ -313,8 +313,12 @@ namespace BOOM {
     const AccumulatorStateVarianceMatrix *state_variance_matrix(
         int t) const override;
 
+    // The accumulator makes the model matrices depend on t.
+    bool state_is_time_invariant() const override {return false;}
+
     void simulate_initial_state(RNG &rng, VectorView state0) const override;
-    Vector simulate_state_error(RNG &rng, int t) const override;
+    void simulate_state_error(RNG &rng, VectorView eta, int t) const override;
+    using ScalarStateSpaceModelBase::simulate_state_error;
 
     Vector initial_state_mean() const override;
     SpdMatrix initial_state_variance() const override;
@@ -128,6 +128,12 @@ namespace BOOM {
       set_kalman_gain(transition * PZprimeHinv * gain);
     }
 
+    SpdMatrix CIMD::observed_observation_variance(
+        const Selector &observed) const {
+      return SpdMatrix(observed.nvars(),
+                       model_->observation_variance(time_index()));
+    }
+
     const MultivariateStateSpaceModelBase *CIMD::model() const {
       return model_;
     }
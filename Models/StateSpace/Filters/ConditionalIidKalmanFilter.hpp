@@ -88,6 +88,10 @@ namespace BOOM {
           const SparseKalmanMatrix &transition,
           const SparseKalmanMatrix &observation_coefficients) override;
 
+      // The observation variance times the identity matrix.
+      SpdMatrix observed_observation_variance(
+          const Selector &observed) const override;
+
       // Compute the forecast precision matrix using the definition.
       SpdMatrix direct_forecast_precision() const;
 
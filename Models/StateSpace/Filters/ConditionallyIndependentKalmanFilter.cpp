@@ -188,5 +188,14 @@ namespace BOOM {
                       observation_coefficient_subset.Tmult(forecast_precision));
     }
     
+    //---------------------------------------------------------------------------
+    SpdMatrix Marginal::observed_observation_variance(
+        const Selector &observed) const {
+      SpdMatrix ans(observed.nvars(), 0.0);
+      ans.diag() = observed.select(
+          model_->observation_variance(time_index()).diag());
+      return ans;
+    }
+    
   }  // namespace Kalman
 }  // namespace BOOM
@@ -85,6 +85,9 @@ namespace BOOM {
           const SparseKalmanMatrix &transition,
           const SparseKalmanMatrix &observation_coefficient_subset) override;
 
+      SpdMatrix observed_observation_variance(
+          const Selector &observed) const override;
+
       ModelType *model_;
       MarginalType *previous_;
 
@@ -25,17 +25,36 @@ namespace BOOM {
     MarginalDistributionBase::MarginalDistributionBase(int dim, int time_index)
         : time_index_(time_index),
           state_mean_(dim),
-          state_variance_(dim) {}
+          state_variance_(dim),
+          state_variance_is_stale_(false) {}
 
     void MarginalDistributionBase::set_state_variance(const SpdMatrix &var) {
       check_variance(var);
       state_variance_ = var;
+      state_variance_root_ = Matrix();
+      state_variance_is_stale_ = false;
     }
 
     void MarginalDistributionBase::increment_state_variance(
         const SpdMatrix &variance_increment) {
-      state_variance_ += variance_increment;
+      mutable_state_variance() += variance_increment;
       check_variance(state_variance_);
+      state_variance_root_ = Matrix();
+    }
+
+    void MarginalDistributionBase::set_state_variance_root(
+        const Matrix &root) {
+      state_variance_root_ = root;
+      state_variance_ = SpdMatrix();
+      state_variance_is_stale_ = true;
+    }
+
+    void MarginalDistributionBase::compute_state_variance_from_root() const {
+      state_variance_.resize(state_variance_root_.nrow());
+      state_variance_ = 0.0;
+      state_variance_.add_outer(state_variance_root_);
+      state_variance_root_ = Matrix();
+      state_variance_is_stale_ = false;
     }
     
     void MarginalDistributionBase::check_variance(const SpdMatrix &v) const {
@@ -52,7 +71,9 @@ namespace BOOM {
 
   //===========================================================================
   KalmanFilterBase::KalmanFilterBase()
-      : status_(NOT_CURRENT), log_likelihood_(negative_infinity()) {}
+      : status_(NOT_CURRENT),
+        log_likelihood_(negative_infinity()),
+        square_root_mode_(false) {}
   
   std::ostream &KalmanFilterBase::print(std::ostream &out) const {
     for (int i = 0; i < size(); ++i) {
@@ -67,10 +67,33 @@ namespace BOOM {
       // state variance from distribution t-1.  After updating, the
       // state_variance() refers to the variance of the state at time t+1 given
       // data to time t.
-      const SpdMatrix &state_variance() const {return state_variance_;}
+      //
+      // If the distribution holds a state_variance_root() then the variance is
+      // computed from the root the first time it is requested, and the root is
+      // discarded, so the distribution never stores both.  Code that only
+      // reads state_variance() (e.g. the smoothers and the simulation filter)
+      // works the same way in square root mode.
+      const SpdMatrix &state_variance() const {
+        if (state_variance_is_stale_) compute_state_variance_from_root();
+        return state_variance_;
+      }
       void set_state_variance(const SpdMatrix &var); 
       void increment_state_variance(const SpdMatrix &variance_increment);
 
+      // A lower triangular matrix L with L * L' == state_variance().  The
+      // factor is only available when the marginal distribution is being
+      // updated by the square root filter.  Calling state_variance(),
+      // set_state_variance() or increment_state_variance() discards it.
+      bool has_state_variance_root() const {
+        return state_variance_root_.nrow() > 0;
+      }
+      const Matrix &state_variance_root() const {return state_variance_root_;}
+
+      // Set the state variance root.  state_variance() becomes root *
+      // root.transpose(), but it is not computed until it is needed.  The root
+      // need not be triangular.
+      void set_state_variance_root(const Matrix &root);
+
       // Convert the state mean and variance from forward-looking moments
       // (e.g. E(state[t+1] | Data to t)) to contemporaneous moments
       // (e.g. E(state[t] | Data to t)).
@@ -95,17 +118,40 @@ namespace BOOM {
       }
 
      protected:
-      SpdMatrix & mutable_state_variance() {return state_variance_;}
+      Vector & mutable_state_mean() {return state_mean_;}
+      SpdMatrix & mutable_state_variance() {
+        if (state_variance_is_stale_) compute_state_variance_from_root();
+        return state_variance_;
+      }
+      // Changes made through the returned reference are reflected in
+      // state_variance() the next time it is requested.
+      Matrix & mutable_state_variance_root() {
+        state_variance_is_stale_ = true;
+        return state_variance_root_;
+      }
       void check_variance(const SpdMatrix &v) const;
       
      private:
+      // Set state_variance_ to state_variance_root_ times its transpose, and
+      // discard state_variance_root_.
+      void compute_state_variance_from_root() const;
+
       // The time point that this marginal distribution describes.
       int time_index_;
 
       // After updating, these describe the mean and variance of the state at
       // time_index_ + 1 given data to time_index_.
       Vector state_mean_;
-      SpdMatrix state_variance_;
+      mutable SpdMatrix state_variance_;
+
+      // Empty unless the square root filter is in use.  Otherwise a lower
+      // triangular factor of the state variance, in which case
+      // state_variance_ is empty until it is computed from the root.
+      mutable Matrix state_variance_root_;
+
+      // True if state_variance_ must be computed from state_variance_root_
+      // before it is used.
+      mutable bool state_variance_is_stale_;
 
       // The r[t] parameter computed from the Durbin-Koopman disturbance
       // smoother.  DK do a poor job of explaining what r is, but it is a scaled
@@ -188,6 +234,22 @@ namespace BOOM {
     // Run the Durbin and Koopman fast disturbance smoother.
     virtual void fast_disturbance_smooth() = 0;
 
+    // If true then update() propagates a Cholesky factor of the state variance
+    // using orthogonal (QR) transformations, instead of updating the state
+    // variance directly.  The square root filter is slower, but the state
+    // variance it implies is positive semidefinite by construction, so it is
+    // robust to the loss of positive definiteness that can arise in long
+    // series with near-deterministic state components.
+    //
+    // Changing the mode sets the filter status to NOT_CURRENT.
+    void set_square_root_mode(bool square_root) {
+      if (square_root != square_root_mode_) {
+        square_root_mode_ = square_root;
+        set_status(NOT_CURRENT);
+      }
+    }
+    bool square_root_mode() const {return square_root_mode_;}
+
    protected:
     void increment_log_likelihood(double loglike) {
       log_likelihood_ += loglike;
@@ -200,6 +262,7 @@ namespace BOOM {
    private:
     KalmanFilterStatus status_;
     double log_likelihood_;
+    bool square_root_mode_;
 
     // Durbin and Koopman's r0 from the fast disturbance smoother (see equation
     // (5) in Durbin and Koopman (2002, Biometrika), or equation 4.32 in Durbin
@@ -39,7 +39,7 @@ namespace BOOM {
     }
 
     a = T * a;
-    a += K * v;
+    a.axpy(K, v);
 
     L = T.transpose();
     L.add_outer(Z, K, -1);  // L is the transpose of Durbin and Koopman's L
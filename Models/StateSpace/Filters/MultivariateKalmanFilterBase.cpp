@@ -18,6 +18,8 @@
 
 #include "Models/StateSpace/Filters/MultivariateKalmanFilterBase.hpp"
 #include "Models/StateSpace/MultivariateStateSpaceModelBase.hpp"
+#include "Models/StateSpace/Filters/SparseKalmanTools.hpp"
+#include "LinAlg/EigenMap.hpp"
 #include "cpputil/report_error.hpp"
 #include "cpputil/Constants.hpp"
 
@@ -42,6 +44,9 @@ namespace BOOM {
         report_error("ConditionalIidMarginalDistribution needs the model to be "
                      "set by set_model() before calling update().");
       }
+      if (has_state_variance_root()) {
+        return square_root_update(observation, observed, state_error_root());
+      }
       if (observed.nvars() == 0) {
         return fully_missing_update();
       }
@@ -66,8 +71,13 @@ namespace BOOM {
 
       // Update the state mean from a[t]   = E(state_t    | Y[t-1]) to 
       //                            a[t+1] = E(state[t+1] | Y[t]).
-      set_state_mean(transition * state_mean()
-                     + kalman_gain() * prediction_error());
+      //
+      // K * v is accumulated in place rather than through operator+, which
+      // would allocate two temporaries.
+      Vector new_state_mean = transition * state_mean();
+      EigenMap(new_state_mean).noalias() +=
+          EigenMap(kalman_gain()) * EigenMap(prediction_error());
+      set_state_mean(new_state_mean);
 
       // Update the state variance from P[t] = Var(state_t | Y[t-1]) to P[t+1] =
       // Var(state[t+1] | Y[t]).
@@ -84,18 +94,16 @@ namespace BOOM {
           observation_coefficient_subset *
           (transition * state_variance()).transpose()).transpose();
 
-      // Step 1:  Set P = T * P * T.transpose()
-      transition.sandwich_inplace(mutable_state_variance());
-      
-      // Step 2: 
+      // Step 1:  Set P = T * P * T.transpose() + RQR
+      transition.sandwich_inplace_and_add(
+          mutable_state_variance(),
+          *model()->state_variance_matrix(time_index()));
+
+      // Step 2:
       // Decrement P by T*P*Z.transpose()*K.transpose().  This step can be
       // skipped if y is missing, because K is zero.
       mutable_state_variance() -= TPZprime.multT(kalman_gain());
 
-      // Step 3: P += RQR
-      model()->state_variance_matrix(time_index())->add_to(
-          mutable_state_variance());
-      
       mutable_state_variance().fix_near_symmetry();
       return log_likelihood;
     }
@@ -151,15 +159,92 @@ namespace BOOM {
       //
       // P[t+1] = T[t] * P[t] * T[t]' + R[t] * Q[t] * R[t]'
 
-      // Step 1:  Set P = T * P * T.transpose()
-      transition.sandwich_inplace(mutable_state_variance());
-      // Step 2: P += RQR
-      model()->state_variance_matrix(time_index())->add_to(
-          mutable_state_variance());
+      // Set P = T * P * T.transpose() + RQR
+      transition.sandwich_inplace_and_add(
+          mutable_state_variance(),
+          *model()->state_variance_matrix(time_index()));
       mutable_state_variance().fix_near_symmetry();
       return log_likelihood;
     }
     
+    //----------------------------------------------------------------------
+    StateErrorVarianceRoot &Marginal::state_error_root() {
+      const Marginal *prev = previous();
+      if (prev && prev->state_error_root_) {
+        state_error_root_ = prev->state_error_root_;
+      } else {
+        state_error_root_ = std::make_shared<StateErrorVarianceRoot>();
+      }
+      return *state_error_root_;
+    }
+
+    //----------------------------------------------------------------------
+    double Marginal::square_root_update(
+        const Vector &observation, const Selector &observed,
+        StateErrorVarianceRoot &state_error_root) {
+      int t = time_index();
+      const SparseKalmanMatrix &transition(
+          *model()->state_transition_matrix(t));
+      const Matrix &L(state_variance_root());
+      const MultivariateStateSpaceModelBase *mod = model();
+      const Matrix &error_root(state_error_root.root(
+          *mod->state_error_expander(t), *mod->state_error_variance(t),
+          [mod]() { return mod->state_is_time_invariant(); }));
+      // The new root overwrites L, which is not needed after the pre-array
+      // has been formed.
+      Matrix forecast_variance_root, gain_root;
+
+      if (observed.nvars() == 0) {
+        square_root_kalman_update(
+            Matrix(0, 0), Matrix(0, L.nrow()), transition, L,
+            error_root, forecast_variance_root, gain_root,
+            mutable_state_variance_root());
+        set_prediction_error(Vector(0));
+        set_state_mean(transition * state_mean());
+        return 0;
+      }
+
+      const SparseKalmanMatrix &observation_coefficient_subset(
+          *model()->observation_coefficients(t, observed));
+      // The prediction error needs a[t], which is overwritten below.
+      set_prediction_error(observed.select(observation)
+                           - observation_coefficient_subset * state_mean());
+      square_root_kalman_update(
+          variance_square_root(observed_observation_variance(observed)),
+          observation_coefficient_subset * L,
+          transition,
+          L,
+          error_root,
+          forecast_variance_root,
+          gain_root,
+          mutable_state_variance_root());
+
+      // With F = C * C', the forecast precision is C^{-T} * C^{-1}, and the
+      // Kalman gain T * P * Z' * Finv is G * C^{-1}.
+      const Matrix &C(forecast_variance_root);
+      Vector whitened_error = Lsolve(C, prediction_error());
+      double log_likelihood = -.5 * observed.nvars() * Constants::log_root_2pi
+          - .5 * whitened_error.normsq();
+      double forecast_variance_log_determinant = 0;
+      for (int i = 0; i < C.nrow(); ++i) {
+        forecast_variance_log_determinant += 2 * log(C(i, i));
+      }
+      set_forecast_precision_log_determinant(
+          -forecast_variance_log_determinant);
+      log_likelihood -= .5 * forecast_variance_log_determinant;
+      set_scaled_prediction_error(LTsolve_inplace(C, whitened_error));
+
+      Matrix gain_transpose = gain_root.transpose();
+      LTsolve_inplace(C, gain_transpose);
+      set_kalman_gain(gain_transpose.transpose());
+
+      Vector new_state_mean = transition * state_mean();
+      EigenMap(new_state_mean).noalias() +=
+          EigenMap(kalman_gain()) * EigenMap(prediction_error());
+      set_state_mean(new_state_mean);
+      return log_likelihood;
+    }
+    
   }  // namespace Kalman
 
   //===========================================================================
@@ -195,10 +280,26 @@ namespace BOOM {
     ensure_size(t);
     if (t == 0) {
       node(t).set_state_mean(model_->initial_state_mean());
-      node(t).set_state_variance(model_->initial_state_variance());
+      if (square_root_mode()) {
+        node(t).set_state_variance_root(
+            variance_square_root(model_->initial_state_variance()));
+      } else {
+        node(t).set_state_variance(model_->initial_state_variance());
+      }
     } else {
-      node(t).set_state_mean(node(t - 1).state_mean());
-      node(t).set_state_variance(node(t - 1).state_variance());
+      const Kalman::MultivariateMarginalDistributionBase &previous(
+          node(t - 1));
+      node(t).set_state_mean(previous.state_mean());
+      if (square_root_mode()) {
+        // The previous node lacks a root if it was filtered before the
+        // square root mode was turned on.
+        node(t).set_state_variance_root(
+            previous.has_state_variance_root()
+            ? previous.state_variance_root()
+            : variance_square_root(previous.state_variance()));
+      } else {
+        node(t).set_state_variance(previous.state_variance());
+      }
     }
     increment_log_likelihood(node(t).update(y, observed));
   }
@@ -19,9 +19,11 @@
   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
 */
 
+#include <memory>
 #include "LinAlg/Vector.hpp"
 #include "LinAlg/SpdMatrix.hpp"
 #include "Models/StateSpace/Filters/KalmanFilterBase.hpp"
+#include "Models/StateSpace/Filters/SparseKalmanTools.hpp"
 #include "cpputil/math_utils.hpp"
 
 namespace BOOM {
@@ -154,6 +156,11 @@ namespace BOOM {
           const SparseKalmanMatrix &transition,
           const SparseKalmanMatrix &observation_coefficients) = 0;
 
+      // The variance of the observed elements of y[t] given state[t], where
+      // t is time_index().  Only needed by the square root filter.
+      virtual SpdMatrix observed_observation_variance(
+          const Selector &observed) const = 0;
+
       // Update the prediction error, scaled prediction error, forecast variance
       // (if computed) and Kalman gain, using the textbook formulas for the
       // Kalman filter updates.
@@ -166,6 +173,19 @@ namespace BOOM {
       // Implement update() in the case where y[t] is fully missing (i.e. no
       // part of it is observed.
       double fully_missing_update();
+
+      // Implement update() by propagating state_variance_root() through the
+      // square root filter.  Used if has_state_variance_root().
+      double square_root_update(const Vector &observation,
+                                const Selector &observed,
+                                StateErrorVarianceRoot &state_error_root);
+
+      // The root of R * Q * R' used by square_root_update().  The same object
+      // is handed from each time point to the next, so the root is computed
+      // once per pass over the data when the state is time invariant.  A new
+      // one is started at the first time point, because the model parameters
+      // may have changed since the last pass.
+      StateErrorVarianceRoot &state_error_root();
       
       // y[t] - E(y[t] | Y[t-1]).  The dimension matches y[t], which might vary
       // across t.
@@ -184,6 +204,9 @@ namespace BOOM {
       // Rows correspond to states and columns to observation elements, so the
       // dimension is S x m.
       Matrix kalman_gain_;
+
+      // Shared with the neighboring time points.  See state_error_root().
+      std::shared_ptr<StateErrorVarianceRoot> state_error_root_;
     };
   }  // namespace Kalman
 
@@ -18,6 +18,8 @@
 
 #include "Models/StateSpace/Filters/ScalarKalmanFilter.hpp"
 #include "Models/StateSpace/StateSpaceModelBase.hpp"
+#include "Models/StateSpace/Filters/SparseKalmanTools.hpp"
+#include "cpputil/math_utils.hpp"
 #include "distributions.hpp"
 
 namespace BOOM {
@@ -38,10 +40,33 @@ namespace BOOM {
           prediction_variance_(0),
           kalman_gain_(model_->state_dimension(), 0) {}
     
+    void ScalarKalmanWorkspace::resize(int state_dimension) {
+      if (PZ.size() != state_dimension) {
+        PZ.resize(state_dimension);
+        TPZ.resize(state_dimension);
+        state_mean.resize(state_dimension);
+        scaled_state_error.resize(state_dimension);
+      }
+    }
+
     double Marginal::update(double y, bool missing, int t,
                             double observation_variance_scale_factor) {
+      ScalarKalmanWorkspace workspace;
+      workspace.resize(model_->state_dimension());
+      return update(y, missing, t, workspace,
+                    observation_variance_scale_factor);
+    }
+
+    double Marginal::update(double y, bool missing, int t,
+                            ScalarKalmanWorkspace &workspace,
+                            double observation_variance_scale_factor) {
+      if (has_state_variance_root()) {
+        return square_root_update(y, missing, t, workspace,
+                                  observation_variance_scale_factor);
+      }
       const SparseVector observation_coefficients = model_->observation_matrix(t);
-      Vector PZ = state_variance() * observation_coefficients;
+      Vector &PZ(workspace.PZ);
+      multiply(VectorView(PZ), state_variance(), observation_coefficients);
 
       prediction_variance_ =
           observation_coefficients.dot(PZ) +
@@ -53,11 +78,13 @@ namespace BOOM {
       }
       const SparseKalmanMatrix &state_transition_matrix(
           *model_->state_transition_matrix(t));
-      Vector TPZ = state_transition_matrix * PZ;
+      Vector &TPZ(workspace.TPZ);
+      state_transition_matrix.multiply(VectorView(TPZ), PZ);
 
       double loglike = 0;
       if (!missing) {
-        kalman_gain_ = TPZ / prediction_variance_;
+        kalman_gain_ = TPZ;
+        kalman_gain_ /= prediction_variance_;
         double mu = observation_coefficients.dot(state_mean());
         prediction_error_ = y - mu;
         loglike = dnorm(y, mu, sqrt(prediction_variance_), true);
@@ -66,22 +93,99 @@ namespace BOOM {
         prediction_error_ = 0;
       }
 
+      Vector &new_state_mean(workspace.state_mean);
+      state_transition_matrix.multiply(VectorView(new_state_mean),
+                                       state_mean());
       if (!missing) {
-        set_state_mean(state_transition_matrix * state_mean()
-                       + kalman_gain_ * prediction_error_);
-      } else {
-        set_state_mean(state_transition_matrix * state_mean());
+        new_state_mean.axpy(kalman_gain_, prediction_error_);
       }
+      mutable_state_mean() = new_state_mean;
 
-      state_transition_matrix.sandwich_inplace(mutable_state_variance());
+      // P = T P T' + RQR' - T P Z' K'
+      state_transition_matrix.sandwich_inplace_and_add(
+          mutable_state_variance(), *model_->state_variance_matrix(t));
       if (!missing) {
         mutable_state_variance().Matrix::add_outer(TPZ, kalman_gain_, -1);
       }
-      model_->state_variance_matrix(t)->add_to(mutable_state_variance());
       mutable_state_variance().fix_near_symmetry();
       return loglike;
     }
 
+    double Marginal::square_root_update(
+        double y, bool missing, int t, ScalarKalmanWorkspace &workspace,
+        double observation_variance_scale_factor) {
+      const SparseVector observation_coefficients =
+          model_->observation_matrix(t);
+      const SparseKalmanMatrix &transition(*model_->state_transition_matrix(t));
+      const Matrix &L(state_variance_root());
+      int state_dim = L.nrow();
+
+      double observation_variance =
+          model_->observation_variance(t) * observation_variance_scale_factor;
+      Matrix ZL(1, state_dim);
+      for (int j = 0; j < state_dim; ++j) {
+        ZL(0, j) = observation_coefficients.dot(L.col(j));
+      }
+      double mu = observation_coefficients.dot(state_mean());
+
+      const Matrix &state_error_root(workspace.state_error_root.root(
+          *model_->state_error_expander(t), *model_->state_error_variance(t),
+          [this]() { return model_->state_is_time_invariant(); }));
+      // The new root overwrites L, which is not needed after the pre-array
+      // has been formed.
+      Matrix forecast_variance_root, gain_root;
+      if (missing) {
+        // Missing observations drop out of the pre-array.  The forecast
+        // variance is still reported, as in the standard filter.
+        prediction_variance_ = ZL.row(0).normsq() + observation_variance;
+        square_root_kalman_update(
+            Matrix(0, 0), Matrix(0, state_dim), transition, L,
+            state_error_root, forecast_variance_root, gain_root,
+            mutable_state_variance_root());
+      } else {
+        square_root_kalman_update(
+            Matrix(1, 1, sqrt(observation_variance)), ZL, transition, L,
+            state_error_root, forecast_variance_root, gain_root,
+            mutable_state_variance_root());
+        prediction_variance_ = square(forecast_variance_root(0, 0));
+      }
+      if (prediction_variance_ <= 0) {
+        report_error("Found a zero (or negative) forecast variance!");
+      }
+
+      double loglike = 0;
+      Vector &new_state_mean(workspace.state_mean);
+      transition.multiply(VectorView(new_state_mean), state_mean());
+      if (!missing) {
+        double forecast_standard_deviation = forecast_variance_root(0, 0);
+        kalman_gain_ = gain_root.col(0) / forecast_standard_deviation;
+        prediction_error_ = y - mu;
+        loglike = dnorm(y, mu, forecast_standard_deviation, true);
+        new_state_mean.axpy(kalman_gain_, prediction_error_);
+      } else {
+        kalman_gain_ = 0.0;
+        prediction_error_ = 0;
+      }
+      mutable_state_mean() = new_state_mean;
+      return loglike;
+    }
+
+    double Marginal::steady_state_update(
+        double y, int t, const ScalarMarginalDistribution &steady_state,
+        ScalarKalmanWorkspace &workspace) {
+      kalman_gain_ = steady_state.kalman_gain_;
+      prediction_variance_ = steady_state.prediction_variance_;
+      double mu = model_->observation_matrix(t).dot(state_mean());
+      prediction_error_ = y - mu;
+
+      Vector &new_state_mean(workspace.state_mean);
+      model_->state_transition_matrix(t)->multiply(
+          VectorView(new_state_mean), state_mean());
+      new_state_mean.axpy(kalman_gain_, prediction_error_);
+      mutable_state_mean() = new_state_mean;
+      return dnorm(y, mu, sqrt(prediction_variance_), true);
+    }
+
     Vector Marginal::contemporaneous_state_mean() const {
       if (!previous_) {
         // This marginal distribution is the initial distribution.
@@ -108,32 +212,62 @@ namespace BOOM {
   }  // namespace Kalman
 
   ScalarKalmanFilter::ScalarKalmanFilter(ScalarStateSpaceModelBase *model)
-      : model_(model)
+      : model_(model),
+        steady_state_tolerance_(1e-10),
+        steady_state_possible_(false),
+        steady_state_index_(-1),
+        steady_state_run_length_(0),
+        last_time_index_(-1),
+        last_observation_variance_(0),
+        number_of_steady_state_updates_(0)
   {} 
 
-  void ScalarKalmanFilter::update() {
-    if (!model_) {
-      report_error("Model must be set before calling update().");
-    }
-    while (nodes_.size() <= model_->time_dimension()) {
+  void ScalarKalmanFilter::ensure_size(int n) {
+    while (nodes_.size() < n) {
       Kalman::ScalarMarginalDistribution *previous =
           nodes_.empty() ? nullptr : &nodes_.back();
       nodes_.push_back(Kalman::ScalarMarginalDistribution(
           model_, previous, nodes_.size()));
     }
-    clear();
-    nodes_[0].set_state_mean(model_->initial_state_mean());
-    nodes_[0].set_state_variance(model_->initial_state_variance());
+    workspace_.resize(model_->state_dimension());
+  }
 
-    for (int t = 0; t < model_->time_dimension(); ++t) {
-      if (t > 0) {
-        nodes_[t].set_state_mean(nodes_[t-1].state_mean());
-        nodes_[t].set_state_variance(nodes_[t-1].state_variance());
+  void ScalarKalmanFilter::initialize_node(int t) {
+    if (t == 0) {
+      nodes_[0].set_state_mean(model_->initial_state_mean());
+      if (square_root_mode()) {
+        nodes_[0].set_state_variance_root(
+            variance_square_root(model_->initial_state_variance()));
+      } else {
+        nodes_[0].set_state_variance(model_->initial_state_variance());
       }
-      increment_log_likelihood(nodes_[t].update(
+    } else {
+      const Kalman::ScalarMarginalDistribution &previous(nodes_[t - 1]);
+      nodes_[t].set_state_mean(previous.state_mean());
+      if (square_root_mode()) {
+        // The previous node lacks a root if it was filtered before the
+        // square root mode was turned on.
+        nodes_[t].set_state_variance_root(
+            previous.has_state_variance_root()
+            ? previous.state_variance_root()
+            : variance_square_root(previous.state_variance()));
+      } else {
+        nodes_[t].set_state_variance(previous.state_variance());
+      }
+    }
+  }
+
+  void ScalarKalmanFilter::update() {
+    if (!model_) {
+      report_error("Model must be set before calling update().");
+    }
+    ensure_size(model_->time_dimension() + 1);
+    clear();
+    for (int t = 0; t < model_->time_dimension(); ++t) {
+      increment_log_likelihood(update_node(
           model_->adjusted_observation(t),
-          model_->is_missing_observation(t),
-          t));
+          t,
+          model_->is_missing_observation(t)));
       if (!std::isfinite(log_likelihood())) {
         set_status(NOT_CURRENT);
         return;
@@ -153,6 +287,8 @@ namespace BOOM {
     }
 
     int n = model_->time_dimension();
+    workspace_.resize(model_->state_dimension());
+    Vector &rt_1(workspace_.scaled_state_error);
     Vector r(model_->state_dimension(), 0.0);
     for (int t = n - 1; t >= 0; --t) {
       // Upon entry r is r[t].
@@ -169,10 +305,10 @@ namespace BOOM {
       double coefficient = (v / F) - nodes_[t].kalman_gain().dot(r);
 
       // Now produce r[t-1]
-      Vector rt_1 = model_->state_transition_matrix(t)->Tmult(r);
+      model_->state_transition_matrix(t)->Tmult(VectorView(rt_1), r);
       model_->observation_matrix(t).add_this_to(rt_1, coefficient);
       nodes_[t].set_scaled_state_error(r);
-      r = rt_1;
+      r.swap(rt_1);
     }
     set_initial_scaled_state_error(r);
   }
@@ -181,21 +317,82 @@ namespace BOOM {
     if (!model_) {
       report_error("Model must be set before calling update().");
     }
+    ensure_size(t + 1);
+    increment_log_likelihood(update_node(y, t, missing));
+  }
 
-    while (nodes_.size() <= t) {
-      Kalman::ScalarMarginalDistribution *previous =
-          nodes_.empty() ? nullptr : &nodes_.back();
-      nodes_.push_back(
-          Kalman::ScalarMarginalDistribution(model_, previous, nodes_.size()));
+  double ScalarKalmanFilter::update_node(double y, int t, bool missing) {
+    initialize_node(t);
+    if (t == 0 || t != last_time_index_ + 1) {
+      // The steady state (if any) belongs to a different pass of the filter,
+      // as does the square root of the state error variance.
+      workspace_.state_error_root.clear();
+      steady_state_possible_ = steady_state_tolerance_ > 0
+          && model_->state_is_time_invariant();
+      steady_state_index_ = -1;
+      steady_state_run_length_ = 0;
+      if (t == 0) {
+        number_of_steady_state_updates_ = 0;
+      }
     }
-    if (t == 0) {
-      nodes_[t].set_state_mean(model_->initial_state_mean());
-      nodes_[t].set_state_variance(model_->initial_state_variance());
-    } else {
-      nodes_[t].set_state_mean(nodes_[t-1].state_mean());
-      nodes_[t].set_state_variance(nodes_[t-1].state_variance());
+    last_time_index_ = t;
+    if (!steady_state_possible_) {
+      return nodes_[t].update(y, missing, t, workspace_);
+    }
+
+    double observation_variance = model_->observation_variance(t);
+    if (missing || observation_variance != last_observation_variance_) {
+      steady_state_index_ = -1;
+      steady_state_run_length_ = 0;
+    }
+    last_observation_variance_ = observation_variance;
+    if (steady_state_index_ >= 0) {
+      ++number_of_steady_state_updates_;
+      return nodes_[t].steady_state_update(
+          y, t, nodes_[steady_state_index_], workspace_);
+    }
+
+    double loglike = nodes_[t].update(y, missing, t, workspace_);
+    if (!missing && ++steady_state_run_length_ >= 2 && has_converged(t)) {
+      steady_state_index_ = t;
+    }
+    return loglike;
+  }
+
+  namespace {
+    // Returns true if |x - y| <= tolerance * scale for all elements of x and
+    // y.
+    bool close_enough(const ConstVectorView &x, const ConstVectorView &y,
+                      double scale, double tolerance) {
+      for (int i = 0; i < x.size(); ++i) {
+        if (fabs(x[i] - y[i]) > tolerance * scale) return false;
+      }
+      return true;
+    }
+  }  // namespace
+
+  bool ScalarKalmanFilter::has_converged(int t) const {
+    const Kalman::ScalarMarginalDistribution &now(nodes_[t]);
+    const Kalman::ScalarMarginalDistribution &then(nodes_[t - 1]);
+    double tolerance = steady_state_tolerance_;
+    double F = now.prediction_variance();
+    if (fabs(F - then.prediction_variance()) > tolerance * F) {
+      return false;
+    }
+    if (!close_enough(now.kalman_gain(), then.kalman_gain(),
+                      now.kalman_gain().max_abs(), tolerance)) {
+      return false;
+    }
+    // now.state_variance() is P[t+1] and then.state_variance() is P[t].
+    const SpdMatrix &P(now.state_variance());
+    double scale = P.max_abs();
+    for (int j = 0; j < P.ncol(); ++j) {
+      if (!close_enough(P.col(j), then.state_variance().col(j), scale,
+                        tolerance)) {
+        return false;
+      }
     }
-    increment_log_likelihood(nodes_[t].update(y, missing, t));
+    return true;
   }
   
   double ScalarKalmanFilter::prediction_error(int t, bool standardize) const {
@@ -20,11 +20,34 @@
 */
 
 #include "Models/StateSpace/Filters/KalmanFilterBase.hpp"
+#include "Models/StateSpace/Filters/SparseKalmanTools.hpp"
 #include "LinAlg/Vector.hpp"
 
 namespace BOOM {
   class ScalarStateSpaceModelBase;
   namespace Kalman {
+    // Scratch space for the vectors that the scalar Kalman filter and
+    // disturbance smoother compute at each time step.  A filter owns one
+    // workspace, which is resized only when the state dimension changes, so
+    // that the per-time-step work does not allocate.
+    struct ScalarKalmanWorkspace {
+      // Set the size of all the workspace vectors to state_dimension.  This is
+      // a no-op if the sizes are already correct.
+      void resize(int state_dimension);
+      int state_dimension() const { return PZ.size(); }
+
+      // P[t] * Z[t]
+      Vector PZ;
+      // T[t] * P[t] * Z[t]
+      Vector TPZ;
+      // Holds a[t+1] while it is being computed.
+      Vector state_mean;
+      // Holds the smoother's r[t-1] while it is being computed.
+      Vector scaled_state_error;
+      // Used by the square root filter.  Cleared at the start of each pass.
+      StateErrorVarianceRoot state_error_root;
+    };
+
     // A marginal distribution for the case of univariate data.
     class ScalarMarginalDistribution
         : public MarginalDistributionBase {
@@ -54,6 +77,16 @@ namespace BOOM {
                     int t,
                     double observation_variance_scale_factor = 1.0);
 
+      // Same as above, but temporaries are stored in 'workspace' instead of
+      // being allocated.
+      //
+      // If has_state_variance_root() then the update is carried out by the
+      // square root filter, which propagates state_variance_root() rather
+      // than state_variance().
+      double update(double y, bool missing, int t,
+                    ScalarKalmanWorkspace &workspace,
+                    double observation_variance_scale_factor = 1.0);
+
       // After the call to update(), state_mean() and state_variance() refer to
       // the predictive mean and variance of the state at time_dimension() + 1
       // given data to time_dimension().
@@ -74,8 +107,21 @@ namespace BOOM {
 
       const Vector &kalman_gain() const {return kalman_gain_;}
       void set_kalman_gain(const Vector &gain) {kalman_gain_ = gain;}
+
+      // An inexpensive version of update() for use once the filter has
+      // reached a steady state.  The Kalman gain and prediction variance are
+      // copied from 'steady_state' instead of being computed, and the state
+      // variance is left unchanged.  y must be observed.
+      double steady_state_update(double y, int t,
+                                 const ScalarMarginalDistribution &steady_state,
+                                 ScalarKalmanWorkspace &workspace);
       
      private:
+      // The implementation of update() used by the square root filter.
+      double square_root_update(double y, bool missing, int t,
+                                ScalarKalmanWorkspace &workspace,
+                                double observation_variance_scale_factor);
+
       const ScalarStateSpaceModelBase *model_;
       ScalarMarginalDistribution *previous_;
       double prediction_error_;
@@ -115,10 +161,72 @@ namespace BOOM {
       
     const Kalman::ScalarMarginalDistribution &back() const;
     int size() const override {return nodes_.size();}
+
+    // If the model's state is time invariant then the state variance P[t]
+    // converges to a steady state.  Once P, K, and F agree with their values
+    // from the preceding time point to within a relative 'tolerance' the
+    // filter stops updating P, and reuses the converged K and F.  The full
+    // update resumes at a missing observation or a change in the observation
+    // variance, and the filter then waits to converge again.
+    //
+    // A non-positive tolerance disables steady state detection.  Changing the
+    // tolerance sets the filter status to NOT_CURRENT.
+    void set_steady_state_tolerance(double tolerance) {
+      if (tolerance != steady_state_tolerance_) {
+        steady_state_tolerance_ = tolerance;
+        set_status(NOT_CURRENT);
+      }
+    }
+    double steady_state_tolerance() const {return steady_state_tolerance_;}
+
+    // The number of time points handled by the steady state update since the
+    // filter was last started at t = 0.
+    int number_of_steady_state_updates() const {
+      return number_of_steady_state_updates_;
+    }
     
    private:
+    // Make sure there are at least n nodes, and that the workspace matches
+    // the model's state dimension.
+    void ensure_size(int n);
+
+    // Set the state mean and variance (or its square root, in square root
+    // mode) of node t to the values predicted by node t-1, or to the initial
+    // state distribution if t == 0.
+    void initialize_node(int t);
+
+    // Initialize node t and update it with observation y.  The update uses the
+    // steady state gain if one is available.  Returns the log likelihood
+    // contribution from time t.
+    double update_node(double y, int t, bool missing);
+
+    // Returns true if the moments held by nodes t and t-1 agree to within
+    // steady_state_tolerance_.
+    bool has_converged(int t) const;
+
     ScalarStateSpaceModelBase *model_;
     std::vector<Kalman::ScalarMarginalDistribution> nodes_;
+    Kalman::ScalarKalmanWorkspace workspace_;
+
+    double steady_state_tolerance_;
+
+    // True if the model's state is time invariant, so that the filter can
+    // reach a steady state.  Set when the filter starts at t = 0.
+    bool steady_state_possible_;
+
+    // The index of the node whose Kalman gain and prediction variance
+    // define the steady state, or -1 if the filter is not in a steady state.
+    int steady_state_index_;
+
+    // The number of consecutive full updates with observed data and the same
+    // observation variance, ending at the most recent update.
+    int steady_state_run_length_;
+
+    // The time index and observation variance of the most recent update.
+    int last_time_index_;
+    double last_observation_variance_;
+
+    int number_of_steady_state_updates_;
   };
 
 }  // namespace BOOM
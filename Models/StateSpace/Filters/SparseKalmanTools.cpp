@@ -17,7 +17,9 @@
   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
 */
 
+#include "Eigen/QR"
 #include "LinAlg/Cholesky.hpp"
+#include "LinAlg/EigenMap.hpp"
 #include "Models/StateSpace/Filters/SparseKalmanTools.hpp"
 #include "Models/StateSpace/Filters/KalmanTools.hpp"
 #include "Models/StateSpace/Filters/SparseMatrix.hpp"
@@ -69,11 +71,10 @@ namespace BOOM {
 
     a = T * a;                          // Sparse multiplication
     if (!missing) a.axpy(K, v);         // a += K * v
-    T.sandwich_inplace(P);              // P = T P T.transpose()
+    T.sandwich_inplace_and_add(P, RQR);  // P = T P T.transpose() + RQR
     if (!missing) {                     // K is zero if missing, so skip this
       P.Matrix::add_outer(TPZ, K, -1);  // P-= T*P*Z*K.transpose();
     }
-    RQR.add_to(P);  // P += RQR
     P.fix_near_symmetry();
     return loglike;
   }
@@ -120,8 +121,9 @@ namespace BOOM {
 
     state_conditional_mean = transition_matrix * state_conditional_mean;
     if (!missing) {
-      // a += K * v
-      state_conditional_mean += kalman_gain * forecast_error;
+      // a += K * v, accumulated in place to avoid two temporaries.
+      EigenMap(state_conditional_mean).noalias() +=
+          EigenMap(kalman_gain) * EigenMap(forecast_error);
     }
 
     // Need to define TPZprime before modifying P (known here as
@@ -132,15 +134,14 @@ namespace BOOM {
       TPZprime = transition_matrix *
                  multT(state_conditional_variance, observation_coefficients);
     }
-    // Set P = T * P * T.transpose()
-    transition_matrix.sandwich_inplace(state_conditional_variance);
+    // Set P = T * P * T.transpose() + RQR
+    transition_matrix.sandwich_inplace_and_add(state_conditional_variance,
+                                               RQR);
     if (!missing) {
       // Decrement P by T*P*Z.transpose()*K.transpose().  This step can be
       // skipped if y is missing, because K is zero.
       state_conditional_variance.Matrix::add_outer(TPZprime, kalman_gain, -1);
     }
-    // P += RQR
-    RQR.add_to(state_conditional_variance);
     state_conditional_variance.fix_near_symmetry();
     return log_likelihood;
   }
@@ -266,6 +267,100 @@ namespace BOOM {
   //   return log_likelihood;
   // }
 
+  namespace {
+    // Copy source.transpose() into dest, with its upper left corner at
+    // position (row, col).
+    void copy_transpose(const Matrix &source, Matrix &dest, int row, int col) {
+      for (int i = 0; i < source.nrow(); ++i) {
+        for (int j = 0; j < source.ncol(); ++j) {
+          dest(row + j, col + i) = source(i, j);
+        }
+      }
+    }
+
+    // Set dest to the transpose of the nrow x ncol block of R with its upper
+    // left corner at position (row, col), keeping only the elements on or
+    // above the diagonal of R.  Row i of R is multiplied by sign[i].
+    void copy_upper_transpose(const Matrix &R, const Vector &sign, int row,
+                              int col, int nrow, int ncol, Matrix &dest) {
+      dest.resize(ncol, nrow);
+      for (int j = 0; j < nrow; ++j) {
+        for (int i = 0; i < ncol; ++i) {
+          dest(i, j) = (row + j <= col + i) ? sign[row + j] * R(row + j, col + i)
+                                            : 0.0;
+        }
+      }
+    }
+  }  // namespace
+
+  Matrix variance_square_root(const SpdMatrix &V) {
+    bool ok = true;
+    Matrix ans = V.chol(ok);
+    if (ok) return ans;
+    Matrix eigenvectors(V.nrow(), V.ncol());
+    Vector eigenvalues = eigen(V, eigenvectors);
+    for (int i = 0; i < eigenvalues.size(); ++i) {
+      eigenvectors.col(i) *= sqrt(std::max<double>(eigenvalues[i], 0.0));
+    }
+    return eigenvectors;
+  }
+
+  //----------------------------------------------------------------------
+  void square_root_kalman_update(const Matrix &observation_variance_root,
+                                 const Matrix &ZL,
+                                 const SparseKalmanMatrix &transition,
+                                 const Matrix &L,
+                                 const Matrix &state_error_root,
+                                 Matrix &forecast_variance_root,
+                                 Matrix &gain_root,
+                                 Matrix &state_variance_root) {
+    int ydim = ZL.nrow();
+    int state_dim = L.nrow();
+    int error_dim = state_error_root.ncol();
+    if (L.ncol() != state_dim
+        || transition.nrow() != state_dim
+        || transition.ncol() != state_dim
+        || state_error_root.nrow() != state_dim
+        || (ydim > 0 && (ZL.ncol() != state_dim
+                         || observation_variance_root.nrow() != ydim
+                         || observation_variance_root.ncol() != ydim))) {
+      report_error("Incompatible arguments in square_root_kalman_update.");
+    }
+
+    // The transpose of the pre-array is tall, so its R factor is square.
+    int nrow = ydim + state_dim + error_dim;
+    int ncol = ydim + state_dim;
+    Matrix pre_array_transpose(nrow, ncol, 0.0);
+    copy_transpose(observation_variance_root, pre_array_transpose, 0, 0);
+    copy_transpose(ZL, pre_array_transpose, ydim, 0);
+    copy_transpose(L, pre_array_transpose, ydim, ydim);
+    // (T * L)' = L' * T'.
+    transition.matrix_transpose_premultiply_inplace(
+        SubMatrix(pre_array_transpose, ydim, ydim + state_dim - 1,
+                  ydim, ncol - 1));
+    copy_transpose(state_error_root, pre_array_transpose,
+                   ydim + state_dim, ydim);
+
+    // Only R is needed.  The in-place decomposition leaves R in the upper
+    // triangle of pre_array_transpose.
+    auto pre_array_map = EigenMap(pre_array_transpose);
+    Eigen::HouseholderQR<Eigen::Ref<Eigen::MatrixXd>> qr(pre_array_map);
+    const Matrix &R(pre_array_transpose);
+
+    // Householder QR only determines the columns of the post array (the rows
+    // of R) up to sign.  Choose the signs that make the diagonal
+    // non-negative, so the leading block is a proper Cholesky factor.
+    Vector sign(ncol, 1.0);
+    for (int i = 0; i < ncol; ++i) {
+      if (R(i, i) < 0) sign[i] = -1;
+    }
+    copy_upper_transpose(R, sign, 0, 0, ydim, ydim, forecast_variance_root);
+    copy_upper_transpose(R, sign, 0, ydim, ydim, state_dim, gain_root);
+    copy_upper_transpose(R, sign, ydim, ydim, state_dim, state_dim,
+                         state_variance_root);
+  }
+
+  //----------------------------------------------------------------------
   // As part of the Kalman smoothing (backward) recursion, update the
   // vector r[t] and the matrix N[t] to time t-1.
   //
@@ -182,6 +182,102 @@ namespace BOOM {
       const SparseKalmanMatrix &transition_matrix,
       const SparseKalmanMatrix &RQR);
 
+  // Returns a matrix S with S * S.transpose() == V.  If V is positive definite
+  // then S is its lower Cholesky triangle.  Otherwise V is only positive
+  // semidefinite (e.g. the state error variance of a model with deterministic
+  // state components), and S is built from the eigendecomposition of V, with
+  // any eigenvalues made negative by rounding error set to zero.
+  Matrix variance_square_root(const SpdMatrix &V);
+
+  // A square root of the state error variance R[t] * Q[t] * R[t]', for use by
+  // the square root filter.  Computing the root takes a Cholesky (or eigen)
+  // decomposition of Q[t], so filters keep one of these for each pass over
+  // the data, and reuse the root across time points when the state is time
+  // invariant.
+  class StateErrorVarianceRoot {
+   public:
+    StateErrorVarianceRoot() : current_(false), time_invariant_(false) {}
+
+    // Discard the stored root.  Filters call this at the start of each pass
+    // over the data, because the model parameters may have changed.
+    void clear() { current_ = false; }
+
+    // Returns a matrix S with S * S' == R * Q * R'.  If a root is stored from
+    // an earlier call and the state is time invariant, the stored root is
+    // returned without looking at the arguments.
+    //
+    // Args:
+    //   expander:  The state error expander R[t].
+    //   variance:  The state error variance Q[t].
+    //   time_invariant: A functor returning true if R and Q do not depend on
+    //     t.  It is only called when the root is computed.
+    template <class PREDICATE>
+    const Matrix &root(const SparseKalmanMatrix &expander,
+                       const SparseKalmanMatrix &variance,
+                       PREDICATE time_invariant) {
+      if (!current_ || !time_invariant_) {
+        root_ = expander * variance_square_root(variance.dense());
+        time_invariant_ = time_invariant();
+        current_ = true;
+      }
+      return root_;
+    }
+
+   private:
+    Matrix root_;
+    bool current_;
+    bool time_invariant_;
+  };
+
+  // One step of the square root (or "array") form of the Kalman filter, which
+  // carries a factor L[t] with L[t] * L[t]' == P[t] instead of P[t] itself.
+  //
+  // The pre-array
+  //
+  //         [ H^{1/2}   Z * L      0     ]
+  //     A = [                            ]
+  //         [    0      T * L   (RQR')^{1/2} ]
+  //
+  // satisfies A * A' == [F, Z P T' \ T P Z', T P T' + RQR'].  An orthogonal
+  // transformation (computed from the QR decomposition of A') reduces A to the
+  // lower triangular post-array
+  //
+  //         [ F^{1/2}     0     0 ]
+  //     B = [                     ]
+  //         [    G     L[t+1]   0 ]
+  //
+  // with B * B' == A * A'.  Thus G = T P Z' F^{-T/2}, the Kalman gain is
+  // K = G * F^{-1/2}, and L[t+1] * L[t+1]' == P[t+1].  Because P[t+1] is never
+  // computed by subtraction it can't lose positive definiteness to rounding
+  // error.
+  //
+  // T * L is formed in place inside the pre-array using the block structure of
+  // T (see SparseKalmanMatrix::matrix_transpose_premultiply_inplace), and the
+  // Householder reduction is done in place, without forming Q.
+  //
+  // Args:
+  //   observation_variance_root: A square root of H[t], the observation
+  //     variance of the observed elements of y[t].  This is 0 x 0 if y[t] is
+  //     entirely missing.
+  //   ZL: Z[t] * L[t], where Z[t] only includes rows for observed elements of
+  //     y[t].
+  //   transition:  T[t].
+  //   L: L[t], a root of P[t].
+  //   state_error_root: A matrix S with S * S' == R[t] * Q[t] * R[t]'.
+  //   forecast_variance_root: Input is not read.  On output this is the lower
+  //     Cholesky triangle of F[t].
+  //   gain_root:  Input is not read.  On output this is G, defined above.
+  //   state_variance_root: On output this is the lower triangular L[t+1].  It
+  //     may be the same object as L.
+  void square_root_kalman_update(const Matrix &observation_variance_root,
+                                 const Matrix &ZL,
+                                 const SparseKalmanMatrix &transition,
+                                 const Matrix &L,
+                                 const Matrix &state_error_root,
+                                 Matrix &forecast_variance_root,
+                                 Matrix &gain_root,
+                                 Matrix &state_variance_root);
+
   // Updates a[t] and P[t] to condition on all Y, and sets up r and N
   // for use in the next recursion.
   void sparse_scalar_kalman_smoother_update(
@@ -18,6 +18,7 @@
 */
 
 #include "Models/StateSpace/Filters/SparseMatrix.hpp"
+#include <algorithm>
 #include <iostream>
 #include <utility>
 #include "LinAlg/SpdMatrix.hpp"
@@ -43,6 +44,21 @@ namespace BOOM {
     report_error(err.str());
   }
 
+  void SparseKalmanMatrix::multiply(VectorView lhs,
+                                    const ConstVectorView &rhs) const {
+    lhs = (*this) * rhs;
+  }
+
+  void SparseKalmanMatrix::multiply_and_add(VectorView lhs,
+                                            const ConstVectorView &rhs) const {
+    lhs += (*this) * rhs;
+  }
+
+  void SparseKalmanMatrix::Tmult(VectorView lhs,
+                                 const ConstVectorView &rhs) const {
+    lhs = Tmult(rhs);
+  }
+
   namespace {
     template <class VECTOR>
     Vector sparse_multiply_impl(const SparseMatrixBlock &m, const VECTOR &v) {
@@ -448,6 +464,13 @@ namespace BOOM {
     return new LocalLinearTrendMatrix(*this);
   }
 
+  void LocalLinearTrendMatrix::fill(double *matrix) const {
+    matrix[0] = 1.0;
+    matrix[1] = 0.0;
+    matrix[2] = 1.0;
+    matrix[3] = 1.0;
+  }
+
   void LocalLinearTrendMatrix::multiply(VectorView lhs,
                                         const ConstVectorView &rhs) const {
     conforms_to_rows(lhs.size());
@@ -477,6 +500,17 @@ namespace BOOM {
     v[0] += v[1];
   }
 
+  void LocalLinearTrendMatrix::matrix_multiply_inplace(SubMatrix m) const {
+    conforms_to_cols(m.nrow());
+    m.row(0) += m.row(1);
+  }
+
+  void LocalLinearTrendMatrix::matrix_transpose_premultiply_inplace(
+      SubMatrix m) const {
+    conforms_to_cols(m.ncol());
+    m.col(0) += m.col(1);
+  }
+
   SpdMatrix LocalLinearTrendMatrix::inner() const {
     // 1 0 * 1 1  = 1 1
     // 1 1   0 1    1 2
@@ -627,6 +661,63 @@ namespace BOOM {
   //======================================================================
   namespace {
     typedef SeasonalStateSpaceMatrix SSSM;
+
+    // The seasonal and autoregression transition matrices share the form
+    //
+    //   w0 w1 w2 ... wp
+    //    1  0  0 ...  0
+    //    0  1  0 ...  0
+    //            ...
+    //    0  0 ... 1   0
+    //
+    // The following replace m with T * m and m * T.transpose() for a matrix T
+    // of this form, where weight(j) returns w_j.  Both work one column of m
+    // at a time, so memory is traversed contiguously.
+
+    // m = T * m.  In each column the first element becomes the weighted sum
+    // of the column, and the remaining elements shift down one place.
+    template <class WEIGHT>
+    void shift_rows_down(SubMatrix m, WEIGHT weight) {
+      const int n = m.nrow();
+      if (n == 0) return;
+      for (int j = 0; j < m.ncol(); ++j) {
+        double *column = m.data() + j * m.stride();
+        double first = weight(n - 1) * column[n - 1];
+        for (int i = n - 1; i > 0; --i) {
+          first += weight(i - 1) * column[i - 1];
+          column[i] = column[i - 1];
+        }
+        column[0] = first;
+      }
+    }
+
+    // m = m * T.transpose().  The first column becomes the weighted sum of
+    // the columns, and the remaining columns shift right one place.  Rows are
+    // handled in chunks so the running sums fit in a small buffer.
+    template <class WEIGHT>
+    void shift_columns_right(SubMatrix m, WEIGHT weight) {
+      const int n = m.ncol();
+      if (n == 0) return;
+      const int stride = m.stride();
+      const int chunk_size = 64;
+      double first[chunk_size];
+      for (int begin = 0; begin < m.nrow(); begin += chunk_size) {
+        const int size = std::min<int>(chunk_size, m.nrow() - begin);
+        double *column = m.data() + begin + (n - 1) * stride;
+        double w = weight(n - 1);
+        for (int i = 0; i < size; ++i) first[i] = w * column[i];
+        for (int j = n - 1; j > 0; --j) {
+          const double *previous = column - stride;
+          w = weight(j - 1);
+          for (int i = 0; i < size; ++i) {
+            first[i] += w * previous[i];
+            column[i] = previous[i];
+          }
+          column -= stride;
+        }
+        std::copy(first, first + size, column);
+      }
+    }
   }  // namespace
 
   SSSM::SeasonalStateSpaceMatrix(int number_of_seasons)
@@ -685,6 +776,16 @@ namespace BOOM {
     *now = total;
   }
 
+  void SSSM::matrix_multiply_inplace(SubMatrix m) const {
+    conforms_to_cols(m.nrow());
+    shift_rows_down(m, [](int) { return -1.0; });
+  }
+
+  void SSSM::matrix_transpose_premultiply_inplace(SubMatrix m) const {
+    conforms_to_cols(m.ncol());
+    shift_columns_right(m, [](int) { return -1.0; });
+  }
+
   SpdMatrix SSSM::inner() const {
     // -1  1  0  0 .... 0          -1 -1 -1 -1 ... -1
     // -1  0  1  0 .... 0           1  0  0  0 .... 0
@@ -805,6 +906,20 @@ namespace BOOM {
     }
   }
 
+  void AutoRegressionTransitionMatrix::matrix_multiply_inplace(
+      SubMatrix m) const {
+    conforms_to_cols(m.nrow());
+    const Vector &rho(autoregression_params_->value());
+    shift_rows_down(m, [&rho](int i) { return rho[i]; });
+  }
+
+  void AutoRegressionTransitionMatrix::matrix_transpose_premultiply_inplace(
+      SubMatrix m) const {
+    conforms_to_cols(m.ncol());
+    const Vector &rho(autoregression_params_->value());
+    shift_columns_right(m, [&rho](int i) { return rho[i]; });
+  }
+
   SpdMatrix AutoRegressionTransitionMatrix::inner() const {
     SpdMatrix ans = outer(autoregression_params_->value());
     int dim = ans.nrow();
@@ -1178,6 +1293,20 @@ namespace BOOM {
     return ans;
   }
 
+  void SparseKalmanMatrix::matrix_transpose_premultiply_inplace(
+      SubMatrix m) const {
+    if (nrow() != ncol()) {
+      report_error("matrix_transpose_premultiply_inplace only works for "
+                   "square matrices.");
+    }
+    conforms_to_cols(m.ncol());
+    Vector row(ncol());
+    for (int i = 0; i < m.nrow(); ++i) {
+      row = m.row(i);
+      multiply(m.row(i), row);
+    }
+  }
+
   void SparseKalmanMatrix::sandwich_inplace(SpdMatrix &P) const {
     // First replace P with *this * P, which corresponds to *this
     // multiplying each column of P.
@@ -1195,6 +1324,12 @@ namespace BOOM {
     }
   }
 
+  void SparseKalmanMatrix::sandwich_inplace_and_add(
+      SpdMatrix &P, const SparseKalmanMatrix &variance) const {
+    sandwich_inplace(P);
+    variance.add_to(P);
+  }
+
   void SparseKalmanMatrix::sandwich_inplace_submatrix(SubMatrix P) const {
     SpdMatrix tmp(P.to_matrix());
     sandwich_inplace(tmp);
@@ -1287,10 +1422,13 @@ namespace BOOM {
   }
 
   //======================================================================
-  BlockDiagonalMatrix::BlockDiagonalMatrix() : nrow_(0), ncol_(0) {}
+  BlockDiagonalMatrix::BlockDiagonalMatrix()
+      : nrow_(0), ncol_(0), square_blocks_(true) {}
 
   void BlockDiagonalMatrix::add_block(const Ptr<SparseMatrixBlock> &m) {
     blocks_.push_back(m);
+    plan_.push_back(compile_block(m.get(), nrow_, ncol_));
+    square_blocks_ = square_blocks_ && (m->nrow() == m->ncol());
     nrow_ += m->nrow();
     ncol_ += m->ncol();
     row_boundaries_.push_back(nrow_);
@@ -1299,20 +1437,188 @@ namespace BOOM {
 
   void BlockDiagonalMatrix::replace_block(int which_block,
                                           const Ptr<SparseMatrixBlock> &b) {
-    if (b->nrow() != blocks_[which_block]->nrow() ||
-        b->ncol() != blocks_[which_block]->ncol()) {
-      report_error("");
+    PlanEntry &entry(plan_[which_block]);
+    if (b.get() == entry.block) {
+      return;
+    }
+    if (b->nrow() != entry.nrow || b->ncol() != entry.ncol) {
+      report_error("Replacement block has the wrong dimensions.");
     }
     blocks_[which_block] = b;
+    entry = compile_block(b.get(), entry.row_begin, entry.col_begin);
   }
 
   void BlockDiagonalMatrix::clear() {
     blocks_.clear();
+    plan_.clear();
+    square_blocks_ = true;
     nrow_ = ncol_ = 0;
     row_boundaries_.clear();
     col_boundaries_.clear();
   }
 
+  namespace {
+    template <int DIM>
+    void sandwich_fixed(const SparseMatrixBlock *block, SubMatrix m) {
+      static_cast<const FixedDimensionMatrixBlock<DIM> *>(block)
+          ->sandwich_block_inplace(m);
+    }
+  }  // namespace
+
+  BlockDiagonalMatrix::PlanEntry BlockDiagonalMatrix::compile_block(
+      const SparseMatrixBlock *block, int row_begin, int col_begin) {
+    PlanEntry entry;
+    entry.block = block;
+    entry.row_begin = row_begin;
+    entry.col_begin = col_begin;
+    entry.nrow = block->nrow();
+    entry.ncol = block->ncol();
+    entry.kind = block->kind();
+    entry.fixed_dimension = block->fixed_dimension();
+    return entry;
+  }
+
+  // In the block operations below the specialized cases use qualified names,
+  // so the calls are resolved at compile time and can be inlined.
+  void BlockDiagonalMatrix::multiply_block(const PlanEntry &entry,
+                                           VectorView lhs,
+                                           const ConstVectorView &rhs) const {
+    switch (entry.kind) {
+      case BlockKind::kIdentity:
+        lhs = rhs;
+        break;
+      case BlockKind::kSeasonal:
+        static_cast<const SeasonalStateSpaceMatrix *>(entry.block)
+            ->SeasonalStateSpaceMatrix::multiply(lhs, rhs);
+        break;
+      case BlockKind::kLocalLinearTrend:
+        static_cast<const LocalLinearTrendMatrix *>(entry.block)
+            ->LocalLinearTrendMatrix::multiply(lhs, rhs);
+        break;
+      case BlockKind::kAutoRegression:
+        static_cast<const AutoRegressionTransitionMatrix *>(entry.block)
+            ->AutoRegressionTransitionMatrix::multiply(lhs, rhs);
+        break;
+      default:
+        entry.block->multiply(lhs, rhs);
+    }
+  }
+
+  void BlockDiagonalMatrix::multiply_and_add_block(
+      const PlanEntry &entry, VectorView lhs,
+      const ConstVectorView &rhs) const {
+    switch (entry.kind) {
+      case BlockKind::kIdentity:
+        lhs += rhs;
+        break;
+      case BlockKind::kSeasonal:
+        static_cast<const SeasonalStateSpaceMatrix *>(entry.block)
+            ->SeasonalStateSpaceMatrix::multiply_and_add(lhs, rhs);
+        break;
+      case BlockKind::kLocalLinearTrend:
+        static_cast<const LocalLinearTrendMatrix *>(entry.block)
+            ->LocalLinearTrendMatrix::multiply_and_add(lhs, rhs);
+        break;
+      case BlockKind::kAutoRegression:
+        static_cast<const AutoRegressionTransitionMatrix *>(entry.block)
+            ->AutoRegressionTransitionMatrix::multiply_and_add(lhs, rhs);
+        break;
+      default:
+        entry.block->multiply_and_add(lhs, rhs);
+    }
+  }
+
+  void BlockDiagonalMatrix::Tmult_block(const PlanEntry &entry,
+                                        VectorView lhs,
+                                        const ConstVectorView &rhs) const {
+    switch (entry.kind) {
+      case BlockKind::kIdentity:
+        lhs = rhs;
+        break;
+      case BlockKind::kSeasonal:
+        static_cast<const SeasonalStateSpaceMatrix *>(entry.block)
+            ->SeasonalStateSpaceMatrix::Tmult(lhs, rhs);
+        break;
+      case BlockKind::kLocalLinearTrend:
+        static_cast<const LocalLinearTrendMatrix *>(entry.block)
+            ->LocalLinearTrendMatrix::Tmult(lhs, rhs);
+        break;
+      case BlockKind::kAutoRegression:
+        static_cast<const AutoRegressionTransitionMatrix *>(entry.block)
+            ->AutoRegressionTransitionMatrix::Tmult(lhs, rhs);
+        break;
+      default:
+        entry.block->Tmult(lhs, rhs);
+    }
+  }
+
+  void BlockDiagonalMatrix::left_multiply_block_inplace(const PlanEntry &entry,
+                                                        SubMatrix m) const {
+    switch (entry.kind) {
+      case BlockKind::kIdentity:
+        break;
+      case BlockKind::kSeasonal:
+        static_cast<const SeasonalStateSpaceMatrix *>(entry.block)
+            ->SeasonalStateSpaceMatrix::matrix_multiply_inplace(m);
+        break;
+      case BlockKind::kLocalLinearTrend:
+        static_cast<const LocalLinearTrendMatrix *>(entry.block)
+            ->LocalLinearTrendMatrix::matrix_multiply_inplace(m);
+        break;
+      case BlockKind::kAutoRegression:
+        static_cast<const AutoRegressionTransitionMatrix *>(entry.block)
+            ->AutoRegressionTransitionMatrix::matrix_multiply_inplace(m);
+        break;
+      default:
+        entry.block->matrix_multiply_inplace(m);
+    }
+  }
+
+  void BlockDiagonalMatrix::right_multiply_block_inplace(
+      const PlanEntry &entry, SubMatrix m) const {
+    switch (entry.kind) {
+      case BlockKind::kIdentity:
+        break;
+      case BlockKind::kSeasonal:
+        static_cast<const SeasonalStateSpaceMatrix *>(entry.block)
+            ->SeasonalStateSpaceMatrix::matrix_transpose_premultiply_inplace(
+                m);
+        break;
+      case BlockKind::kLocalLinearTrend:
+        static_cast<const LocalLinearTrendMatrix *>(entry.block)
+            ->LocalLinearTrendMatrix::matrix_transpose_premultiply_inplace(m);
+        break;
+      case BlockKind::kAutoRegression:
+        static_cast<const AutoRegressionTransitionMatrix *>(entry.block)
+            ->AutoRegressionTransitionMatrix::
+            matrix_transpose_premultiply_inplace(m);
+        break;
+      default:
+        entry.block->matrix_transpose_premultiply_inplace(m);
+    }
+  }
+
+  void BlockDiagonalMatrix::sandwich_fixed_block_inplace(
+      const PlanEntry &entry, SubMatrix m) const {
+    switch (entry.fixed_dimension) {
+      case 1:
+        sandwich_fixed<1>(entry.block, m);
+        break;
+      case 2:
+        sandwich_fixed<2>(entry.block, m);
+        break;
+      case 3:
+        sandwich_fixed<3>(entry.block, m);
+        break;
+      case 4:
+        sandwich_fixed<4>(entry.block, m);
+        break;
+      default:
+        left_multiply_block_inplace(entry, m);
+        right_multiply_block_inplace(entry, m);
+    }
+  }
+
   int BlockDiagonalMatrix::nrow() const { return nrow_; }
   int BlockDiagonalMatrix::ncol() const { return ncol_; }
 
@@ -1353,6 +1659,40 @@ namespace BOOM {
     return block_multiply(v, nrow(), ncol(), blocks_);
   }
 
+  void BlockDiagonalMatrix::multiply(VectorView lhs,
+                                     const ConstVectorView &rhs) const {
+    conforms_to_rows(lhs.size());
+    conforms_to_cols(rhs.size());
+    // Some blocks only write their nonzero elements.
+    lhs = 0.0;
+    for (const PlanEntry &entry : plan_) {
+      multiply_block(entry, VectorView(lhs, entry.row_begin, entry.nrow),
+                     ConstVectorView(rhs, entry.col_begin, entry.ncol));
+    }
+  }
+
+  void BlockDiagonalMatrix::multiply_and_add(
+      VectorView lhs, const ConstVectorView &rhs) const {
+    conforms_to_rows(lhs.size());
+    conforms_to_cols(rhs.size());
+    for (const PlanEntry &entry : plan_) {
+      multiply_and_add_block(
+          entry, VectorView(lhs, entry.row_begin, entry.nrow),
+          ConstVectorView(rhs, entry.col_begin, entry.ncol));
+    }
+  }
+
+  void BlockDiagonalMatrix::Tmult(VectorView lhs,
+                                  const ConstVectorView &rhs) const {
+    conforms_to_cols(lhs.size());
+    conforms_to_rows(rhs.size());
+    lhs = 0.0;
+    for (const PlanEntry &entry : plan_) {
+      Tmult_block(entry, VectorView(lhs, entry.col_begin, entry.ncol),
+                  ConstVectorView(rhs, entry.row_begin, entry.nrow));
+    }
+  }
+
   Vector BlockDiagonalMatrix::Tmult(const ConstVectorView &x) const {
     if (x.size() != nrow()) {
       report_error(
@@ -1448,17 +1788,79 @@ namespace BOOM {
   }
 
   void BlockDiagonalMatrix::sandwich_inplace(SpdMatrix &P) const {
-    for (int i = 0; i < blocks_.size(); ++i) {
-      int rlo = i == 0 ? 0 : row_boundaries_[i - 1];
-      int rhi = row_boundaries_[i] - 1;
-      blocks_[i]->matrix_multiply_inplace(
-          SubMatrix(P, rlo, rhi, 0, P.ncol() - 1));
+    sandwich_upper_blocks(P, nullptr);
+    P.reflect();
+  }
+
+  void BlockDiagonalMatrix::sandwich_inplace_and_add(
+      SpdMatrix &P, const SparseKalmanMatrix &variance) const {
+    const BlockDiagonalMatrix *block_variance =
+        dynamic_cast<const BlockDiagonalMatrix *>(&variance);
+    if (block_variance && has_same_square_blocks(*block_variance)) {
+      sandwich_upper_blocks(P, block_variance);
+      P.reflect();
+    } else {
+      sandwich_inplace(P);
+      variance.add_to(P);
+    }
+  }
+
+  // Block (i, j) of T * P * T' is T[i] * P[i, j] * T[j]', which only involves
+  // block (i, j) of P.  Each block can be transformed in place independently
+  // of the others, and by symmetry only the blocks with j >= i are needed.
+  void BlockDiagonalMatrix::sandwich_upper_blocks(
+      SpdMatrix &P, const BlockDiagonalMatrix *variance) const {
+    if (!square_blocks_) {
+      report_error("sandwich_inplace requires all blocks to be square.");
+    }
+    if (P.nrow() != nrow()) {
+      report_error("'sandwich_inplace' called on a non-conforming matrix.");
+    }
+    for (int i = 0; i < plan_.size(); ++i) {
+      const PlanEntry &left(plan_[i]);
+      if (left.nrow == 0) continue;
+      for (int j = i; j < plan_.size(); ++j) {
+        const PlanEntry &right(plan_[j]);
+        if (right.nrow == 0) continue;
+        SubMatrix block(P, left.row_begin, left.row_begin + left.nrow - 1,
+                        right.row_begin, right.row_begin + right.nrow - 1);
+        if (i == j && left.fixed_dimension > 0) {
+          sandwich_fixed_block_inplace(left, block);
+        } else {
+          left_multiply_block_inplace(left, block);
+          right_multiply_block_inplace(right, block);
+        }
+        if (variance && i == j) {
+          variance->plan_[i].block->add_to_block(block);
+        }
+      }
     }
-    for (int i = 0; i < blocks_.size(); ++i) {
-      int clo = i == 0 ? 0 : col_boundaries_[i - 1];
-      int chi = col_boundaries_[i] - 1;
-      blocks_[i]->matrix_transpose_premultiply_inplace(
-          SubMatrix(P, 0, P.nrow() - 1, clo, chi));
+  }
+
+  bool BlockDiagonalMatrix::has_same_square_blocks(
+      const BlockDiagonalMatrix &other) const {
+    if (!other.square_blocks_ || other.plan_.size() != plan_.size()) {
+      return false;
+    }
+    for (int i = 0; i < plan_.size(); ++i) {
+      if (other.plan_[i].nrow != plan_[i].nrow) return false;
+    }
+    return true;
+  }
+
+  void BlockDiagonalMatrix::matrix_transpose_premultiply_inplace(
+      SubMatrix m) const {
+    if (!square_blocks_) {
+      report_error("matrix_transpose_premultiply_inplace requires square "
+                   "blocks.");
+    }
+    conforms_to_cols(m.ncol());
+    if (m.nrow() == 0) return;
+    for (const PlanEntry &entry : plan_) {
+      if (entry.ncol == 0) continue;
+      right_multiply_block_inplace(
+          entry, SubMatrix(m, 0, m.nrow() - 1, entry.col_begin,
+                           entry.col_begin + entry.ncol - 1));
     }
   }
 
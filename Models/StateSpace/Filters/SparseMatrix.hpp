@@ -61,12 +61,40 @@ namespace BOOM {
     virtual Vector Tmult(const ConstVectorView &v) const = 0;
     virtual Matrix Tmult(const Matrix &rhs) const;
 
+    // Versions of the matrix-vector products that write into caller-supplied
+    // storage, for code like the Kalman filter that runs in a tight loop and
+    // should not allocate.  lhs must already have the right size, and must not
+    // overlap rhs.
+    //   multiply:          lhs = this * rhs
+    //   multiply_and_add:  lhs += this * rhs
+    //   Tmult:             lhs = this->transpose() * rhs
+    // The default implementations are written in terms of the operators
+    // above, so they allocate a temporary.  Concrete classes should override.
+    virtual void multiply(VectorView lhs, const ConstVectorView &rhs) const;
+    virtual void multiply_and_add(VectorView lhs,
+                                  const ConstVectorView &rhs) const;
+    virtual void Tmult(VectorView lhs, const ConstVectorView &rhs) const;
+
     // Replace the argument P with
     //   this * P * this.transpose()
     // This only works with square matrices.  Non-square matrices will throw.
     virtual void sandwich_inplace(SpdMatrix &P) const;
     virtual void sandwich_inplace_submatrix(SubMatrix P) const;
 
+    // Replace the argument P with
+    //   this * P * this.transpose() + variance
+    // which is the state variance step of the Kalman filter (T P T' + RQR').
+    // The default implementation calls sandwich_inplace followed by
+    // variance.add_to.  Classes that can do both in a single pass should
+    // override.
+    virtual void sandwich_inplace_and_add(
+        SpdMatrix &P, const SparseKalmanMatrix &variance) const;
+
+    // Replace m with m * this->transpose().  This only works with square
+    // matrices.  The default implementation multiplies each row of m by
+    // *this.
+    virtual void matrix_transpose_premultiply_inplace(SubMatrix m) const;
+
     // Replace the argument P with
     //    this->transpose() * P * this
     // This only works with square matrices.  Non-square matrices will throw.
@@ -183,7 +211,7 @@ namespace BOOM {
     Matrix dense() const override;
 
     // m = m * this->t();
-    virtual void matrix_transpose_premultiply_inplace(SubMatrix m) const;
+    void matrix_transpose_premultiply_inplace(SubMatrix m) const override;
 
     // Add *this to block
     virtual void add_to_block(SubMatrix block) const = 0;
@@ -194,6 +222,206 @@ namespace BOOM {
     virtual void left_inverse(VectorView lhs,
                               const ConstVectorView &rhs) const;
     using SparseKalmanMatrix::left_inverse;
+
+    // Block types that are common in state transition matrices, and that get
+    // specialized (non-virtual) kernels in BlockDiagonalMatrix.  All other
+    // blocks are kGeneric, and are handled through the virtual interface.
+    enum class Kind {
+      kGeneric,
+      kIdentity,
+      kSeasonal,
+      kLocalLinearTrend,
+      kAutoRegression
+    };
+    virtual Kind kind() const { return Kind::kGeneric; }
+
+    // The dimension of a FixedDimensionMatrixBlock, or 0 for other blocks.
+    // BlockDiagonalMatrix relies on a nonzero value meaning the block is a
+    // FixedDimensionMatrixBlock<fixed_dimension()>, so only that class
+    // overrides it.
+    virtual int fixed_dimension() const { return 0; }
+  };
+
+  //===========================================================================
+  // A square SparseMatrixBlock whose dimension is fixed at compile time.  Most
+  // state models have tiny transition matrices (2 x 2 for the local linear
+  // trend, 3 x 3 for the semilocal linear trend), where the loops, views, and
+  // virtual calls in the general SparseMatrixBlock operations cost more than
+  // the arithmetic.
+  //
+  // Child classes describe the matrix by implementing fill().  The operations
+  // below copy the matrix into a DIM x DIM array on the stack and work with
+  // loop bounds known at compile time, so the compiler can unroll them
+  // completely and nothing is allocated.  Child classes can still override
+  // any of them to take advantage of known zeros.
+  //
+  // BlockDiagonalMatrix recognizes these blocks (for DIM up to 4) and uses
+  // sandwich_block_inplace() for the diagonal blocks of T * P * T'.
+  template <int DIM>
+  class FixedDimensionMatrixBlock : public SparseMatrixBlock {
+   public:
+    static_assert(DIM > 0, "The dimension of a matrix must be positive.");
+    static constexpr int dimension = DIM;
+
+    // Write the elements of the matrix to 'matrix' in column major order, so
+    // that element (i, j) is matrix[i + j * DIM].
+    virtual void fill(double *matrix) const = 0;
+
+    int nrow() const override { return DIM; }
+    int ncol() const override { return DIM; }
+    int fixed_dimension() const override { return DIM; }
+
+    void multiply(VectorView lhs, const ConstVectorView &rhs) const override {
+      conforms_to_rows(lhs.size());
+      conforms_to_cols(rhs.size());
+      double T[DIM * DIM], x[DIM];
+      fill(T);
+      load(rhs, x);
+      for (int i = 0; i < DIM; ++i) lhs[i] = row_dot(T, i, x);
+    }
+
+    void multiply_and_add(VectorView lhs,
+                          const ConstVectorView &rhs) const override {
+      conforms_to_rows(lhs.size());
+      conforms_to_cols(rhs.size());
+      double T[DIM * DIM], x[DIM];
+      fill(T);
+      load(rhs, x);
+      for (int i = 0; i < DIM; ++i) lhs[i] += row_dot(T, i, x);
+    }
+
+    void Tmult(VectorView lhs, const ConstVectorView &rhs) const override {
+      conforms_to_cols(lhs.size());
+      conforms_to_rows(rhs.size());
+      double T[DIM * DIM], x[DIM];
+      fill(T);
+      load(rhs, x);
+      for (int j = 0; j < DIM; ++j) lhs[j] = col_dot(T, j, x);
+    }
+
+    void multiply_inplace(VectorView v) const override {
+      conforms_to_cols(v.size());
+      double T[DIM * DIM], x[DIM];
+      fill(T);
+      load(v, x);
+      for (int i = 0; i < DIM; ++i) v[i] = row_dot(T, i, x);
+    }
+
+    // m = this * m
+    void matrix_multiply_inplace(SubMatrix m) const override {
+      conforms_to_cols(m.nrow());
+      double T[DIM * DIM], x[DIM];
+      fill(T);
+      for (int j = 0; j < m.ncol(); ++j) {
+        double *column = m.data() + j * m.stride();
+        for (int k = 0; k < DIM; ++k) x[k] = column[k];
+        for (int i = 0; i < DIM; ++i) column[i] = row_dot(T, i, x);
+      }
+    }
+
+    // m = m * this->transpose()
+    void matrix_transpose_premultiply_inplace(SubMatrix m) const override {
+      conforms_to_cols(m.ncol());
+      double T[DIM * DIM], x[DIM];
+      fill(T);
+      const int stride = m.stride();
+      for (int r = 0; r < m.nrow(); ++r) {
+        double *row = m.data() + r;
+        for (int k = 0; k < DIM; ++k) x[k] = row[k * stride];
+        for (int i = 0; i < DIM; ++i) row[i * stride] = row_dot(T, i, x);
+      }
+    }
+
+    // Replace the DIM x DIM matrix P with this * P * this->transpose().
+    // This is 2 * DIM^3 multiplications with no temporaries on the heap.
+    void sandwich_block_inplace(SubMatrix P) const {
+      conforms_to_rows(P.nrow());
+      conforms_to_cols(P.ncol());
+      double T[DIM * DIM], TP[DIM * DIM];
+      fill(T);
+      double *data = P.data();
+      const int stride = P.stride();
+      for (int j = 0; j < DIM; ++j) {
+        for (int i = 0; i < DIM; ++i) {
+          double total = 0;
+          for (int k = 0; k < DIM; ++k) {
+            total += T[i + k * DIM] * data[k + j * stride];
+          }
+          TP[i + j * DIM] = total;
+        }
+      }
+      for (int j = 0; j < DIM; ++j) {
+        for (int i = 0; i < DIM; ++i) {
+          data[i + j * stride] = row_dot(TP, i, T + j, DIM);
+        }
+      }
+    }
+
+    SpdMatrix inner() const override {
+      double T[DIM * DIM];
+      fill(T);
+      SpdMatrix ans(DIM);
+      for (int j = 0; j < DIM; ++j) {
+        for (int i = 0; i <= j; ++i) {
+          ans(i, j) = ans(j, i) = col_dot(T, i, T + j * DIM);
+        }
+      }
+      return ans;
+    }
+
+    SpdMatrix inner(const ConstVectorView &weights) const override {
+      if (weights.size() != DIM) {
+        report_error("Wrong size weight vector");
+      }
+      double T[DIM * DIM], weighted_column[DIM];
+      fill(T);
+      SpdMatrix ans(DIM);
+      for (int j = 0; j < DIM; ++j) {
+        for (int k = 0; k < DIM; ++k) {
+          weighted_column[k] = weights[k] * T[k + j * DIM];
+        }
+        for (int i = 0; i <= j; ++i) {
+          ans(i, j) = ans(j, i) = col_dot(T, i, weighted_column);
+        }
+      }
+      return ans;
+    }
+
+    void add_to_block(SubMatrix block) const override {
+      check_can_add(block);
+      double T[DIM * DIM];
+      fill(T);
+      for (int j = 0; j < DIM; ++j) {
+        double *column = block.data() + j * block.stride();
+        for (int i = 0; i < DIM; ++i) column[i] += T[i + j * DIM];
+      }
+    }
+
+    Matrix dense() const override {
+      Matrix ans(DIM, DIM);
+      fill(ans.data());
+      return ans;
+    }
+
+   private:
+    static void load(const ConstVectorView &v, double *x) {
+      for (int i = 0; i < DIM; ++i) x[i] = v[i];
+    }
+
+    // Returns sum_k A(i, k) * x[k * x_stride], where A is DIM x DIM.
+    static double row_dot(const double *A, int i, const double *x,
+                          int x_stride = 1) {
+      double ans = 0;
+      for (int k = 0; k < DIM; ++k) ans += A[i + k * DIM] * x[k * x_stride];
+      return ans;
+    }
+
+    // Returns sum_k A(k, j) * x[k], where A is DIM x DIM.
+    static double col_dot(const double *A, int j, const double *x) {
+      double ans = 0;
+      for (int k = 0; k < DIM; ++k) ans += A[k + j * DIM] * x[k];
+      return ans;
+    }
   };
 
   //===========================================================================
@@ -276,20 +504,22 @@ namespace BOOM {
   //  It corresponds to state elements [mu, delta], where mu[t] =
   //  mu[t-1] + delta[t-1] + error[0] and de[ta[t] = delta[t-1] +
   //  error[1].
-  class LocalLinearTrendMatrix : public SparseMatrixBlock {
+  class LocalLinearTrendMatrix : public FixedDimensionMatrixBlock<2> {
    public:
     LocalLinearTrendMatrix *clone() const override;
-    int nrow() const override { return 2; }
-    int ncol() const override { return 2; }
+    void fill(double *matrix) const override;
     void multiply(VectorView lhs, const ConstVectorView &rhs) const override;
     void multiply_and_add(VectorView lhs,
                           const ConstVectorView &rhs) const override;
     void Tmult(VectorView lhs, const ConstVectorView &rhs) const override;
     void multiply_inplace(VectorView v) const override;
+    void matrix_multiply_inplace(SubMatrix m) const override;
+    void matrix_transpose_premultiply_inplace(SubMatrix m) const override;
     SpdMatrix inner() const override;
     SpdMatrix inner(const ConstVectorView &weights) const override;
     void add_to_block(SubMatrix block) const override;
     Matrix dense() const override;
+    Kind kind() const override { return Kind::kLocalLinearTrend; }
   };
 
   //======================================================================
@@ -575,10 +805,15 @@ namespace BOOM {
     void Tmult(VectorView lhs, const ConstVectorView &rhs) const override;
     // x = (*this) * x;
     void multiply_inplace(VectorView x) const override;
+    // m = (*this) * m, and m = m * this->transpose().  These work a column
+    // of m at a time, so they touch memory contiguously.
+    void matrix_multiply_inplace(SubMatrix m) const override;
+    void matrix_transpose_premultiply_inplace(SubMatrix m) const override;
     SpdMatrix inner() const override;
     SpdMatrix inner(const ConstVectorView &weights) const override;
     void add_to_block(SubMatrix block) const override;
     Matrix dense() const override;
+    Kind kind() const override { return Kind::kSeasonal; }
 
    private:
     int number_of_seasons_;
@@ -614,9 +849,10 @@ namespace BOOM {
     SpdMatrix inner() const override;
     SpdMatrix inner(const ConstVectorView &weights) const override;
     void add_to_block(SubMatrix block) const override;
-    // virtual void matrix_multiply_inplace(SubMatrix m) const;
-    // virtual void matrix_transpose_premultiply_inplace(SubMatrix m) const;
+    void matrix_multiply_inplace(SubMatrix m) const override;
+    void matrix_transpose_premultiply_inplace(SubMatrix m) const override;
     Matrix dense() const override;
+    Kind kind() const override { return Kind::kAutoRegression; }
 
    private:
     Ptr<GlmCoefs> autoregression_params_;
@@ -658,6 +894,7 @@ namespace BOOM {
       ans.diag() = weights;
       return ans;
     }
+    Kind kind() const override { return Kind::kIdentity; }
 
    private:
     int dim_;
@@ -1591,8 +1828,13 @@ namespace BOOM {
     // multiplication operator from the base class.
     using SparseKalmanMatrix::operator*;
 
+    void multiply(VectorView lhs, const ConstVectorView &rhs) const override;
+    void multiply_and_add(VectorView lhs,
+                          const ConstVectorView &rhs) const override;
+
     using SparseKalmanMatrix::Tmult;
     Vector Tmult(const ConstVectorView &x) const override;
+    void Tmult(VectorView lhs, const ConstVectorView &rhs) const override;
     SpdMatrix inner() const override;
     SpdMatrix inner(const ConstVectorView &weights) const override;
 
@@ -1600,6 +1842,17 @@ namespace BOOM {
     void sandwich_inplace(SpdMatrix &P) const override;
     void sandwich_inplace_submatrix(SubMatrix P) const override;
 
+    // m -> m * this.transpose(), one block of columns at a time.
+    void matrix_transpose_premultiply_inplace(SubMatrix m) const override;
+
+    // P -> this * P * this.transpose() + variance.  If variance is a
+    // BlockDiagonalMatrix with the same block structure as *this (as is the
+    // case for the transition and variance matrices assembled from a
+    // collection of state models) then each diagonal block of variance is
+    // added in the same pass that transforms the corresponding block of P.
+    void sandwich_inplace_and_add(
+        SpdMatrix &P, const SparseKalmanMatrix &variance) const override;
+
     // sandwich(P) = this * P * this.transpose()
     SpdMatrix sandwich(const SpdMatrix &P) const override;
 
@@ -1620,6 +1873,57 @@ namespace BOOM {
     Vector left_inverse(const ConstVectorView &rhs) const override;
 
    private:
+    typedef SparseMatrixBlock::Kind BlockKind;
+
+    // The type and position of each block.  The plan is updated as blocks are
+    // added or replaced, so the operations called at each time step of the
+    // Kalman filter dispatch with a switch on 'kind' rather than through
+    // several layers of virtual calls.
+    struct PlanEntry {
+      BlockKind kind;
+      const SparseMatrixBlock *block;
+      int row_begin;
+      int col_begin;
+      int nrow;
+      int ncol;
+      // The dimension of a FixedDimensionMatrixBlock, or 0 for other blocks.
+      int fixed_dimension;
+    };
+    static PlanEntry compile_block(const SparseMatrixBlock *block,
+                                   int row_begin, int col_begin);
+
+    // Operations on a single block, dispatched through the plan.
+    //   left_multiply_block_inplace:  m = block * m
+    //   right_multiply_block_inplace:  m = m * block.transpose()
+    // Both require the block to be square.
+    void multiply_block(const PlanEntry &entry, VectorView lhs,
+                        const ConstVectorView &rhs) const;
+    void multiply_and_add_block(const PlanEntry &entry, VectorView lhs,
+                                const ConstVectorView &rhs) const;
+    void Tmult_block(const PlanEntry &entry, VectorView lhs,
+                     const ConstVectorView &rhs) const;
+    void left_multiply_block_inplace(const PlanEntry &entry,
+                                     SubMatrix m) const;
+    void right_multiply_block_inplace(const PlanEntry &entry,
+                                      SubMatrix m) const;
+
+    // m = block * m * block.transpose(), for a diagonal block m of a
+    // FixedDimensionMatrixBlock.
+    void sandwich_fixed_block_inplace(const PlanEntry &entry,
+                                      SubMatrix m) const;
+
+    // Replace the blocks on and above the block diagonal of P with the
+    // corresponding blocks of this * P * this.transpose().  If variance is
+    // non-NULL its diagonal blocks are added to the diagonal blocks of the
+    // result.  The blocks below the diagonal are left unchanged, and must be
+    // filled by the caller (e.g. with P.reflect()).
+    void sandwich_upper_blocks(SpdMatrix &P,
+                               const BlockDiagonalMatrix *variance) const;
+
+    // Returns true iff 'other' has square blocks matching the row
+    // partition of *this.
+    bool has_same_square_blocks(const BlockDiagonalMatrix &other) const;
+
     // Replace middle with left * middle * right.transpose()
     void sandwich_inplace_block(const SparseMatrixBlock &left,
                                 const SparseMatrixBlock &right,
@@ -1647,6 +1951,12 @@ namespace BOOM {
     // col_boundaries_[i] contains the one-past-the-end position of the upper
     // column boundary of block i.
     std::vector<int> col_boundaries_;
+
+    // plan_[i] describes blocks_[i].
+    std::vector<PlanEntry> plan_;
+
+    // True if every block is square.
+    bool square_blocks_;
   };
   //============================================================================
   // A SparseKalmanMatrix made of blocks that form vertical strips (analogous to
@@ -224,6 +224,17 @@ namespace BOOM {
     return ans;
   }
 
+  void multiply(VectorView lhs, const SpdMatrix &P, const SparseVector &z) {
+    int n = nrow(P);
+    if (lhs.size() != n) {
+      report_error("Wrong size output argument in multiply(lhs, P, z).");
+    }
+    // P is symmetric, so row i and column i agree.  Columns are contiguous.
+    for (int i = 0; i < n; ++i) {
+      lhs[i] = z.dot(P.col(i));
+    }
+  }
+
   std::ostream &operator<<(std::ostream &out, const SparseVector &z) {
     int n = z.size();
     if (n == 0) return out;
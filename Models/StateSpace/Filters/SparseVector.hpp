@@ -24,6 +24,7 @@
 
 #include "LinAlg/SubMatrix.hpp"
 #include "LinAlg/Vector.hpp"
+#include "LinAlg/VectorView.hpp"
 
 #include "Models/ParamTypes.hpp"
 
@@ -103,6 +104,9 @@ namespace BOOM {
 
   Vector operator*(const SpdMatrix &P, const SparseVector &v);
   Vector operator*(const SubMatrix P, const SparseVector &v);
+
+  // Set lhs = P * v without allocating.  lhs must have size P.nrow().
+  void multiply(VectorView lhs, const SpdMatrix &P, const SparseVector &v);
   std::ostream &operator<<(std::ostream &, const SparseVector &v);
 
 }  // namespace BOOM
@@ -4,6 +4,7 @@
 #include "Models/StateSpace/StateSpaceModel.hpp"
 #include "Models/StateSpace/StateModels/LocalLevelStateModel.hpp"
 #include "Models/StateSpace/MultivariateStateSpaceRegressionModel.hpp"
+#include "Models/StateSpace/Filters/SparseKalmanTools.hpp"
 
 
 #include "LinAlg/DiagonalMatrix.hpp"
@@ -233,4 +234,76 @@ namespace {
     
   }
 
+  // Check that the square root update matches the standard update, with and
+  // without missing observations.
+  TEST_F(ConditionallyIndependentKalmanFilterTest, SquareRootMatch) {
+    int ydim = 5;
+    int nfactors = 2;
+    Matrix data(3, ydim);
+    data.randomize();
+
+    NEW(MultivariateStateSpaceRegressionModel, model)(0, ydim);
+    for (int i = 0; i < data.nrow(); ++i) {
+      for (int j = 0; j < ydim; ++j) {
+        NEW(TimeSeriesRegressionData, data_point)(
+            data(i, j), Vector(1, 1.0), j, i);
+        model->add_data(data_point);
+      }
+    }
+    NEW(SharedLocalLevelStateModel, state_model)(nfactors, model.get(), ydim);
+    state_model->set_initial_state_mean(Vector(nfactors, 0.0));
+    state_model->set_initial_state_variance(SpdMatrix(nfactors, 1.0));
+    Matrix Beta = state_model->coefficient_model()->Beta();
+    Beta.randomize();
+    state_model->coefficient_model()->set_Beta(Beta);
+    state_model->innovation_model(0)->set_sigsq(2.0);
+    state_model->innovation_model(1)->set_sigsq(.5);
+    model->add_state(state_model);
+    for (int i = 0; i < ydim; ++i) {
+      model->observation_model()->model(i)->set_sigsq(1.0 + i);
+    }
+
+    SpdMatrix state_variance(nfactors);
+    state_variance.randomize();
+    Vector state_mean(nfactors);
+    state_mean.randomize();
+
+    Selector observed(ydim, true);
+    for (int i = 0; i < 2; ++i) {
+      Marginal standard(model.get(), nullptr, 0);
+      standard.set_high_dimensional_threshold_factor(1000);
+      standard.set_state_mean(state_mean);
+      standard.set_state_variance(state_variance);
+      double loglike = standard.update(data.row(0), observed);
+
+      Marginal square_root(model.get(), nullptr, 0);
+      square_root.set_state_mean(state_mean);
+      square_root.set_state_variance_root(
+          variance_square_root(state_variance));
+      EXPECT_TRUE(MatrixEquals(square_root.state_variance_root().outer(),
+                               state_variance));
+      EXPECT_NEAR(loglike, square_root.update(data.row(0), observed), 1e-8);
+
+      EXPECT_TRUE(VectorEquals(standard.prediction_error(),
+                               square_root.prediction_error()));
+      EXPECT_TRUE(VectorEquals(standard.scaled_prediction_error(),
+                               square_root.scaled_prediction_error()));
+      EXPECT_NEAR(standard.forecast_precision_log_determinant(),
+                  square_root.forecast_precision_log_determinant(),
+                  1e-8);
+      EXPECT_TRUE(MatrixEquals(standard.kalman_gain(),
+                               square_root.kalman_gain()));
+      EXPECT_TRUE(VectorEquals(standard.state_mean(),
+                               square_root.state_mean()));
+      EXPECT_TRUE(square_root.has_state_variance_root());
+      EXPECT_TRUE(MatrixEquals(standard.state_variance(),
+                               square_root.state_variance()));
+      // Computing the variance from the root discards the root.
+      EXPECT_FALSE(square_root.has_state_variance_root());
+
+      // Repeat with a missing observation.
+      observed.drop(1);
+    }
+  }
+
 }  // namespace
@@ -0,0 +1,103 @@
+// A benchmark for the scalar Kalman filter, the fast disturbance smoother, and
+// the forward simulation used by the MCMC state imputation step.  Reports the
+// time and number of heap allocations per iteration of each operation, for a
+// local level + seasonal model on a long series.
+//
+// Usage:
+//   kalman_filter_benchmark [time_dimension] [number_of_seasons] [iterations]
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include "distributions.hpp"
+#include "Models/StateSpace/StateSpaceModel.hpp"
+#include "Models/StateSpace/StateModels/LocalLevelStateModel.hpp"
+#include "Models/StateSpace/StateModels/SeasonalStateModel.hpp"
+
+namespace {
+  std::atomic<long> allocation_count(0);
+}  // namespace
+
+// Count every allocation made through the global operator new.
+void *operator new(std::size_t size) {
+  ++allocation_count;
+  void *ans = std::malloc(size == 0 ? 1 : size);
+  if (!ans) throw std::bad_alloc();
+  return ans;
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace {
+  using namespace BOOM;
+  using std::cout;
+  using std::endl;
+
+  // Run 'f' the requested number of times, and print the average time and
+  // number of allocations per call.
+  template <class F>
+  void benchmark(const std::string &name, int iterations, int time_dimension,
+                 F f) {
+    f();  // Warm up, so one-time sizing is not counted.
+    long allocations_before = allocation_count;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      f();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double allocations =
+        static_cast<double>(allocation_count - allocations_before) /
+        iterations;
+    double microseconds =
+        std::chrono::duration<double, std::micro>(stop - start).count() /
+        iterations;
+    cout << name << ":" << endl
+         << "    microseconds per iteration:  " << microseconds << endl
+         << "    allocations per iteration:   " << allocations << endl
+         << "    allocations per time point:  " << allocations / time_dimension
+         << endl;
+  }
+}  // namespace
+
+int main(int argc, char **argv) {
+  int time_dimension = argc > 1 ? std::atoi(argv[1]) : 2000;
+  int number_of_seasons = argc > 2 ? std::atoi(argv[2]) : 52;
+  int iterations = argc > 3 ? std::atoi(argv[3]) : 20;
+
+  GlobalRng::rng.seed(8675309);
+  Vector y(time_dimension);
+  double level = 0;
+  for (int t = 0; t < time_dimension; ++t) {
+    level += rnorm(0, .1);
+    y[t] = level + sin(2 * 3.14159 * t / number_of_seasons) + rnorm(0, 1);
+  }
+
+  NEW(StateSpaceModel, model)(y);
+  NEW(LocalLevelStateModel, level_model)(.01);
+  level_model->set_initial_state_mean(y[0]);
+  level_model->set_initial_state_variance(1.0);
+  NEW(SeasonalStateModel, seasonal)(number_of_seasons, 1);
+  seasonal->set_initial_state_mean(Vector(number_of_seasons - 1, 0.0));
+  seasonal->set_initial_state_variance(1.0);
+  model->add_state(level_model);
+  model->add_state(seasonal);
+  model->observation_model()->set_sigsq(1.0);
+
+  cout << "time dimension:  " << time_dimension << endl
+       << "state dimension: " << model->state_dimension() << endl
+       << "iterations:      " << iterations << endl;
+
+  ScalarKalmanFilter &filter(model->get_filter());
+  benchmark("ScalarKalmanFilter::update", iterations, time_dimension,
+            [&filter]() { filter.update(); });
+  benchmark("ScalarKalmanFilter::fast_disturbance_smooth", iterations,
+            time_dimension, [&filter]() { filter.fast_disturbance_smooth(); });
+  RNG rng(31);
+  benchmark("StateSpaceModelBase::impute_state", iterations, time_dimension,
+            [&model, &rng]() { model->impute_state(rng); });
+  return 0;
+}
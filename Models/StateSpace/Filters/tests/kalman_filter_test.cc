@@ -1,6 +1,7 @@
 #include "gtest/gtest.h"
 #include "distributions.hpp"
 #include "Models/StateSpace/StateSpaceModel.hpp"
+#include "Models/StateSpace/Filters/ScalarKalmanFilter.hpp"
 #include "Models/StateSpace/StateModels/LocalLevelStateModel.hpp"
 #include "Models/StateSpace/StateModels/SeasonalStateModel.hpp"
 
@@ -71,4 +72,133 @@ namespace {
     // TODO(finish this later)
   }
 
+  // The square root filter and the standard filter should agree to within
+  // rounding error, including at missing observations.
+  TEST_F(KalmanFilterTest, SquareRootFilterMatchesStandardFilter) {
+    int time_dimension = 80;
+    Vector data(time_dimension);
+    std::vector<bool> observed(time_dimension, true);
+    double level = 0;
+    for (int t = 0; t < time_dimension; ++t) {
+      level += rnorm(0, .1);
+      data[t] = level + sin(2 * 3.14159 * t / 7) + rnorm(0, .5);
+      if (t % 11 == 5) observed[t] = false;
+    }
+
+    NEW(StateSpaceModel, model)(data, observed);
+    NEW(LocalLevelStateModel, level_model)(.01);
+    level_model->set_initial_state_mean(data[0]);
+    level_model->set_initial_state_variance(1.0);
+    NEW(SeasonalStateModel, seasonal)(7, 1);
+    seasonal->set_initial_state_mean(Vector(6, 0.0));
+    seasonal->set_initial_state_variance(1.0);
+    // A nearly deterministic seasonal pattern.
+    seasonal->set_sigsq(1e-8);
+    model->add_state(level_model);
+    model->add_state(seasonal);
+    model->observation_model()->set_sigsq(.25);
+
+    ScalarKalmanFilter &filter(model->get_filter());
+    filter.update();
+    double loglike = filter.log_likelihood();
+    std::vector<double> prediction_variance;
+    Matrix state_mean = filter.state_mean();
+    SpdMatrix final_state_variance = filter.back().state_variance();
+    SpdMatrix middle_state_variance =
+        filter[time_dimension / 2].state_variance();
+    for (int t = 0; t < time_dimension; ++t) {
+      prediction_variance.push_back(filter[t].prediction_variance());
+    }
+    filter.fast_disturbance_smooth();
+    Vector r0 = filter.initial_scaled_state_error();
+
+    model->use_square_root_filter();
+    EXPECT_TRUE(filter.square_root_mode());
+    filter.update();
+    EXPECT_TRUE(filter.back().has_state_variance_root());
+    EXPECT_NEAR(loglike, filter.log_likelihood(), 1e-6);
+    EXPECT_TRUE(MatrixEquals(state_mean, filter.state_mean(), 1e-6));
+    EXPECT_TRUE(MatrixEquals(final_state_variance,
+                             filter.back().state_variance(), 1e-6));
+    // The state variance at each node is formed from the root on request.
+    EXPECT_TRUE(MatrixEquals(middle_state_variance,
+                             filter[time_dimension / 2].state_variance(),
+                             1e-6));
+    for (int t = 0; t < time_dimension; ++t) {
+      EXPECT_NEAR(prediction_variance[t], filter[t].prediction_variance(),
+                  1e-6);
+    }
+    filter.fast_disturbance_smooth();
+    EXPECT_TRUE(VectorEquals(r0, filter.initial_scaled_state_error(), 1e-6));
+
+    model->use_square_root_filter(false);
+    filter.update();
+    EXPECT_FALSE(filter.back().has_state_variance_root());
+    EXPECT_NEAR(loglike, filter.log_likelihood(), 1e-6);
+  }
+
+  // Once the filter reaches a steady state it should produce the same answers
+  // as the full update, and it should leave the steady state at missing data.
+  TEST_F(KalmanFilterTest, SteadyStateFilterMatchesFullFilter) {
+    int time_dimension = 1000;
+    Vector data(time_dimension);
+    std::vector<bool> observed(time_dimension, true);
+    double level = 0;
+    for (int t = 0; t < time_dimension; ++t) {
+      level += rnorm(0, .3);
+      data[t] = level + cos(2 * 3.14159 * t / 7) + rnorm(0, 1);
+    }
+    for (int t = 500; t < 505; ++t) {
+      observed[t] = false;
+    }
+
+    NEW(StateSpaceModel, model)(data, observed);
+    NEW(LocalLevelStateModel, level_model)(.09);
+    level_model->set_initial_state_mean(data[0]);
+    level_model->set_initial_state_variance(1.0);
+    NEW(SeasonalStateModel, seasonal)(7, 1);
+    seasonal->set_initial_state_mean(Vector(6, 0.0));
+    seasonal->set_initial_state_variance(1.0);
+    // A nearly deterministic seasonal pattern takes many periods to converge,
+    // so the seasonal variance is not too small.
+    seasonal->set_sigsq(.25);
+    model->add_state(level_model);
+    model->add_state(seasonal);
+    model->observation_model()->set_sigsq(1.0);
+    EXPECT_TRUE(model->state_is_time_invariant());
+
+    ScalarKalmanFilter &filter(model->get_filter());
+    filter.set_steady_state_tolerance(0);
+    filter.update();
+    EXPECT_EQ(0, filter.number_of_steady_state_updates());
+    double loglike = filter.log_likelihood();
+    Matrix state_mean = filter.state_mean();
+    Vector prediction_errors = model->one_step_prediction_errors();
+    filter.fast_disturbance_smooth();
+    Vector r0 = filter.initial_scaled_state_error();
+
+    filter.set_steady_state_tolerance(1e-10);
+    filter.update();
+    // The missing data forces a return to the full update, so there are two
+    // separate steady state periods.
+    EXPECT_GT(filter.number_of_steady_state_updates(), 500);
+    EXPECT_LT(filter.number_of_steady_state_updates(), time_dimension - 10);
+    EXPECT_NEAR(loglike, filter.log_likelihood(), 1e-6);
+    EXPECT_TRUE(MatrixEquals(state_mean, filter.state_mean(), 1e-6));
+    EXPECT_TRUE(VectorEquals(prediction_errors,
+                             model->one_step_prediction_errors(), 1e-6));
+    filter.fast_disturbance_smooth();
+    EXPECT_TRUE(VectorEquals(r0, filter.initial_scaled_state_error(), 1e-6));
+
+    // A seasonal model with a season duration longer than 1 is not time
+    // invariant, so the filter never enters the steady state.
+    NEW(SeasonalStateModel, weekly)(4, 7);
+    weekly->set_initial_state_mean(Vector(3, 0.0));
+    weekly->set_initial_state_variance(1.0);
+    model->add_state(weekly);
+    EXPECT_FALSE(model->state_is_time_invariant());
+    filter.update();
+    EXPECT_EQ(0, filter.number_of_steady_state_updates());
+  }
+
 }  // namespace
@@ -2,6 +2,7 @@
 #include "distributions.hpp"
 
 #include "Models/StateSpace/Filters/SparseMatrix.hpp"
+#include "Models/StateSpace/Filters/SparseKalmanTools.hpp"
 
 #include "test_utils/test_utils.hpp"
 #include <fstream>
@@ -64,4 +65,60 @@ namespace {
     EXPECT_TRUE(MatrixEquals(P2, P3));
   }    
 
+  // Check that the array form of the Kalman filter update reproduces the
+  // textbook formulas for F, K, and the updated P.
+  TEST_F(MultivariateKalmanFilterTest, SquareRootUpdate) {
+    int ydim = 3;
+    int state_dim = 4;
+    int error_dim = 2;
+
+    SpdMatrix H(ydim, 0.0);
+    H.diag() = pow(rnorm_vector(ydim, 0, 1), 2) + .1;
+    Matrix Z(ydim, state_dim);
+    Z.randomize();
+    Matrix T(state_dim, state_dim);
+    T.randomize();
+    NEW(DenseMatrix, transition)(T);
+    Matrix R(state_dim, error_dim);
+    R.randomize();
+    SpdMatrix P(state_dim);
+    P.randomize();
+
+    SpdMatrix RQR(state_dim, 0.0);
+    RQR.add_outer(R);
+    SpdMatrix F = H + sandwich(Z, P);
+    Matrix K = T * P * Z.transpose() * F.inv();
+    SpdMatrix next_P = sandwich(T, P) + RQR
+        - SpdMatrix(T * P * Z.transpose() * K.transpose(), false);
+
+    Matrix L = variance_square_root(P);
+    EXPECT_TRUE(MatrixEquals(L.outer(), P));
+    Matrix forecast_variance_root, gain_root, state_variance_root;
+    square_root_kalman_update(variance_square_root(H), Z * L, *transition, L, R,
+                              forecast_variance_root, gain_root,
+                              state_variance_root);
+    EXPECT_TRUE(MatrixEquals(forecast_variance_root.outer(), F));
+    EXPECT_TRUE(MatrixEquals(gain_root * forecast_variance_root.inv(), K));
+    EXPECT_TRUE(MatrixEquals(state_variance_root.outer(), next_P));
+    for (int i = 0; i < state_dim; ++i) {
+      EXPECT_GE(state_variance_root(i, i), 0.0);
+      for (int j = i + 1; j < state_dim; ++j) {
+        EXPECT_DOUBLE_EQ(0.0, state_variance_root(i, j));
+      }
+    }
+
+    // A rank deficient variance has a root, even though it has no Cholesky
+    // factor.
+    EXPECT_TRUE(MatrixEquals(variance_square_root(RQR).outer(), RQR));
+
+    // With no observed data the update is the time update T P T' + RQR'.
+    square_root_kalman_update(Matrix(0, 0), Matrix(0, state_dim), *transition, L,
+                              R,
+                              forecast_variance_root, gain_root,
+                              state_variance_root);
+    EXPECT_EQ(0, forecast_variance_root.nrow());
+    EXPECT_TRUE(MatrixEquals(state_variance_root.outer(),
+                             sandwich(T, P) + RQR));
+  }
+
 }  // namespace
@@ -503,6 +503,129 @@ namespace {
     CheckSparseKalmanMatrix(sparse);
   }
 
+  // Exercise each of the specialized block kernels, alongside a generic block.
+  TEST_F(SparseMatrixTest, BlockDiagonalSpecializedBlocks) {
+    BlockDiagonalMatrix transition;
+    transition.add_block(new LocalLinearTrendMatrix);
+    transition.add_block(new SeasonalStateSpaceMatrix(7));
+    NEW(GlmCoefs, rho)(Vector{.6, -.2, .1});
+    transition.add_block(new AutoRegressionTransitionMatrix(rho));
+    transition.add_block(new IdentityMatrix(2));
+    Matrix dense_block(3, 3);
+    dense_block.randomize();
+    transition.add_block(new DenseMatrix(dense_block));
+    CheckSparseKalmanMatrix(transition);
+
+    BlockDiagonalMatrix variance;
+    variance.add_block(new DiagonalMatrixBlock(Vector{1.0, 2.0}));
+    variance.add_block(new UpperLeftCornerMatrix(6, 3.0));
+    variance.add_block(new UpperLeftCornerMatrix(3, .5));
+    variance.add_block(new ZeroMatrix(2));
+    SpdMatrix dense_variance(3);
+    dense_variance.randomize();
+    variance.add_block(new DenseSpd(dense_variance));
+
+    SpdMatrix P(transition.nrow());
+    P.randomize();
+    Matrix T = transition.dense();
+    SpdMatrix expected = T * P * T.transpose() + variance.dense();
+    transition.sandwich_inplace_and_add(P, variance);
+    EXPECT_TRUE(MatrixEquals(P, expected))
+        << "P = " << endl << P << endl
+        << "expected = " << endl << expected;
+
+    // A variance matrix with a different block structure takes the unfused
+    // path.
+    P.randomize();
+    SpdMatrix dense_rqr(transition.nrow());
+    dense_rqr.randomize();
+    DenseSpd rqr(dense_rqr);
+    expected = T * P * T.transpose() + dense_rqr;
+    transition.sandwich_inplace_and_add(P, rqr);
+    EXPECT_TRUE(MatrixEquals(P, expected));
+
+    // m * T', as used by the square root filter.
+    Matrix m(4, transition.ncol());
+    m.randomize();
+    Matrix expected_product = m * T.transpose();
+    transition.matrix_transpose_premultiply_inplace(SubMatrix(m));
+    EXPECT_TRUE(MatrixEquals(m, expected_product));
+
+    // Replacing a block updates the plan.
+    NEW(GlmCoefs, rho2)(Vector{.3, .2, -.4});
+    transition.replace_block(2, new AutoRegressionTransitionMatrix(rho2));
+    CheckSparseKalmanMatrix(transition);
+    transition.replace_block(4, new IdentityMatrix(3));
+    CheckSparseKalmanMatrix(transition);
+  }
+
+  // A FixedDimensionMatrixBlock holding an arbitrary dense matrix, which
+  // exercises the default implementations in the base class.
+  template <int DIM>
+  class DenseFixedDimensionBlock : public FixedDimensionMatrixBlock<DIM> {
+   public:
+    explicit DenseFixedDimensionBlock(const Matrix &m) : m_(m) {}
+    DenseFixedDimensionBlock *clone() const override {
+      return new DenseFixedDimensionBlock(*this);
+    }
+    void fill(double *matrix) const override {
+      std::copy(m_.begin(), m_.end(), matrix);
+    }
+
+   private:
+    Matrix m_;
+  };
+
+  TEST_F(SparseMatrixTest, FixedDimensionBlocks) {
+    Matrix dense4(4, 4);
+    dense4.randomize();
+    NEW(DenseFixedDimensionBlock<4>, block4)(dense4);
+    CheckSparseMatrixBlock(block4, dense4);
+
+    Matrix dense1(1, 1);
+    dense1.randomize();
+    NEW(DenseFixedDimensionBlock<1>, block1)(dense1);
+    CheckSparseMatrixBlock(block1, dense1);
+
+    // The diagonal blocks of T * P * T' use the fixed dimension kernel for
+    // every block but the seasonal one.
+    NEW(UnivParams, phi)(.7);
+    BlockDiagonalMatrix transition;
+    transition.add_block(new LocalLinearTrendMatrix);
+    transition.add_block(new SemilocalLinearTrendMatrix(phi));
+    transition.add_block(new SeasonalStateSpaceMatrix(4));
+    transition.add_block(block4);
+    transition.add_block(block1);
+    CheckSparseKalmanMatrix(transition);
+
+    BlockDiagonalMatrix variance;
+    for (int dim : {2, 3, 3, 4, 1}) {
+      SpdMatrix block_variance(dim);
+      block_variance.randomize();
+      variance.add_block(new DenseSpd(block_variance));
+    }
+
+    SpdMatrix P(transition.nrow());
+    P.randomize();
+    Matrix T = transition.dense();
+    SpdMatrix expected = T * P * T.transpose() + variance.dense();
+    transition.sandwich_inplace_and_add(P, variance);
+    EXPECT_TRUE(MatrixEquals(P, expected))
+        << "P = " << endl << P << endl
+        << "expected = " << endl << expected;
+
+    // The kernels read phi each time they are called.
+    phi->set(.2);
+    P.randomize();
+    T = transition.dense();
+    EXPECT_DOUBLE_EQ(T(3, 3), .2);
+    expected = T * P * T.transpose();
+    transition.sandwich_inplace(P);
+    EXPECT_TRUE(MatrixEquals(P, expected))
+        << "P = " << endl << P << endl
+        << "expected = " << endl << expected;
+  }
+
   TEST_F(SparseMatrixTest, SparseVerticalStripMatrixTest) {
     SparseVerticalStripMatrix sparse;
     int nrows = 8;
@@ -49,6 +49,19 @@ namespace BOOM {
     }
   }
 
+  //----------------------------------------------------------------------
+  void MvBase::use_square_root_filter(bool square_root) {
+    get_filter().set_square_root_mode(square_root);
+    get_simulation_filter().set_square_root_mode(square_root);
+  }
+
+  bool MvBase::state_is_time_invariant() const {
+    for (int s = 0; s < number_of_state_models(); ++s) {
+      if (!state_model(s)->is_time_invariant()) return false;
+    }
+    return true;
+  }
+
   void MvBase::impute_state(RNG &rng) {
     if (number_of_state_models() == 0) {
       report_error("No state has been defined.");
@@ -110,6 +110,14 @@ namespace BOOM {
     virtual MultivariateKalmanFilterBase & get_simulation_filter() = 0;
     virtual const MultivariateKalmanFilterBase & get_simulation_filter() const = 0;
 
+    // See StateSpaceModelBase::use_square_root_filter.
+    void use_square_root_filter(bool square_root = true);
+
+    // Returns true if the structural matrices below do not depend on t.  The
+    // default implementation returns true if every state model is time
+    // invariant.
+    virtual bool state_is_time_invariant() const;
+
     // Durbin and Koopman's T[t] built from state models.
     virtual const SparseKalmanMatrix *state_transition_matrix(int t) const {
       return state_model_vector().state_transition_matrix(t);
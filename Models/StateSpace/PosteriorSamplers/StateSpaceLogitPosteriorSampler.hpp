@@ -49,6 +49,7 @@ namespace BOOM {
     // data point, conditional on the state, observed data, and model
     // parameters.
     void impute_nonstate_latent_data() override;
+    bool has_nonstate_latent_data() const override { return true; }
 
     // Clear the complete_data_sufficient_statistics for the logistic
     // regression model.
@@ -47,6 +47,7 @@ namespace BOOM {
     // Impute the latent Gaussian observations and variances at each
     // data point.
     void impute_nonstate_latent_data() override;
+    bool has_nonstate_latent_data() const override { return true; }
 
     // Clear the complete_data_sufficient_statistics for the Poisson
     // regression model.
@@ -19,6 +19,7 @@
 
 #include "Models/StateSpace/PosteriorSamplers/StateSpacePosteriorSampler.hpp"
 #include "TargetFun/TargetFun.hpp"
+#include "cpputil/Checkpoint.hpp"
 #include "cpputil/math_utils.hpp"
 #include "numopt.hpp"
 
@@ -58,6 +59,17 @@ namespace BOOM {
     // the Kalman filter matches up with the parameter draws.
   }
 
+  void SSPS::save_state(CheckpointWriter &checkpoint) const {
+    PosteriorSampler::save_state(checkpoint);
+    checkpoint.write_int(latent_data_initialized_);
+  }
+
+  void SSPS::restore_state(CheckpointReader &checkpoint) {
+    PosteriorSampler::restore_state(checkpoint);
+    latent_data_initialized_ =
+        checkpoint.read_int() && !has_nonstate_latent_data();
+  }
+
   double SSPS::logpri() const {
     double ans = 0;
     // Multivariate state space models sometimes use proxies that don't have an
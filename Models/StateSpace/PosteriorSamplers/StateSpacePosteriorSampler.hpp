@@ -68,6 +68,12 @@ namespace BOOM {
 
     void disable_threads() { pool_.set_number_of_threads(-1); }
 
+    // The checkpoint records whether the latent state has been imputed, so
+    // a restored chain does not impute it a second time before drawing the
+    // parameters.
+    void save_state(CheckpointWriter &checkpoint) const override;
+    void restore_state(CheckpointReader &checkpoint) override;
+
    protected:
     // Samplers for models with observation equations that are
     // conditionally normal can override this function to impute the
@@ -75,6 +81,11 @@ namespace BOOM {
     // no-op.
     virtual void impute_nonstate_latent_data() {}
 
+    // Samplers that override impute_nonstate_latent_data() should return
+    // true.  That latent data is not checkpointed, so a restored sampler
+    // imputes it (and the state) again before its first draw.
+    virtual bool has_nonstate_latent_data() const { return false; }
+
    private:
     // The M step in an EM algorithm for finding the posterior mode.
     // The Estep is provided by the model.  The Mstep is kept here
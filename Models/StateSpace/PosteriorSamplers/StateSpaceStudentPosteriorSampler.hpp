@@ -36,6 +36,7 @@ namespace BOOM {
 
     // Impute the latent variances at each data point.
     void impute_nonstate_latent_data() override;
+    bool has_nonstate_latent_data() const override { return true; }
 
     // Clear the complete_data_sufficient_statistics for the weighted
     // regression model.
@@ -124,6 +124,10 @@ namespace BOOM {
 
     int season_duration() const {return duration_;}
 
+    // Seasons lasting more than one time period have a transition matrix
+    // that depends on t.
+    bool is_time_invariant() const override {return duration_ == 1;}
+
    private:
     uint duration_;
     int time_of_first_observation_;
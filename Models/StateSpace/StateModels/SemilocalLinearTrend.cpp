@@ -28,10 +28,26 @@ namespace BOOM {
   LMAT::SemilocalLinearTrendMatrix(const Ptr<UnivParams> &phi) : phi_(phi) {}
 
   LMAT::SemilocalLinearTrendMatrix(const LMAT &rhs)
-      : SparseMatrixBlock(rhs), phi_(rhs.phi_) {}
+      : FixedDimensionMatrixBlock<3>(rhs), phi_(rhs.phi_) {}
 
   LMAT *LMAT::clone() const { return new LMAT(*this); }
 
+  void LMAT::fill(double *matrix) const {
+    double phi = phi_->value();
+    // Column 0.
+    matrix[0] = 1.0;
+    matrix[1] = 0.0;
+    matrix[2] = 0.0;
+    // Column 1.
+    matrix[3] = 1.0;
+    matrix[4] = phi;
+    matrix[5] = 0.0;
+    // Column 2.
+    matrix[6] = 0.0;
+    matrix[7] = 1 - phi;
+    matrix[8] = 1.0;
+  }
+
   void LMAT::multiply(VectorView lhs, const ConstVectorView &rhs) const {
     if (lhs.size() != 3) {
       report_error("lhs is the wrong size in LMAT::multiply");
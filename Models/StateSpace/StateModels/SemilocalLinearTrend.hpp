@@ -36,7 +36,7 @@ namespace BOOM {
   //  0   0   1
   //
   // This class is tested in the test suite for the other sparse matrices.
-  class SemilocalLinearTrendMatrix : public SparseMatrixBlock {
+  class SemilocalLinearTrendMatrix : public FixedDimensionMatrixBlock<3> {
    public:
     explicit SemilocalLinearTrendMatrix(const Ptr<UnivParams> &phi);
 
@@ -44,8 +44,7 @@ namespace BOOM {
     // class can change the value of the pointer.
     SemilocalLinearTrendMatrix(const SemilocalLinearTrendMatrix &rhs);
     SemilocalLinearTrendMatrix *clone() const override;
-    int nrow() const override { return 3; }
-    int ncol() const override { return 3; }
+    void fill(double *matrix) const override;
     void multiply(VectorView lhs, const ConstVectorView &rhs) const override;
     void multiply_and_add(VectorView lhs,
                           const ConstVectorView &rhs) const override;
@@ -103,6 +102,7 @@ namespace BOOM {
     Ptr<SparseMatrixBlock> state_error_variance(int t) const override;
 
     SparseVector observation_matrix(int t) const override;
+    bool is_time_invariant() const override {return true;}
 
     Vector initial_state_mean() const override;
     SpdMatrix initial_state_variance() const override;
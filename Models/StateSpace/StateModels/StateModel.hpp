@@ -160,6 +160,12 @@ namespace BOOM {
     // behavior for these member functions is a no-op.
     virtual void set_behavior(Behavior) {}
 
+    // Returns true if the model matrices (the transition matrix, the state
+    // variance, and the observation coefficients) do not depend on t.  Kalman
+    // filters use this to decide whether the state variance can be expected
+    // to converge to a steady state.  The default is the conservative answer.
+    virtual bool is_time_invariant() const {return false;}
+
     // The index of a state model is its position in the vector of state models
     // maintained by the host model which owns the StateModel (e.g. a
     // StateSpaceModel.
@@ -151,6 +151,7 @@ namespace BOOM {
     SparseVector observation_matrix(int t) const override {
       return observation_matrix_;
     }
+    bool is_time_invariant() const override {return true;}
     
     Vector initial_state_mean() const override {
       return initial_state_mean_;
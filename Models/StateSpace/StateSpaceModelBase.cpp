@@ -18,10 +18,12 @@
 */
 
 #include "Models/StateSpace/StateSpaceModelBase.hpp"
+#include <cmath>
 #include <functional>
 
 #include "LinAlg/SubMatrix.hpp"
 #include "Models/StateSpace/Filters/SparseKalmanTools.hpp"
+#include "cpputil/Checkpoint.hpp"
 #include "cpputil/report_error.hpp"
 #include "distributions.hpp"
 #include "numopt.hpp"
@@ -242,6 +244,14 @@ namespace BOOM {
     }
   }
 
+  //----------------------------------------------------------------------
+  bool Base::state_is_time_invariant() const {
+    for (int s = 0; s < number_of_state_models(); ++s) {
+      if (!state_model(s)->is_time_invariant()) return false;
+    }
+    return true;
+  }
+
   //----------------------------------------------------------------------
   void Base::set_state_model_behavior(StateModelBase::Behavior behavior) {
     for (int s = 0; s < number_of_state_models(); ++s) {
@@ -249,6 +259,12 @@ namespace BOOM {
     }
   }
 
+  //----------------------------------------------------------------------
+  void Base::use_square_root_filter(bool square_root) {
+    get_filter().set_square_root_mode(square_root);
+    get_simulation_filter().set_square_root_mode(square_root);
+  }
+
   //----------------------------------------------------------------------
   void Base::impute_state(RNG &rng) {
     if (number_of_state_models() == 0) {
@@ -265,6 +281,48 @@ namespace BOOM {
     }
   }
 
+  //----------------------------------------------------------------------
+  void Base::save_state(CheckpointWriter &checkpoint) const {
+    Model::save_state(checkpoint);
+    if (observation_model()) {
+      observation_model()->save_state(checkpoint);
+    }
+    for (int s = 0; s < number_of_state_models(); ++s) {
+      state_model(s)->save_state(checkpoint);
+    }
+    checkpoint.write_matrix(state_);
+  }
+
+  //----------------------------------------------------------------------
+  void Base::restore_state(CheckpointReader &checkpoint) {
+    Model::restore_state(checkpoint);
+    if (observation_model()) {
+      observation_model()->restore_state(checkpoint);
+    }
+    for (int s = 0; s < number_of_state_models(); ++s) {
+      state_model(s)->restore_state(checkpoint);
+    }
+    Matrix state = checkpoint.read_matrix();
+    if (state.nrow() == 0) {
+      // The state had not been imputed when the checkpoint was saved.
+      return;
+    }
+    if (state.nrow() != state_dimension() ||
+        state.ncol() != time_dimension()) {
+      report_error("The state in the checkpoint does not match the "
+                   "dimensions of the model.");
+    }
+    state_ = state;
+    // Rebuild the complete data sufficient statistics that impute_state()
+    // left behind.
+    set_state_model_behavior(StateModel::MIXTURE);
+    clear_client_data();
+    for (int t = 0; t < time_dimension(); ++t) {
+      observe_state(t);
+      observe_data_given_state(t);
+    }
+  }
+
   namespace {
     // A functor that evaluates the log likelihood of a StateSpaceModelBase.
     // Suitable for passing to numerical optimizers.
@@ -281,15 +339,32 @@ namespace BOOM {
         return ans;
       }
 
+      // Parameters outside the legal range (e.g. negative variances) cause
+      // the model to throw.  Once the target has been evaluated successfully,
+      // returning negative infinity lets a line search back away from them.
+      // An error at the first evaluation is a problem with the model or its
+      // starting values rather than a bad step, so it is rethrown.
+      double operator()(const Vector &parameters, Vector &gradient) {
+        try {
+          double ans = model_->log_likelihood_derivatives(parameters, gradient);
+          has_been_evaluated_ = true;
+          return ans;
+        } catch (std::exception &) {
+          if (!has_been_evaluated_) throw;
+          return negative_infinity();
+        }
+      }
+
      private:
       StateSpaceModelBase *model_;
+      bool has_been_evaluated_ = false;
     };
   }  // namespace
 
   //----------------------------------------------------------------------
-  double Base::mle(double epsilon) {
+  double Base::mle(double epsilon, bool use_derivatives) {
     // If the model can be estimated using an EM algorithm, then do a
-    // few steps of EM, and then switch to BFGS.
+    // few steps of EM, and then switch to a numerical optimizer.
     Vector original_parameters = vectorize_params(true);
     if (check_that_em_is_legal()) {
       clear_client_data();
@@ -305,6 +380,24 @@ namespace BOOM {
     }
 
     StateSpaceTargetFun target(this);
+    if (use_derivatives) {
+      Vector parameters = vectorize_params(true);
+      double loglike;
+      std::string error_message;
+      bool ok = max_nd1_careful(parameters, loglike, Target(target),
+                                dTarget(target), error_message, epsilon, 500,
+                                LBFGS);
+      // LBFGS only accepts steps that improve the likelihood, so if it stops
+      // early (e.g. at the iteration limit) 'parameters' is the best point
+      // it found.  That is kept, as the Powell branch below keeps the best
+      // point after its evaluation limit.
+      if (!ok && (!std::isfinite(loglike) || !parameters.all_finite())) {
+        report_error("StateSpaceModelBase::mle failed with error message: " +
+                     error_message);
+      }
+      unvectorize_params(parameters);
+      return log_likelihood();
+    }
     Negate min_target(target);
     PowellMinimizer minimizer(min_target);
     minimizer.set_evaluation_limit(500);
@@ -413,8 +506,10 @@ namespace BOOM {
   // Simulates state for time period t
   void Base::simulate_next_state(RNG &rng, const ConstVectorView &last,
                                  VectorView next, int t) const {
-    next = (*state_transition_matrix(t - 1)) * last
-        + simulate_state_error(rng, t - 1);
+    // Build next = T * last + error in place, to avoid allocating in the
+    // simulation loop.
+    simulate_state_error(rng, next, t - 1);
+    state_transition_matrix(t - 1)->multiply_and_add(next, last);
   }
 
   //----------------------------------------------------------------------
@@ -459,14 +554,19 @@ namespace BOOM {
 
   //----------------------------------------------------------------------
   Vector Base::simulate_state_error(RNG &rng, int t) const {
-    // simulate N(0, RQR) for the state at time t+1, using the
-    // variance matrix at time t.
     Vector ans(state_dimension(), 0);
+    simulate_state_error(rng, VectorView(ans), t);
+    return ans;
+  }
+
+  void Base::simulate_state_error(RNG &rng, VectorView eta, int t) const {
+    // simulate N(0, RQR) for the state at time t+1, using the
+    // variance matrix at time t.  Some state models only fill the nonzero
+    // elements of their error.
+    eta = 0.0;
     for (int s = 0; s < number_of_state_models(); ++s) {
-      VectorView eta(state_component(ans, s));
-      state_model(s)->simulate_state_error(rng, eta, t);
+      state_model(s)->simulate_state_error(rng, state_component(eta, s), t);
     }
-    return ans;
   }
 
   //=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
@@ -735,9 +835,6 @@ namespace BOOM {
     ScalarKalmanFilter &filter(get_filter());
     filter.update();
     ScalarKalmanFilter &simulation_filter(get_simulation_filter());
-    Vector simulated_data_state_mean = initial_state_mean();
-    SpdMatrix simulated_data_state_variance = initial_state_variance();
-
     for (int t = 0; t < time_dimension(); ++t) {
       // simulate_state at time t
       if (t == 0) {
@@ -838,15 +935,24 @@ namespace BOOM {
     observe_state(0);
     observe_data_given_state(0);
 
+    // Workspace for the next state means, so the loop does not allocate.
+    Vector next_state_mean_sim(state_dimension());
+    Vector next_state_mean_obs(state_dimension());
     for (int t = 1; t < time_dimension(); ++t) {
-      state_mean_sim = (*state_transition_matrix(t - 1)) * state_mean_sim +
-          (*state_variance_matrix(t - 1)) *
-          simulation_filter[t - 1].scaled_state_error();
-      state_mean_obs =
-          (*state_transition_matrix(t - 1)) * state_mean_obs +
-          (*state_variance_matrix(t - 1)) * filter[t - 1].scaled_state_error();
-
-      mutable_state().col(t).axpy(state_mean_obs - state_mean_sim);
+      const SparseKalmanMatrix &transition(*state_transition_matrix(t - 1));
+      const SparseKalmanMatrix &variance(*state_variance_matrix(t - 1));
+      transition.multiply(VectorView(next_state_mean_sim), state_mean_sim);
+      variance.multiply_and_add(VectorView(next_state_mean_sim),
+                                simulation_filter[t - 1].scaled_state_error());
+      state_mean_sim.swap(next_state_mean_sim);
+
+      transition.multiply(VectorView(next_state_mean_obs), state_mean_obs);
+      variance.multiply_and_add(VectorView(next_state_mean_obs),
+                                filter[t - 1].scaled_state_error());
+      state_mean_obs.swap(next_state_mean_obs);
+
+      mutable_state().col(t) += state_mean_obs;
+      mutable_state().col(t) -= state_mean_sim;
       observe_state(t);
       observe_data_given_state(t);
     }
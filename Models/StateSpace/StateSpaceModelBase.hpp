@@ -245,6 +245,13 @@ namespace BOOM {
       return state_models_.state_error_variance(t);
     }
 
+    // Returns true if the structural matrices above, and the observation
+    // coefficients, do not depend on t.  The default implementation returns
+    // true if every state model is time invariant.  Child classes that modify
+    // the structural matrices should override.  The observation variance is
+    // not considered.
+    virtual bool state_is_time_invariant() const;
+
     //----------------- Access to data -----------------
     // Clears sufficient statistics for state models and for the client model
     // describing observed data given state.
@@ -286,6 +293,18 @@ namespace BOOM {
     //   rng:  The random number generator to use for simulation.
     virtual void impute_state(RNG &rng);
 
+    //--------- Checkpointing ----------
+    // In addition to the parameters and the samplers owned by this model,
+    // the checkpoint holds the state of the observation model and each state
+    // model (including the RNGs of their posterior samplers) and the most
+    // recent draw of the state.  On restore the complete data sufficient
+    // statistics are rebuilt from the restored state, so a Gaussian model
+    // resumes exactly where it left off.  Latent data other than the state
+    // (e.g. the mixture weights of non-Gaussian observation models) is not
+    // saved, and is re-imputed on the next draw.
+    void save_state(CheckpointWriter &checkpoint) const override;
+    void restore_state(CheckpointReader &checkpoint) override;
+
     //---------------- Prediction, filtering, smoothing ---------------
     // Run the full Kalman filter over the observed data, saving the information
     // produced in the process in full_kalman_storage_.  The log likelihood is
@@ -298,6 +317,18 @@ namespace BOOM {
     virtual KalmanFilterBase & get_simulation_filter() = 0;
     virtual const KalmanFilterBase & get_simulation_filter() const = 0;
 
+    // Choose between the standard Kalman filter (the default), and the square
+    // root filter, which propagates a Cholesky factor of the state variance
+    // using QR decompositions.  The square root filter costs more per time
+    // point, but it can't lose positive definiteness through rounding error,
+    // which can be a problem for long series with near-deterministic state
+    // components.  The choice applies to both the filter and the simulation
+    // filter.  The smoothers read the state variance, which is formed from
+    // the factor when it is first requested, so they work in either mode.
+    //
+    // MultivariateStateSpaceModelBase::use_square_root_filter is the same.
+    void use_square_root_filter(bool square_root = true);
+
     //------------- Parameter estimation by MLE and MAP --------------------
     // Set model parameters to their maximum-likelihood estimates, and return
     // the likelihood at the MLE.  Note that some state models cannot be used
@@ -309,10 +340,15 @@ namespace BOOM {
     //   epsilon: Convergence for optimization algorithm will be declared when
     //     consecutive values of log-likelihood are observed with a difference
     //     of less than epsilon.
+    //   use_derivatives: If true then the final optimization is done by LBFGS
+    //     using log_likelihood_derivatives().  Otherwise a derivative free
+    //     method (Powell's method) is used.  LBFGS needs far fewer likelihood
+    //     evaluations when there are many parameters, but it requires all the
+    //     state models to implement increment_expected_gradient().
     //
     // Returns:
     //   The value of the log-likelihood at the MLE.
-    double mle(double epsilon = 1e-5);
+    double mle(double epsilon = 1e-5, bool use_derivatives = false);
 
     // The E-step of the EM algorithm.  Computes complete data sufficient
     // statistics for state models and the observation variance parameter.
@@ -469,6 +505,12 @@ namespace BOOM {
     // functions of other elements.
     virtual Vector simulate_state_error(RNG &rng, int t) const;
 
+    // Same as above, but the simulated error is written to 'eta', which must
+    // have size state_dimension().  Child classes that change how the state
+    // error is simulated should override this version, which is the one used
+    // by simulate_next_state().
+    virtual void simulate_state_error(RNG &rng, VectorView eta, int t) const;
+
     // Reset the size of the state_ matrix so that it has state_dimension() rows
     // and time_dimension() columns.
     void resize_state();
@@ -6,6 +6,7 @@
 #include "Models/ZeroMeanGaussianModel.hpp"
 #include "Models/PosteriorSamplers/ZeroMeanMvnIndependenceSampler.hpp"
 #include "Models/PosteriorSamplers/ZeroMeanGaussianConjSampler.hpp"
+#include "cpputil/Checkpoint.hpp"
 #include "distributions.hpp"
 
 #include "test_utils/test_utils.hpp"
@@ -77,5 +78,67 @@ namespace {
     // forecast SD.
     EXPECT_TRUE(VectorEquals(raw_errors / sqrt(variances), scaled_errors));
   }
+
+  // A local linear trend model for y, with samplers seeded from 'seed'.
+  Ptr<StateSpaceModel> build_trend_model(const Vector &y, int seed) {
+    GlobalRng::rng.seed(seed);
+    Ptr<LocalLinearTrendStateModel> trend(new LocalLinearTrendStateModel);
+    trend->set_initial_state_mean(Vector{y[0], 0});
+    trend->set_initial_state_variance(SpdMatrix(2, 3.0));
+    NEW(ZeroMeanMvnIndependenceSampler, trend_level_sampler)(
+        trend.get(), 1, 1, 0);
+    NEW(ZeroMeanMvnIndependenceSampler, trend_slope_sampler)(
+        trend.get(), 1, 1, 1);
+    trend->set_method(trend_level_sampler);
+    trend->set_method(trend_slope_sampler);
+
+    NEW(StateSpaceModel, model)(y);
+    model->add_state(trend);
+    NEW(ZeroMeanGaussianConjSampler, observation_model_sampler)(
+        model->observation_model(), 1, 1);
+    model->observation_model()->set_method(observation_model_sampler);
+    NEW(StateSpacePosteriorSampler, sampler)(model.get());
+    model->set_method(sampler);
+    return model;
+  }
+
+  // A chain restored from a checkpoint continues with exactly the draws the
+  // original chain would have made.  This requires the RNGs of the samplers
+  // for the observation and state models, and the imputed state.
+  TEST_F(StateSpaceModelTest, CheckpointResumesExactly) {
+    ifstream datafile("./Models/StateSpace/tests/airpassengers.txt");
+    Vector y(datafile);
+    ASSERT_EQ(y.size(), 144);
+    y = log(y);
+
+    Ptr<StateSpaceModel> model = build_trend_model(y, 8675309);
+    for (int i = 0; i < 20; ++i) {
+      model->sample_posterior();
+    }
+    CheckpointWriter writer;
+    model->save_state(writer);
+    std::vector<std::uint64_t> global_rng_state = GlobalRng::rng.state();
+
+    int niter = 10;
+    Matrix uninterrupted(niter, model->vectorize_params(false).size());
+    for (int i = 0; i < niter; ++i) {
+      model->sample_posterior();
+      uninterrupted.row(i) = model->vectorize_params(false);
+    }
+    Vector final_state = model->final_state();
+
+    Ptr<StateSpaceModel> resumed = build_trend_model(y, 12345);
+    CheckpointReader reader(writer.bytes());
+    resumed->restore_state(reader);
+    EXPECT_TRUE(reader.at_end());
+    GlobalRng::rng.set_state(global_rng_state);
+    Matrix resumed_draws(niter, uninterrupted.ncol());
+    for (int i = 0; i < niter; ++i) {
+      resumed->sample_posterior();
+      resumed_draws.row(i) = resumed->vectorize_params(false);
+    }
+    EXPECT_EQ(uninterrupted, resumed_draws);
+    EXPECT_EQ(final_state, Vector(resumed->final_state()));
+  }
   
 }  // namespace
@@ -31,6 +31,15 @@ namespace BOOM {
     virtual double logp(const Vector &x) const = 0;
     VectorModel *clone() const override = 0;
     virtual Vector sim(RNG &rng = GlobalRng::rng) const = 0;
+
+    // Evaluate the log density at each row of X.
+    // Args:
+    //   X:  Each row is a point where the density is to be evaluated.
+    //   log_density: On output log_density[i] is logp(X.row(i)).  Must have
+    //     one element per row of X.
+    //
+    // The default implementation calls logp() once per row.
+    virtual void fill_logp(const Matrix &X, VectorView log_density) const;
   };
 
   class LocationScaleVectorModel : virtual public VectorModel {
@@ -0,0 +1,130 @@
+#include "gtest/gtest.h"
+#include "Models/BetaModel.hpp"
+#include "Models/GammaModel.hpp"
+#include "Models/GaussianModel.hpp"
+#include "Models/MultinomialModel.hpp"
+#include "Models/MvnModel.hpp"
+#include "Models/PoissonModel.hpp"
+#include "distributions.hpp"
+
+#include "test_utils/test_utils.hpp"
+#include <cmath>
+
+namespace {
+  using namespace BOOM;
+  using std::endl;
+  using std::cout;
+
+  class BatchLogpTest : public ::testing::Test {
+   protected:
+    BatchLogpTest() {
+      GlobalRng::rng.seed(8675309);
+    }
+
+    // Checks that the batch and scalar log densities agree at each element
+    // of x.
+    void check_double_model(const DoubleModel &model, const Vector &x) {
+      Vector batch(x.size());
+      model.fill_logp(x, VectorView(batch));
+      for (int i = 0; i < x.size(); ++i) {
+        double scalar = model.logp(x[i]);
+        if (std::isinf(scalar)) {
+          EXPECT_EQ(scalar, batch[i]) << "x = " << x[i];
+        } else {
+          EXPECT_NEAR(scalar, batch[i], 1e-10) << "x = " << x[i];
+        }
+      }
+
+      std::vector<Ptr<Data>> data;
+      for (double value : x) data.push_back(new DoubleData(value));
+      data.back()->set_missing_status(Data::completely_missing);
+      Vector from_data(data.size());
+      model.fill_log_pdf(data, VectorView(from_data));
+      EXPECT_DOUBLE_EQ(0.0, from_data.back());
+      for (int i = 0; i + 1 < x.size(); ++i) {
+        EXPECT_EQ(batch[i], from_data[i]);
+      }
+    }
+  };
+
+  TEST_F(BatchLogpTest, Gaussian) {
+    GaussianModel model(1.2, 3.7);
+    Vector x(50);
+    for (int i = 0; i < x.size(); ++i) x[i] = rnorm(1.0, 4.0);
+    check_double_model(model, x);
+  }
+
+  TEST_F(BatchLogpTest, Gamma) {
+    GammaModel model(2.3, 1.7);
+    Vector x(50);
+    for (int i = 0; i < x.size(); ++i) x[i] = rgamma(2.0, 1.0);
+    x[0] = 0.0;
+    x[1] = -1.0;
+    check_double_model(model, x);
+  }
+
+  TEST_F(BatchLogpTest, Beta) {
+    BetaModel model(2.5, 0.8);
+    Vector x(50);
+    for (int i = 0; i < x.size(); ++i) x[i] = runif(0, 1);
+    x[0] = 0.0;
+    x[1] = 1.0;
+    x[2] = 1.5;
+    check_double_model(model, x);
+  }
+
+  TEST_F(BatchLogpTest, Poisson) {
+    PoissonModel model(3.4);
+    std::vector<Ptr<Data>> data;
+    for (int i = 0; i < 50; ++i) data.push_back(new IntData(rpois(3.0)));
+    data[0]->set_missing_status(Data::completely_missing);
+    Vector batch(data.size());
+    model.fill_log_pdf(data, VectorView(batch));
+    EXPECT_DOUBLE_EQ(0.0, batch[0]);
+    for (int i = 1; i < data.size(); ++i) {
+      EXPECT_NEAR(model.pdf(data[i].get(), true), batch[i], 1e-10);
+    }
+  }
+
+  TEST_F(BatchLogpTest, Multinomial) {
+    Vector probs = {.2, .3, .5};
+    MultinomialModel model(probs);
+    std::vector<Ptr<Data>> data;
+    for (int i = 0; i < 30; ++i) {
+      data.push_back(new CategoricalData(i % 3, 3));
+    }
+    Vector batch(data.size());
+    model.fill_log_pdf(data, VectorView(batch));
+    for (int i = 0; i < data.size(); ++i) {
+      EXPECT_DOUBLE_EQ(log(probs[i % 3]), batch[i]);
+    }
+  }
+
+  TEST_F(BatchLogpTest, Mvn) {
+    int dim = 4;
+    Vector mu(dim);
+    for (int i = 0; i < dim; ++i) mu[i] = rnorm(0, 3);
+    SpdMatrix Sigma(dim);
+    Sigma.randomize();
+    MvnModel model(mu, Sigma);
+
+    Matrix X(20, dim);
+    X.randomize();
+    Vector batch(X.nrow());
+    model.fill_logp(X, VectorView(batch));
+    for (int i = 0; i < X.nrow(); ++i) {
+      EXPECT_NEAR(model.logp(X.row(i)), batch[i], 1e-8);
+    }
+
+    std::vector<Ptr<Data>> data;
+    for (int i = 0; i < X.nrow(); ++i) {
+      data.push_back(new VectorData(X.row(i)));
+    }
+    data[3]->set_missing_status(Data::completely_missing);
+    Vector from_data(data.size());
+    model.fill_log_pdf(data, VectorView(from_data));
+    EXPECT_DOUBLE_EQ(0.0, from_data[3]);
+    EXPECT_NEAR(batch[5], from_data[5], 1e-10);
+  }
+
+}  // namespace
@@ -0,0 +1,187 @@
+#include "gtest/gtest.h"
+#include "Models/GammaModel.hpp"
+#include "Models/GaussianModel.hpp"
+#include "Models/GaussianModelGivenSigma.hpp"
+#include "Models/PosteriorSamplers/GaussianConjSampler.hpp"
+#include "Models/PosteriorSamplers/McmcCheckpoint.hpp"
+#include "Samplers/TIM.hpp"
+#include "cpputil/Checkpoint.hpp"
+#include "distributions.hpp"
+
+#include "test_utils/test_utils.hpp"
+#include <cstdio>
+
+namespace {
+  using namespace BOOM;
+  using std::endl;
+  using std::cout;
+
+  class CheckpointTest : public ::testing::Test {
+   protected:
+    CheckpointTest() : filename_("checkpoint_test.ckpt") {
+      GlobalRng::rng.seed(8675309);
+      for (int i = 0; i < 100; ++i) {
+        data_.push_back(new DoubleData(rnorm(3, 2)));
+      }
+    }
+    ~CheckpointTest() override { std::remove(filename_.c_str()); }
+
+    Ptr<GaussianModel> build(unsigned long seed) {
+      NEW(GaussianModel, model)(0.0, 1.0);
+      for (const auto &data_point : data_) {
+        model->add_data(data_point);
+      }
+      NEW(GammaModel, precision_prior)(1.0, 1.0);
+      NEW(GaussianModelGivenSigma, mean_prior)(model->Sigsq_prm(), 0.0, .01);
+      NEW(GaussianConjSampler, sampler)(model.get(), mean_prior,
+                                        precision_prior);
+      sampler->set_seed(seed);
+      model->set_method(sampler);
+      return model;
+    }
+
+    std::string filename_;
+    std::vector<Ptr<DoubleData>> data_;
+  };
+
+  TEST_F(CheckpointTest, RngStateRoundTrip) {
+    RNG rng(17);
+    // Leave the engine part way through a block of output.
+    rng();
+    std::vector<std::uint64_t> state = rng.state();
+    Vector first(5), second(5);
+    for (int i = 0; i < 5; ++i) first[i] = rng();
+    RNG child = rng.spawn();
+
+    RNG restored(99);
+    restored.set_state(state);
+    for (int i = 0; i < 5; ++i) second[i] = restored();
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(child(), restored.spawn()());
+  }
+
+  TEST_F(CheckpointTest, BufferRoundTrip) {
+    CheckpointWriter writer;
+    Matrix m(2, 3);
+    m.randomize();
+    writer.write_int(-3);
+    writer.write_string("hello");
+    writer.write_vector(Vector{1.0, 2.5, -0.1});
+    writer.write_matrix(m);
+
+    CheckpointReader reader(writer.bytes());
+    EXPECT_EQ(-3, reader.read_int());
+    EXPECT_EQ("hello", reader.read_string());
+    EXPECT_EQ(Vector({1.0, 2.5, -0.1}), reader.read_vector());
+    EXPECT_EQ(m, reader.read_matrix());
+    EXPECT_TRUE(reader.at_end());
+    EXPECT_THROW(reader.read_double(), std::exception);
+  }
+
+  TEST_F(CheckpointTest, ResumedChainMatchesUninterruptedChain) {
+    Ptr<GaussianModel> model = build(12);
+    McmcCheckpoint checkpoint(filename_);
+    checkpoint.add_model(model);
+    EXPECT_EQ(-1, checkpoint.restore());
+
+    for (int i = 0; i < 50; ++i) model->sample_posterior();
+    checkpoint.save(49);
+    checkpoint.wait();
+
+    Matrix uninterrupted(20, 2);
+    for (int i = 0; i < 20; ++i) {
+      model->sample_posterior();
+      uninterrupted.row(i) = model->vectorize_params(false);
+    }
+
+    // A fresh model, seeded differently, picks up from the checkpoint.
+    Ptr<GaussianModel> resumed = build(101);
+    McmcCheckpoint resumed_checkpoint(filename_);
+    resumed_checkpoint.add_model(resumed);
+    EXPECT_EQ(49, resumed_checkpoint.restore());
+    Matrix resumed_draws(20, 2);
+    for (int i = 0; i < 20; ++i) {
+      resumed->sample_posterior();
+      resumed_draws.row(i) = resumed->vectorize_params(false);
+    }
+    EXPECT_EQ(uninterrupted, resumed_draws);
+  }
+
+  // A header claiming more payload than the file holds is rejected before
+  // any memory is allocated for it.
+  TEST_F(CheckpointTest, OversizedPayloadIsRejected) {
+    Ptr<GaussianModel> model = build(12);
+    McmcCheckpoint checkpoint(filename_);
+    checkpoint.add_model(model);
+    model->sample_posterior();
+    checkpoint.save(0);
+    checkpoint.wait();
+
+    // The payload size follows the magic number, version, byte order mark
+    // and iteration number.
+    std::FILE *file = std::fopen(filename_.c_str(), "r+b");
+    ASSERT_TRUE(file != nullptr);
+    ASSERT_EQ(0, std::fseek(file, 24, SEEK_SET));
+    std::uint64_t huge = std::uint64_t(1) << 62;
+    ASSERT_EQ(1, std::fwrite(&huge, sizeof(huge), 1, file));
+    std::fclose(file);
+
+    McmcCheckpoint corrupt_checkpoint(filename_);
+    corrupt_checkpoint.add_model(build(13));
+    EXPECT_THROW(corrupt_checkpoint.restore(), std::exception);
+  }
+
+  // The log density of N(mu, Sigma), with derivatives, up to a constant.
+  double normal_log_density(const Vector &x, Vector &gradient,
+                            Matrix &hessian, int nd) {
+    Vector mu = {1.0, -2.0};
+    SpdMatrix siginv(2);
+    siginv(0, 0) = 2.0;
+    siginv(1, 1) = 1.0;
+    siginv(0, 1) = siginv(1, 0) = 0.5;
+    Vector r = x - mu;
+    if (nd > 0) gradient = -1 * (siginv * r);
+    if (nd > 1) hessian = -1 * siginv;
+    return -0.5 * siginv.Mdist(r);
+  }
+
+  // A TIM sampler with a fixed mode keeps its modal approximation across a
+  // checkpoint, so a restored sampler makes the same draws without having to
+  // locate the mode again.
+  TEST_F(CheckpointTest, TimProposalRoundTrip) {
+    RNG rng(31);
+    TIM sampler(normal_log_density, 3, &rng);
+    sampler.fix_mode(true);
+    Vector x = {0.0, 0.0};
+    for (int i = 0; i < 5; ++i) x = sampler.draw(x);
+
+    CheckpointWriter writer;
+    sampler.save_state(writer);
+    std::vector<std::uint64_t> rng_state = rng.state();
+    Vector y = x;
+    Matrix uninterrupted(10, 2);
+    for (int i = 0; i < 10; ++i) {
+      y = sampler.draw(y);
+      uninterrupted.row(i) = y;
+    }
+
+    RNG resumed_rng(32);
+    resumed_rng.set_state(rng_state);
+    TIM resumed(normal_log_density, 3, &resumed_rng);
+    resumed.fix_mode(true);
+    CheckpointReader reader(writer.bytes());
+    resumed.restore_state(reader);
+    EXPECT_TRUE(reader.at_end());
+    EXPECT_EQ(sampler.mode(), resumed.mode());
+    EXPECT_EQ(sampler.ivar(), resumed.ivar());
+
+    Matrix resumed_draws(10, 2);
+    y = x;
+    for (int i = 0; i < 10; ++i) {
+      y = resumed.draw(y);
+      resumed_draws.row(i) = y;
+    }
+    EXPECT_EQ(uninterrupted, resumed_draws);
+  }
+
+}  // namespace
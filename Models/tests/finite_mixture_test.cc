@@ -0,0 +1,176 @@
+#include "gtest/gtest.h"
+#include "Models/FiniteMixtureModel.hpp"
+#include "Models/GaussianModel.hpp"
+#include "Models/PosteriorSamplers/FiniteMixturePosteriorSampler.hpp"
+#include "distributions.hpp"
+
+#include "test_utils/test_utils.hpp"
+
+namespace {
+  using namespace BOOM;
+  using std::endl;
+  using std::cout;
+
+  class FiniteMixtureTest : public ::testing::Test {
+   protected:
+    FiniteMixtureTest() {
+      GlobalRng::rng.seed(8675309);
+      for (int i = 0; i < 1000; ++i) {
+        double y = runif() < .3 ? rnorm(-2, 1) : rnorm(3, 2);
+        data_.push_back(new DoubleData(y));
+      }
+      data_[17]->set_missing_status(Data::completely_missing);
+    }
+
+    // Give the mixture components distinct parameters.
+    void set_params(FiniteMixtureModel &model) {
+      model.mixture_component(0).dcast<GaussianModel>()->set_params(-2, 1);
+      model.mixture_component(1).dcast<GaussianModel>()->set_params(3, 4);
+      model.mixing_distribution()->set_pi(Vector{.3, .7});
+    }
+
+    Ptr<FiniteMixtureModel> build() {
+      NEW(GaussianModel, prototype)(0, 1);
+      NEW(FiniteMixtureModel, model)(prototype, 2);
+      for (const auto &data_point : data_) {
+        model->add_data(data_point);
+      }
+      set_params(*model);
+      return model;
+    }
+
+    double total_sample_size(const FiniteMixtureModel &model) {
+      double ans = 0;
+      for (int s = 0; s < model.number_of_mixture_components(); ++s) {
+        ans += dynamic_cast<const GaussianModel *>(model.mixture_component(s))
+                   ->suf()->n();
+      }
+      return ans;
+    }
+
+    std::vector<Ptr<DoubleData>> data_;
+  };
+
+  TEST_F(FiniteMixtureTest, ParallelImputationMatchesSerial) {
+    Ptr<FiniteMixtureModel> serial = build();
+    serial->impute_latent_data(GlobalRng::rng);
+
+    Ptr<FiniteMixtureModel> parallel = build();
+    FiniteMixturePosteriorSampler sampler(parallel.get(), GlobalRng::rng, 3);
+    sampler.impute_latent_data();
+
+    // The class membership probabilities do not depend on the random
+    // draws, so they should agree exactly.
+    EXPECT_EQ(serial->class_membership_probability(),
+              parallel->class_membership_probability());
+    EXPECT_NEAR(serial->last_loglike(), parallel->last_loglike(), 1e-8);
+
+    // Each observation is assigned to exactly one component.  The missing
+    // observation is in the data but not the sufficient statistics.
+    EXPECT_DOUBLE_EQ(data_.size() - 1, total_sample_size(*parallel));
+    int total_data = 0;
+    for (int s = 0; s < 2; ++s) {
+      total_data += parallel->mixture_component(s)->number_of_observations();
+    }
+    EXPECT_EQ(data_.size(), total_data);
+    EXPECT_DOUBLE_EQ(data_.size(),
+                     parallel->mixing_distribution()->suf()->n().sum());
+
+    // The imputed classes match the complete data.
+    Vector classes = parallel->class_assignment();
+    for (int s = 0; s < 2; ++s) {
+      double ybar = 0;
+      double count = 0;
+      for (int i = 0; i < data_.size(); ++i) {
+        if (classes[i] == s && !data_[i]->missing()) {
+          ybar += data_[i]->value();
+          ++count;
+        }
+      }
+      Ptr<GaussianModel> component =
+          parallel->mixture_component(s).dcast<GaussianModel>();
+      EXPECT_DOUBLE_EQ(count, component->suf()->n());
+      EXPECT_NEAR(ybar, component->suf()->sum(), 1e-8);
+    }
+
+    // Imputing a second time clears the first set of complete data.
+    sampler.impute_latent_data();
+    EXPECT_DOUBLE_EQ(data_.size() - 1, total_sample_size(*parallel));
+  }
+
+  // The workers evaluate densities with their own copies of the mixture
+  // components, which must pick up parameters set after the workers were
+  // created.
+  TEST_F(FiniteMixtureTest, WorkersTrackParameterChanges) {
+    Ptr<FiniteMixtureModel> parallel = build();
+    FiniteMixturePosteriorSampler sampler(parallel.get(), GlobalRng::rng, 3);
+    parallel->mixture_component(1).dcast<GaussianModel>()->set_params(1, 9);
+    sampler.impute_latent_data();
+
+    Ptr<FiniteMixtureModel> serial = build();
+    serial->mixture_component(1).dcast<GaussianModel>()->set_params(1, 9);
+    serial->impute_latent_data(GlobalRng::rng);
+    EXPECT_EQ(serial->class_membership_probability(),
+              parallel->class_membership_probability());
+    EXPECT_NEAR(serial->last_loglike(), parallel->last_loglike(), 1e-8);
+  }
+
+  TEST_F(FiniteMixtureTest, KnownSourceIncludingFirstComponent) {
+    Ptr<FiniteMixtureModel> model = build();
+    std::vector<int> source(data_.size(), -1);
+    source[3] = 0;
+    source[4] = 1;
+    model->set_data_source(source);
+    FiniteMixturePosteriorSampler sampler(model.get(), GlobalRng::rng, 2);
+    sampler.impute_latent_data();
+    const Matrix &probs(model->class_membership_probability());
+    EXPECT_DOUBLE_EQ(1.0, probs(3, 0));
+    EXPECT_DOUBLE_EQ(0.0, probs(3, 1));
+    EXPECT_DOUBLE_EQ(0.0, probs(4, 0));
+    EXPECT_DOUBLE_EQ(1.0, probs(4, 1));
+  }
+
+  TEST_F(FiniteMixtureTest, ParallelEStepMatchesSerial) {
+    NEW(GaussianModel, prototype)(0, 1);
+    EmFiniteMixtureModel serial(prototype, 2);
+    EmFiniteMixtureModel parallel(prototype, 2);
+    for (const auto &data_point : data_) {
+      if (data_point->missing()) continue;
+      serial.add_data(data_point);
+      parallel.add_data(data_point);
+    }
+    set_params(serial);
+    set_params(parallel);
+    parallel.set_number_of_threads(3);
+
+    double serial_loglike = serial.EStep();
+    double parallel_loglike = parallel.EStep();
+    EXPECT_NEAR(serial_loglike, parallel_loglike, 1e-8);
+    for (int s = 0; s < 2; ++s) {
+      Ptr<GaussianModel> serial_component =
+          serial.mixture_component(s).dcast<GaussianModel>();
+      Ptr<GaussianModel> parallel_component =
+          parallel.mixture_component(s).dcast<GaussianModel>();
+      EXPECT_NEAR(serial_component->suf()->n(),
+                  parallel_component->suf()->n(), 1e-8);
+      EXPECT_NEAR(serial_component->suf()->sum(),
+                  parallel_component->suf()->sum(), 1e-8);
+      EXPECT_NEAR(serial_component->suf()->sumsq(),
+                  parallel_component->suf()->sumsq(), 1e-6);
+    }
+    EXPECT_TRUE(VectorEquals(serial.mixing_distribution()->suf()->n(),
+                             parallel.mixing_distribution()->suf()->n(),
+                             1e-8));
+
+    // A second E-step replaces the sufficient statistics from the first.
+    EXPECT_NEAR(parallel_loglike, parallel.EStep(), 1e-8);
+    EXPECT_NEAR(data_.size() - 1,
+                parallel.mixing_distribution()->suf()->n().sum(), 1e-8);
+
+    // After an M-step the workers evaluate the new parameters.
+    serial.MStep(false);
+    parallel.MStep(false);
+    EXPECT_NEAR(serial.EStep(), parallel.EStep(), 1e-8);
+  }
+
+}  // namespace
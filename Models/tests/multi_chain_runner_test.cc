@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+#include "Models/GaussianModel.hpp"
+#include "Models/GaussianModelGivenSigma.hpp"
+#include "Models/GammaModel.hpp"
+#include "Models/PosteriorSamplers/GaussianConjSampler.hpp"
+#include "Models/PosteriorSamplers/MultiChainRunner.hpp"
+#include "distributions.hpp"
+
+#include "test_utils/test_utils.hpp"
+
+namespace {
+  using namespace BOOM;
+  using std::endl;
+  using std::cout;
+
+  class MultiChainRunnerTest : public ::testing::Test {
+   protected:
+    MultiChainRunnerTest() {
+      GlobalRng::rng.seed(8675309);
+      for (int i = 0; i < 200; ++i) {
+        data_.push_back(new DoubleData(rnorm(3, 2)));
+      }
+    }
+
+    // Builds a GaussianModel that shares data_ with every other chain.
+    Ptr<Model> build(int chain, RNG &seeding_rng) {
+      NEW(GaussianModel, model)(0.0, 1.0 + chain);
+      for (const auto &data_point : data_) {
+        model->add_data(data_point);
+      }
+      NEW(GammaModel, precision_prior)(1.0, 1.0);
+      NEW(GaussianModelGivenSigma, mean_prior)(model->Sigsq_prm(), 0.0, .01);
+      NEW(GaussianConjSampler, sampler)(
+          model.get(), mean_prior, precision_prior, seeding_rng);
+      model->set_method(sampler);
+      return model;
+    }
+
+    MultiChainRunner::ModelBuilder builder() {
+      return [this](int chain, RNG &seeding_rng) {
+        return build(chain, seeding_rng);
+      };
+    }
+
+    std::vector<Ptr<DoubleData>> data_;
+  };
+
+  TEST_F(MultiChainRunnerTest, SharedDataAndDiagnostics) {
+    MultiChainRunner runner(4, builder());
+    EXPECT_EQ(4, runner.number_of_chains());
+    EXPECT_EQ(2, runner.parameter_dimension());
+
+    // The chains share the data rather than copying it.
+    GaussianModel *m0 = dynamic_cast<GaussianModel *>(runner.model(0).get());
+    GaussianModel *m3 = dynamic_cast<GaussianModel *>(runner.model(3).get());
+    ASSERT_TRUE(m0 && m3);
+    EXPECT_EQ(m0->dat()[7].get(), m3->dat()[7].get());
+
+    runner.run(500, 50);
+    EXPECT_EQ(500, runner.number_of_draws());
+    EXPECT_EQ(500, runner.draws(2).nrow());
+    EXPECT_EQ(2, runner.draws(2).ncol());
+    EXPECT_NEAR(3.0, runner.draws(1).col(0).sum() / 500, .5);
+
+    Vector rhat = runner.rhat();
+    EXPECT_LT(rhat.max_abs(), 1.05);
+    EXPECT_GT(rhat[0], .95);
+
+    // The conjugate sampler produces independent draws, so the effective
+    // sample size should be close to the total number of draws.
+    Vector ess = runner.effective_sample_size();
+    EXPECT_GT(ess[0], 1000);
+    EXPECT_LT(ess[0], 4000 * std::log10(2000.0));
+  }
+
+  // Each chain has its own RNG stream, so the draws do not depend on the
+  // number of threads.
+  TEST_F(MultiChainRunnerTest, ReproducibleAcrossThreadCounts) {
+    RNG seeding_rng(17);
+    MultiChainRunner serial(3, builder(), seeding_rng);
+    serial.run(20, 0, 1);
+    MultiChainRunner parallel(3, builder(), seeding_rng);
+    parallel.run(20, 0, 3);
+    for (int chain = 0; chain < 3; ++chain) {
+      EXPECT_TRUE(MatrixEquals(serial.draws(chain), parallel.draws(chain)));
+    }
+    EXPECT_FALSE(MatrixEquals(serial.draws(0), serial.draws(1)));
+  }
+
+  // R-hat detects chains that have not mixed.
+  TEST_F(MultiChainRunnerTest, RhatDetectsStuckChains) {
+    int chain_counter = 0;
+    MultiChainRunner runner(2, [&chain_counter](int chain, RNG &) {
+        NEW(GaussianModel, model)(10.0 * chain, 1.0);
+        ++chain_counter;
+        return Ptr<Model>(model);
+      });
+    EXPECT_EQ(2, chain_counter);
+    // With no sampler the chains never move, and they disagree.
+    runner.run(10);
+    EXPECT_EQ(infinity(), runner.rhat()[0]);
+    EXPECT_DOUBLE_EQ(1.0, runner.rhat()[1]);
+  }
+
+}  // namespace
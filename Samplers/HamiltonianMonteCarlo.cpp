@@ -0,0 +1,487 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include "Samplers/HamiltonianMonteCarlo.hpp"
+
+#include <cmath>
+#include <sstream>
+
+#include "cpputil/math_utils.hpp"
+#include "cpputil/report_error.hpp"
+#include "distributions.hpp"
+
+namespace BOOM {
+
+  namespace {
+    using HMC = HamiltonianMonteCarloSampler;
+
+    // A trajectory whose energy differs from its starting value by more
+    // than this amount is treated as divergent, and NUTS stops extending
+    // it.  The value is from Hoffman and Gelman.
+    const double kMaxEnergyError = 1000.0;
+
+    // Dual averaging constants recommended by Hoffman and Gelman.
+    const double kDualAveragingGamma = 0.05;
+    const double kDualAveragingT0 = 10.0;
+    const double kDualAveragingKappa = 0.75;
+
+    // Stan's default warmup schedule: an initial buffer where only the step
+    // size is adapted, a series of doubling windows where the metric is
+    // estimated, and a terminal buffer for the final step size.
+    const int kInitialBuffer = 75;
+    const int kTerminalBuffer = 50;
+    const int kBaseMetricWindow = 25;
+
+    // The acceptance probability of a step relative to the start of the
+    // trajectory.
+    double metropolis_probability(double energy, double initial_energy) {
+      double log_ratio = energy - initial_energy;
+      if (std::isnan(log_ratio)) return 0.0;
+      return log_ratio >= 0 ? 1.0 : exp(log_ratio);
+    }
+  }  // namespace
+
+  HMC::HamiltonianMonteCarloSampler(const dTarget &logf,
+                                    int number_of_warmup_iterations, RNG *rng)
+      : Sampler(rng),
+        logf_(logf),
+        metric_type_(DIAGONAL_METRIC),
+        metric_is_set_(false),
+        step_size_(1.0),
+        step_size_is_set_(false),
+        max_tree_depth_(10),
+        number_of_leapfrog_steps_(0),
+        warmup_(number_of_warmup_iterations),
+        iteration_(0),
+        target_acceptance_rate_(0.8),
+        acceptance_probability_(0.0),
+        leapfrog_steps_(0),
+        diverged_(false) {
+    initialize_adaptation();
+  }
+
+  HMC::HamiltonianMonteCarloSampler(const Ptr<dTargetFun> &logf,
+                                    int number_of_warmup_iterations, RNG *rng)
+      : HamiltonianMonteCarloSampler(
+            [logf](const Vector &x, Vector &gradient) {
+              return (*logf)(x, gradient);
+            },
+            number_of_warmup_iterations, rng) {}
+
+  //----------------------------------------------------------------------
+  Vector HMC::draw(const Vector &old) {
+    PhasePoint current;
+    current.position = old;
+    evaluate(current);
+    if (!std::isfinite(current.logp)) {
+      report_error("The Hamiltonian Monte Carlo sampler was started at a "
+                   "point where the target density is zero.");
+    }
+    if (!metric_is_set_) {
+      set_default_metric(old.size());
+    } else if (old.size() != (metric_type_ == DIAGONAL_METRIC
+                                  ? inverse_metric_diagonal_.size()
+                                  : inverse_metric_.nrow())) {
+      report_error("The argument to HamiltonianMonteCarloSampler::draw does "
+                   "not match the dimension of the metric.");
+    }
+    if (!step_size_is_set_) {
+      find_reasonable_step_size(current);
+      restart_step_size_adaptation();
+      step_size_is_set_ = true;
+    }
+    diverged_ = false;
+    Vector ans = number_of_leapfrog_steps_ > 0 ? hmc_draw(current)
+                                               : nuts_draw(current);
+    if (in_warmup()) {
+      adapt(ans);
+    }
+    ++iteration_;
+    return ans;
+  }
+
+  //----------------------------------------------------------------------
+  Vector HMC::nuts_draw(PhasePoint &current) {
+    draw_momentum(current.momentum);
+    double initial_energy = current.logp - kinetic_energy(current.momentum);
+    // The slice variable u ~ U(0, exp(initial_energy)), on the log scale.
+    double log_slice = initial_energy + log(runif_mt(rng()));
+
+    PhasePoint minus = current;
+    PhasePoint plus = current;
+    last_draw_ = current;
+    double size = 1.0;
+    bool ok = true;
+    double acceptance_probability_sum = 0;
+    int number_of_points = 0;
+    for (int depth = 0; ok && depth < max_tree_depth_; ++depth) {
+      int direction = runif_mt(rng()) < 0.5 ? -1 : 1;
+      Subtree tree = build_tree(direction < 0 ? minus : plus, log_slice,
+                                direction, depth, initial_energy);
+      if (direction < 0) {
+        minus = tree.minus;
+      } else {
+        plus = tree.plus;
+      }
+      acceptance_probability_sum += tree.acceptance_probability_sum;
+      number_of_points += tree.number_of_points;
+      if (tree.ok && runif_mt(rng()) < tree.size / size) {
+        last_draw_ = tree.proposal;
+      }
+      size += tree.size;
+      ok = tree.ok && no_u_turn(minus, plus);
+    }
+    acceptance_probability_ =
+        number_of_points > 0 ? acceptance_probability_sum / number_of_points
+                             : 0.0;
+    leapfrog_steps_ = number_of_points;
+    return last_draw_.position;
+  }
+
+  //----------------------------------------------------------------------
+  HMC::Subtree HMC::build_tree(const PhasePoint &start, double log_slice,
+                               int direction, int depth,
+                               double initial_energy) {
+    if (depth == 0) {
+      Subtree tree;
+      tree.proposal = start;
+      leapfrog(tree.proposal, direction * step_size_);
+      double energy =
+          tree.proposal.logp - kinetic_energy(tree.proposal.momentum);
+      tree.size = log_slice <= energy ? 1.0 : 0.0;
+      tree.ok = log_slice < energy + kMaxEnergyError;
+      if (!tree.ok) diverged_ = true;
+      tree.acceptance_probability_sum =
+          metropolis_probability(energy, initial_energy);
+      tree.number_of_points = 1;
+      tree.minus = tree.proposal;
+      tree.plus = tree.proposal;
+      return tree;
+    }
+
+    Subtree tree =
+        build_tree(start, log_slice, direction, depth - 1, initial_energy);
+    if (!tree.ok) return tree;
+    Subtree outer = build_tree(direction < 0 ? tree.minus : tree.plus,
+                               log_slice, direction, depth - 1,
+                               initial_energy);
+    if (direction < 0) {
+      tree.minus = outer.minus;
+    } else {
+      tree.plus = outer.plus;
+    }
+    double total_size = tree.size + outer.size;
+    if (total_size > 0 && runif_mt(rng()) < outer.size / total_size) {
+      tree.proposal = outer.proposal;
+    }
+    tree.size = total_size;
+    tree.acceptance_probability_sum += outer.acceptance_probability_sum;
+    tree.number_of_points += outer.number_of_points;
+    tree.ok = outer.ok && no_u_turn(tree.minus, tree.plus);
+    return tree;
+  }
+
+  //----------------------------------------------------------------------
+  Vector HMC::hmc_draw(PhasePoint &current) {
+    draw_momentum(current.momentum);
+    double initial_energy = current.logp - kinetic_energy(current.momentum);
+    PhasePoint candidate = current;
+    int steps = 0;
+    while (steps < number_of_leapfrog_steps_) {
+      leapfrog(candidate, step_size_);
+      ++steps;
+      if (!std::isfinite(candidate.logp)) {
+        diverged_ = true;
+        break;
+      }
+    }
+    double energy = candidate.logp - kinetic_energy(candidate.momentum);
+    acceptance_probability_ =
+        diverged_ ? 0.0 : metropolis_probability(energy, initial_energy);
+    leapfrog_steps_ = steps;
+    last_draw_ = runif_mt(rng()) < acceptance_probability_ ? candidate
+                                                            : current;
+    return last_draw_.position;
+  }
+
+  //----------------------------------------------------------------------
+  double HMC::logf(const Vector &x, Vector &gradient) const {
+    gradient.resize(x.size());
+    double ans = logf_(x, gradient);
+    return std::isnan(ans) ? negative_infinity() : ans;
+  }
+
+  void HMC::evaluate(PhasePoint &point) const {
+    point.logp = logf(point.position, point.gradient);
+  }
+
+  void HMC::leapfrog(PhasePoint &point, double epsilon) const {
+    point.momentum.axpy(point.gradient, 0.5 * epsilon);
+    point.position.axpy(velocity(point.momentum), epsilon);
+    evaluate(point);
+    point.momentum.axpy(point.gradient, 0.5 * epsilon);
+  }
+
+  double HMC::kinetic_energy(const Vector &momentum) const {
+    if (metric_type_ == DIAGONAL_METRIC) {
+      double ans = 0;
+      for (int i = 0; i < momentum.size(); ++i) {
+        ans += square(momentum[i]) * inverse_metric_diagonal_[i];
+      }
+      return 0.5 * ans;
+    }
+    return 0.5 * inverse_metric_.Mdist(momentum);
+  }
+
+  Vector HMC::velocity(const Vector &momentum) const {
+    if (metric_type_ == DIAGONAL_METRIC) {
+      Vector ans(momentum);
+      for (int i = 0; i < ans.size(); ++i) {
+        ans[i] *= inverse_metric_diagonal_[i];
+      }
+      return ans;
+    }
+    return inverse_metric_ * momentum;
+  }
+
+  // The momentum is N(0, M), where M is the inverse of the metric.
+  void HMC::draw_momentum(Vector &momentum) {
+    int dim = metric_type_ == DIAGONAL_METRIC ? inverse_metric_diagonal_.size()
+                                              : inverse_metric_.nrow();
+    momentum.resize(dim);
+    for (int i = 0; i < dim; ++i) {
+      momentum[i] = rnorm_mt(rng());
+    }
+    if (metric_type_ == DIAGONAL_METRIC) {
+      for (int i = 0; i < dim; ++i) {
+        momentum[i] /= sqrt(inverse_metric_diagonal_[i]);
+      }
+    } else {
+      // If the metric is L * L^T then M = L^{-T} L^{-1}.
+      LTsolve_inplace(inverse_metric_cholesky_, momentum);
+    }
+  }
+
+  bool HMC::no_u_turn(const PhasePoint &minus, const PhasePoint &plus) const {
+    Vector span = plus.position - minus.position;
+    return span.dot(velocity(minus.momentum)) >= 0 &&
+           span.dot(velocity(plus.momentum)) >= 0;
+  }
+
+  //----------------------------------------------------------------------
+  void HMC::find_reasonable_step_size(const PhasePoint &current) {
+    PhasePoint start = current;
+    draw_momentum(start.momentum);
+    double initial_energy = start.logp - kinetic_energy(start.momentum);
+    auto log_acceptance_ratio = [&]() {
+      PhasePoint point = start;
+      leapfrog(point, step_size_);
+      double ans = point.logp - kinetic_energy(point.momentum) -
+                   initial_energy;
+      return std::isnan(ans) ? negative_infinity() : ans;
+    };
+    step_size_ = 1.0;
+    const double log_half = log(0.5);
+    double log_ratio = log_acceptance_ratio();
+    int direction = log_ratio > log_half ? 1 : -1;
+    // Double or halve the step size until the acceptance probability of a
+    // single step crosses 1/2.  The iteration limit guards against targets
+    // that are flat or improper.
+    for (int i = 0; i < 100; ++i) {
+      if (direction * (log_ratio - log_half) <= 0) break;
+      step_size_ *= direction > 0 ? 2.0 : 0.5;
+      log_ratio = log_acceptance_ratio();
+    }
+  }
+
+  //----------------------------------------------------------------------
+  void HMC::set_number_of_warmup_iterations(int n) {
+    warmup_ = n;
+    initialize_adaptation();
+    restart_step_size_adaptation();
+  }
+
+  void HMC::initialize_adaptation() {
+    iteration_ = 0;
+    int initial_buffer = kInitialBuffer;
+    int terminal_buffer = kTerminalBuffer;
+    int base_window = kBaseMetricWindow;
+    if (warmup_ < initial_buffer + terminal_buffer + base_window) {
+      initial_buffer = lround(0.15 * warmup_);
+      terminal_buffer = lround(0.1 * warmup_);
+      base_window = warmup_ - initial_buffer - terminal_buffer;
+    }
+    metric_window_start_ = initial_buffer;
+    terminal_buffer_start_ = warmup_ - terminal_buffer;
+    metric_window_size_ = base_window;
+    metric_window_end_ = initial_buffer + base_window;
+    if (metric_window_end_ + 2 * metric_window_size_ >
+        terminal_buffer_start_) {
+      metric_window_end_ = terminal_buffer_start_;
+    }
+    window_draw_count_ = 0;
+  }
+
+  void HMC::restart_step_size_adaptation() {
+    dual_averaging_mu_ = log(10 * step_size_);
+    dual_averaging_hbar_ = 0;
+    log_step_size_bar_ = 0;
+    dual_averaging_count_ = 0;
+  }
+
+  void HMC::adapt(const Vector &draw) {
+    ++dual_averaging_count_;
+    double m = dual_averaging_count_;
+    double weight = 1.0 / (m + kDualAveragingT0);
+    dual_averaging_hbar_ =
+        (1 - weight) * dual_averaging_hbar_ +
+        weight * (target_acceptance_rate_ - acceptance_probability_);
+    double log_step_size =
+        dual_averaging_mu_ - sqrt(m) / kDualAveragingGamma * dual_averaging_hbar_;
+    double eta = pow(m, -kDualAveragingKappa);
+    log_step_size_bar_ = eta * log_step_size + (1 - eta) * log_step_size_bar_;
+    step_size_ = exp(log_step_size);
+
+    if (iteration_ >= metric_window_start_ &&
+        iteration_ < terminal_buffer_start_) {
+      // Welford's algorithm for the running mean and sum of squares.
+      ++window_draw_count_;
+      if (window_draw_count_ == 1) {
+        window_mean_ = draw;
+        window_diagonal_sum_of_squares_ = Vector(draw.size(), 0.0);
+        if (metric_type_ == DENSE_METRIC) {
+          window_sum_of_squares_ = SpdMatrix(draw.size(), 0.0);
+        }
+      } else {
+        double k = window_draw_count_;
+        Vector delta = draw - window_mean_;
+        window_mean_.axpy(delta, 1.0 / k);
+        for (int i = 0; i < delta.size(); ++i) {
+          window_diagonal_sum_of_squares_[i] += (k - 1) / k * square(delta[i]);
+        }
+        if (metric_type_ == DENSE_METRIC) {
+          window_sum_of_squares_.add_outer(delta, (k - 1) / k, false);
+        }
+      }
+      if (iteration_ + 1 == metric_window_end_) {
+        update_metric_from_warmup_draws();
+        metric_window_size_ *= 2;
+        metric_window_end_ = iteration_ + 1 + metric_window_size_;
+        if (metric_window_end_ + 2 * metric_window_size_ >
+            terminal_buffer_start_) {
+          metric_window_end_ = terminal_buffer_start_;
+        }
+        find_reasonable_step_size(last_draw_);
+        restart_step_size_adaptation();
+      }
+    }
+
+    if (iteration_ + 1 == warmup_ && dual_averaging_count_ > 0) {
+      step_size_ = exp(log_step_size_bar_);
+    }
+  }
+
+  // The estimate is shrunk towards a small multiple of the identity, as in
+  // Stan, so that it is well conditioned even when the window is short.
+  void HMC::update_metric_from_warmup_draws() {
+    int n = window_draw_count_;
+    window_draw_count_ = 0;
+    if (n < 3) return;
+    double shrinkage = n / (n + 5.0);
+    double regularization = 1e-3 * 5.0 / (n + 5.0);
+    if (metric_type_ == DIAGONAL_METRIC) {
+      Vector variance = window_diagonal_sum_of_squares_ * (shrinkage / (n - 1));
+      variance += regularization;
+      set_inverse_metric(variance);
+    } else {
+      SpdMatrix variance = window_sum_of_squares_;
+      variance.reflect();
+      variance *= shrinkage / (n - 1);
+      variance.diag() += regularization;
+      set_inverse_metric(variance);
+    }
+  }
+
+  //----------------------------------------------------------------------
+  void HMC::set_metric_type(MetricType type) {
+    metric_type_ = type;
+    metric_is_set_ = false;
+  }
+
+  void HMC::set_default_metric(int dim) {
+    if (metric_type_ == DIAGONAL_METRIC) {
+      set_inverse_metric(Vector(dim, 1.0));
+    } else {
+      set_inverse_metric(SpdMatrix(dim, 1.0));
+    }
+  }
+
+  void HMC::set_inverse_metric(const Vector &diagonal) {
+    for (int i = 0; i < diagonal.size(); ++i) {
+      if (!(diagonal[i] > 0)) {
+        report_error("The diagonal of the inverse metric must be positive.");
+      }
+    }
+    inverse_metric_diagonal_ = diagonal;
+    metric_type_ = DIAGONAL_METRIC;
+    metric_is_set_ = true;
+  }
+
+  void HMC::set_inverse_metric(const SpdMatrix &variance) {
+    bool ok = true;
+    Matrix cholesky = variance.chol(ok);
+    if (!ok) {
+      report_error("The inverse metric must be positive definite.");
+    }
+    inverse_metric_ = variance;
+    inverse_metric_cholesky_ = cholesky;
+    metric_type_ = DENSE_METRIC;
+    metric_is_set_ = true;
+  }
+
+  void HMC::set_target_acceptance_rate(double rate) {
+    if (rate <= 0 || rate >= 1) {
+      report_error("The target acceptance rate must be in (0, 1).");
+    }
+    target_acceptance_rate_ = rate;
+  }
+
+  void HMC::set_max_tree_depth(int depth) {
+    if (depth < 1) {
+      report_error("The maximum tree depth must be positive.");
+    }
+    max_tree_depth_ = depth;
+  }
+
+  void HMC::set_number_of_leapfrog_steps(int n) {
+    if (n < 0) {
+      report_error("The number of leapfrog steps must be non-negative.");
+    }
+    number_of_leapfrog_steps_ = n;
+  }
+
+  void HMC::set_step_size(double step_size) {
+    if (step_size <= 0) {
+      report_error("The step size must be positive.");
+    }
+    step_size_ = step_size;
+    step_size_is_set_ = true;
+    restart_step_size_adaptation();
+  }
+
+}  // namespace BOOM
@@ -0,0 +1,212 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_HAMILTONIAN_MONTE_CARLO_HPP_
+#define BOOM_HAMILTONIAN_MONTE_CARLO_HPP_
+
+#include "LinAlg/Matrix.hpp"
+#include "LinAlg/SpdMatrix.hpp"
+#include "LinAlg/Vector.hpp"
+#include "Samplers/Sampler.hpp"
+#include "TargetFun/TargetFun.hpp"
+#include "cpputil/Ptr.hpp"
+#include "numopt.hpp"
+
+namespace BOOM {
+
+  // Hamiltonian Monte Carlo for a differentiable log density.  By default
+  // each draw uses the No-U-Turn sampler (NUTS) of Hoffman and Gelman
+  // (2014, JMLR), which lengthens the trajectory until it starts to double
+  // back on itself.  That removes the trajectory length, the hardest HMC
+  // tuning parameter to set.
+  //
+  // The sampler adapts during the first number_of_warmup_iterations()
+  // calls to draw().  The step size is adapted by dual averaging to hit
+  // the target acceptance rate.  The metric (the inverse of the mass
+  // matrix) is estimated from the warmup draws, in windows of doubling
+  // size, following Stan.  Adaptation violates detailed balance, so draws
+  // made during warmup should be discarded as burn-in.  Once warmup is
+  // over the step size and metric stay fixed.
+  class HamiltonianMonteCarloSampler : public Sampler {
+   public:
+    // The form of the metric estimated during warmup.  A diagonal metric
+    // rescales each coordinate.  A dense metric also removes linear
+    // correlation, at O(dim^2) cost per leapfrog step.
+    enum MetricType { DIAGONAL_METRIC, DENSE_METRIC };
+
+    // Args:
+    //   logf: The log of the (un-normalized) target density.  It takes the
+    //     argument x and a vector g.  It returns logf(x) and fills g with
+    //     the gradient of logf at x.
+    //   number_of_warmup_iterations: The number of calls to draw() during
+    //     which the step size and metric are adapted.
+    //   rng:  The random number generator used by the sampler.
+    explicit HamiltonianMonteCarloSampler(const dTarget &logf,
+                                          int number_of_warmup_iterations = 0,
+                                          RNG *rng = nullptr);
+    explicit HamiltonianMonteCarloSampler(const Ptr<dTargetFun> &logf,
+                                          int number_of_warmup_iterations = 0,
+                                          RNG *rng = nullptr);
+
+    // Each call evaluates the target and its gradient at 'old', even if
+    // 'old' is the previous draw.  The target may depend on values that
+    // have changed since then, e.g. when this sampler is one step of a
+    // Gibbs sampler.
+    Vector draw(const Vector &old) override;
+
+    // Restart adaptation.  The next n calls to draw() will adapt the step
+    // size and the metric.
+    void set_number_of_warmup_iterations(int n);
+    int number_of_warmup_iterations() const { return warmup_; }
+    bool in_warmup() const { return iteration_ < warmup_; }
+
+    void set_metric_type(MetricType type);
+
+    // The average acceptance probability targeted by step size
+    // adaptation.  The default is 0.8.
+    void set_target_acceptance_rate(double rate);
+
+    // NUTS doubles the trajectory at most this many times.  The default is
+    // 10, for at most 1023 leapfrog steps per draw.
+    void set_max_tree_depth(int depth);
+
+    // If n > 0 then each draw is a plain HMC move with n leapfrog steps,
+    // followed by a Metropolis-Hastings accept/reject step.  If n == 0
+    // (the default) then each draw uses NUTS.
+    void set_number_of_leapfrog_steps(int n);
+
+    // If the step size is not set it is chosen by a heuristic the first
+    // time draw() is called.
+    void set_step_size(double step_size);
+    double step_size() const { return step_size_; }
+
+    // Set the metric (the inverse mass matrix), which should approximate
+    // the variance of the target distribution.  The default is the
+    // identity.
+    void set_inverse_metric(const Vector &diagonal);
+    void set_inverse_metric(const SpdMatrix &variance);
+
+    // Diagnostics from the most recent call to draw().
+    // The average acceptance probability over the trajectory.
+    double acceptance_probability() const { return acceptance_probability_; }
+    int number_of_leapfrog_steps_taken() const { return leapfrog_steps_; }
+    bool diverged() const { return diverged_; }
+
+   private:
+    // A point in phase space, along with the log density and gradient at
+    // the position.
+    struct PhasePoint {
+      Vector position;
+      Vector momentum;
+      Vector gradient;
+      double logp;
+    };
+
+    // A subtree built during NUTS.
+    struct Subtree {
+      PhasePoint minus;
+      PhasePoint plus;
+      PhasePoint proposal;
+      // The number of points in the slice.
+      double size;
+      // False if the subtree made a U-turn or diverged.
+      bool ok;
+      // Sum of the acceptance probabilities of the points in the tree,
+      // relative to the starting point.
+      double acceptance_probability_sum;
+      int number_of_points;
+    };
+
+    double logf(const Vector &x, Vector &gradient) const;
+    void evaluate(PhasePoint &point) const;
+
+    // Take one leapfrog step of size epsilon (which may be negative).
+    void leapfrog(PhasePoint &point, double epsilon) const;
+
+    double kinetic_energy(const Vector &momentum) const;
+    Vector velocity(const Vector &momentum) const;
+    void draw_momentum(Vector &momentum);
+
+    // Returns true if the trajectory from minus to plus has not yet
+    // started to turn back on itself.
+    bool no_u_turn(const PhasePoint &minus, const PhasePoint &plus) const;
+
+    Subtree build_tree(const PhasePoint &start, double log_slice, int direction,
+                       int depth, double initial_energy);
+    Vector nuts_draw(PhasePoint &current);
+    Vector hmc_draw(PhasePoint &current);
+
+    // The heuristic from Hoffman and Gelman's Algorithm 4 for a first step
+    // size.
+    void find_reasonable_step_size(const PhasePoint &current);
+
+    // Adaptation.
+    void initialize_adaptation();
+    void restart_step_size_adaptation();
+    void adapt(const Vector &draw);
+    void update_metric_from_warmup_draws();
+    void set_default_metric(int dim);
+
+    dTarget logf_;
+
+    MetricType metric_type_;
+    // The metric is stored as its diagonal or as the full matrix along
+    // with its lower Cholesky factor.
+    Vector inverse_metric_diagonal_;
+    SpdMatrix inverse_metric_;
+    Matrix inverse_metric_cholesky_;
+    bool metric_is_set_;
+
+    double step_size_;
+    bool step_size_is_set_;
+    int max_tree_depth_;
+    int number_of_leapfrog_steps_;
+
+    // Warmup bookkeeping.
+    int warmup_;
+    int iteration_;
+    int metric_window_start_;
+    int metric_window_end_;
+    int metric_window_size_;
+    int terminal_buffer_start_;
+
+    // Dual averaging state.
+    double target_acceptance_rate_;
+    double dual_averaging_mu_;
+    double dual_averaging_hbar_;
+    double log_step_size_bar_;
+    int dual_averaging_count_;
+
+    // Running moments of the draws in the current metric window.  Only the
+    // diagonal of the sum of squares is kept for a diagonal metric.
+    int window_draw_count_;
+    Vector window_mean_;
+    Vector window_diagonal_sum_of_squares_;
+    SpdMatrix window_sum_of_squares_;
+
+    // The most recent draw, with its log density and gradient.
+    PhasePoint last_draw_;
+
+    double acceptance_probability_;
+    int leapfrog_steps_;
+    bool diverged_;
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_HAMILTONIAN_MONTE_CARLO_HPP_
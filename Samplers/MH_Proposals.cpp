@@ -18,6 +18,8 @@
 */
 #include "Samplers/MH_Proposals.hpp"
 #include "LinAlg/Cholesky.hpp"
+#include "LinAlg/VectorExpression.hpp"
+#include "cpputil/Checkpoint.hpp"
 #include "distributions.hpp"
 namespace BOOM {
 
@@ -31,14 +33,17 @@ namespace BOOM {
 
   Vector MVTP::draw(const Vector &old, RNG *rng) const {
     int n = old.size();
-    Vector ans(n);
-    for (int i = 0; i < n; ++i) ans[i] = rnorm_mt(*rng, 0, 1);
-    ans = chol_ * ans;
+    Vector z(n);
+    for (int i = 0; i < n; ++i) z[i] = rnorm_mt(*rng, 0, 1);
+    double scale = 1.0;
     if (std::isfinite(nu_) && nu_ > 0) {
       double w = rgamma_mt(*rng, nu_ / 2.0, nu_ / 2.0);
-      ans /= sqrt(w);
+      scale = 1.0 / sqrt(w);
     }
-    ans += mu(old);
+    // ans = mu + scale * chol * z, with the sum fused into one pass.
+    Vector ans(n);
+    chol_.mult(z, ans);
+    (lazy(mu(old)) + scale * lazy(ans)).assign_to(ans);
     return ans;
   }
 
@@ -68,6 +73,23 @@ namespace BOOM {
     return dmvn(x, mu(old), siginv_, ldsi_, true);
   }
 
+  // The Cholesky factor is saved as is, rather than recomputed on restore,
+  // because set_var() and set_ivar() store different (but equally valid)
+  // factors, which produce different draws.
+  void MVTP::save_state(CheckpointWriter &checkpoint) const {
+    checkpoint.write_matrix(siginv_);
+    checkpoint.write_matrix(chol_);
+    checkpoint.write_double(ldsi_);
+    checkpoint.write_double(nu_);
+  }
+
+  void MVTP::restore_state(CheckpointReader &checkpoint) {
+    siginv_ = SpdMatrix(checkpoint.read_matrix(), false);
+    chol_ = checkpoint.read_matrix();
+    ldsi_ = checkpoint.read_double();
+    nu_ = checkpoint.read_double();
+  }
+
   typedef MvtRwmProposal MVTR;
   MVTR::MvtRwmProposal(const SpdMatrix &Ivar, double nu) : MVTP(Ivar, nu) {}
 
@@ -77,6 +99,16 @@ namespace BOOM {
 
   void MVTI::set_mu(const Vector &mu) { mu_ = mu; }
 
+  void MVTI::save_state(CheckpointWriter &checkpoint) const {
+    MVTP::save_state(checkpoint);
+    checkpoint.write_vector(mu_);
+  }
+
+  void MVTI::restore_state(CheckpointReader &checkpoint) {
+    MVTP::restore_state(checkpoint);
+    mu_ = checkpoint.read_vector();
+  }
+
   //======================================================================
   typedef TScalarMhProposal TSP;
 
@@ -24,6 +24,9 @@
 #include "cpputil/Ptr.hpp"
 
 namespace BOOM {
+  class CheckpointWriter;
+  class CheckpointReader;
+
   // ======================================================================
   // MH_Proposal models a proposal distribution for a
   // MetropolisHastings sampler
@@ -35,6 +38,12 @@ namespace BOOM {
     virtual double logf(const Vector &x, const Vector &old) const = 0;
     virtual bool sym() const = 0;  // logf(x|old)== logf(old|x)
 
+    // Save and restore the location and scale of the proposal, so that a
+    // checkpointed sampler resumes with the proposal it had tuned.  The
+    // default saves nothing.
+    virtual void save_state(CheckpointWriter &checkpoint) const {}
+    virtual void restore_state(CheckpointReader &checkpoint) {}
+
     friend void intrusive_ptr_add_ref(MH_Proposal *s) { s->up_count(); }
     friend void intrusive_ptr_release(MH_Proposal *s) {
       s->down_count();
@@ -58,6 +67,8 @@ namespace BOOM {
     void set_nu(double nu);
     uint dim() const;
     const SpdMatrix &ivar() const { return siginv_; }
+    void save_state(CheckpointWriter &checkpoint) const override;
+    void restore_state(CheckpointReader &checkpoint) override;
 
    private:
     SpdMatrix siginv_;
@@ -76,6 +87,8 @@ namespace BOOM {
     void set_mu(const Vector &mu);
     // the name 'mode' is used because 'mu' is taken
     const Vector &mode() const { return mu_; }
+    void save_state(CheckpointWriter &checkpoint) const override;
+    void restore_state(CheckpointReader &checkpoint) override;
 
    private:
     Vector mu_;
@@ -18,6 +18,7 @@
 */
 #include "Samplers/MetropolisHastings.hpp"
 #include <utility>
+#include "cpputil/Checkpoint.hpp"
 #include "cpputil/report_error.hpp"
 #include "distributions.hpp"
 
@@ -32,6 +33,14 @@ namespace BOOM {
 
   void MH::set_target(const Target &f) { f_ = f; }
 
+  void MH::save_state(CheckpointWriter &checkpoint) const {
+    if (prop_) prop_->save_state(checkpoint);
+  }
+
+  void MH::restore_state(CheckpointReader &checkpoint) {
+    if (prop_) prop_->restore_state(checkpoint);
+  }
+
   Vector MH::draw(const Vector &old) {
     cand_ = prop_->draw(old, &rng());
     double logp_cand = logp(cand_);
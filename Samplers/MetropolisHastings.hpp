@@ -33,6 +33,12 @@ namespace BOOM {
     virtual double logp(const Vector &x) const;
     bool last_draw_was_accepted() const;
 
+    // Save and restore the state of the proposal distribution.  The RNG is
+    // not included.  It normally belongs to (and is checkpointed by) the
+    // PosteriorSampler that owns this object.
+    virtual void save_state(CheckpointWriter &checkpoint) const;
+    virtual void restore_state(CheckpointReader &checkpoint);
+
    protected:
     void set_proposal(const Ptr<MH_Proposal> &);
     void set_target(const Target &f);
@@ -19,6 +19,7 @@
 
 #include "Samplers/MoveAccounting.hpp"
 #include <set>
+#include "cpputil/Checkpoint.hpp"
 
 namespace BOOM {
 
@@ -51,6 +52,45 @@ namespace BOOM {
     }
   }  // namespace
 
+  void MoveAccounting::save_state(CheckpointWriter &checkpoint) const {
+    checkpoint.write_uint64(counts_.size());
+    for (CountsIterator move_type = counts_.begin(); move_type != counts_.end();
+         ++move_type) {
+      checkpoint.write_string(move_type->first);
+      checkpoint.write_uint64(move_type->second.size());
+      for (IntMapIterator outcome = move_type->second.begin();
+           outcome != move_type->second.end(); ++outcome) {
+        checkpoint.write_string(outcome->first);
+        checkpoint.write_int(outcome->second);
+      }
+    }
+    checkpoint.write_uint64(time_in_seconds_.size());
+    for (TimeIterator timing = time_in_seconds_.begin();
+         timing != time_in_seconds_.end(); ++timing) {
+      checkpoint.write_string(timing->first);
+      checkpoint.write_double(timing->second);
+    }
+  }
+
+  void MoveAccounting::restore_state(CheckpointReader &checkpoint) {
+    counts_.clear();
+    time_in_seconds_.clear();
+    std::uint64_t number_of_move_types = checkpoint.read_uint64();
+    for (std::uint64_t i = 0; i < number_of_move_types; ++i) {
+      std::map<std::string, int> &outcomes(counts_[checkpoint.read_string()]);
+      std::uint64_t number_of_outcomes = checkpoint.read_uint64();
+      for (std::uint64_t j = 0; j < number_of_outcomes; ++j) {
+        std::string outcome = checkpoint.read_string();
+        outcomes[outcome] = checkpoint.read_int();
+      }
+    }
+    std::uint64_t number_of_timings = checkpoint.read_uint64();
+    for (std::uint64_t i = 0; i < number_of_timings; ++i) {
+      std::string move_type = checkpoint.read_string();
+      time_in_seconds_[move_type] = checkpoint.read_double();
+    }
+  }
+
   LabeledMatrix MoveAccounting::to_matrix() const {
     std::vector<std::string> move_types = compute_move_types();
     std::vector<std::string> outcome_types = compute_outcome_type_names();
@@ -29,6 +29,8 @@
 
 namespace BOOM {
 
+  class CheckpointWriter;
+  class CheckpointReader;
   class MoveAccounting;
   // A MoveTimer class will record the amount of time between its
   // creation and its destruction.
@@ -87,6 +89,11 @@ namespace BOOM {
     MoveTimer start_time(const std::string &move_type);
     double stop_time(const std::string &move_type, clock_t start);
 
+    // Save or restore the counts and timings, so that the accounting for
+    // a resumed MCMC run picks up where it left off.
+    void save_state(CheckpointWriter &checkpoint) const;
+    void restore_state(CheckpointReader &checkpoint);
+
    private:
     // counts_ is essentially a matrix indexed by strings instead of
     // integers.  The "row" index is called a "move type".  It is
@@ -20,6 +20,7 @@
 #include <cassert>
 #include <cmath>
 #include <stdexcept>
+#include "LinAlg/VectorExpression.hpp"
 #include "cpputil/math_utils.hpp"
 #include "cpputil/report_error.hpp"
 #include "distributions.hpp"
@@ -57,20 +58,20 @@ namespace BOOM {
     hi_ = scale_;
 
     set_random_direction();
-    logplo_ = logp_(last_position_ - lo_ * random_direction_);
+    logplo_ = logp_(lazy(last_position_) - lo_ * lazy(random_direction_));
     // If necessary, shrink the lower bound until the log density is
     // finite.
     while (!std::isfinite(logplo_)) {
       lo_ /= 2.0;
-      logplo_ = logp_(last_position_ - lo_ * random_direction_);
+      logplo_ = logp_(lazy(last_position_) - lo_ * lazy(random_direction_));
     }
 
-    logphi_ = logp_(last_position_ + hi_ * random_direction_);
+    logphi_ = logp_(lazy(last_position_) + hi_ * lazy(random_direction_));
     // If necessary, shrink the upper bound until the log density is
     // finite.
     while (!std::isfinite(logphi_)) {
       hi_ /= 2.0;
-      logphi_ = logp_(last_position_ + hi_ * random_direction_);
+      logphi_ = logp_(lazy(last_position_) + hi_ * lazy(random_direction_));
     }
   }
 
@@ -100,10 +101,10 @@ namespace BOOM {
       value = old;
       return;
     }
-    p = logp_(last_position_ + sgn * value * random_direction_);
+    p = logp_(lazy(last_position_) + sgn * value * lazy(random_direction_));
     while (isnan(p)) {
       value = (value + old) / 2;
-      p = logp_(last_position_ + sgn * value * random_direction_);
+      p = logp_(lazy(last_position_) + sgn * value * lazy(random_direction_));
     }
   }
 
@@ -154,7 +155,8 @@ namespace BOOM {
     double logp_candidate = log_p_slice_ - 1;
     do {
       double lambda = runif_mt(rng(), -lo_, hi_);
-      candidate = last_position_ + lambda * random_direction_;
+      (lazy(last_position_) + lambda * lazy(random_direction_))
+          .assign_to(candidate);
       logp_candidate = logp_(candidate);
       if (logp_candidate < log_p_slice_) contract(lambda, logp_candidate);
     } while (logp_candidate < log_p_slice_);
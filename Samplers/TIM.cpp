@@ -19,6 +19,7 @@
 #include "Samplers/TIM.hpp"
 #include <functional>
 #include "Samplers/MH_Proposals.hpp"
+#include "cpputil/Checkpoint.hpp"
 #include "cpputil/report_error.hpp"
 
 namespace BOOM {
@@ -135,6 +136,24 @@ namespace BOOM {
     return prop_->ivar();
   }
 
+  void TIM::save_state(CheckpointWriter &checkpoint) const {
+    checkpoint.write_int(mode_is_fixed_);
+    checkpoint.write_int(mode_has_been_found_);
+    checkpoint.write_int(!!prop_);
+    if (prop_) prop_->save_state(checkpoint);
+  }
+
+  void TIM::restore_state(CheckpointReader &checkpoint) {
+    mode_is_fixed_ = checkpoint.read_int();
+    mode_has_been_found_ = checkpoint.read_int();
+    bool has_proposal = checkpoint.read_int();
+    if (has_proposal) {
+      // The dimension is a placeholder.  The restored proposal replaces it.
+      check_proposal(1);
+      prop_->restore_state(checkpoint);
+    }
+  }
+
   Ptr<MvtIndepProposal> TIM::create_proposal(int dim, double nu) {
     Vector mu(dim);
     SpdMatrix Sigma(dim);
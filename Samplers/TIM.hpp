@@ -89,6 +89,11 @@ namespace BOOM {
     const Vector &mode() const;
     const SpdMatrix &ivar() const;
 
+    // The checkpoint includes the modal approximation, so a sampler with a
+    // fixed mode does not have to locate it again after being restored.
+    void save_state(CheckpointWriter &checkpoint) const override;
+    void restore_state(CheckpointReader &checkpoint) override;
+
    private:
     void report_failure(const Vector &old);
     Ptr<MvtIndepProposal> create_proposal(int dim, double nu);
@@ -0,0 +1,117 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_CPPUTIL_ALIGNED_ALLOCATOR_HPP_
+#define BOOM_CPPUTIL_ALIGNED_ALLOCATOR_HPP_
+
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace BOOM {
+
+  // The default alignment, in bytes, of an AlignedAllocator.  64 bytes is a
+  // cache line, and the width of an AVX-512 register.
+  constexpr std::size_t kSimdAlignment = 64;
+
+  // An STL allocator returning storage aligned to ALIGNMENT bytes, so that
+  // vectorized code can use aligned loads and stores.
+  //
+  // Memory comes from posix_memalign (_aligned_malloc on Windows), which is
+  // available under C++11, where aligned operator new and
+  // std::aligned_alloc are not.
+  //
+  // Memory cost: the C library satisfies an aligned request by carving an
+  // aligned block out of a larger chunk, so aligned allocations use more
+  // heap than plain malloc.  Measured with glibc and 64-byte alignment, a
+  // 3-element array of doubles occupies 96 bytes of heap instead of 32, and
+  // a 100-element array 928 bytes instead of 816.  For that reason Vector
+  // and Matrix use the default allocator, and aligned storage is reserved
+  // for large workspaces such as AlignedMatrix.
+  template <class T, std::size_t ALIGNMENT = kSimdAlignment>
+  class AlignedAllocator {
+   public:
+    static_assert(ALIGNMENT >= alignof(void *) &&
+                      (ALIGNMENT & (ALIGNMENT - 1)) == 0,
+                  "ALIGNMENT must be a power of 2 at least as large as a "
+                  "pointer's alignment.");
+
+    typedef T value_type;
+    typedef T *pointer;
+    typedef const T *const_pointer;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template <class U>
+    struct rebind {
+      typedef AlignedAllocator<U, ALIGNMENT> other;
+    };
+
+    AlignedAllocator() noexcept {}
+    template <class U>
+    AlignedAllocator(const AlignedAllocator<U, ALIGNMENT> &) noexcept {}
+
+    T *allocate(std::size_t n) {
+      if (n == 0) return nullptr;
+      if (n > max_size()) throw std::bad_alloc();
+#ifdef _WIN32
+      void *ans = _aligned_malloc(n * sizeof(T), ALIGNMENT);
+#else
+      void *ans = nullptr;
+      if (posix_memalign(&ans, ALIGNMENT, n * sizeof(T)) != 0) {
+        ans = nullptr;
+      }
+#endif
+      if (!ans) throw std::bad_alloc();
+      return static_cast<T *>(ans);
+    }
+
+    void deallocate(T *p, std::size_t) noexcept {
+#ifdef _WIN32
+      _aligned_free(p);
+#else
+      std::free(p);
+#endif
+    }
+
+    std::size_t max_size() const noexcept {
+      return std::numeric_limits<std::size_t>::max() / sizeof(T);
+    }
+  };
+
+  // All AlignedAllocators with the same alignment are interchangeable.
+  template <class T, class U, std::size_t ALIGNMENT>
+  bool operator==(const AlignedAllocator<T, ALIGNMENT> &,
+                  const AlignedAllocator<U, ALIGNMENT> &) {
+    return true;
+  }
+
+  template <class T, class U, std::size_t ALIGNMENT>
+  bool operator!=(const AlignedAllocator<T, ALIGNMENT> &,
+                  const AlignedAllocator<U, ALIGNMENT> &) {
+    return false;
+  }
+
+}  // namespace BOOM
+
+#endif  // BOOM_CPPUTIL_ALIGNED_ALLOCATOR_HPP_
@@ -0,0 +1,442 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include "cpputil/BinaryDrawFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "cpputil/report_error.hpp"
+
+namespace BOOM {
+
+  namespace DrawFile {
+    namespace {
+      const char kMagic[8] = {'B', 'O', 'O', 'M', 'D', 'R', 'A', 'W'};
+      const std::uint32_t kVersion = 1;
+      const std::uint32_t kByteOrderMark = 0x01020304;
+
+      // Reads objects of type T from a byte buffer, checking bounds.
+      class ByteReader {
+       public:
+        ByteReader(const char *data, std::size_t size)
+            : data_(data), size_(size), position_(0) {}
+
+        template <class T>
+        T read() {
+          T ans;
+          read_bytes(&ans, sizeof(T));
+          return ans;
+        }
+
+        void read_bytes(void *output, std::size_t n) {
+          if (position_ + n > size_) {
+            report_error("Unexpected end of file in draw file header.");
+          }
+          std::memcpy(output, data_ + position_, n);
+          position_ += n;
+        }
+
+        std::size_t position() const { return position_; }
+
+       private:
+        const char *data_;
+        std::size_t size_;
+        std::size_t position_;
+      };
+
+      std::size_t round_up_to_multiple_of_8(std::size_t n) {
+        return (n + 7) / 8 * 8;
+      }
+
+      // Parse the header at the start of 'data'.  Returns the position where
+      // the first block begins.
+      std::size_t parse_header(const char *data, std::size_t size,
+                               Header &header, const std::string &filename) {
+        ByteReader reader(data, size);
+        char magic[8];
+        reader.read_bytes(magic, 8);
+        if (std::memcmp(magic, kMagic, 8) != 0) {
+          report_error(filename + " is not a BOOM draw file.");
+        }
+        std::uint32_t version = reader.read<std::uint32_t>();
+        if (version != kVersion) {
+          std::ostringstream err;
+          err << "Unsupported draw file version " << version << " in "
+              << filename << ".";
+          report_error(err.str());
+        }
+        if (reader.read<std::uint32_t>() != kByteOrderMark) {
+          report_error(filename + " was written with a different byte order.");
+        }
+        std::uint64_t number_of_parameters = reader.read<std::uint64_t>();
+        header.names.clear();
+        header.dimensions.clear();
+        for (std::uint64_t i = 0; i < number_of_parameters; ++i) {
+          std::uint64_t name_length = reader.read<std::uint64_t>();
+          if (name_length > size) {
+            report_error("Corrupt parameter name in " + filename + ".");
+          }
+          std::string name(name_length, ' ');
+          if (name_length > 0) reader.read_bytes(&name[0], name_length);
+          header.names.push_back(name);
+          header.dimensions.push_back(reader.read<std::uint64_t>());
+        }
+        return round_up_to_multiple_of_8(reader.position());
+      }
+
+      bool file_exists_and_is_nonempty(const std::string &filename) {
+        std::ifstream in(filename, std::ios::binary | std::ios::ate);
+        return in && in.tellg() > 0;
+      }
+    }  // namespace
+
+    int Header::total_dimension() const {
+      int ans = 0;
+      for (int dim : dimensions) ans += dim;
+      return ans;
+    }
+  }  // namespace DrawFile
+
+  //===========================================================================
+  DrawFileWriter::DrawFileWriter(const std::string &filename,
+                                 const std::vector<std::string> &names,
+                                 const std::vector<int> &dimensions,
+                                 int block_size, bool append)
+      : filename_(filename),
+        total_dimension_(0),
+        block_size_(std::max<int>(block_size, 1)),
+        buffered_rows_(0),
+        file_(nullptr) {
+    if (names.size() != dimensions.size()) {
+      report_error("The number of parameter names must match the number "
+                   "of dimensions.");
+    }
+    header_.names = names;
+    header_.dimensions = dimensions;
+    for (int dim : dimensions) {
+      if (dim < 0) report_error("Parameter dimensions must be non-negative.");
+    }
+    total_dimension_ = header_.total_dimension();
+    buffer_.resize(static_cast<std::size_t>(block_size_) * total_dimension_);
+
+    if (append && DrawFile::file_exists_and_is_nonempty(filename_)) {
+      {
+        DrawFileReader existing(filename_);
+        bool match = existing.number_of_parameters() == names.size();
+        for (int i = 0; match && i < names.size(); ++i) {
+          match = existing.name(i) == names[i]
+              && existing.dimension(i) == dimensions[i];
+        }
+        if (!match) {
+          report_error("Can't append to " + filename_ +
+                       " because its parameters do not match.");
+        }
+      }
+      file_ = std::fopen(filename_.c_str(), "ab");
+      if (!file_) report_error("Could not open " + filename_ + ".");
+    } else {
+      write_header();
+    }
+  }
+
+  DrawFileWriter::~DrawFileWriter() {
+    if (file_) {
+      if (buffered_rows_ > 0) {
+        try {
+          flush();
+        } catch (...) {
+          // Destructors must not throw.
+        }
+      }
+      std::fclose(file_);
+    }
+  }
+
+  void DrawFileWriter::write_header() {
+    if (file_) std::fclose(file_);
+    file_ = std::fopen(filename_.c_str(), "wb");
+    if (!file_) report_error("Could not open " + filename_ + " for writing.");
+    std::vector<char> header;
+    auto append_bytes = [&header](const void *data, std::size_t n) {
+      const char *bytes = static_cast<const char *>(data);
+      header.insert(header.end(), bytes, bytes + n);
+    };
+    append_bytes(DrawFile::kMagic, 8);
+    append_bytes(&DrawFile::kVersion, sizeof(DrawFile::kVersion));
+    append_bytes(&DrawFile::kByteOrderMark, sizeof(DrawFile::kByteOrderMark));
+    std::uint64_t number_of_parameters = header_.names.size();
+    append_bytes(&number_of_parameters, sizeof(number_of_parameters));
+    for (int i = 0; i < header_.names.size(); ++i) {
+      std::uint64_t name_length = header_.names[i].size();
+      append_bytes(&name_length, sizeof(name_length));
+      append_bytes(header_.names[i].data(), name_length);
+      std::uint64_t dim = header_.dimensions[i];
+      append_bytes(&dim, sizeof(dim));
+    }
+    header.resize(DrawFile::round_up_to_multiple_of_8(header.size()), 0);
+    if (std::fwrite(header.data(), 1, header.size(), file_) != header.size()) {
+      report_error("Error writing header to " + filename_ + ".");
+    }
+  }
+
+  void DrawFileWriter::write(const ConstVectorView &draw) {
+    if (draw.size() != total_dimension_) {
+      report_error("Draw has the wrong dimension for " + filename_ + ".");
+    }
+    double *row = buffer_.data() + buffered_rows_;
+    for (int j = 0; j < total_dimension_; ++j) {
+      row[static_cast<std::size_t>(j) * block_size_] = draw[j];
+    }
+    if (++buffered_rows_ == block_size_) {
+      flush();
+    }
+  }
+
+  void DrawFileWriter::flush() {
+    if (buffered_rows_ > 0) {
+      std::uint64_t nrows = buffered_rows_;
+      bool ok = std::fwrite(&nrows, sizeof(nrows), 1, file_) == 1;
+      // The buffer's leading dimension is block_size_, so a short block is
+      // written one column at a time.
+      for (int j = 0; ok && j < total_dimension_; ++j) {
+        ok = std::fwrite(buffer_.data() + static_cast<std::size_t>(j) *
+                         block_size_, sizeof(double), buffered_rows_, file_)
+            == buffered_rows_;
+      }
+      if (!ok) report_error("Error writing draws to " + filename_ + ".");
+      buffered_rows_ = 0;
+    }
+    std::fflush(file_);
+  }
+
+  void DrawFileWriter::clear() {
+    buffered_rows_ = 0;
+    write_header();
+    std::fflush(file_);
+  }
+
+  void DrawFileWriter::set_block_size(int block_size) {
+    flush();
+    block_size_ = std::max<int>(block_size, 1);
+    buffer_.resize(static_cast<std::size_t>(block_size_) * total_dimension_);
+  }
+
+  //===========================================================================
+  DrawFileReader::DrawFileReader(const std::string &filename)
+      : filename_(filename),
+        total_dimension_(0),
+        number_of_draws_(0),
+        file_(filename) {
+    const char *data = file_.data();
+    std::size_t size = file_.size();
+
+    std::size_t position = DrawFile::parse_header(
+        data, size, header_, filename_);
+    int offset = 0;
+    for (int dim : header_.dimensions) {
+      offsets_.push_back(offset);
+      offset += dim;
+    }
+    total_dimension_ = offset;
+
+    // Index the blocks.  A truncated final block (e.g. from an interrupted
+    // run) is ignored.
+    while (position + sizeof(std::uint64_t) <= size) {
+      std::uint64_t nrows;
+      std::memcpy(&nrows, data + position, sizeof(nrows));
+      std::size_t block_bytes = nrows * total_dimension_ * sizeof(double);
+      if (position + sizeof(nrows) + block_bytes > size) break;
+      Block block;
+      block.first_row = number_of_draws_;
+      block.nrows = nrows;
+      block.data = reinterpret_cast<const double *>(
+          data + position + sizeof(nrows));
+      blocks_.push_back(block);
+      number_of_draws_ += nrows;
+      position += sizeof(nrows) + block_bytes;
+    }
+  }
+
+  DrawFileReader::~DrawFileReader() {}
+
+  int DrawFileReader::parameter_index(const std::string &name) const {
+    auto it = std::find(header_.names.begin(), header_.names.end(), name);
+    return it == header_.names.end() ? -1 : it - header_.names.begin();
+  }
+
+  const DrawFileReader::Block &DrawFileReader::find_block(
+      int iteration) const {
+    if (iteration < 0 || iteration >= number_of_draws_) {
+      std::ostringstream err;
+      err << "Iteration " << iteration << " is out of range.  " << filename_
+          << " contains " << number_of_draws_ << " draws.";
+      report_error(err.str());
+    }
+    auto it = std::upper_bound(
+        blocks_.begin(), blocks_.end(), iteration,
+        [](int row, const Block &block) { return row < block.first_row; });
+    return *(it - 1);
+  }
+
+  double DrawFileReader::value(int iteration, int j) const {
+    const Block &block(find_block(iteration));
+    return block.data[static_cast<std::size_t>(j) * block.nrows
+                      + iteration - block.first_row];
+  }
+
+  void DrawFileReader::read_draw(int iteration, VectorView output) const {
+    if (output.size() != total_dimension_) {
+      report_error("Output has the wrong size in DrawFileReader::read_draw.");
+    }
+    const Block &block(find_block(iteration));
+    const double *data = block.data + iteration - block.first_row;
+    for (int j = 0; j < total_dimension_; ++j) {
+      output[j] = data[static_cast<std::size_t>(j) * block.nrows];
+    }
+  }
+
+  Vector DrawFileReader::draw(int iteration) const {
+    Vector ans(total_dimension_);
+    read_draw(iteration, VectorView(ans));
+    return ans;
+  }
+
+  Vector DrawFileReader::column(int j) const {
+    if (j < 0 || j >= total_dimension_) {
+      report_error("Column index out of range in DrawFileReader::column.");
+    }
+    Vector ans(number_of_draws_);
+    for (const Block &block : blocks_) {
+      const double *data = block.data + static_cast<std::size_t>(j) *
+          block.nrows;
+      std::copy(data, data + block.nrows, ans.begin() + block.first_row);
+    }
+    return ans;
+  }
+
+  Matrix DrawFileReader::parameter_draws(int parameter) const {
+    int dim = dimension(parameter);
+    Matrix ans(number_of_draws_, dim);
+    for (int k = 0; k < dim; ++k) {
+      ans.col(k) = column(offsets_[parameter] + k);
+    }
+    return ans;
+  }
+
+  //===========================================================================
+  BinaryParamIoManager::BinaryParamIoManager(const std::string &filename)
+      : filename_(filename),
+        buffer_size_in_iterations_(100),
+        next_iteration_(-1) {}
+
+  void BinaryParamIoManager::add_parameter(const Ptr<Params> &parameter,
+                                           const std::string &name) {
+    if (writer_) {
+      report_error("Parameters must be added before the first call to "
+                   "write().");
+    }
+    parameters_.push_back(parameter);
+    names_.push_back(name);
+  }
+
+  void BinaryParamIoManager::set_bufsize(int iterations) {
+    buffer_size_in_iterations_ = iterations;
+    if (writer_) writer_->set_block_size(iterations);
+  }
+
+  void BinaryParamIoManager::ensure_writer() {
+    if (!writer_) {
+      std::vector<int> dimensions;
+      for (const auto &parameter : parameters_) {
+        dimensions.push_back(parameter->size(false));
+      }
+      writer_.reset(new DrawFileWriter(
+          filename_, names_, dimensions, buffer_size_in_iterations_, true));
+      workspace_.resize(writer_->total_dimension());
+    }
+  }
+
+  void BinaryParamIoManager::ensure_reader() {
+    if (writer_) writer_->flush();
+    if (!reader_) {
+      reader_.reset(new DrawFileReader(filename_));
+      if (reader_->number_of_parameters() != parameters_.size()) {
+        report_error(filename_ + " does not match the managed parameters.");
+      }
+      for (int i = 0; i < parameters_.size(); ++i) {
+        if (reader_->dimension(i) != parameters_[i]->size(false)) {
+          report_error(filename_ + " does not match the managed parameters.");
+        }
+      }
+      workspace_.resize(reader_->total_dimension());
+    }
+  }
+
+  void BinaryParamIoManager::clear_files() {
+    reader_.reset();
+    ensure_writer();
+    writer_->clear();
+    next_iteration_ = -1;
+  }
+
+  void BinaryParamIoManager::flush() {
+    if (writer_) writer_->flush();
+  }
+
+  void BinaryParamIoManager::write() {
+    ensure_writer();
+    int position = 0;
+    for (const auto &parameter : parameters_) {
+      Vector value = parameter->vectorize(false);
+      std::copy(value.begin(), value.end(), workspace_.begin() + position);
+      position += value.size();
+    }
+    writer_->write(workspace_);
+  }
+
+  void BinaryParamIoManager::rewind() {
+    // Drop the reader so that draws written since it was opened are visible.
+    reader_.reset();
+    next_iteration_ = 0;
+  }
+
+  void BinaryParamIoManager::read_next_value() {
+    if (next_iteration_ < 0) rewind();
+    ensure_reader();
+    read_iteration(next_iteration_++);
+  }
+
+  void BinaryParamIoManager::read_last_line() {
+    reader_.reset();
+    ensure_reader();
+    next_iteration_ = reader_->number_of_draws();
+    read_iteration(next_iteration_ - 1);
+  }
+
+  void BinaryParamIoManager::read_iteration(int iteration) {
+    reader_->read_draw(iteration, VectorView(workspace_));
+    Vector::const_iterator it = workspace_.cbegin();
+    for (auto &parameter : parameters_) {
+      parameter->unvectorize(it, false);
+    }
+  }
+
+}  // namespace BOOM
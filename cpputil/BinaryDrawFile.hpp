@@ -0,0 +1,248 @@
+#ifndef BOOM_CPPUTIL_BINARY_DRAW_FILE_HPP_
+#define BOOM_CPPUTIL_BINARY_DRAW_FILE_HPP_
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LinAlg/Matrix.hpp"
+#include "LinAlg/Vector.hpp"
+#include "LinAlg/VectorView.hpp"
+#include "cpputil/MappedFile.hpp"
+#include "Models/ParamTypes.hpp"
+
+namespace BOOM {
+
+  // A binary file format for storing MCMC draws, intended as a faster and
+  // more compact alternative to writing each parameter as lines of text.
+  //
+  // The file begins with a header describing the parameters:
+  //   * The 8 characters "BOOMDRAW".
+  //   * uint32: the format version (currently 1).
+  //   * uint32: 0x01020304, used to detect a byte order mismatch.
+  //   * uint64: the number of parameters.
+  //   * For each parameter: a uint64 name length, the name's characters,
+  //     and a uint64 dimension.
+  //   * Zero padding to a multiple of 8 bytes.
+  // The header is followed by any number of blocks.  Each block holds
+  //   * uint64: the number of iterations (rows) in the block, and
+  //   * rows * total_dimension doubles, stored by column.
+  // Storing blocks by column means that reading every draw of a single
+  // parameter touches a contiguous stretch of each block, while appending
+  // only requires buffering one block's worth of draws.  Values are written
+  // in the native byte order.
+  namespace DrawFile {
+    struct Header {
+      std::vector<std::string> names;
+      std::vector<int> dimensions;
+      int total_dimension() const;
+    };
+  }  // namespace DrawFile
+
+  //===========================================================================
+  // Appends draws to a binary draw file.  Draws are buffered in memory and
+  // written one block at a time.
+  class DrawFileWriter {
+   public:
+    // Args:
+    //   filename:  The name of the file to write.
+    //   names: The names of the parameters stored in each draw.
+    //   dimensions: The number of values each parameter contributes to a
+    //     draw.  Must be the same length as 'names'.
+    //   block_size:  The number of draws to buffer before writing a block.
+    //   append: If true and 'filename' already exists with a header
+    //     matching 'names' and 'dimensions' then new draws are added to the
+    //     end of the file.  Otherwise the file is overwritten.  An existing
+    //     file with a different header is an error if 'append' is true.
+    DrawFileWriter(const std::string &filename,
+                   const std::vector<std::string> &names,
+                   const std::vector<int> &dimensions,
+                   int block_size = 100,
+                   bool append = false);
+
+    // Writes any buffered draws.
+    ~DrawFileWriter();
+
+    DrawFileWriter(const DrawFileWriter &rhs) = delete;
+    DrawFileWriter &operator=(const DrawFileWriter &rhs) = delete;
+
+    // Add a draw to the buffer, and write the buffer to the file if it is
+    // full.  The draw must have total_dimension() elements.
+    void write(const ConstVectorView &draw);
+
+    // Write any buffered draws to the file as a (possibly short) block.
+    void flush();
+
+    // Remove all draws from the file (and the buffer), leaving just the
+    // header.
+    void clear();
+
+    // Sets the number of draws to buffer before writing.  Any buffered draws
+    // are flushed first.
+    void set_block_size(int block_size);
+
+    int total_dimension() const { return total_dimension_; }
+    const std::string &filename() const { return filename_; }
+
+   private:
+    void write_header();
+
+    std::string filename_;
+    DrawFile::Header header_;
+    int total_dimension_;
+    int block_size_;
+
+    // Holds up to block_size_ draws, stored by column with leading
+    // dimension block_size_.
+    std::vector<double> buffer_;
+    int buffered_rows_;
+
+    std::FILE *file_;
+  };
+
+  //===========================================================================
+  // Provides random access to the contents of a binary draw file.  The file
+  // is memory mapped where the operating system supports it, and read into
+  // memory otherwise.  The reader sees the draws that were in the file when
+  // it was opened.
+  class DrawFileReader {
+   public:
+    explicit DrawFileReader(const std::string &filename);
+    ~DrawFileReader();
+
+    DrawFileReader(const DrawFileReader &rhs) = delete;
+    DrawFileReader &operator=(const DrawFileReader &rhs) = delete;
+
+    int number_of_draws() const { return number_of_draws_; }
+    int number_of_parameters() const { return header_.names.size(); }
+    const std::string &name(int parameter) const {
+      return header_.names[parameter];
+    }
+    int dimension(int parameter) const {
+      return header_.dimensions[parameter];
+    }
+    int total_dimension() const { return total_dimension_; }
+
+    // The position in a draw of the first element of the given parameter.
+    int offset(int parameter) const { return offsets_[parameter]; }
+
+    // Returns the index of the parameter with the given name, or -1 if there
+    // is no such parameter.
+    int parameter_index(const std::string &name) const;
+
+    // Element j of draw 'iteration'.
+    double value(int iteration, int j) const;
+
+    // Copy the full draw from the given iteration into 'output', which must
+    // have total_dimension() elements.
+    void read_draw(int iteration, VectorView output) const;
+    Vector draw(int iteration) const;
+
+    // Element j of every draw.
+    Vector column(int j) const;
+
+    // All the draws of the given parameter, one row per iteration.
+    Matrix parameter_draws(int parameter) const;
+
+   private:
+    struct Block {
+      int first_row;
+      int nrows;
+      const double *data;
+    };
+
+    // Returns the block containing the given iteration.
+    const Block &find_block(int iteration) const;
+
+    std::string filename_;
+    DrawFile::Header header_;
+    std::vector<int> offsets_;
+    int total_dimension_;
+    int number_of_draws_;
+    std::vector<Block> blocks_;
+
+    // The file contents.
+    MappedFile file_;
+  };
+
+  //===========================================================================
+  // Stores draws of a collection of Params objects in a single binary draw
+  // file.  The public interface matches ParamFileIoManager, so either can be
+  // used to save and restore MCMC output.  Each call to write() records the
+  // current (non-minimal) value of every parameter.  Each call to
+  // read_next_value() sets the parameters to the values from the next
+  // stored iteration.
+  class BinaryParamIoManager {
+   public:
+    explicit BinaryParamIoManager(const std::string &filename);
+
+    // Adds a parameter to the set of parameters being managed.  All
+    // parameters must be added before the first call to write().
+    void add_parameter(const Ptr<Params> &parameter, const std::string &name);
+
+    // Sets the size of the output buffer to the specified number of
+    // iterations.
+    void set_bufsize(int iterations);
+
+    // Removes any draws from the file.
+    void clear_files();
+
+    // Any draws currently in the buffer are written to the file, and the
+    // buffer is made empty.
+    void flush();
+
+    // Appends parameter values to the end of the buffer.  If the buffer is
+    // full then it will be flushed.  Draws are appended to any draws already
+    // present in the file.
+    void write();
+
+    // Resets the read position to the start of the file.
+    void rewind();
+
+    // Sets the parameters to the values in the next stored iteration.  If no
+    // reading has been done thus far then reading starts from the first
+    // iteration.
+    void read_next_value();
+
+    // Sets the parameters to the values in the last stored iteration.  Future
+    // output is appended at the end of the file.
+    void read_last_line();
+
+   private:
+    // Sets the managed parameters to the values from the given iteration.
+    void read_iteration(int iteration);
+    void ensure_writer();
+    void ensure_reader();
+
+    std::string filename_;
+    std::vector<Ptr<Params>> parameters_;
+    std::vector<std::string> names_;
+    int buffer_size_in_iterations_;
+    std::unique_ptr<DrawFileWriter> writer_;
+    std::unique_ptr<DrawFileReader> reader_;
+    int next_iteration_;
+    Vector workspace_;
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_CPPUTIL_BINARY_DRAW_FILE_HPP_
@@ -0,0 +1,142 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include "cpputil/Checkpoint.hpp"
+
+#include <cstring>
+#include <utility>
+
+#include "cpputil/report_error.hpp"
+
+namespace BOOM {
+
+  void CheckpointWriter::write_bytes(const void *data, std::size_t n) {
+    const char *begin = static_cast<const char *>(data);
+    buffer_.insert(buffer_.end(), begin, begin + n);
+  }
+
+  void CheckpointWriter::write_uint64(std::uint64_t value) {
+    write_bytes(&value, sizeof(value));
+  }
+
+  void CheckpointWriter::write_int(std::int64_t value) {
+    write_bytes(&value, sizeof(value));
+  }
+
+  void CheckpointWriter::write_double(double value) {
+    write_bytes(&value, sizeof(value));
+  }
+
+  void CheckpointWriter::write_string(const std::string &value) {
+    write_uint64(value.size());
+    write_bytes(value.data(), value.size());
+  }
+
+  void CheckpointWriter::write_vector(const ConstVectorView &value) {
+    write_uint64(value.size());
+    if (value.stride() == 1) {
+      write_bytes(value.data(), value.size() * sizeof(double));
+    } else {
+      for (int i = 0; i < value.size(); ++i) write_double(value[i]);
+    }
+  }
+
+  void CheckpointWriter::write_matrix(const Matrix &value) {
+    write_uint64(value.nrow());
+    write_uint64(value.ncol());
+    write_bytes(value.data(), value.size() * sizeof(double));
+  }
+
+  void CheckpointWriter::write_uint64_vector(
+      const std::vector<std::uint64_t> &value) {
+    write_uint64(value.size());
+    write_bytes(value.data(), value.size() * sizeof(std::uint64_t));
+  }
+
+  //===========================================================================
+  CheckpointReader::CheckpointReader(std::vector<char> bytes)
+      : bytes_(std::move(bytes)), position_(0) {}
+
+  void CheckpointReader::read_bytes(void *output, std::size_t n) {
+    if (n > bytes_.size() - position_) {
+      report_error("Unexpected end of checkpoint data.");
+    }
+    if (n > 0) std::memcpy(output, bytes_.data() + position_, n);
+    position_ += n;
+  }
+
+  std::size_t CheckpointReader::read_length(std::size_t element_size) {
+    std::uint64_t length = read_uint64();
+    if (length > (bytes_.size() - position_) / element_size) {
+      report_error("Corrupt length field in checkpoint data.");
+    }
+    return length;
+  }
+
+  std::uint64_t CheckpointReader::read_uint64() {
+    std::uint64_t ans;
+    read_bytes(&ans, sizeof(ans));
+    return ans;
+  }
+
+  std::int64_t CheckpointReader::read_int() {
+    std::int64_t ans;
+    read_bytes(&ans, sizeof(ans));
+    return ans;
+  }
+
+  double CheckpointReader::read_double() {
+    double ans;
+    read_bytes(&ans, sizeof(ans));
+    return ans;
+  }
+
+  std::string CheckpointReader::read_string() {
+    std::size_t length = read_length(1);
+    std::string ans(length, ' ');
+    if (length > 0) read_bytes(&ans[0], length);
+    return ans;
+  }
+
+  Vector CheckpointReader::read_vector() {
+    std::size_t length = read_length(sizeof(double));
+    Vector ans(length);
+    read_bytes(ans.data(), length * sizeof(double));
+    return ans;
+  }
+
+  Matrix CheckpointReader::read_matrix() {
+    std::uint64_t nrow = read_uint64();
+    std::uint64_t ncol = read_uint64();
+    if (ncol > 0 &&
+        nrow > (bytes_.size() - position_) / sizeof(double) / ncol) {
+      report_error("Corrupt matrix dimensions in checkpoint data.");
+    }
+    Matrix ans(nrow, ncol);
+    read_bytes(ans.data(), nrow * ncol * sizeof(double));
+    return ans;
+  }
+
+  std::vector<std::uint64_t> CheckpointReader::read_uint64_vector() {
+    std::size_t length = read_length(sizeof(std::uint64_t));
+    std::vector<std::uint64_t> ans(length);
+    read_bytes(ans.data(), length * sizeof(std::uint64_t));
+    return ans;
+  }
+
+}  // namespace BOOM
@@ -0,0 +1,93 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_CPPUTIL_CHECKPOINT_HPP_
+#define BOOM_CPPUTIL_CHECKPOINT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "LinAlg/Matrix.hpp"
+#include "LinAlg/Vector.hpp"
+#include "LinAlg/VectorView.hpp"
+
+namespace BOOM {
+
+  // CheckpointWriter and CheckpointReader move the state of a running
+  // simulation (parameters, sampler internals, random number generators)
+  // to and from a flat buffer of bytes.  Objects that need to be
+  // checkpointed implement save_state(CheckpointWriter &) and
+  // restore_state(CheckpointReader &), reading back exactly what they
+  // wrote, in the same order.
+  //
+  // Values are stored in native byte order with no padding.  Doubles are
+  // copied bit for bit, so a restored simulation continues exactly where
+  // the saved one left off.  See McmcCheckpoint for the file format that
+  // wraps a buffer.
+  class CheckpointWriter {
+   public:
+    void write_uint64(std::uint64_t value);
+    void write_int(std::int64_t value);
+    void write_double(double value);
+    void write_string(const std::string &value);
+    void write_vector(const ConstVectorView &value);
+    void write_matrix(const Matrix &value);
+    void write_uint64_vector(const std::vector<std::uint64_t> &value);
+
+    const std::vector<char> &bytes() const { return buffer_; }
+    void clear() { buffer_.clear(); }
+
+   private:
+    void write_bytes(const void *data, std::size_t n);
+    std::vector<char> buffer_;
+  };
+
+  //===========================================================================
+  class CheckpointReader {
+   public:
+    explicit CheckpointReader(std::vector<char> bytes);
+
+    // Each read function throws an exception if there are not enough bytes
+    // left in the buffer.
+    std::uint64_t read_uint64();
+    std::int64_t read_int();
+    double read_double();
+    std::string read_string();
+    Vector read_vector();
+    Matrix read_matrix();
+    std::vector<std::uint64_t> read_uint64_vector();
+
+    // Returns true if every byte has been read.
+    bool at_end() const { return position_ == bytes_.size(); }
+
+   private:
+    void read_bytes(void *output, std::size_t n);
+
+    // Read a length field, checking that it could fit in the rest of the
+    // buffer given the size of each element.
+    std::size_t read_length(std::size_t element_size);
+
+    std::vector<char> bytes_;
+    std::size_t position_;
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_CPPUTIL_CHECKPOINT_HPP_
@@ -0,0 +1,74 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include "cpputil/MappedFile.hpp"
+
+#include <fstream>
+#include <iterator>
+
+#include "cpputil/report_error.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace BOOM {
+
+  MappedFile::MappedFile(const std::string &filename)
+      : filename_(filename), data_(nullptr), size_(0), mapped_(false) {
+#ifndef _WIN32
+    int fd = ::open(filename_.c_str(), O_RDONLY);
+    if (fd < 0) report_error("Could not open " + filename_ + ".");
+    struct stat file_status;
+    if (::fstat(fd, &file_status) != 0) {
+      ::close(fd);
+      report_error("Could not determine the size of " + filename_ + ".");
+    }
+    std::size_t size = file_status.st_size;
+    if (size > 0) {
+      void *map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (map != MAP_FAILED) {
+        data_ = static_cast<const char *>(map);
+        size_ = size;
+        mapped_ = true;
+      }
+    }
+    ::close(fd);
+#endif
+    if (!mapped_) {
+      std::ifstream in(filename_, std::ios::binary);
+      if (!in) report_error("Could not open " + filename_ + ".");
+      contents_.assign(std::istreambuf_iterator<char>(in),
+                       std::istreambuf_iterator<char>());
+      data_ = contents_.data();
+      size_ = contents_.size();
+    }
+  }
+
+  MappedFile::~MappedFile() {
+#ifndef _WIN32
+    if (mapped_) {
+      ::munmap(const_cast<char *>(data_), size_);
+    }
+#endif
+  }
+
+}  // namespace BOOM
@@ -0,0 +1,55 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+#ifndef BOOM_CPPUTIL_MAPPED_FILE_HPP_
+#define BOOM_CPPUTIL_MAPPED_FILE_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace BOOM {
+
+  // Read-only access to the contents of a file.  The file is memory mapped
+  // where the operating system supports it, and read into memory otherwise.
+  // The contents reflect the file as it was when the MappedFile was created.
+  class MappedFile {
+   public:
+    explicit MappedFile(const std::string &filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &rhs) = delete;
+    MappedFile &operator=(const MappedFile &rhs) = delete;
+
+    const char *data() const { return data_; }
+    std::size_t size() const { return size_; }
+    const std::string &filename() const { return filename_; }
+
+    // True if the file is memory mapped, false if it was copied into memory.
+    bool is_mapped() const { return mapped_; }
+
+   private:
+    std::string filename_;
+    const char *data_;
+    std::size_t size_;
+    bool mapped_;
+    std::vector<char> contents_;
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_CPPUTIL_MAPPED_FILE_HPP_
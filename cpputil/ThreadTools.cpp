@@ -46,51 +46,206 @@ namespace BOOM {
     return task_queue_.empty();
   }
 
-  ThreadWorkerPool::ThreadWorkerPool(int number_of_threads) : done_(false) {
+  //======================================================================
+  void WorkStealingQueue::push(MoveOnlyTaskWrapper &&task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+
+  bool WorkStealingQueue::try_pop(MoveOnlyTaskWrapper &task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (tasks_.empty()) {
+      return false;
+    }
+    task = std::move(tasks_.back());
+    tasks_.pop_back();
+    return true;
+  }
+
+  bool WorkStealingQueue::try_steal(MoveOnlyTaskWrapper &task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (tasks_.empty()) {
+      return false;
+    }
+    task = std::move(tasks_.front());
+    tasks_.pop_front();
+    return true;
+  }
+
+  bool WorkStealingQueue::empty() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.empty();
+  }
+
+  //======================================================================
+  namespace {
+    // Identifies the pool (if any) that owns the current thread, and the
+    // index of the current thread's queue in that pool.
+    thread_local const ThreadWorkerPool *current_pool = nullptr;
+    thread_local int current_queue = -1;
+  }  // namespace
+
+  ThreadWorkerPool::ThreadWorkerPool(int number_of_threads)
+      : done_(false),
+        pending_tasks_(0),
+        next_queue_(0),
+        number_of_sleepers_(0),
+        number_of_waiters_(0) {
+    queues_.emplace_back(new WorkStealingQueue);
     if (number_of_threads > 0) {
       add_threads(number_of_threads);
     }
   }
 
-  ThreadWorkerPool::~ThreadWorkerPool() { done_ = true; }
+  ThreadWorkerPool::~ThreadWorkerPool() { stop_workers(); }
 
   void ThreadWorkerPool::add_threads(int number_of_threads) {
+    if (number_of_threads > 0) {
+      restart_workers(number_of_joinable_threads() + number_of_threads);
+    }
+  }
+
+  void ThreadWorkerPool::set_number_of_threads(int n) {
+    if (n <= 0) {
+      stop_workers();
+    } else if (number_of_joinable_threads() < n) {
+      restart_workers(n);
+    }
+  }
+
+  void ThreadWorkerPool::stop_workers() {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      done_ = true;
+    }
+    work_available_.notify_all();
+    threads_.clear();
+  }
+
+  void ThreadWorkerPool::restart_workers(int number_of_threads) {
+    stop_workers();
+    // With no workers running, only threads outside the pool can touch
+    // queues_, and they hold queues_mutex_ to do it.  Work left in queues
+    // that are about to be removed is moved to the first queue.
+    std::lock_guard<std::mutex> lock(queues_mutex_);
+    while (queues_.size() < number_of_threads) {
+      queues_.emplace_back(new WorkStealingQueue);
+    }
+    for (int i = number_of_threads; i < queues_.size(); ++i) {
+      MoveOnlyTaskWrapper task;
+      while (queues_[i]->try_steal(task)) {
+        queues_[0]->push(std::move(task));
+      }
+    }
+    queues_.resize(number_of_threads);
+
+    done_ = false;
     try {
       for (int i = 0; i < number_of_threads; ++i) {
-        threads_.push_back(std::thread(&ThreadWorkerPool::worker_thread, this));
+        threads_.push_back(
+            std::thread(&ThreadWorkerPool::worker_thread, this, i));
       }
     } catch (...) {
-      done_ = true;
+      stop_workers();
       throw;
     }
   }
 
-  void ThreadWorkerPool::set_number_of_threads(int n) {
-    if (n <= 0) {
-      done_ = true;
-      threads_.clear();
-      return;
+  int ThreadWorkerPool::current_queue_index() const {
+    return current_pool == this ? current_queue : -1;
+  }
+
+  void ThreadWorkerPool::push_task(MoveOnlyTaskWrapper &&task) {
+    int index = current_queue_index();
+    if (index < 0) {
+      std::lock_guard<std::mutex> lock(queues_mutex_);
+      index = next_queue_++ % queues_.size();
+      queues_[index]->push(std::move(task));
     } else {
-      int current_number_of_joinable_threads = 0;
-      done_ = false;
-      for (int i = 0; i < threads_.size(); ++i) {
-        current_number_of_joinable_threads += threads_[i].joinable();
+      queues_[index]->push(std::move(task));
+    }
+    ++pending_tasks_;
+    // A sleeping thread increments number_of_sleepers_ (or
+    // number_of_waiters_) before checking pending_tasks_, and we increment
+    // pending_tasks_ before checking the counts, so at least one of us sees
+    // the other's update.
+    if (number_of_sleepers_ > 0 || number_of_waiters_ > 0) {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      work_available_.notify_one();
+      task_finished_.notify_all();
+    }
+  }
+
+  void ThreadWorkerPool::run_task(MoveOnlyTaskWrapper &task) {
+    task();
+    // The same argument as in push_task: the task's future is ready before
+    // number_of_waiters_ is checked here, and a waiter increments
+    // number_of_waiters_ before checking its future.
+    if (number_of_waiters_ > 0) {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      task_finished_.notify_all();
+    }
+  }
+
+  bool ThreadWorkerPool::find_task(int queue_index,
+                                   MoveOnlyTaskWrapper &task) {
+    if (queue_index >= 0 && queues_[queue_index]->try_pop(task)) {
+      --pending_tasks_;
+      return true;
+    }
+    std::unique_lock<std::mutex> lock(queues_mutex_, std::defer_lock);
+    if (queue_index < 0) lock.lock();
+    int number_of_queues = queues_.size();
+    int start = queue_index >= 0 ? queue_index + 1 : 0;
+    for (int i = 0; i < number_of_queues; ++i) {
+      int victim = (start + i) % number_of_queues;
+      if (victim != queue_index && queues_[victim]->try_steal(task)) {
+        --pending_tasks_;
+        return true;
       }
-      if (current_number_of_joinable_threads < n) {
-        add_threads(n - current_number_of_joinable_threads);
+    }
+    return false;
+  }
+
+  void ThreadWorkerPool::wait(std::future<void> &future) {
+    int queue_index = current_queue_index();
+    auto is_ready = [&future]() {
+      return future.wait_for(std::chrono::seconds(0)) ==
+             std::future_status::ready;
+    };
+    while (!is_ready()) {
+      MoveOnlyTaskWrapper task;
+      if (find_task(queue_index, task)) {
+        run_task(task);
+      } else {
+        // The task behind 'future' is running on another thread.  Sleep
+        // until some task finishes or there is new work to help with.
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        ++number_of_waiters_;
+        task_finished_.wait(
+            lock, [&]() { return pending_tasks_ > 0 || is_ready(); });
+        --number_of_waiters_;
       }
     }
   }
 
-  void ThreadWorkerPool::worker_thread() {
+  void ThreadWorkerPool::worker_thread(int queue_index) {
+    current_pool = this;
+    current_queue = queue_index;
     while (!done_) {
       MoveOnlyTaskWrapper task;
-      if (work_queue_.wait_and_pop(task)) {
-        task();
+      if (find_task(queue_index, task)) {
+        run_task(task);
       } else {
-        std::this_thread::yield();
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        ++number_of_sleepers_;
+        work_available_.wait(
+            lock, [this]() { return done_ || pending_tasks_ > 0; });
+        --number_of_sleepers_;
       }
     }
+    current_pool = nullptr;
+    current_queue = -1;
   }
 
 }  // namespace BOOM
@@ -20,13 +20,18 @@
   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
 */
 
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <deque>
+#include <exception>
 #include <functional>
 #include <future>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <vector>
 
 namespace BOOM {
 
@@ -146,8 +151,42 @@ namespace BOOM {
   };
 
   //======================================================================
-  // Manages a collection of threads and a ThreadSafeTaskQueue for
-  // passing work to them.
+  // A double-ended queue of tasks owned by a single worker thread in a
+  // ThreadWorkerPool.  The owning thread pushes and pops at the back, so
+  // recently spawned (nested) work runs first while its data is still in
+  // cache.  Idle threads steal from the front, taking the oldest (and
+  // typically largest) pieces of work.  Each queue has its own mutex, so
+  // threads only contend when one of them is stealing.
+  class WorkStealingQueue {
+   public:
+    // Pushes a task onto the back of the queue.
+    void push(MoveOnlyTaskWrapper &&task);
+
+    // Pops the most recently pushed task.  Intended for the owning thread.
+    // Returns true if a task was placed in the argument, and false if the
+    // queue was empty.
+    bool try_pop(MoveOnlyTaskWrapper &task);
+
+    // Removes the least recently pushed task.  Intended for threads other
+    // than the owner.  Returns true if a task was placed in the argument, and
+    // false if the queue was empty.
+    bool try_steal(MoveOnlyTaskWrapper &task);
+
+    // Returns true if the queue is empty, false otherwise.
+    bool empty() const;
+
+   private:
+    mutable std::mutex mutex_;
+    std::deque<MoveOnlyTaskWrapper> tasks_;
+  };
+
+  //======================================================================
+  // Manages a collection of threads, each with its own WorkStealingQueue.
+  // Work submitted from outside the pool is dealt round robin to the worker
+  // queues.  Work submitted from inside a task running on the pool goes to
+  // the queue of the thread running that task.  Threads that run out of work
+  // steal from their neighbors, and sleep (without polling) when the whole
+  // pool is idle.
   //
   // The idiom for using this is:
   //
@@ -163,6 +202,18 @@ namespace BOOM {
   //
   // Note that the call to futures[i].get() passes any exceptions
   // encountered by worker threads back to the calling thread.
+  //
+  // Loops over an index range can be written more compactly using
+  // parallel_for:
+  //
+  // pool.parallel_for(0, n, 1000, [&](int begin, int end) {
+  //   for (int i = begin; i < end; ++i) do_some_work(i);
+  // });
+  //
+  // Tasks running on the pool may themselves call submit() or
+  // parallel_for().  A task that needs to wait on a nested future should
+  // call pool.wait(future) rather than future.get(), so that the waiting
+  // thread keeps doing useful work instead of blocking a worker.
   class ThreadWorkerPool {
    public:
     // Start a worker pool with the given number of threads.
@@ -197,10 +248,68 @@ namespace BOOM {
     std::future<void> submit(FunctionType work) {
       std::packaged_task<void()> task(std::move(work));
       std::future<void> res(task.get_future());
-      work_queue_.push(std::move(task));
+      push_task(std::move(task));
       return res;
     }
 
+    // Wait until 'future' is ready, running other tasks from the pool in the
+    // meantime.  This is safe to call from inside a task running on the pool,
+    // and it is the only way the calling thread can help with the work.  If
+    // the pool has no threads, the calling thread does all the work itself.
+    //
+    // This function does not call future.get(), so any exception stored in
+    // the future is left for the caller to retrieve.
+    void wait(std::future<void> &future);
+
+    // Apply 'body' to the half-open range [begin, end), split into chunks.
+    // The chunks are run in parallel by the pool and by the calling thread,
+    // which blocks until every chunk has finished.
+    //
+    // Args:
+    //   begin, end:  The half-open range of indices to process.
+    //   grain_size: The number of indices in each chunk.  If grain_size <= 0
+    //     a chunk size is chosen giving a few chunks per thread.
+    //   body: A function-like object with signature void(int begin, int
+    //     end), which processes the indices in [begin, end).
+    //
+    // If one or more chunks throws an exception, the first one is rethrown
+    // after all chunks have finished.
+    template <typename FunctionType>
+    void parallel_for(int begin, int end, int grain_size, FunctionType body) {
+      if (end <= begin) return;
+      int range = end - begin;
+      if (grain_size <= 0) {
+        int number_of_chunks = 4 * (number_of_threads() + 1);
+        grain_size = (range + number_of_chunks - 1) / number_of_chunks;
+      }
+      if (no_threads() || range <= grain_size) {
+        body(begin, end);
+        return;
+      }
+      std::vector<std::future<void>> futures;
+      futures.reserve(range / grain_size + 1);
+      int lo = begin;
+      for (; lo + grain_size < end; lo += grain_size) {
+        int hi = lo + grain_size;
+        futures.emplace_back(submit([&body, lo, hi]() { body(lo, hi); }));
+      }
+      std::exception_ptr error;
+      try {
+        body(lo, end);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      for (auto &future : futures) {
+        wait(future);
+        try {
+          future.get();
+        } catch (...) {
+          if (!error) error = std::current_exception();
+        }
+      }
+      if (error) std::rethrow_exception(error);
+    }
+
     // Returns true() if there are currently no threads available to
     // do work.  Worker threads can be added by calling add_threads().
     bool no_threads() const { return threads_.empty(); }
@@ -219,16 +328,64 @@ namespace BOOM {
     // A flag indicating that worker threads should shut down.
     std::atomic_bool done_;
 
-    // A queue for passing work to worker threads.
-    ThreadSafeTaskQueue work_queue_;
+    // One queue per worker thread.  There is always at least one queue, so
+    // that work can be submitted to a pool with no threads.
+    std::vector<std::unique_ptr<WorkStealingQueue>> queues_;
+
+    // Guards queues_ while restart_workers rebuilds it.  Threads outside the
+    // pool hold it whenever they touch queues_.  Worker threads need not,
+    // because restart_workers joins them before it changes queues_.
+    std::mutex queues_mutex_;
+
+    // The number of tasks sitting in queues_, waiting to be run.
+    std::atomic<int> pending_tasks_;
+
+    // Round robin counter used to deal externally submitted work to queues.
+    std::atomic<unsigned> next_queue_;
+
+    // Idle workers sleep on work_available_ rather than polling.
+    // number_of_sleepers_ lets push_task skip the notification when every
+    // thread is busy.
+    std::mutex sleep_mutex_;
+    std::condition_variable work_available_;
+    std::atomic<int> number_of_sleepers_;
+
+    // Threads in wait() with nothing to run sleep on task_finished_, which
+    // is signalled when a task finishes or new work is queued.
+    // number_of_waiters_ lets the notification be skipped when nobody is
+    // waiting.  Both use sleep_mutex_.
+    std::condition_variable task_finished_;
+    std::atomic<int> number_of_waiters_;
 
     // The collection of worker threads.
     ThreadVector threads_;
 
-    // A thread to run in the background.  Continually checks to see
-    // if there is work in the queue.  If it finds a task then do it,
-    // otherwise yield to the next thread.
-    void worker_thread();
+    // Place a task in the queue of the current worker thread, or in the next
+    // queue in round robin order if the caller is not a worker in this pool.
+    void push_task(MoveOnlyTaskWrapper &&task);
+
+    // Look for a task to run, first in the queue owned by 'queue_index'
+    // (which may be negative if the caller owns no queue), then in the other
+    // queues.  Returns true iff a task was placed in 'task'.
+    bool find_task(int queue_index, MoveOnlyTaskWrapper &task);
+
+    // The index of the queue owned by the calling thread, or -1 if the
+    // calling thread is not a worker in this pool.
+    int current_queue_index() const;
+
+    // Run 'task', then wake any threads blocked in wait().
+    void run_task(MoveOnlyTaskWrapper &task);
+
+    // Join all worker threads, leaving any unfinished work in the queues.
+    void stop_workers();
+
+    // Stop the current workers and restart the pool with the given number of
+    // threads, keeping any queued work.
+    void restart_workers(int number_of_threads);
+
+    // The main loop run by each worker thread.  Runs tasks from its own
+    // queue, or stolen from other queues, and sleeps when there is no work.
+    void worker_thread(int queue_index);
   };
 
 }  // namespace BOOM
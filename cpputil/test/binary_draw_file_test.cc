@@ -0,0 +1,131 @@
+#include "gtest/gtest.h"
+#include "cpputil/BinaryDrawFile.hpp"
+#include "Models/ParamTypes.hpp"
+#include "Models/SpdParams.hpp"
+#include "distributions.hpp"
+#include "test_utils/test_utils.hpp"
+#include <cstdio>
+
+namespace {
+  using namespace BOOM;
+  using std::endl;
+
+  class BinaryDrawFileTest : public ::testing::Test {
+   protected:
+    BinaryDrawFileTest() : filename_("binary_draw_file_test.draws") {
+      GlobalRng::rng.seed(8675309);
+    }
+    ~BinaryDrawFileTest() override { std::remove(filename_.c_str()); }
+    std::string filename_;
+  };
+
+  TEST_F(BinaryDrawFileTest, WriteAndRead) {
+    Matrix draws(23, 4);
+    draws.randomize();
+    {
+      // A block size that does not divide the number of draws leaves a
+      // short final block.
+      DrawFileWriter writer(filename_, {"sigma", "beta"}, {1, 3}, 5);
+      EXPECT_EQ(4, writer.total_dimension());
+      for (int i = 0; i < draws.nrow(); ++i) {
+        writer.write(draws.row(i));
+      }
+    }
+
+    DrawFileReader reader(filename_);
+    EXPECT_EQ(23, reader.number_of_draws());
+    EXPECT_EQ(2, reader.number_of_parameters());
+    EXPECT_EQ("beta", reader.name(1));
+    EXPECT_EQ(3, reader.dimension(1));
+    EXPECT_EQ(1, reader.offset(1));
+    EXPECT_EQ(1, reader.parameter_index("beta"));
+    EXPECT_EQ(-1, reader.parameter_index("gamma"));
+
+    for (int i = 0; i < draws.nrow(); ++i) {
+      EXPECT_TRUE(VectorEquals(draws.row(i), reader.draw(i)));
+    }
+    EXPECT_DOUBLE_EQ(draws(17, 2), reader.value(17, 2));
+    EXPECT_TRUE(VectorEquals(draws.col(3), reader.column(3)));
+    EXPECT_TRUE(MatrixEquals(SubMatrix(draws, 0, 22, 1, 3).to_matrix(),
+                             reader.parameter_draws(1)));
+  }
+
+  TEST_F(BinaryDrawFileTest, Append) {
+    Vector x(2);
+    {
+      DrawFileWriter writer(filename_, {"x"}, {2}, 3);
+      for (int i = 0; i < 4; ++i) {
+        x = double(i);
+        writer.write(x);
+      }
+    }
+    {
+      DrawFileWriter writer(filename_, {"x"}, {2}, 3, true);
+      x = 4.0;
+      writer.write(x);
+    }
+    DrawFileReader reader(filename_);
+    EXPECT_EQ(5, reader.number_of_draws());
+    EXPECT_TRUE(VectorEquals(reader.column(1), Vector{0, 1, 2, 3, 4}));
+
+    // Appending with a different header is an error.
+    EXPECT_THROW(DrawFileWriter(filename_, {"y"}, {2}, 3, true),
+                 std::exception);
+
+    // Without 'append' the file is replaced.
+    {
+      DrawFileWriter writer(filename_, {"y"}, {2}, 3);
+    }
+    DrawFileReader empty_reader(filename_);
+    EXPECT_EQ(0, empty_reader.number_of_draws());
+    EXPECT_EQ("y", empty_reader.name(0));
+  }
+
+  TEST_F(BinaryDrawFileTest, IoManager) {
+    NEW(UnivParams, sigsq)(1.0);
+    NEW(VectorParams, beta)(Vector{1.0, 2.0, 3.0});
+    NEW(SpdParams, Sigma)(SpdMatrix(2, 1.0));
+
+    BinaryParamIoManager io(filename_);
+    io.add_parameter(sigsq, "sigsq");
+    io.add_parameter(beta, "beta");
+    io.add_parameter(Sigma, "Sigma");
+    io.set_bufsize(4);
+    io.clear_files();
+
+    std::vector<Vector> history;
+    for (int i = 0; i < 10; ++i) {
+      sigsq->set(i + 1.0);
+      Vector b(3);
+      b.randomize();
+      beta->set(b);
+      history.push_back(b);
+      SpdMatrix S(2);
+      S.randomize();
+      Sigma->set(S);
+      io.write();
+    }
+    io.flush();
+
+    DrawFileReader reader(filename_);
+    EXPECT_EQ(10, reader.number_of_draws());
+    EXPECT_EQ(1 + 3 + 4, reader.total_dimension());
+
+    io.rewind();
+    for (int i = 0; i < 10; ++i) {
+      io.read_next_value();
+      EXPECT_DOUBLE_EQ(i + 1.0, sigsq->value());
+      EXPECT_TRUE(VectorEquals(history[i], beta->value()));
+    }
+    EXPECT_THROW(io.read_next_value(), std::exception);
+
+    io.read_last_line();
+    EXPECT_DOUBLE_EQ(10.0, sigsq->value());
+    // Output after read_last_line() is appended to the file.
+    io.write();
+    io.rewind();
+    for (int i = 0; i < 11; ++i) io.read_next_value();
+    EXPECT_DOUBLE_EQ(10.0, sigsq->value());
+  }
+
+}  // namespace
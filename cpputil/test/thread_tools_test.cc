@@ -0,0 +1,128 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include "cpputil/ThreadTools.hpp"
+
+#include "test_utils/test_utils.hpp"
+
+namespace {
+  using namespace BOOM;
+  using std::endl;
+
+  TEST(ThreadWorkerPool, submit_runs_every_task) {
+    ThreadWorkerPool pool(4);
+    std::atomic<int> counter(0);
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 1000; ++i) {
+      futures.emplace_back(pool.submit([&counter]() { ++counter; }));
+    }
+    for (int i = 0; i < futures.size(); ++i) {
+      futures[i].get();
+    }
+    EXPECT_EQ(1000, counter);
+  }
+
+  TEST(ThreadWorkerPool, parallel_for_covers_range) {
+    ThreadWorkerPool pool(3);
+    std::vector<int> visits(10007, 0);
+    pool.parallel_for(0, visits.size(), 100, [&visits](int begin, int end) {
+      for (int i = begin; i < end; ++i) {
+        ++visits[i];
+      }
+    });
+    for (int i = 0; i < visits.size(); ++i) {
+      EXPECT_EQ(1, visits[i]) << "index " << i;
+    }
+
+    // Default grain size.
+    std::atomic<long> total(0);
+    pool.parallel_for(0, 1000, 0, [&total](int begin, int end) {
+      for (int i = begin; i < end; ++i) total += i;
+    });
+    EXPECT_EQ(999 * 1000 / 2, total);
+  }
+
+  TEST(ThreadWorkerPool, parallel_for_without_threads) {
+    ThreadWorkerPool pool;
+    EXPECT_TRUE(pool.no_threads());
+    int total = 0;
+    pool.parallel_for(0, 100, 7, [&total](int begin, int end) {
+      for (int i = begin; i < end; ++i) total += i;
+    });
+    EXPECT_EQ(99 * 100 / 2, total);
+  }
+
+  TEST(ThreadWorkerPool, nested_parallel_for) {
+    // More outer tasks than threads, each of which blocks on inner tasks.
+    // This would deadlock if waiting threads did not help with the work.
+    ThreadWorkerPool pool(2);
+    std::atomic<int> counter(0);
+    pool.parallel_for(0, 16, 1, [&pool, &counter](int begin, int end) {
+      pool.parallel_for(0, 100, 10, [&counter](int lo, int hi) {
+        counter += hi - lo;
+      });
+    });
+    EXPECT_EQ(1600, counter);
+
+    std::future<void> outer = pool.submit([&pool, &counter]() {
+      std::future<void> inner = pool.submit([&counter]() { ++counter; });
+      pool.wait(inner);
+      inner.get();
+    });
+    pool.wait(outer);
+    outer.get();
+    EXPECT_EQ(1601, counter);
+  }
+
+  TEST(ThreadWorkerPool, exceptions_are_passed_to_caller) {
+    ThreadWorkerPool pool(2);
+    EXPECT_THROW(pool.parallel_for(0, 100, 10, [](int begin, int end) {
+                   if (begin == 50) throw std::runtime_error("oops");
+                 }),
+                 std::runtime_error);
+    std::future<void> future =
+        pool.submit([]() { throw std::runtime_error("oops"); });
+    EXPECT_THROW(future.get(), std::runtime_error);
+  }
+
+  TEST(ThreadWorkerPool, resizing_keeps_pending_work) {
+    ThreadWorkerPool pool;
+    std::atomic<int> counter(0);
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 50; ++i) {
+      futures.emplace_back(pool.submit([&counter]() { ++counter; }));
+    }
+    pool.set_number_of_threads(3);
+    EXPECT_EQ(3, pool.number_of_threads());
+    pool.add_threads(2);
+    EXPECT_EQ(5, pool.number_of_threads());
+    for (int i = 0; i < futures.size(); ++i) {
+      futures[i].get();
+    }
+    EXPECT_EQ(50, counter);
+    pool.set_number_of_threads(0);
+    EXPECT_TRUE(pool.no_threads());
+  }
+
+  TEST(ThreadWorkerPool, submit_while_resizing) {
+    ThreadWorkerPool pool(1);
+    std::atomic<int> counter(0);
+    std::vector<std::future<void>> futures;
+    std::thread resizer([&pool]() {
+      for (int n = 2; n <= 8; ++n) {
+        pool.set_number_of_threads(n);
+      }
+    });
+    for (int i = 0; i < 2000; ++i) {
+      futures.emplace_back(pool.submit([&counter]() { ++counter; }));
+    }
+    resizer.join();
+    for (int i = 0; i < futures.size(); ++i) {
+      pool.wait(futures[i]);
+    }
+    EXPECT_EQ(2000, counter);
+  }
+
+}  // namespace
@@ -207,6 +207,15 @@ namespace BOOM {
     return ans;
   }
 
+  // Fill v with independent draws from the given distribution.  These
+  // consume uniforms from rng in bulk, so they are much faster than calling
+  // runif_mt or rexp_mt once per element, but they produce a different
+  // sequence of draws than those functions would.
+  void fill_uniform(RNG &rng, VectorView v, double lo = 0.0, double hi = 1.0);
+  void fill_uniform(RNG &rng, Vector &v, double lo = 0.0, double hi = 1.0);
+  void fill_exponential(RNG &rng, VectorView v, double rate = 1.0);
+  void fill_exponential(RNG &rng, Vector &v, double rate = 1.0);
+
   //======================================================================
   // Several varieties of multivariate normal generation.
   //
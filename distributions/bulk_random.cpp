@@ -0,0 +1,68 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <algorithm>
+#include <cmath>
+#include "cpputil/report_error.hpp"
+#include "distributions.hpp"
+
+namespace BOOM {
+
+  namespace {
+    // The number of draws generated at a time.
+    const int kChunkSize = 256;
+  }  // namespace
+
+  void fill_uniform(RNG &rng, VectorView v, double lo, double hi) {
+    if (!(lo <= hi) || !std::isfinite(lo) || !std::isfinite(hi)) {
+      report_error("fill_uniform requires finite lo <= hi.");
+    }
+    double buffer[kChunkSize];
+    const double width = hi - lo;
+    for (int begin = 0; begin < v.size(); begin += kChunkSize) {
+      int size = std::min<int>(kChunkSize, v.size() - begin);
+      rng.fill_uniform(buffer, size);
+      for (int i = 0; i < size; ++i) {
+        v[begin + i] = lo + width * buffer[i];
+      }
+    }
+  }
+
+  void fill_exponential(RNG &rng, VectorView v, double rate) {
+    if (!(rate > 0) || !std::isfinite(rate)) {
+      report_error("fill_exponential requires a finite positive rate.");
+    }
+    double buffer[kChunkSize];
+    for (int begin = 0; begin < v.size(); begin += kChunkSize) {
+      int size = std::min<int>(kChunkSize, v.size() - begin);
+      rng.fill_uniform(buffer, size);
+      for (int i = 0; i < size; ++i) {
+        v[begin + i] = -std::log1p(-buffer[i]) / rate;
+      }
+    }
+  }
+
+  void fill_uniform(RNG &rng, Vector &v, double lo, double hi) {
+    fill_uniform(rng, VectorView(v), lo, hi);
+  }
+
+  void fill_exponential(RNG &rng, Vector &v, double rate) {
+    fill_exponential(rng, VectorView(v), rate);
+  }
+
+}  // namespace BOOM
@@ -18,29 +18,180 @@
 */
 
 #include "distributions/rng.hpp"
+#include <algorithm>
 #include <ctime>
+#include <random>
 #include "cpputil/math_utils.hpp"
+#include "cpputil/report_error.hpp"
 #include "distributions.hpp"
 
 namespace BOOM {
 
-  RNG::RNG()
-      : generator_(std::random_device()())
-  {}
+  namespace {
+    constexpr std::uint32_t kPhiloxM0 = 0xD2511F53;
+    constexpr std::uint32_t kPhiloxM1 = 0xCD9E8D57;
+    constexpr std::uint32_t kPhiloxW0 = 0x9E3779B9;
+    constexpr std::uint32_t kPhiloxW1 = 0xBB67AE85;
 
-  RNG::RNG(RngIntType seed)
-      : generator_(seed)
-  {}
+    inline void mulhilo(std::uint32_t a, std::uint32_t b, std::uint32_t *hi,
+                        std::uint32_t *lo) {
+      std::uint64_t product = static_cast<std::uint64_t>(a) * b;
+      *hi = static_cast<std::uint32_t>(product >> 32);
+      *lo = static_cast<std::uint32_t>(product);
+    }
+
+    // The splitmix64 finalizer, used to scatter stream ids.
+    inline std::uint64_t mix64(std::uint64_t x) {
+      x += 0x9E3779B97F4A7C15ULL;
+      x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+      return x ^ (x >> 31);
+    }
+
+    std::uint64_t random_device_seed() {
+      std::random_device device;
+      std::uint64_t high = device();
+      return (high << 32) | device();
+    }
+  }  // namespace
+
+  void PhiloxEngine::philox(const std::uint32_t counter[4],
+                            const std::uint32_t key[2],
+                            std::uint32_t output[4]) {
+    std::uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2],
+                  c3 = counter[3];
+    std::uint32_t k0 = key[0], k1 = key[1];
+    for (int round = 0; round < 10; ++round) {
+      std::uint32_t hi0, lo0, hi1, lo1;
+      mulhilo(kPhiloxM0, c0, &hi0, &lo0);
+      mulhilo(kPhiloxM1, c2, &hi1, &lo1);
+      c0 = hi1 ^ c1 ^ k0;
+      c1 = lo1;
+      c2 = hi0 ^ c3 ^ k1;
+      c3 = lo0;
+      k0 += kPhiloxW0;
+      k1 += kPhiloxW1;
+    }
+    output[0] = c0;
+    output[1] = c1;
+    output[2] = c2;
+    output[3] = c3;
+  }
+
+  void PhiloxEngine::generate_block(std::uint64_t key, std::uint64_t stream,
+                                    std::uint64_t block, result_type *output) {
+    const std::uint32_t counter[4] = {
+        static_cast<std::uint32_t>(block),
+        static_cast<std::uint32_t>(block >> 32),
+        static_cast<std::uint32_t>(stream),
+        static_cast<std::uint32_t>(stream >> 32)};
+    const std::uint32_t split_key[2] = {static_cast<std::uint32_t>(key),
+                                        static_cast<std::uint32_t>(key >> 32)};
+    std::uint32_t bits[4];
+    philox(counter, split_key, bits);
+    output[0] = (static_cast<std::uint64_t>(bits[1]) << 32) | bits[0];
+    output[1] = (static_cast<std::uint64_t>(bits[3]) << 32) | bits[2];
+  }
+
+  void PhiloxEngine::seed(std::uint64_t seed, std::uint64_t stream) {
+    key_ = seed;
+    stream_ = stream;
+    block_ = 0;
+    position_ = 2;
+  }
+
+  void PhiloxEngine::discard(std::uint64_t n) {
+    while (n > 0 && position_ < 2) {
+      ++position_;
+      --n;
+    }
+    block_ += n / 2;
+    if (n % 2 == 1) {
+      generate_block(key_, stream_, block_++, output_);
+      position_ = 1;
+    }
+  }
+
+  void PhiloxEngine::generate(result_type *output, std::size_t n) {
+    std::size_t i = 0;
+    while (i < n && position_ < 2) {
+      output[i++] = output_[position_++];
+    }
+    std::size_t number_of_blocks = (n - i) / 2;
+    for (std::size_t b = 0; b < number_of_blocks; ++b) {
+      generate_block(key_, stream_, block_ + b, output + i + 2 * b);
+    }
+    block_ += number_of_blocks;
+    i += 2 * number_of_blocks;
+    while (i < n) {
+      output[i++] = (*this)();
+    }
+  }
+
+  std::vector<std::uint64_t> PhiloxEngine::state() const {
+    return {key_, stream_, block_, static_cast<std::uint64_t>(position_)};
+  }
+
+  void PhiloxEngine::set_state(const std::vector<std::uint64_t> &state) {
+    if (state.size() != 4 || state[3] > 2 || (state[3] < 2 && state[2] == 0)) {
+      report_error("Invalid state passed to PhiloxEngine::set_state.");
+    }
+    key_ = state[0];
+    stream_ = state[1];
+    block_ = state[2];
+    position_ = state[3];
+    if (position_ < 2) {
+      generate_block(key_, stream_, block_ - 1, output_);
+    }
+  }
+
+  //======================================================================
+  RNG::RNG() : generator_(random_device_seed()), number_of_children_(0) {}
+
+  RNG::RNG(RngIntType seed) : generator_(seed), number_of_children_(0) {}
+
+  void RNG::seed() { seed(random_device_seed()); }
+
+  void RNG::fill_uniform(double *output, std::size_t n) {
+    const std::size_t chunk_size = 256;
+    std::uint64_t bits[chunk_size];
+    for (std::size_t begin = 0; begin < n; begin += chunk_size) {
+      std::size_t size = std::min(chunk_size, n - begin);
+      generator_.generate(bits, size);
+      for (std::size_t i = 0; i < size; ++i) {
+        output[begin + i] = to_unit_interval(bits[i]);
+      }
+    }
+  }
+
+  std::vector<std::uint64_t> RNG::state() const {
+    std::vector<std::uint64_t> ans = generator_.state();
+    ans.push_back(number_of_children_);
+    return ans;
+  }
+
+  void RNG::set_state(const std::vector<std::uint64_t> &state) {
+    if (state.size() != 5) {
+      report_error("Invalid state passed to RNG::set_state.");
+    }
+    generator_.set_state(
+        std::vector<std::uint64_t>(state.begin(), state.begin() + 4));
+    number_of_children_ = state[4];
+  }
 
-  void RNG::seed() {
-    generator_.seed(std::random_device()());
+  RNG RNG::split(std::uint64_t stream_id) const {
+    std::uint64_t child_stream =
+        mix64(generator_.stream() ^ mix64(stream_id + 1));
+    return RNG(Engine(generator_.key(), child_stream));
   }
 
   RNG::RngIntType seed_rng(RNG &rng) {
+    // Use the raw 64 bits from the engine.  Scaling a uniform deviate by the
+    // maximum integer and rounding with lround() overflows for deviates above
+    // 1/2, which mapped half of all seeds to the same value.
     RNG::RngIntType ans = 0;
     while (ans <= 2) {
-      double u = runif_mt(rng) * std::numeric_limits<RNG::RngIntType>::max();
-      ans = lround(u);
+      ans = rng.generator()();
     }
     return ans;
   }
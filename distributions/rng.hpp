@@ -20,14 +20,93 @@
 #ifndef BOOM_DISTRIBUTIONS_RNG_HPP
 #define BOOM_DISTRIBUTIONS_RNG_HPP
 
-#include <random>
+#include <cstddef>
 #include <cstdint>
+#include <random>
+#include <vector>
 
 namespace BOOM {
+
+  // A counter-based random bit generator implementing the Philox4x32-10
+  // algorithm from Salmon, Moraes, Dror, and Shaw (2011) "Parallel random
+  // numbers: as easy as 1, 2, 3".  The output is a keyed bijection of a 128
+  // bit counter, so the generator state is just (key, stream, block).  This
+  // makes it cheap to skip ahead, and to create any number of independent
+  // streams that share a key.
+  //
+  // The counter is split into a 64 bit block index and a 64 bit stream id.
+  // Each block produces two 64-bit outputs.  The class satisfies the
+  // requirements of a C++ UniformRandomBitGenerator, so it can be used with
+  // the distributions in <random>.
+  class PhiloxEngine {
+   public:
+    using result_type = std::uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type(0); }
+
+    explicit PhiloxEngine(std::uint64_t seed = 0, std::uint64_t stream = 0) {
+      this->seed(seed, stream);
+    }
+
+    // Reset the engine to the start of the given stream under the given key.
+    void seed(std::uint64_t seed, std::uint64_t stream = 0);
+
+    result_type operator()() {
+      if (position_ >= 2) {
+        generate_block(key_, stream_, block_++, output_);
+        position_ = 0;
+      }
+      return output_[position_++];
+    }
+
+    // Advance the engine as if operator() had been called n times.  This is
+    // a constant time operation.
+    void discard(std::uint64_t n);
+
+    // Fill the array 'output' with the next n outputs of the engine.  The
+    // result is the same as calling operator() n times, but full blocks are
+    // generated in a tight loop that the compiler can vectorize.
+    void generate(result_type *output, std::size_t n);
+
+    std::uint64_t key() const { return key_; }
+    std::uint64_t stream() const { return stream_; }
+
+    // The complete state of the engine: (key, stream, block, position).
+    // Passing the result to set_state() resumes the sequence exactly where
+    // it left off.  The buffered outputs are not part of the state because
+    // they can be regenerated from the previous block.
+    std::vector<std::uint64_t> state() const;
+    void set_state(const std::vector<std::uint64_t> &state);
+
+    // The Philox4x32-10 bijection.  Maps a counter to 128 random bits.
+    static void philox(const std::uint32_t counter[4],
+                       const std::uint32_t key[2], std::uint32_t output[4]);
+
+   private:
+    // Compute the two 64-bit outputs for the given counter.
+    static void generate_block(std::uint64_t key, std::uint64_t stream,
+                               std::uint64_t block, result_type *output);
+
+    std::uint64_t key_;
+    std::uint64_t stream_;
+    // The index of the next block to be generated.
+    std::uint64_t block_;
+    result_type output_[2];
+    // The position of the next unused element of output_.  2 means empty.
+    int position_;
+  };
+
   // A random number generator for simulating real valued U[0, 1) deviates.
+  //
+  // NOTE: Before the switch to PhiloxEngine the RNG was a std::mt19937_64.
+  // Every seeded sequence changed with the switch: an RNG (including
+  // GlobalRng::rng) seeded with a given value produces different draws than
+  // it did under the Mersenne twister, so simulations run with an earlier
+  // version of the library cannot be reproduced draw for draw.
   class RNG {
    public:
     using RngIntType = std::uint_fast64_t;
+    using Engine = PhiloxEngine;
 
     // Seed with std::random_device.
     RNG();
@@ -39,18 +118,56 @@ namespace BOOM {
     void seed();
 
     // Seed using a specified value.
-    void seed(RngIntType seed) {generator_.seed(seed);}
+    void seed(RngIntType seed) {
+      generator_.seed(seed);
+      number_of_children_ = 0;
+    }
 
     // Simulate a U[0, 1) random deviate.
-    double operator()() {return dist_(generator_);}
-
-    std::mt19937_64 & generator() {return generator_;}
+    double operator()() { return to_unit_interval(generator_()); }
+
+    // Fill the array 'output' with n U[0, 1) deviates.  The values are
+    // identical to n successive calls to operator().
+    void fill_uniform(double *output, std::size_t n);
+
+    // Advance the stream as if operator() had been called n times.  This
+    // takes constant time.
+    void jump(std::uint64_t n) { generator_.discard(n); }
+
+    // Return an RNG that produces a stream independent of this one, and of
+    // any other stream split from this one with a different stream_id.
+    // Splitting does not change the state of this RNG, and the same
+    // (RNG, stream_id) pair always produces the same child, so a collection
+    // of threads, chains, or time series can each be given a reproducible
+    // stream by splitting a common parent on the index of the thread, chain,
+    // or series.
+    RNG split(std::uint64_t stream_id) const;
+
+    // Return split(k), where k is the number of times spawn() has previously
+    // been called on this RNG (since it was last seeded).  This is a
+    // replacement for seeding a child RNG with seed_rng(*this) that does not
+    // consume any draws from this RNG.
+    RNG spawn() { return split(number_of_children_++); }
+
+    Engine &generator() { return generator_; }
+
+    // The complete state of the RNG, suitable for checkpointing a long
+    // simulation.  An RNG restored with set_state() produces exactly the
+    // same sequence of draws (and children) as the RNG that was saved.
+    std::vector<std::uint64_t> state() const;
+    void set_state(const std::vector<std::uint64_t> &state);
 
    private:
-    // TODO(steve): once you can use c++17 in R and elsewhere replace this with
-    // a std::variant that will choose the fastest RNG for each implementation.
-    std::mt19937_64 generator_;
-    std::uniform_real_distribution<double> dist_;
+    explicit RNG(const Engine &engine)
+        : generator_(engine), number_of_children_(0) {}
+
+    // Convert 64 random bits to a U[0, 1) deviate using the 53 high bits.
+    static double to_unit_interval(std::uint64_t bits) {
+      return (bits >> 11) * (1.0 / 9007199254740992.0);  // 2^-53
+    }
+
+    Engine generator_;
+    std::uint64_t number_of_children_;
   };
 
   // The GlobalRng is a singleton.
@@ -0,0 +1,139 @@
+#include "gtest/gtest.h"
+#include "distributions.hpp"
+#include "distributions/rng.hpp"
+#include "LinAlg/Matrix.hpp"
+#include "LinAlg/Vector.hpp"
+#include "LinAlg/VectorView.hpp"
+#include "stats/moments.hpp"
+#include "test_utils/test_utils.hpp"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+  using namespace BOOM;
+  using std::endl;
+
+  // Known answer tests from the Random123 distribution.
+  TEST(PhiloxTest, KnownAnswers) {
+    std::uint32_t zero_counter[4] = {0, 0, 0, 0};
+    std::uint32_t zero_key[2] = {0, 0};
+    std::uint32_t output[4];
+    PhiloxEngine::philox(zero_counter, zero_key, output);
+    EXPECT_EQ(output[0], 0x6627e8d5u);
+    EXPECT_EQ(output[1], 0xe169c58du);
+    EXPECT_EQ(output[2], 0xbc57ac4cu);
+    EXPECT_EQ(output[3], 0x9b00dbd8u);
+
+    std::uint32_t pi_counter[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e,
+                                   0x03707344};
+    std::uint32_t pi_key[2] = {0xa4093822, 0x299f31d0};
+    PhiloxEngine::philox(pi_counter, pi_key, output);
+    EXPECT_EQ(output[0], 0xd16cfe09u);
+    EXPECT_EQ(output[1], 0x94fdccebu);
+    EXPECT_EQ(output[2], 0x5001e420u);
+    EXPECT_EQ(output[3], 0x24126ea1u);
+  }
+
+  TEST(RngTest, JumpMatchesSequentialDraws) {
+    for (int skip : {0, 1, 2, 3, 10, 11}) {
+      RNG sequential(12345);
+      RNG jumped(12345);
+      for (int i = 0; i < skip; ++i) sequential();
+      jumped.jump(skip);
+      for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(sequential(), jumped()) << "skip = " << skip;
+      }
+    }
+    // Jumping from the middle of a block.
+    RNG sequential(8);
+    RNG jumped(8);
+    sequential();
+    jumped();
+    for (int i = 0; i < 7; ++i) sequential();
+    jumped.jump(7);
+    EXPECT_EQ(sequential(), jumped());
+  }
+
+  TEST(RngTest, FillUniformMatchesSequentialDraws) {
+    RNG sequential(17);
+    RNG bulk(17);
+    // Leave the bulk generator partway through a block.
+    EXPECT_EQ(sequential(), bulk());
+    std::vector<double> draws(1001);
+    bulk.fill_uniform(draws.data(), draws.size());
+    for (double draw : draws) {
+      EXPECT_EQ(draw, sequential());
+      EXPECT_GE(draw, 0.0);
+      EXPECT_LT(draw, 1.0);
+    }
+    EXPECT_EQ(sequential(), bulk());
+  }
+
+  TEST(RngTest, SplitIsReproducibleAndIndependent) {
+    RNG parent(99);
+    RNG child1 = parent.split(1);
+    RNG child1_again = parent.split(1);
+    RNG child2 = parent.split(2);
+    RNG parent_copy(99);
+    bool all_equal_to_sibling = true;
+    for (int i = 0; i < 10; ++i) {
+      double u = child1();
+      EXPECT_EQ(u, child1_again());
+      if (u != child2()) all_equal_to_sibling = false;
+      // Splitting does not disturb the parent.
+      EXPECT_EQ(parent(), parent_copy());
+    }
+    EXPECT_FALSE(all_equal_to_sibling);
+
+    // spawn() hands out split(0), split(1), ...
+    RNG spawner(99);
+    RNG spawned0 = spawner.spawn();
+    RNG spawned1 = spawner.spawn();
+    RNG split0 = RNG(99).split(0);
+    EXPECT_EQ(spawned0(), split0());
+    EXPECT_EQ(spawned1(), RNG(99).split(1)());
+  }
+
+  TEST(RngTest, WorksWithStandardDistributions) {
+    RNG rng(3);
+    std::poisson_distribution<int> poisson(4.0);
+    double total = 0;
+    int n = 10000;
+    for (int i = 0; i < n; ++i) total += poisson(rng.generator());
+    EXPECT_NEAR(total / n, 4.0, .1);
+  }
+
+  TEST(BulkRandomTest, Moments) {
+    RNG rng(31);
+    Vector draws(100001);
+    fill_uniform(rng, draws, 2.0, 5.0);
+    EXPECT_NEAR(mean(draws), 3.5, .02);
+    EXPECT_NEAR(var(draws), 9.0 / 12, .02);
+    EXPECT_GE(draws.min(), 2.0);
+    EXPECT_LT(draws.max(), 5.0);
+
+    fill_exponential(rng, draws, 2.0);
+    EXPECT_NEAR(mean(draws), 0.5, .01);
+    EXPECT_GE(draws.min(), 0.0);
+    EXPECT_TRUE(DistributionsMatch(draws, [](double x) {
+      return pexp(x, 2.0);
+    }));
+
+    // Strided views are filled in place.
+    Matrix m(3, 4, 0.0);
+    fill_exponential(rng, m.row(1));
+    EXPECT_DOUBLE_EQ(0.0, m.row(0).abs_norm());
+    EXPECT_DOUBLE_EQ(0.0, m.row(2).abs_norm());
+    EXPECT_GT(m.row(1).abs_norm(), 0.0);
+  }
+
+  TEST(BulkRandomTest, Reproducible) {
+    RNG rng1(5), rng2(5);
+    Vector v1(37), v2(37);
+    fill_exponential(rng1, v1);
+    fill_exponential(rng2, v2);
+    EXPECT_TRUE(VectorEquals(v1, v2));
+  }
+
+}  // namespace
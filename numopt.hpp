@@ -55,6 +55,9 @@ namespace BOOM{
   //    in the optimization.
   //  * Both: Try conjugate gradient first, and then transition to
   //    BFGS.
+  //  * LBFGS: Limited memory BFGS, which approximates the Hessian using
+  //    the most recent few gradient changes instead of storing it.  Use
+  //    this for problems with too many parameters for a dense Hessian.
   //
   // Conjugate gradient is more stable far from the mode, but requires
   // more function evaluations.  BFGS can be unstable far from the
@@ -62,7 +65,8 @@ namespace BOOM{
   enum OptimizationMethod {
     BFGS,
     ConjugateGradient,
-    Both
+    Both,
+    LBFGS
   };
 
   // Optimize a function for which no derivative information is
@@ -222,6 +226,43 @@ namespace BOOM{
               bool &fail,
               int trace_freq= -1);
 
+  // Minimize a function using the limited memory BFGS algorithm, with a
+  // line search satisfying the strong Wolfe conditions.  Only the most
+  // recent 'history_size' steps are used to approximate the inverse
+  // Hessian, so memory use is O(history_size * x.size()).  This makes
+  // it suitable for problems with many thousands of parameters.
+  //
+  // Args:
+  //   x: On input x is the initial set of function arguments of the
+  //     algorithm.  On output it is the minimizing value.
+  //   function_value: On output, the value of target at the minimizing x.
+  //   target: The function to be minimized, with gradient.
+  //   max_iterations:  The maximum number of iterations allowed.
+  //   absolute_tolerance: Convergence is declared if no element of the
+  //     gradient exceeds this value in absolute value.
+  //   relative_tolerance: Convergence is declared if the relative change
+  //     in function value between iterations is less than this value.
+  //   fncount: On output this is filled with the number of function
+  //     (and gradient) evaluations that were made.
+  //   error_message: Empty on success.  Otherwise describes the reason
+  //     for failure.
+  //   history_size: The number of position and gradient differences
+  //     used to approximate the inverse Hessian.
+  //
+  // Returns:
+  //   A return value of true indicates success.  A return value of
+  //   false indicates an error, which will be explained in
+  //   error_message.
+  bool lbfgs(Vector &x,
+             double &function_value,
+             const dTarget &target,
+             int max_iterations,
+             double absolute_tolerance,
+             double relative_tolerance,
+             int &fncount,
+             std::string &error_message,
+             int history_size = 10);
+
   // Minimize the function f using the conjugate gradient algorithm.
   // Args:
 
@@ -0,0 +1,327 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+#include "LinAlg/Vector.hpp"
+#include "cpputil/math_utils.hpp"
+#include "cpputil/report_error.hpp"
+#include "numopt.hpp"
+
+namespace BOOM {
+
+  namespace {
+    // Constants for the strong Wolfe conditions.  The sufficient decrease
+    // constant c1 and the curvature constant c2 are the values recommended
+    // by Nocedal and Wright (2006) for quasi-Newton methods.
+    const double kSufficientDecrease = 1e-4;
+    const double kCurvature = 0.9;
+    const int kMaxLineSearchSteps = 40;
+
+    // A trial point along the search direction.
+    struct LineSearchPoint {
+      explicit LineSearchPoint(int dim)
+          : step(0), value(0), derivative(0), x(dim), gradient(dim) {}
+      double step;
+      double value;
+      // Directional derivative: gradient.dot(direction).
+      double derivative;
+      Vector x;
+      Vector gradient;
+    };
+
+    // The minimizer of the cubic interpolating the values and directional
+    // derivatives at two points, safeguarded to stay well inside the
+    // interval between them.  Falls back to bisection if the cubic is not
+    // well defined.
+    double interpolate_step(const LineSearchPoint &lo,
+                            const LineSearchPoint &hi) {
+      double width = hi.step - lo.step;
+      double bisection = lo.step + .5 * width;
+      if (!std::isfinite(hi.value) || !std::isfinite(hi.derivative)) {
+        return bisection;
+      }
+      double d1 = lo.derivative + hi.derivative -
+                  3 * (lo.value - hi.value) / (lo.step - hi.step);
+      double discriminant = d1 * d1 - lo.derivative * hi.derivative;
+      if (discriminant < 0) return bisection;
+      double d2 = (width > 0 ? 1 : -1) * sqrt(discriminant);
+      double denominator = hi.derivative - lo.derivative + 2 * d2;
+      if (denominator == 0) return bisection;
+      double step =
+          hi.step - width * (hi.derivative + d2 - d1) / denominator;
+      double margin = .1 * fabs(width);
+      double left = std::min(lo.step, hi.step) + margin;
+      double right = std::max(lo.step, hi.step) - margin;
+      if (!std::isfinite(step) || step < left || step > right) {
+        return bisection;
+      }
+      return step;
+    }
+
+    // A line search satisfying the strong Wolfe conditions (Nocedal and
+    // Wright 2006, algorithms 3.5 and 3.6).  Non-finite function values
+    // are treated as failures of the sufficient decrease condition, so
+    // the search backs away from regions where the target is undefined.
+    class StrongWolfeLineSearch {
+     public:
+      StrongWolfeLineSearch(const dTarget &target, const Vector &x,
+                            double value, double derivative,
+                            const Vector &direction, int &fncount)
+          : target_(target),
+            x_(x),
+            value_(value),
+            derivative_(derivative),
+            direction_(direction),
+            fncount_(fncount),
+            trial_(x.size()),
+            lo_(x.size()),
+            hi_(x.size()) {}
+
+      // Search for a step satisfying the strong Wolfe conditions, starting
+      // from 'initial_step'.  Returns true on success, in which case
+      // result() is the accepted point.  If no such step is found, but a
+      // step giving sufficient decrease is, that step is accepted.
+      bool search(double initial_step) {
+        // lo_ holds the previous trial point, starting from x itself.
+        lo_.step = 0;
+        lo_.value = value_;
+        lo_.derivative = derivative_;
+        double step = initial_step;
+        for (int i = 0; i < kMaxLineSearchSteps; ++i) {
+          evaluate(step, trial_);
+          if (!sufficient_decrease(trial_) ||
+              (i > 0 && trial_.value >= lo_.value)) {
+            std::swap(hi_, trial_);
+            return zoom();
+          }
+          if (curvature_ok(trial_)) {
+            result_ = &trial_;
+            return true;
+          }
+          if (trial_.derivative >= 0) {
+            std::swap(hi_, lo_);
+            std::swap(lo_, trial_);
+            return zoom();
+          }
+          std::swap(lo_, trial_);
+          step *= 2;
+        }
+        return accept_lo();
+      }
+
+      const LineSearchPoint &result() const { return *result_; }
+
+     private:
+      void evaluate(double step, LineSearchPoint &point) {
+        point.step = step;
+        point.x = x_;
+        point.x.axpy(direction_, step);
+        point.value = target_(point.x, point.gradient);
+        ++fncount_;
+        point.derivative = std::isfinite(point.value)
+                               ? point.gradient.dot(direction_)
+                               : infinity();
+      }
+
+      bool sufficient_decrease(const LineSearchPoint &point) const {
+        return std::isfinite(point.value) &&
+               point.value <=
+                   value_ + kSufficientDecrease * point.step * derivative_;
+      }
+
+      bool curvature_ok(const LineSearchPoint &point) const {
+        return fabs(point.derivative) <= -kCurvature * derivative_;
+      }
+
+      // On entry lo_ satisfies sufficient decrease and has the smallest
+      // value seen so far.  hi_ is the other end of an interval known to
+      // contain an acceptable step.
+      bool zoom() {
+        for (int i = 0; i < kMaxLineSearchSteps; ++i) {
+          if (fabs(hi_.step - lo_.step) <=
+              std::numeric_limits<double>::epsilon() *
+                  std::max(fabs(hi_.step), fabs(lo_.step))) {
+            break;
+          }
+          evaluate(interpolate_step(lo_, hi_), trial_);
+          if (!sufficient_decrease(trial_) || trial_.value >= lo_.value) {
+            std::swap(hi_, trial_);
+          } else {
+            if (curvature_ok(trial_)) {
+              result_ = &trial_;
+              return true;
+            }
+            if (trial_.derivative * (hi_.step - lo_.step) >= 0) {
+              std::swap(hi_, lo_);
+            }
+            std::swap(lo_, trial_);
+          }
+        }
+        return accept_lo();
+      }
+
+      bool accept_lo() {
+        if (lo_.step > 0) {
+          result_ = &lo_;
+          return true;
+        }
+        return false;
+      }
+
+      const dTarget &target_;
+      const Vector &x_;
+      double value_;
+      double derivative_;
+      const Vector &direction_;
+      int &fncount_;
+
+      LineSearchPoint trial_;
+      LineSearchPoint lo_;
+      LineSearchPoint hi_;
+      const LineSearchPoint *result_ = nullptr;
+    };
+  }  // namespace
+
+  bool lbfgs(Vector &x, double &function_value, const dTarget &target,
+             int max_iterations, double absolute_tolerance,
+             double relative_tolerance, int &fncount,
+             std::string &error_message, int history_size) {
+    error_message = "";
+    fncount = 0;
+    if (history_size <= 0) {
+      report_error("lbfgs needs a positive history_size.");
+    }
+    const int dim = x.size();
+    Vector gradient(dim);
+    function_value = target(x, gradient);
+    ++fncount;
+    if (!std::isfinite(function_value)) {
+      std::ostringstream err;
+      err << "Initial value in lbfgs is not finite." << std::endl
+          << "Initial x = " << x << std::endl;
+      error_message = err.str();
+      return false;
+    }
+    if (max_iterations <= 0) {
+      error_message = "The maximum number of iterations was not positive.";
+      return false;
+    }
+
+    // The most recent 'history_size' position and gradient differences,
+    // stored in a circular buffer.  The buffer is allocated once, so memory
+    // use is O(history_size * dim) no matter how many iterations are run.
+    std::vector<Vector> position_change(history_size, Vector(dim));
+    std::vector<Vector> gradient_change(history_size, Vector(dim));
+    std::vector<double> rho(history_size);
+    std::vector<double> alpha(history_size);
+    int history_length = 0;
+    int newest = -1;
+
+    Vector direction(dim);
+    Vector s(dim);
+    Vector y(dim);
+    for (int iteration = 0; iteration < max_iterations; ++iteration) {
+      if (gradient.max_abs() <= absolute_tolerance) {
+        return true;
+      }
+
+      // The two-loop recursion computes direction = -H * gradient, where H
+      // is the implicit inverse Hessian approximation.
+      direction = gradient;
+      for (int i = 0; i < history_length; ++i) {
+        int k = (newest - i + history_size) % history_size;
+        alpha[k] = rho[k] * position_change[k].dot(direction);
+        direction.axpy(gradient_change[k], -alpha[k]);
+      }
+      if (history_length > 0) {
+        // Scale the initial inverse Hessian by s'y / y'y for the newest
+        // pair, so the first trial step is usually accepted.
+        const Vector &latest(gradient_change[newest]);
+        direction *= 1.0 / (rho[newest] * latest.dot(latest));
+      }
+      for (int i = history_length - 1; i >= 0; --i) {
+        int k = (newest - i + history_size) % history_size;
+        double beta = rho[k] * gradient_change[k].dot(direction);
+        direction.axpy(position_change[k], alpha[k] - beta);
+      }
+      direction *= -1;
+
+      double derivative = direction.dot(gradient);
+      if (!(derivative < 0)) {
+        // The approximation has lost positive definiteness (e.g. through
+        // round off).  Start over from steepest descent.
+        history_length = 0;
+        direction = gradient;
+        direction *= -1;
+        derivative = -gradient.dot(gradient);
+      }
+
+      // Without curvature information the first step is scaled so that it
+      // moves x a unit distance.
+      double initial_step =
+          history_length > 0 ? 1.0 : std::min(1.0, 1.0 / gradient.max_abs());
+      StrongWolfeLineSearch line_search(target, x, function_value, derivative,
+                                        direction, fncount);
+      if (!line_search.search(initial_step)) {
+        if (history_length > 0) {
+          // Retry from steepest descent before giving up.
+          history_length = 0;
+          continue;
+        }
+        error_message = "The lbfgs line search failed to find a step that "
+                        "decreases the function.";
+        return false;
+      }
+      const LineSearchPoint &next(line_search.result());
+
+      s = next.x;
+      s -= x;
+      y = next.gradient;
+      y -= gradient;
+      double sy = s.dot(y);
+
+      double old_value = function_value;
+      x = next.x;
+      gradient = next.gradient;
+      function_value = next.value;
+
+      // Pairs without usable curvature information are skipped, which
+      // keeps the implicit inverse Hessian positive definite.
+      if (sy > std::numeric_limits<double>::epsilon() * y.dot(y)) {
+        newest = (newest + 1) % history_size;
+        std::swap(position_change[newest], s);
+        std::swap(gradient_change[newest], y);
+        rho[newest] = 1.0 / sy;
+        history_length = std::min(history_length + 1, history_size);
+      }
+
+      if (fabs(old_value - function_value) <=
+          relative_tolerance * (fabs(old_value) + relative_tolerance)) {
+        return true;
+      }
+    }
+    error_message = "lbfgs exceeded the maximum number of iterations.";
+    return false;
+  }
+
+}  // namespace BOOM
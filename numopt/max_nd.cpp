@@ -88,12 +88,24 @@ namespace BOOM {
         }
         break;
       }
+
+      case LBFGS: {
+        fail = !lbfgs(x, function_value, negative_f, max_iterations, epsilon,
+                      epsilon, fcount, error_message);
+        if (!std::isfinite(function_value) || !x.all_finite()) {
+          x = original_x;
+        }
+        break;
+      }
+
       default:
         error_message = "Unknown optimization method.";
         return false;
     }  // switch method
 
-    while (fail && ntries < maxntries) {
+    // The Nelder-Mead restarts store a simplex with x.size() + 1 vertices,
+    // which would defeat the purpose of LBFGS's bounded memory.
+    while (fail && ntries < maxntries && method != LBFGS) {
       Vector g = x;
       nelder_mead_driver(x, g, Target(negative_f), 1e-5, 1e-5, 1.0, .5, 2.0,
                          fcount, 1000);
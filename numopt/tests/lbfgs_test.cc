@@ -0,0 +1,159 @@
+#include "gtest/gtest.h"
+#include "LinAlg/SpdMatrix.hpp"
+#include "LinAlg/Vector.hpp"
+#include "numopt.hpp"
+#include "distributions.hpp"
+
+#include "test_utils/test_utils.hpp"
+#include <cmath>
+#include <limits>
+
+namespace {
+  using namespace BOOM;
+  using std::endl;
+
+  class LbfgsTest : public ::testing::Test {
+   protected:
+    LbfgsTest() {
+      GlobalRng::rng.seed(8675309);
+    }
+  };
+
+  // The extended Rosenbrock function, with its minimum of 0 at (1, ..., 1).
+  double rosenbrock(const Vector &x, Vector &gradient) {
+    double ans = 0;
+    gradient.resize(x.size());
+    gradient = 0.0;
+    for (int i = 0; i + 1 < x.size(); i += 2) {
+      double a = x[i + 1] - x[i] * x[i];
+      double b = 1 - x[i];
+      ans += 100 * a * a + b * b;
+      gradient[i] += -400 * x[i] * a - 2 * b;
+      gradient[i + 1] += 200 * a;
+    }
+    return ans;
+  }
+
+  TEST_F(LbfgsTest, Quadratic) {
+    int dim = 20;
+    SpdMatrix A(dim);
+    A.randomize();
+    A.diag() += dim;
+    Vector b(dim);
+    b.randomize();
+    // f(x) = .5 * x'Ax - b'x is minimized at A^{-1} b.
+    auto target = [&A, &b](const Vector &x, Vector &gradient) {
+      gradient = A * x - b;
+      return .5 * A.Mdist(x) - b.dot(x);
+    };
+    Vector x(dim, 0.0);
+    double value = 0;
+    int fncount = 0;
+    std::string error_message;
+    EXPECT_TRUE(lbfgs(x, value, target, 500, 1e-10, 1e-14, fncount,
+                      error_message))
+        << error_message;
+    EXPECT_TRUE(error_message.empty());
+    Vector solution = A.solve(b);
+    EXPECT_TRUE(VectorEquals(x, solution, 1e-6))
+        << "x = " << x << endl << "solution = " << solution;
+    EXPECT_NEAR(-.5 * b.dot(solution), value, 1e-8);
+    EXPECT_GT(fncount, 0);
+  }
+
+  TEST_F(LbfgsTest, Rosenbrock) {
+    int dim = 100;
+    Vector x(dim, -1.2);
+    for (int i = 1; i < dim; i += 2) x[i] = 1.0;
+    double value = 0;
+    int fncount = 0;
+    std::string error_message;
+    EXPECT_TRUE(lbfgs(x, value, rosenbrock, 2000, 1e-8, 1e-16, fncount,
+                      error_message))
+        << error_message;
+    EXPECT_TRUE(VectorEquals(x, Vector(dim, 1.0), 1e-4)) << x;
+    EXPECT_NEAR(0.0, value, 1e-8);
+
+    // A small history still converges.
+    x = Vector(dim, -1.2);
+    EXPECT_TRUE(lbfgs(x, value, rosenbrock, 5000, 1e-8, 1e-16, fncount,
+                      error_message, 3))
+        << error_message;
+    EXPECT_TRUE(VectorEquals(x, Vector(dim, 1.0), 1e-4)) << x;
+  }
+
+  // Running out of iterations leaves x at the best point found so far.
+  TEST_F(LbfgsTest, MaxIterationsKeepsBestPoint) {
+    Vector x = {-1.2, 1.0};
+    Vector gradient;
+    double initial_value = rosenbrock(x, gradient);
+    double value = 0;
+    int fncount = 0;
+    std::string error_message;
+    EXPECT_FALSE(lbfgs(x, value, rosenbrock, 3, 1e-10, 1e-16, fncount,
+                       error_message));
+    EXPECT_FALSE(error_message.empty());
+    EXPECT_LT(value, initial_value);
+    EXPECT_DOUBLE_EQ(value, rosenbrock(x, gradient));
+  }
+
+  TEST_F(LbfgsTest, NonFiniteTarget) {
+    // A target that is not finite at the starting value is an error.
+    auto infinite = [](const Vector &x, Vector &gradient) {
+      gradient = x;
+      return std::numeric_limits<double>::infinity();
+    };
+    Vector x = {1.0, 2.0};
+    double value = 0;
+    int fncount = 0;
+    std::string error_message;
+    EXPECT_FALSE(lbfgs(x, value, infinite, 100, 1e-8, 1e-12, fncount,
+                       error_message));
+    EXPECT_FALSE(error_message.empty());
+    EXPECT_EQ(Vector({1.0, 2.0}), x);
+
+    // A target that is only finite inside a region: the line search backs
+    // away from the points outside it.  The minimum of (x - 3)^2 subject
+    // to x < 2 is at the boundary.
+    auto bounded = [](const Vector &x, Vector &gradient) {
+      gradient.resize(1);
+      if (x[0] >= 2) {
+        gradient[0] = std::numeric_limits<double>::quiet_NaN();
+        return std::numeric_limits<double>::infinity();
+      }
+      gradient[0] = 2 * (x[0] - 3) + 1.0 / (2 - x[0]);
+      return (x[0] - 3) * (x[0] - 3) - log(2 - x[0]);
+    };
+    x = Vector(1, 0.0);
+    EXPECT_TRUE(lbfgs(x, value, bounded, 200, 1e-8, 1e-14, fncount,
+                      error_message))
+        << error_message;
+    EXPECT_LT(x[0], 2.0);
+    EXPECT_TRUE(std::isfinite(value));
+    // The minimizer solves 2(3 - x)(2 - x) = 1.
+    double expected = 2.5 - sqrt(0.25 + 0.5);
+    EXPECT_NEAR(expected, x[0], 1e-5);
+  }
+
+  // max_nd1_careful maximizes, and dispatches to lbfgs when asked.
+  TEST_F(LbfgsTest, MaxNd1Careful) {
+    Target target = [](const Vector &x) {
+      Vector gradient;
+      return -rosenbrock(x, gradient);
+    };
+    dTarget dtarget = [](const Vector &x, Vector &gradient) {
+      double ans = -rosenbrock(x, gradient);
+      gradient *= -1;
+      return ans;
+    };
+    Vector x = {-1.2, 1.0, -1.2, 1.0};
+    double value = 0;
+    std::string error_message;
+    EXPECT_TRUE(max_nd1_careful(x, value, target, dtarget, error_message,
+                                1e-10, 1000, LBFGS))
+        << error_message;
+    EXPECT_TRUE(VectorEquals(x, Vector(4, 1.0), 1e-4)) << x;
+    EXPECT_NEAR(0.0, value, 1e-8);
+  }
+
+}  // namespace
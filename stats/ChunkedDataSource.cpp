@@ -0,0 +1,201 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include "stats/ChunkedDataSource.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+
+#include "cpputil/DefaultVnames.hpp"
+#include "cpputil/report_error.hpp"
+#include "cpputil/string_utils.hpp"
+
+namespace BOOM {
+
+  namespace {
+    // Convert a field from a text file to a number.  Returns true on
+    // success and false if the field is not numeric.  Missing value codes
+    // are converted to NaN.
+    bool parse_field(const std::string &field, double &value) {
+      const char *begin = field.c_str();
+      const char *end = begin + field.size();
+      while (begin < end && std::isspace(static_cast<unsigned char>(*begin))) {
+        ++begin;
+      }
+      while (end > begin &&
+             std::isspace(static_cast<unsigned char>(end[-1]))) {
+        --end;
+      }
+      std::string trimmed(begin, end);
+      if (trimmed.empty() || trimmed == "NA" || trimmed == "NaN" ||
+          trimmed == ".") {
+        value = std::numeric_limits<double>::quiet_NaN();
+        return true;
+      }
+      char *stop = nullptr;
+      value = std::strtod(trimmed.c_str(), &stop);
+      return stop == trimmed.c_str() + trimmed.size();
+    }
+  }  // namespace
+
+  //===========================================================================
+  // The raw lines of a chunk of a text file.  Splitting and number
+  // conversion are deferred to parse().  Refers to the reader's file name
+  // and splitter, so it must not outlive the reader.
+  class CsvChunkReader::TextChunk : public ChunkedDataSource::Chunk {
+   public:
+    TextChunk(const std::string &filename, const StringSplitter &split,
+              int ncol)
+        : filename_(filename), split_(split), ncol_(ncol) {}
+
+    int nrow() const override { return lines_.size(); }
+
+    void parse(Matrix &rows) const override {
+      rows.resize(lines_.size(), ncol_);
+      for (int i = 0; i < lines_.size(); ++i) {
+        std::vector<std::string> fields = split_(lines_[i]);
+        if (fields.size() != ncol_) {
+          std::ostringstream err;
+          err << "Line " << line_numbers_[i] << " of " << filename_
+              << " has " << fields.size() << " fields.  Expected " << ncol_
+              << ".";
+          report_error(err.str());
+        }
+        for (int j = 0; j < ncol_; ++j) {
+          if (!parse_field(fields[j], rows(i, j))) {
+            std::ostringstream err;
+            err << "Field " << j + 1 << " on line " << line_numbers_[i]
+                << " of " << filename_ << " is not numeric: '" << fields[j]
+                << "'.";
+            report_error(err.str());
+          }
+        }
+      }
+    }
+
+    void add_line(std::string &line, long line_number) {
+      lines_.emplace_back();
+      lines_.back().swap(line);
+      line_numbers_.push_back(line_number);
+    }
+
+   private:
+    const std::string &filename_;
+    const StringSplitter &split_;
+    int ncol_;
+    std::vector<std::string> lines_;
+    std::vector<long> line_numbers_;
+  };
+
+  CsvChunkReader::CsvChunkReader(const std::string &filename, bool header,
+                                 const std::string &sep, int chunk_size)
+      : filename_(filename),
+        input_(filename.c_str()),
+        split_(sep),
+        chunk_size_(chunk_size),
+        ncol_(0),
+        line_number_(0),
+        has_pending_line_(false) {
+    if (!input_) {
+      report_error("Could not open " + filename + " for reading.");
+    }
+    if (chunk_size_ <= 0) {
+      report_error("chunk_size must be positive.");
+    }
+    std::string line;
+    if (header) {
+      if (!next_line(line)) {
+        report_error(filename + " is empty.");
+      }
+      variable_names_ = split_(line);
+      ncol_ = variable_names_.size();
+    }
+    has_pending_line_ = next_line(pending_line_);
+    if (!header) {
+      if (!has_pending_line_) {
+        report_error(filename + " is empty.");
+      }
+      ncol_ = split_(pending_line_).size();
+      variable_names_ = default_vnames(ncol_);
+    }
+  }
+
+  bool CsvChunkReader::next_line(std::string &line) {
+    while (std::getline(input_, line)) {
+      ++line_number_;
+      if (!line.empty() && line.back() == '\r') line.pop_back();
+      if (!is_all_white(line)) return true;
+    }
+    return false;
+  }
+
+  std::unique_ptr<ChunkedDataSource::Chunk> CsvChunkReader::next_chunk() {
+    std::unique_ptr<TextChunk> chunk(
+        new TextChunk(filename_, split_, ncol_));
+    if (has_pending_line_) {
+      chunk->add_line(pending_line_, line_number_);
+      has_pending_line_ = false;
+    }
+    std::string line;
+    while (chunk->nrow() < chunk_size_ && next_line(line)) {
+      chunk->add_line(line, line_number_);
+    }
+    if (chunk->nrow() == 0) return nullptr;
+    return chunk;
+  }
+
+  //===========================================================================
+  class DrawFileChunkReader::DrawChunk : public ChunkedDataSource::Chunk {
+   public:
+    DrawChunk(const DrawFileReader &reader, int begin, int end)
+        : reader_(reader), begin_(begin), end_(end) {}
+
+    int nrow() const override { return end_ - begin_; }
+
+    void parse(Matrix &rows) const override {
+      rows.resize(nrow(), reader_.total_dimension());
+      for (int i = begin_; i < end_; ++i) {
+        reader_.read_draw(i, rows.row(i - begin_));
+      }
+    }
+
+   private:
+    const DrawFileReader &reader_;
+    int begin_;
+    int end_;
+  };
+
+  DrawFileChunkReader::DrawFileChunkReader(const std::string &filename,
+                                           int chunk_size)
+      : reader_(filename), chunk_size_(chunk_size), position_(0) {
+    if (chunk_size_ <= 0) {
+      report_error("chunk_size must be positive.");
+    }
+  }
+
+  std::unique_ptr<ChunkedDataSource::Chunk> DrawFileChunkReader::next_chunk() {
+    if (position_ >= reader_.number_of_draws()) return nullptr;
+    int begin = position_;
+    position_ = std::min(position_ + chunk_size_, reader_.number_of_draws());
+    return std::unique_ptr<Chunk>(new DrawChunk(reader_, begin, position_));
+  }
+
+}  // namespace BOOM
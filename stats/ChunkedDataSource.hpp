@@ -0,0 +1,137 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+#ifndef BOOM_STATS_CHUNKED_DATA_SOURCE_HPP_
+#define BOOM_STATS_CHUNKED_DATA_SOURCE_HPP_
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LinAlg/Matrix.hpp"
+#include "cpputil/BinaryDrawFile.hpp"
+#include "cpputil/Split.hpp"
+
+namespace BOOM {
+
+  // A numeric data set that is read a chunk of rows at a time, so that
+  // statistics can be accumulated from files too large to hold in memory.
+  //
+  // Reading is split into two stages.  next_chunk() pulls the raw contents
+  // of the next chunk from the underlying file.  It must be called by one
+  // thread at a time.  Chunk::parse() converts a chunk to numbers.  It does
+  // not touch the source, so different chunks can be parsed concurrently.
+  // Text files do most of their work in parse(), which lets the expensive
+  // part of reading them run in parallel.
+  //
+  // Missing values are represented as NaN.
+  class ChunkedDataSource {
+   public:
+    class Chunk {
+     public:
+      virtual ~Chunk() {}
+
+      // The number of rows in the chunk.
+      virtual int nrow() const = 0;
+
+      // Fill 'rows' with the contents of the chunk, one row per
+      // observation.  'rows' is resized if needed.
+      virtual void parse(Matrix &rows) const = 0;
+    };
+
+    virtual ~ChunkedDataSource() {}
+
+    // The number of variables (columns) in each row.
+    virtual int ncol() const = 0;
+
+    // Returns the next chunk of data, or nullptr if the source is
+    // exhausted.
+    virtual std::unique_ptr<Chunk> next_chunk() = 0;
+  };
+
+  //===========================================================================
+  // Reads a delimited text file of numbers.  Blank lines are skipped.  The
+  // fields "", "NA", "NaN", and "." are treated as missing.
+  class CsvChunkReader : public ChunkedDataSource {
+   public:
+    // Args:
+    //   filename:  The name of the file to read.
+    //   header: If true, the first line of the file contains variable
+    //     names.
+    //   sep: The field separator.  An empty string or a single space
+    //     means fields are separated by white space.
+    //   chunk_size:  The maximum number of lines in each chunk.
+    explicit CsvChunkReader(const std::string &filename, bool header = false,
+                            const std::string &sep = ",",
+                            int chunk_size = 10000);
+
+    int ncol() const override { return ncol_; }
+    std::unique_ptr<Chunk> next_chunk() override;
+
+    // The variable names from the header, or default names (V.0, V.1,
+    // ...) if the file has no header.
+    const std::vector<std::string> &variable_names() const {
+      return variable_names_;
+    }
+
+   private:
+    class TextChunk;
+
+    // Read the next non-blank line into 'line'.  Returns false at the end
+    // of the file.
+    bool next_line(std::string &line);
+
+    std::string filename_;
+    std::ifstream input_;
+    StringSplitter split_;
+    int chunk_size_;
+    int ncol_;
+    long line_number_;
+    std::vector<std::string> variable_names_;
+
+    // The constructor reads the first line of data to learn the number of
+    // fields.  It is held here until the first call to next_chunk().
+    std::string pending_line_;
+    bool has_pending_line_;
+  };
+
+  //===========================================================================
+  // Reads a binary draw file (see cpputil/BinaryDrawFile.hpp) as a data set
+  // with one row per draw.  The file is block-columnar and memory mapped,
+  // so only the pages holding the current chunks need to be resident.
+  class DrawFileChunkReader : public ChunkedDataSource {
+   public:
+    explicit DrawFileChunkReader(const std::string &filename,
+                                 int chunk_size = 10000);
+
+    int ncol() const override { return reader_.total_dimension(); }
+    std::unique_ptr<Chunk> next_chunk() override;
+
+    const DrawFileReader &reader() const { return reader_; }
+
+   private:
+    class DrawChunk;
+
+    DrawFileReader reader_;
+    int chunk_size_;
+    int position_;
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_STATS_CHUNKED_DATA_SOURCE_HPP_
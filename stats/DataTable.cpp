@@ -20,19 +20,27 @@
 #include "stats/DataTable.hpp"
 #include "stats/moments.hpp"
 
+#include <algorithm>
 #include <cctype>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "Models/CategoricalData.hpp"
 #include "cpputil/DefaultVnames.hpp"
+#include "cpputil/MappedFile.hpp"
 #include "cpputil/Ptr.hpp"
 #include "cpputil/math_utils.hpp"
 #include "cpputil/report_error.hpp"
+#include "cpputil/Split.hpp"
+#include "cpputil/ThreadTools.hpp"
 #include "cpputil/string_utils.hpp"
 
 namespace BOOM {
@@ -248,23 +256,119 @@ namespace BOOM {
   }
 
   //===========================================================================
+  CategoricalVariable::CategoricalVariable()
+      : materialized_(false), materialize_once_(new std::once_flag) {}
+
   CategoricalVariable::CategoricalVariable(
       const std::vector<std::string> &raw_data)
-      : key_(make_catkey(raw_data)) {
-    for (int i = 0; i < raw_data.size(); ++i) {
-      Ptr<LabeledCategoricalData> dp(new LabeledCategoricalData(raw_data[i], key_));
-      data_.push_back(dp);
+      : key_(make_catkey(raw_data)),
+        materialized_(false),
+        materialize_once_(new std::once_flag) {
+    // make_catkey sorts the labels, so they can be found by bisection.
+    const std::vector<std::string> &labels(key_->labels());
+    codes_.reserve(raw_data.size());
+    for (const auto &label : raw_data) {
+      codes_.push_back(
+          std::lower_bound(labels.begin(), labels.end(), label) -
+          labels.begin());
     }
   }
 
   CategoricalVariable::CategoricalVariable(
-      const std::vector<int> &values,
+      std::vector<int> values,
       const Ptr<CatKey> &key)
-      : key_(key) {
-    for (const auto &el : values) {
-      NEW(LabeledCategoricalData, dp)(el, key_);
-      data_.push_back(dp);
+      : key_(key),
+        codes_(std::move(values)),
+        materialized_(false),
+        materialize_once_(new std::once_flag) {
+    for (int value : codes_) {
+      if (value < 0 || value >= key_->max_levels()) {
+        report_error("Illegal value passed to CategoricalVariable.");
+      }
+    }
+  }
+
+  CategoricalVariable::CategoricalVariable(
+      const std::vector<Ptr<LabeledCategoricalData>> &data)
+      : key_(data[0]->catkey()),
+        data_(data),
+        materialized_(true),
+        materialize_once_(new std::once_flag) {}
+
+  CategoricalVariable::CategoricalVariable(const CategoricalVariable &rhs)
+      : key_(rhs.key_),
+        codes_(rhs.codes_),
+        data_(rhs.data_),
+        materialized_(rhs.is_materialized()),
+        materialize_once_(new std::once_flag) {}
+
+  CategoricalVariable &CategoricalVariable::operator=(
+      const CategoricalVariable &rhs) {
+    if (&rhs != this) {
+      key_ = rhs.key_;
+      codes_ = rhs.codes_;
+      data_ = rhs.data_;
+      materialized_.store(rhs.is_materialized());
+      materialize_once_.reset(new std::once_flag);
+    }
+    return *this;
+  }
+
+  void CategoricalVariable::set_value(int observation_number, int value) {
+    if (is_materialized()) {
+      data_[observation_number]->set(value);
+    } else {
+      if (value < 0 || value >= key_->max_levels()) {
+        report_error("Illegal value passed to CategoricalVariable.");
+      }
+      codes_[observation_number] = value;
+    }
+  }
+
+  void CategoricalVariable::push_back(int value) {
+    if (is_materialized()) {
+      NEW(LabeledCategoricalData, element)(value, key_);
+      data_.push_back(element);
+    } else {
+      if (value < 0 || value >= key_->max_levels()) {
+        report_error("Illegal value passed to CategoricalVariable.");
+      }
+      codes_.push_back(value);
+    }
+  }
+
+  void CategoricalVariable::set_order(
+      const std::vector<std::string> &level_names) {
+    if (!is_materialized()) {
+      // The key only updates the data objects registered with it, so the
+      // codes must be remapped here.
+      const std::vector<std::string> &old_labels(key_->labels());
+      std::vector<int> new_code(old_labels.size(), -1);
+      for (int i = 0; i < old_labels.size(); ++i) {
+        auto it = std::find(level_names.begin(), level_names.end(),
+                            old_labels[i]);
+        if (it == level_names.end()) {
+          report_error("Level '" + old_labels[i] + "' is missing from the "
+                       "new ordering.");
+        }
+        new_code[i] = it - level_names.begin();
+      }
+      for (int &code : codes_) {
+        code = new_code[code];
+      }
     }
+    key_->reorder(level_names);
+  }
+
+  void CategoricalVariable::materialize() const {
+    if (is_materialized()) return;
+    std::call_once(*materialize_once_, [this]() {
+      data_.reserve(codes_.size());
+      for (int code : codes_) {
+        data_.push_back(new LabeledCategoricalData(code, key_));
+      }
+      materialized_.store(true, std::memory_order_release);
+    });
   }
 
   const Vector &get(const std::map<uint, Vector> &m, uint i) {
@@ -299,81 +403,370 @@ namespace BOOM {
       : type_index_(new DataTypeIndex)
   {}
 
-  DataTable::DataTable(const std::string &fname,
-                       bool header,
-                       const std::string &sep)
-      : type_index_(new DataTypeIndex)
-  {
-    ifstream in(fname.c_str());
-    if (!in) {
-      std::string msg = "bad file name ";
-      report_error(msg + fname);
-    }
+  namespace {
+    // The number of lines of data used to infer the type of each variable.
+    const int kTypeInferenceSampleSize = 1000;
 
-    StringSplitter split(sep);
-    std::string line;
-    uint nfields = 0;
-    uint line_number = 0;
+    // A field in a line of text, which is not null terminated.
+    struct Field {
+      const char *begin;
+      const char *end;
+      std::string str() const { return std::string(begin, end); }
+    };
 
-    std::vector<std::vector<std::string>> categorical_data;
-    std::vector<Vector> numeric_data;
-    std::vector<std::string> variable_names;
-
-    if (header) {
-      ++line_number;
-      getline(in, line);
-      variable_names = split(line);
-      nfields = variable_names.size();
+    inline bool is_blank(const char *begin, const char *end) {
+      for (; begin < end; ++begin) {
+        if (!std::isspace(static_cast<unsigned char>(*begin))) return false;
+      }
+      return true;
     }
 
-    while (in) {
-      ++line_number;
-      getline(in, line);
-      if (is_all_white(line)) continue;
-      std::vector<std::string> fields = split(line);
+    // Moves through the non-blank lines of a block of text.
+    class LineReader {
+     public:
+      LineReader(const char *begin, const char *end)
+          : position_(begin), end_(end), lines_read_(0) {}
+
+      // Find the next line that is not blank.  Trailing carriage returns
+      // are removed.  Returns false if no lines remain.
+      bool next(const char *&line_begin, const char *&line_end) {
+        while (position_ < end_) {
+          const void *newline = std::memchr(position_, '\n', end_ - position_);
+          line_begin = position_;
+          line_end = newline ? static_cast<const char *>(newline) : end_;
+          position_ = newline ? line_end + 1 : end_;
+          ++lines_read_;
+          if (line_end > line_begin && line_end[-1] == '\r') --line_end;
+          if (!is_blank(line_begin, line_end)) return true;
+        }
+        return false;
+      }
 
-      if (nfields == 0) {
-        // No data has yet been read.  Initialize the variable names and data
-        // types based off the first row.
-        nfields = fields.size();
-        variable_names = default_vnames(nfields);
-        type_index_->diagnose_types(fields);
-        type_index_->set_names(variable_names);
-        numeric_data.resize(type_index_->number_of_numeric_fields());
-        categorical_data.resize(type_index_->number_of_categorical_fields());
+      const char *position() const { return position_; }
+
+      // The number of lines (including blank lines) read so far.
+      long lines_read() const { return lines_read_; }
+
+     private:
+      const char *position_;
+      const char *end_;
+      long lines_read_;
+    };
+
+    // Splits a line into fields without copying it.  Lines containing quote
+    // characters are handed to a StringSplitter, which knows how to handle
+    // separators inside quoted fields.
+    class FieldSplitter {
+     public:
+      explicit FieldSplitter(const std::string &sep)
+          : whitespace_(is_all_white(sep)),
+            quoted_line_splitter_(whitespace_ ? " " : sep),
+            is_delimiter_(256, false) {
+        for (char c : sep) {
+          is_delimiter_[static_cast<unsigned char>(c)] = true;
+        }
       }
 
-      if (fields.size() != nfields) {  // check number of fields
-        field_length_error(fname, line_number, nfields, fields.size());
+      // Fill 'fields' with the fields in the line [begin, end).  The
+      // fields may point into 'storage'.
+      void split(const char *begin, const char *end,
+                 std::vector<Field> &fields,
+                 std::vector<std::string> &storage) const {
+        fields.clear();
+        if (std::find_if(begin, end, [](char c) {
+              return c == '"' || c == '\'';
+            }) != end) {
+          storage = quoted_line_splitter_(std::string(begin, end));
+          for (const auto &field : storage) {
+            fields.push_back({field.data(), field.data() + field.size()});
+          }
+        } else if (whitespace_) {
+          const char *pos = begin;
+          while (true) {
+            while (pos < end && (*pos == ' ' || *pos == '\t')) ++pos;
+            if (pos == end) return;
+            const char *field_end = pos;
+            while (field_end < end && *field_end != ' ' && *field_end != '\t') {
+              ++field_end;
+            }
+            fields.push_back({pos, field_end});
+            pos = field_end;
+          }
+        } else {
+          const char *pos = begin;
+          while (true) {
+            const char *field_end = pos;
+            while (field_end < end &&
+                   !is_delimiter_[static_cast<unsigned char>(*field_end)]) {
+              ++field_end;
+            }
+            fields.push_back({pos, field_end});
+            if (field_end == end) return;
+            pos = field_end + 1;
+          }
+        }
       }
 
-      for (uint i = 0; i < nfields; ++i) {
-        if (!type_index_->check_type(i, fields[i])) {
-          wrong_type_error(line_number, i + 1);
+     private:
+      bool whitespace_;
+      StringSplitter quoted_line_splitter_;
+      std::vector<bool> is_delimiter_;
+    };
+
+    inline bool is_numeric_field(const Field &field) {
+      const char *begin = field.begin;
+      const char *end = field.end;
+      while (begin < end && *begin == ' ') ++begin;
+      while (end > begin && end[-1] == ' ') --end;
+      return is_numeric(std::string(begin, end));
+    }
+
+    // Convert 'field' to a number, using 'buffer' as workspace.  Returns
+    // false if the field is not a number.
+    inline bool parse_number(const Field &field, std::string &buffer,
+                             double &value) {
+      buffer.assign(field.begin, field.end);
+      const char *start = buffer.c_str();
+      char *stop = nullptr;
+      value = std::strtod(start, &stop);
+      if (stop == start) return false;
+      while (*stop == ' ') ++stop;
+      return *stop == '\0';
+    }
+
+    // Call task(i) for i = 0, ..., ntasks - 1, spreading the calls over the
+    // threads in 'pool' and the calling thread.  The first exception thrown
+    // by any task is rethrown once all tasks have finished.
+    template <class TASK>
+    void run_tasks(ThreadWorkerPool &pool, int ntasks, const TASK &task) {
+      pool.parallel_for(0, ntasks, 1, [&task](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+          task(i);
         }
+      });
+    }
+  }  // namespace
 
-        if (variable_type(i) == VariableType::numeric) {
-          double tmp = std::stod(fields[i], nullptr);
-          int index = type_index_->type_map(i).second;
-          numeric_data[index].push_back(tmp);
-        } else if (variable_type(i) == VariableType::categorical) {
-          int index = type_index_->type_map(i).second;
-          categorical_data[index].push_back(fields[i]);
-        } else {
-          unknown_type();
+  DataTable::DataTable(const std::string &fname,
+                       bool header,
+                       const std::string &sep,
+                       int nthreads)
+      : type_index_(new DataTypeIndex)
+  {
+    MappedFile file(fname);
+    const char *file_end = file.data() + file.size();
+    FieldSplitter split(sep);
+    std::vector<Field> fields;
+    std::vector<std::string> storage;
+    const char *line_begin;
+    const char *line_end;
+
+    LineReader header_reader(file.data(), file_end);
+    std::vector<std::string> variable_names;
+    if (header) {
+      if (!header_reader.next(line_begin, line_end)) return;
+      split.split(line_begin, line_end, fields, storage);
+      for (const auto &field : fields) {
+        variable_names.push_back(field.str());
+      }
+    }
+    const char *data_begin = header_reader.position();
+    const long header_lines = header_reader.lines_read();
+
+    //---------------------------------------------------------------------
+    // Infer the variable types from the first few lines of data.
+    uint nfields = variable_names.size();
+    std::vector<bool> is_numeric_variable;
+    LineReader sample(data_begin, file_end);
+    for (int i = 0; i < kTypeInferenceSampleSize; ++i) {
+      if (!sample.next(line_begin, line_end)) break;
+      split.split(line_begin, line_end, fields, storage);
+      if (is_numeric_variable.empty()) {
+        if (nfields == 0) nfields = fields.size();
+        is_numeric_variable.assign(nfields, true);
+      }
+      if (fields.size() != nfields) {
+        field_length_error(fname, header_lines + sample.lines_read(),
+                           fields.size(), nfields);
+      }
+      for (uint j = 0; j < nfields; ++j) {
+        if (is_numeric_variable[j] && !is_numeric_field(fields[j])) {
+          is_numeric_variable[j] = false;
         }
       }
     }
+    if (is_numeric_variable.empty()) {
+      // A file with no data.  Any variables named in the header are numeric
+      // with no observations.
+      for (const auto &name : variable_names) {
+        append_variable(Vector(0), name);
+      }
+      return;
+    }
+    if (variable_names.empty()) {
+      variable_names = default_vnames(nfields);
+    }
 
-    for (uint i = 0; i < nfields; ++i) {
-      VariableType type;
-      int index;
-      std::tie(type, index) = type_index_->type_map(i);
+    //---------------------------------------------------------------------
+    // Divide the data into one range of whole lines per thread, and count
+    // the observations in each range.
+    const int nranges = std::max<int>(1, std::min<long>(
+        nthreads, 1 + (file_end - data_begin) / 65536));
+    std::vector<const char *> range_begin(nranges + 1, file_end);
+    range_begin[0] = data_begin;
+    for (int k = 1; k < nranges; ++k) {
+      const char *pos = std::max(
+          range_begin[k - 1], data_begin + (file_end - data_begin) * k / nranges);
+      const void *newline = std::memchr(pos, '\n', file_end - pos);
+      range_begin[k] = newline ? static_cast<const char *>(newline) + 1
+                               : file_end;
+    }
+    ThreadWorkerPool pool(nranges - 1);
+    std::vector<long> rows_in_range(nranges);
+    std::vector<long> lines_in_range(nranges);
+    run_tasks(pool, nranges, [&](int k) {
+        LineReader lines(range_begin[k], range_begin[k + 1]);
+        const char *b, *e;
+        long rows = 0;
+        while (lines.next(b, e)) ++rows;
+        rows_in_range[k] = rows;
+        lines_in_range[k] = lines.lines_read();
+      });
+    std::vector<long> first_row(nranges + 1, 0);
+    std::vector<long> first_line(nranges, header_lines);
+    for (int k = 1; k <= nranges; ++k) {
+      first_row[k] = first_row[k - 1] + rows_in_range[k - 1];
+      if (k < nranges) {
+        first_line[k] = first_line[k - 1] + lines_in_range[k - 1];
+      }
+    }
+    const long nrows = first_row[nranges];
+
+    //---------------------------------------------------------------------
+    // Parse each range directly into the columns.  Categorical levels are
+    // coded in the order each thread first sees them, and recoded below.
+    //
+    // A variable that looked numeric in the sample but has a non-numeric
+    // value further down is demoted to categorical, and the data are parsed
+    // again.  A pass is only repeated if it demoted a variable, and the
+    // first pass normally finds every variable that needs it.
+    std::vector<int> storage_index(nfields);
+    int number_of_numeric_variables;
+    int number_of_categorical_variables;
+    std::vector<Vector> numeric_data;
+    std::vector<std::vector<int>> categorical_codes;
+    using Dictionary = std::unordered_map<std::string, int>;
+    std::vector<std::vector<Dictionary>> dictionaries;
+    std::vector<std::vector<std::vector<std::string>>> local_labels;
+    bool reparse = true;
+    while (reparse) {
+      number_of_numeric_variables = 0;
+      number_of_categorical_variables = 0;
+      for (uint j = 0; j < nfields; ++j) {
+        storage_index[j] = is_numeric_variable[j]
+            ? number_of_numeric_variables++
+            : number_of_categorical_variables++;
+      }
+      numeric_data.assign(number_of_numeric_variables, Vector(nrows));
+      categorical_codes.assign(number_of_categorical_variables,
+                               std::vector<int>(nrows));
+      dictionaries.assign(
+          nranges, std::vector<Dictionary>(number_of_categorical_variables));
+      local_labels.assign(nranges, std::vector<std::vector<std::string>>(
+          number_of_categorical_variables));
+      // Each range records its own demotions, so the threads do not share
+      // writable state.
+      std::vector<std::vector<bool>> demoted(
+          nranges, std::vector<bool>(nfields, false));
+
+      run_tasks(pool, nranges, [&](int k) {
+          LineReader lines(range_begin[k], range_begin[k + 1]);
+          std::vector<Field> fields;
+          std::vector<std::string> storage;
+          std::string buffer;
+          const char *b, *e;
+          long row = first_row[k];
+          while (lines.next(b, e)) {
+            split.split(b, e, fields, storage);
+            long line_number = first_line[k] + lines.lines_read();
+            if (fields.size() != nfields) {
+              field_length_error(fname, line_number, fields.size(), nfields);
+            }
+            for (uint j = 0; j < nfields; ++j) {
+              int index = storage_index[j];
+              if (is_numeric_variable[j]) {
+                if (!demoted[k][j] &&
+                    !parse_number(fields[j], buffer,
+                                  numeric_data[index][row])) {
+                  demoted[k][j] = true;
+                }
+              } else {
+                buffer.assign(fields[j].begin, fields[j].end);
+                Dictionary &dictionary(dictionaries[k][index]);
+                auto it = dictionary.find(buffer);
+                if (it == dictionary.end()) {
+                  std::vector<std::string> &labels(local_labels[k][index]);
+                  it = dictionary.emplace(buffer, labels.size()).first;
+                  labels.push_back(buffer);
+                }
+                categorical_codes[index][row] = it->second;
+              }
+            }
+            ++row;
+          }
+        });
+
+      reparse = false;
+      for (int k = 0; k < nranges; ++k) {
+        for (uint j = 0; j < nfields; ++j) {
+          if (demoted[k][j]) {
+            is_numeric_variable[j] = false;
+            reparse = true;
+          }
+        }
+      }
+    }
 
-      if (type == VariableType::numeric) {
-        numeric_variables_.push_back(numeric_data[index]);
-      } else if (type == VariableType::categorical) {
-        categorical_variables_.emplace_back(categorical_data[i]);
+    //---------------------------------------------------------------------
+    // Merge the per-thread dictionaries into a sorted set of levels, and
+    // recode the categorical variables.
+    std::vector<std::vector<std::string>> levels(
+        number_of_categorical_variables);
+    for (int c = 0; c < number_of_categorical_variables; ++c) {
+      for (int k = 0; k < nranges; ++k) {
+        levels[c].insert(levels[c].end(), local_labels[k][c].begin(),
+                         local_labels[k][c].end());
+      }
+      std::sort(levels[c].begin(), levels[c].end());
+      levels[c].erase(std::unique(levels[c].begin(), levels[c].end()),
+                      levels[c].end());
+    }
+    run_tasks(pool, nranges, [&](int k) {
+        for (int c = 0; c < number_of_categorical_variables; ++c) {
+          const std::vector<std::string> &labels(local_labels[k][c]);
+          std::vector<int> recode(labels.size());
+          for (int i = 0; i < labels.size(); ++i) {
+            recode[i] = std::lower_bound(levels[c].begin(), levels[c].end(),
+                                         labels[i]) - levels[c].begin();
+          }
+          std::vector<int> &codes(categorical_codes[c]);
+          for (long row = first_row[k]; row < first_row[k + 1]; ++row) {
+            codes[row] = recode[codes[row]];
+          }
+        }
+      });
+
+    for (uint j = 0; j < nfields; ++j) {
+      int index = storage_index[j];
+      if (is_numeric_variable[j]) {
+        numeric_variables_.push_back(std::move(numeric_data[index]));
+        type_index_->add_variable(VariableType::numeric, variable_names[j]);
+      } else {
+        categorical_variables_.emplace_back(
+            std::move(categorical_codes[index]),
+            new CatKey(levels[index]));
+        type_index_->add_variable(VariableType::categorical,
+                                  variable_names[j]);
       }
     }
   }
@@ -533,9 +926,11 @@ namespace BOOM {
         if (type == VariableType::numeric) {
           X(i, column++) = numeric_variables_[index][i];
         } else if (type == VariableType::categorical) {
-          const Ptr<LabeledCategoricalData> x(categorical_variables_[index][i]);
-          for (uint k = 1; k < x->nlevels(); ++k)
-            X(i, column++) = (k == x->value() ? 1 : 0);
+          const CategoricalVariable &x(categorical_variables_[index]);
+          const uint nlevels = x.labels().size();
+          const uint value = x.value(i);
+          for (uint k = 1; k < nlevels; ++k)
+            X(i, column++) = (k == value ? 1 : 0);
         } else {
           unknown_type();
         }
@@ -554,7 +949,6 @@ namespace BOOM {
       if (type == VariableType::numeric) {
         dimnames.push_back(vnames()[J]);
       } else if (type == VariableType::categorical) {
-        const Ptr<LabeledCategoricalData> x(categorical_variables_[index][0]);
         std::string stub = vnames()[J];
         std::vector<std::string> labs = categorical_variables_[index].labels();
         for (uint i = 1; i < labs.size(); ++i) {
@@ -592,10 +986,9 @@ namespace BOOM {
             << rhs.categorical_variables_[i].labels() << endl;
         report_error(err.str());
       }
-      Ptr<CatKey> key = categorical_variables_[i].key();
       for (int j = 0; j < rhs.categorical_variables_[i].size(); ++j) {
-        uint value = rhs.categorical_variables_[i][j]->value();
-        categorical_variables_[i].push_back(new LabeledCategoricalData(value, key));
+        categorical_variables_[i].push_back(
+            rhs.categorical_variables_[i].value(j));
       }
     }
     return *this;
@@ -607,7 +1000,7 @@ namespace BOOM {
     int index;
     std::tie(type, index) = type_index_->type_map(i);
     if (type == VariableType::numeric) return 1;
-    return categorical_variables_[index][0]->nlevels();
+    return categorical_variables_[index].labels().size();
   }
 
   int DataTable::numeric_dim() const {
@@ -638,7 +1031,7 @@ namespace BOOM {
     } else {
       Vector ans(nobs());
       for (uint i = 0; i < nobs(); ++i) {
-        ans[i] = categorical_variables_[index][i]->value();
+        ans[i] = categorical_variables_[index].value(i);
       }
       return ans;
     }
@@ -689,7 +1082,7 @@ namespace BOOM {
       report_error(
           "Attempt to set categorical value to non-categorical variable.");
     }
-    categorical_variables_[index][row]->set(value);
+    categorical_variables_[index].set_value(row, value);
   }
 
   // DataTable::OrdinalVariable DataTable::get_ordinal(uint n)const{
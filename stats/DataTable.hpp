@@ -20,7 +20,10 @@
 #ifndef BOOM_DATA_TABLE_HPP
 #define BOOM_DATA_TABLE_HPP
 
+#include <atomic>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include "uint.hpp"
 
 #include "LinAlg/Matrix.hpp"
@@ -188,44 +191,91 @@ namespace BOOM {
   // assumed to come in string format, so a CatKey is used to handle the
   // mapping between the string values and the values of the categorical data
   // elements.
+  //
+  // The column is stored in dictionary encoded form: a vector of integer
+  // codes indexing the labels in the CatKey.  A LabeledCategoricalData object
+  // is only created for each element the first time one of the methods
+  // returning per-element objects (operator[], data(), push_back of a data
+  // pointer) is called.  From then on the objects are shared with any caller
+  // that holds them, so changes made through set_value() are visible to
+  // them.  Callers that only need the levels should use value() or label(),
+  // which never create objects.
+  //
+  // The const accessors that create the objects are safe to call from
+  // several threads at once: the objects are created exactly once, under
+  // std::call_once, and the codes are left in place so that concurrent calls
+  // to value() and label() can keep reading them.  That costs an int per
+  // observation on top of the objects.
   class CategoricalVariable {
    public:
-    CategoricalVariable() = default;
+    CategoricalVariable();
     explicit CategoricalVariable(const std::vector<std::string> &raw_data);
-    CategoricalVariable(const std::vector<int> &values, const Ptr<CatKey> &key);
+    CategoricalVariable(std::vector<int> values, const Ptr<CatKey> &key);
     explicit CategoricalVariable(
-        const std::vector<Ptr<LabeledCategoricalData>> &data)
-        : key_(data[0]->catkey()), data_(data) {}
+        const std::vector<Ptr<LabeledCategoricalData>> &data);
+    CategoricalVariable(const CategoricalVariable &rhs);
+    CategoricalVariable &operator=(const CategoricalVariable &rhs);
 
-    Ptr<LabeledCategoricalData> operator[](uint i) { return data_[i]; }
+    Ptr<LabeledCategoricalData> operator[](uint i) {
+      materialize();
+      return data_[i];
+    }
     const Ptr<LabeledCategoricalData> operator[](uint i) const {
+      materialize();
       return data_[i];
     }
     const std::vector<std::string> &labels() const { return key_->labels(); }
 
+    // The integer code of the ith data point.
+    int value(int observation_number) const {
+      return is_materialized() ? data_[observation_number]->value()
+                               : codes_[observation_number];
+    }
+    void set_value(int observation_number, int value);
+
     // Return the label of the ith data point.
     const std::string &label(int observation_number) const {
-      return key_->label(data_[observation_number]->value());
+      return key_->label(value(observation_number));
     }
 
-    int size() const { return data_.size(); }
-    bool empty() const { return data_.empty(); }
+    int size() const {
+      return is_materialized() ? data_.size() : codes_.size();
+    }
+    bool empty() const { return size() == 0; }
     void push_back(const Ptr<LabeledCategoricalData> &element) {
+      materialize();
       data_.push_back(element);
       key_->Register(element.get());
     }
-    void set_order(const std::vector<std::string> &level_names) {
-      key_->reorder(level_names);
-    }
+    void push_back(int value);
+
+    // Reorder the levels of the key.  If the key is shared with another
+    // CategoricalVariable that has not created its data objects then that
+    // variable's codes are not updated.
+    void set_order(const std::vector<std::string> &level_names);
 
     Ptr<CatKey> key() { return key_; }
+    const Ptr<CatKey> &key() const { return key_; }
     const std::vector<Ptr<LabeledCategoricalData>> &data() const {
+      materialize();
       return data_;
     }
 
    private:
+    // Create a LabeledCategoricalData object for each code, and switch to
+    // storing the objects.  The objects are created once, even if several
+    // threads call this at the same time.
+    void materialize() const;
+
+    bool is_materialized() const {
+      return materialized_.load(std::memory_order_acquire);
+    }
+
     Ptr<CatKey> key_;
-    std::vector<Ptr<LabeledCategoricalData>> data_;
+    std::vector<int> codes_;
+    mutable std::vector<Ptr<LabeledCategoricalData>> data_;
+    mutable std::atomic<bool> materialized_;
+    std::unique_ptr<std::once_flag> materialize_once_;
   };
 
   //===========================================================================
@@ -271,8 +321,16 @@ namespace BOOM {
     //     is the first observation, and variable names will be
     //     automatically generated.
     //   sep: The separator between fields in the data file.
+    //   nthreads: The number of threads to use when parsing the file.
+    //
+    // The file is memory mapped and divided into one range of lines per
+    // thread.  Variable types are inferred from the first 1000 lines of
+    // data: a column is numeric if every sampled field is numeric, and
+    // categorical otherwise.  A column with a non-numeric value after the
+    // sampled lines is read again as categorical, which costs an extra pass
+    // over the file.  The levels of a categorical variable are sorted.
     explicit DataTable(const std::string &fname, bool header = false,
-                       const std::string &sep = "");
+                       const std::string &sep = "", int nthreads = 1);
 
     DataTable *clone() const override;
     std::ostream &display(std::ostream &out) const override;
@@ -70,7 +70,7 @@ namespace BOOM {
   Matrix EffectsEncoder::encode(const CategoricalVariable &variable) const {
     Matrix ans(variable.size(), dim());
     for (size_t i = 0; i < variable.size(); ++i) {
-      ans.row(i) = encode(*variable[i]);
+      encode(variable.value(i), ans.row(i));
     }
     return ans;
   }
@@ -0,0 +1,236 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include "stats/StreamingSufstat.hpp"
+
+#include <cmath>
+#include <memory>
+#include <sstream>
+
+#include "Models/GaussianModelBase.hpp"
+#include "Models/Glm/RegressionModel.hpp"
+#include "Models/MultinomialModel.hpp"
+#include "Models/MvnBase.hpp"
+#include "cpputil/ThreadTools.hpp"
+#include "cpputil/report_error.hpp"
+
+namespace BOOM {
+
+  namespace {
+    void check_column(const ChunkedDataSource &source, int column) {
+      if (column < 0 || column >= source.ncol()) {
+        std::ostringstream err;
+        err << "Column " << column << " was requested from a data source "
+            << "with " << source.ncol() << " columns.";
+        report_error(err.str());
+      }
+    }
+
+    // Feed each chunk of 'source' to 'update', which adds the rows of a
+    // chunk to a sufficient statistic and returns the number of rows it
+    // used.
+    //
+    // Args:
+    //   source:  The data to be read.
+    //   suf: The sufficient statistic to be updated.  SUF must provide
+    //     clone(), clear(), and abstract_combine().
+    //   nthreads:  The number of threads to use.
+    //   update: A callable with signature long(const Matrix &rows, SUF
+    //     &suf).  It is called concurrently from different threads, each
+    //     with its own 'suf'.
+    template <class SUF, class UPDATE>
+    long stream_chunks(ChunkedDataSource &source, SUF &suf, int nthreads,
+                       const UPDATE &update) {
+      if (nthreads <= 1) {
+        long count = 0;
+        Matrix rows;
+        while (std::unique_ptr<ChunkedDataSource::Chunk> chunk =
+                   source.next_chunk()) {
+          chunk->parse(rows);
+          count += update(rows, suf);
+        }
+        return count;
+      }
+
+      // Chunks are read in batches of 'nthreads'.  Each chunk in a batch is
+      // parsed into its own copy of 'suf' by the worker pool (the calling
+      // thread is one of the workers), and the copies are combined in the
+      // order the chunks were read, so the result does not depend on which
+      // thread handled which chunk.
+      ThreadWorkerPool pool(nthreads - 1);
+      std::vector<std::unique_ptr<SUF>> chunk_suf;
+      for (int i = 0; i < nthreads; ++i) {
+        chunk_suf.emplace_back(suf.clone());
+      }
+      std::vector<std::unique_ptr<ChunkedDataSource::Chunk>> chunks;
+      std::vector<long> counts(nthreads, 0);
+      long total = 0;
+      bool exhausted = false;
+      while (!exhausted) {
+        chunks.clear();
+        while (chunks.size() < nthreads) {
+          std::unique_ptr<ChunkedDataSource::Chunk> chunk = source.next_chunk();
+          if (!chunk) {
+            exhausted = true;
+            break;
+          }
+          chunks.push_back(std::move(chunk));
+        }
+        pool.parallel_for(0, chunks.size(), 1, [&](int begin, int end) {
+          Matrix rows;
+          for (int i = begin; i < end; ++i) {
+            chunk_suf[i]->clear();
+            chunks[i]->parse(rows);
+            counts[i] = update(rows, *chunk_suf[i]);
+          }
+        });
+        for (int i = 0; i < chunks.size(); ++i) {
+          // Some sufficient statistics (e.g. MvnSuf) cannot combine two
+          // empty sets of data, so chunks that produced no data are left
+          // out.
+          if (counts[i] > 0) {
+            suf.abstract_combine(chunk_suf[i].get());
+            total += counts[i];
+          }
+        }
+      }
+      return total;
+    }
+  }  // namespace
+
+  //===========================================================================
+  long stream_sufstat(ChunkedDataSource &source, int column, GaussianSuf &suf,
+                      int nthreads) {
+    check_column(source, column);
+    return stream_chunks(
+        source, suf, nthreads, [column](const Matrix &rows, GaussianSuf &s) {
+          long count = 0;
+          for (int i = 0; i < rows.nrow(); ++i) {
+            double y = rows(i, column);
+            if (std::isnan(y)) continue;
+            s.update_raw(y);
+            ++count;
+          }
+          return count;
+        });
+  }
+
+  //===========================================================================
+  long stream_sufstat(ChunkedDataSource &source,
+                      const std::vector<int> &columns, MvnSuf &suf,
+                      int nthreads) {
+    for (int column : columns) {
+      check_column(source, column);
+    }
+    if (suf.ybar().empty()) {
+      suf.resize(columns.size());
+    } else if (suf.ybar().size() != columns.size()) {
+      report_error("The dimension of the MvnSuf does not match the number of "
+                   "columns requested.");
+    }
+    return stream_chunks(
+        source, suf, nthreads, [&columns](const Matrix &rows, MvnSuf &s) {
+          long count = 0;
+          Vector y(columns.size());
+          for (int i = 0; i < rows.nrow(); ++i) {
+            bool missing = false;
+            for (int j = 0; j < columns.size(); ++j) {
+              y[j] = rows(i, columns[j]);
+              missing = missing || std::isnan(y[j]);
+            }
+            if (missing) continue;
+            s.update_raw(y);
+            ++count;
+          }
+          return count;
+        });
+  }
+
+  //===========================================================================
+  long stream_sufstat(ChunkedDataSource &source, int column,
+                      MultinomialSuf &suf, int nthreads) {
+    check_column(source, column);
+    return stream_chunks(
+        source, suf, nthreads,
+        [column](const Matrix &rows, MultinomialSuf &s) {
+          long count = 0;
+          for (int i = 0; i < rows.nrow(); ++i) {
+            double y = rows(i, column);
+            if (std::isnan(y)) continue;
+            if (y < 0 || y >= s.dim() || y != std::floor(y)) {
+              std::ostringstream err;
+              err << "Illegal value " << y << " for a multinomial "
+                  << "variable with " << s.dim() << " levels.";
+              report_error(err.str());
+            }
+            s.update_raw(static_cast<uint>(y));
+            ++count;
+          }
+          return count;
+        });
+  }
+
+  //===========================================================================
+  long stream_sufstat(ChunkedDataSource &source, int response_column,
+                      const std::vector<int> &predictor_columns,
+                      bool add_intercept, NeRegSuf &suf, int nthreads) {
+    check_column(source, response_column);
+    for (int column : predictor_columns) {
+      check_column(source, column);
+    }
+    const int xdim = predictor_columns.size() + add_intercept;
+    if (suf.size() != xdim) {
+      std::ostringstream err;
+      err << "The regression sufficient statistics have dimension "
+          << suf.size() << " but there are " << xdim << " predictors.";
+      report_error(err.str());
+    }
+
+    return stream_chunks(
+        source, suf, nthreads,
+        [&, response_column, add_intercept, xdim](const Matrix &rows,
+                                                  NeRegSuf &s) {
+          // Copy the complete rows into a design matrix so they can be
+          // added to the sufficient statistics as a single batch.
+          std::vector<int> complete;
+          complete.reserve(rows.nrow());
+          for (int i = 0; i < rows.nrow(); ++i) {
+            bool missing = std::isnan(rows(i, response_column));
+            for (int column : predictor_columns) {
+              missing = missing || std::isnan(rows(i, column));
+            }
+            if (!missing) complete.push_back(i);
+          }
+          const int n = complete.size();
+          Vector y(n);
+          Matrix X(n, xdim);
+          for (int k = 0; k < n; ++k) {
+            int i = complete[k];
+            y[k] = rows(i, response_column);
+            int j = 0;
+            if (add_intercept) X(k, j++) = 1.0;
+            for (int column : predictor_columns) {
+              X(k, j++) = rows(i, column);
+            }
+          }
+          s.add_mixture_data(y, X, Vector(n, 1.0));
+          return static_cast<long>(n);
+        });
+  }
+
+}  // namespace BOOM
@@ -0,0 +1,80 @@
+/*
+  Copyright (C) 2005-2019 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+#ifndef BOOM_STATS_STREAMING_SUFSTAT_HPP_
+#define BOOM_STATS_STREAMING_SUFSTAT_HPP_
+
+#include <vector>
+#include "stats/ChunkedDataSource.hpp"
+
+namespace BOOM {
+
+  class GaussianSuf;
+  class MvnSuf;
+  class MultinomialSuf;
+  class NeRegSuf;
+
+  // Accumulate sufficient statistics directly from a ChunkedDataSource,
+  // without creating a Data object for each observation.  Memory use is
+  // bounded by the chunk size times the number of threads, regardless of
+  // the size of the file.
+  //
+  // Each function adds the data to whatever 'suf' already contains.  With
+  // more than one thread, each chunk is parsed into its own copy of 'suf' by
+  // a ThreadWorkerPool, and the copies are combined into 'suf' in the order
+  // the chunks were read.  The result is the same for any number of threads
+  // greater than one, but it can differ from the single threaded result by
+  // rounding error.
+  //
+  // Rows where any of the requested columns is missing are skipped.  Each
+  // function returns the number of rows that were added to 'suf'.
+
+  // Args:
+  //   source:  The data to be read.
+  //   column:  The (zero-based) column holding the variable of interest.
+  //   suf:  The sufficient statistics to be updated.
+  //   nthreads:  The number of threads to use.
+  long stream_sufstat(ChunkedDataSource &source, int column, GaussianSuf &suf,
+                      int nthreads = 1);
+
+  // Args:
+  //   columns: The columns forming the observed vector.  'suf' must either
+  //     be empty (dimension 0) or have dimension columns.size().
+  long stream_sufstat(ChunkedDataSource &source,
+                      const std::vector<int> &columns, MvnSuf &suf,
+                      int nthreads = 1);
+
+  // The values in 'column' must be integer codes 0, 1, ..., suf.dim() - 1.
+  long stream_sufstat(ChunkedDataSource &source, int column,
+                      MultinomialSuf &suf, int nthreads = 1);
+
+  // Args:
+  //   response_column:  The column holding the response variable.
+  //   predictor_columns:  The columns holding the predictor variables.
+  //   add_intercept: If true, a column of 1's is prepended to the
+  //     predictors.
+  //   suf: The sufficient statistics to be updated.  Its dimension must
+  //     match the number of predictors, including the intercept.  Only the
+  //     normal equations form is supported, because a QrRegSuf can be
+  //     neither updated in batches nor combined.
+  long stream_sufstat(ChunkedDataSource &source, int response_column,
+                      const std::vector<int> &predictor_columns,
+                      bool add_intercept, NeRegSuf &suf, int nthreads = 1);
+
+}  // namespace BOOM
+
+#endif  // BOOM_STATS_STREAMING_SUFSTAT_HPP_
@@ -128,7 +128,7 @@ namespace BOOM {
   void CategoricalSummary::summarize(const CategoricalVariable &x) {
     std::vector<int> category_codes;
     for (int i = 0; i < x.size(); ++i) {
-      category_codes.push_back(x[i]->value());
+      category_codes.push_back(x.value(i));
     }
     frequency_distribution_ = FrequencyDistribution(category_codes);
     frequency_distribution_.set_labels(x.labels());
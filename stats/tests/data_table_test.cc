@@ -6,6 +6,11 @@
 #include "stats/ChiSquareTest.hpp"
 #include "stats/FreqDist.hpp"
 #include "stats/DataTable.hpp"
+#include "cpputil/ThreadTools.hpp"
+#include "distributions.hpp"
+
+#include <cstdio>
+#include <fstream>
 
 namespace {
   using namespace BOOM;
@@ -28,4 +33,137 @@ namespace {
     MixedMultivariateData data;
   }
 
+  class DataTableFileTest : public ::testing::Test {
+   protected:
+    DataTableFileTest() : filename_("data_table_test.csv") {
+      GlobalRng::rng.seed(8675309);
+    }
+    ~DataTableFileTest() override { std::remove(filename_.c_str()); }
+    std::string filename_;
+  };
+
+  TEST_F(DataTableFileTest, ReadsMixedTypes) {
+    std::vector<std::string> colors = {"red", "blue", "green"};
+    int nobs = 5000;
+    Vector x(nobs);
+    std::vector<std::string> color(nobs);
+    {
+      std::ofstream out(filename_);
+      out.precision(17);
+      out << "x,color,count" << endl;
+      for (int i = 0; i < nobs; ++i) {
+        x[i] = rnorm();
+        color[i] = colors[random_int(0, 2)];
+        out << x[i] << "," << color[i] << "," << i << endl;
+        if (i == 100) out << endl;
+      }
+    }
+
+    for (int nthreads : {1, 4}) {
+      DataTable table(filename_, true, ",", nthreads);
+      EXPECT_EQ(3, table.nvars());
+      EXPECT_EQ(nobs, table.nrow());
+      EXPECT_EQ("color", table.vnames()[1]);
+      EXPECT_EQ(VariableType::numeric, table.variable_type(0));
+      EXPECT_EQ(VariableType::categorical, table.variable_type(1));
+      EXPECT_EQ(VariableType::numeric, table.variable_type(2));
+      EXPECT_EQ(x, table.getvar(0));
+      EXPECT_DOUBLE_EQ(nobs - 1, table.getvar(2).back());
+
+      CategoricalVariable variable = table.get_nominal(1);
+      EXPECT_EQ(std::vector<std::string>({"blue", "green", "red"}),
+                variable.labels());
+      for (int i = 0; i < nobs; ++i) {
+        ASSERT_EQ(color[i], variable.label(i));
+      }
+      EXPECT_EQ(3, table.nlevels(1));
+      EXPECT_EQ(color[17], table.get_nominal(17, 1)->label());
+    }
+  }
+
+  TEST_F(DataTableFileTest, QuotesAndWhiteSpace) {
+    {
+      std::ofstream out(filename_);
+      out << "1 \"big dog\"  2.5" << endl
+          << "2 cat 3" << endl;
+    }
+    DataTable table(filename_, false, " ");
+    EXPECT_EQ(2, table.nrow());
+    EXPECT_EQ("V.0", table.vnames()[0]);
+    EXPECT_EQ(VariableType::categorical, table.variable_type(1));
+    EXPECT_EQ("big dog", table.get_nominal(1).label(0));
+    EXPECT_EQ(Vector({2.5, 3.0}), table.getvar(2));
+  }
+
+  TEST_F(DataTableFileTest, NonNumericAfterSampleIsCategorical) {
+    {
+      std::ofstream out(filename_);
+      for (int i = 0; i < 20000; ++i) out << i << ",a," << i % 3 << endl;
+      out << "oops,b,1" << endl;
+    }
+    DataTable table(filename_, false, ",", 2);
+    EXPECT_EQ(20001, table.nrow());
+    EXPECT_EQ(VariableType::categorical, table.variable_type(0));
+    EXPECT_EQ(VariableType::categorical, table.variable_type(1));
+    EXPECT_EQ(VariableType::numeric, table.variable_type(2));
+    EXPECT_EQ("oops", table.get_nominal(0).label(20000));
+    EXPECT_EQ("17", table.get_nominal(0).label(17));
+    EXPECT_DOUBLE_EQ(2.0, table.getvar(2)[19997]);
+    EXPECT_DOUBLE_EQ(1.0, table.getvar(2)[20000]);
+  }
+
+  TEST(CategoricalVariableTest, CodesAndObjectsAgree) {
+    CategoricalVariable variable({"b", "a", "c", "a"});
+    EXPECT_EQ(4, variable.size());
+    EXPECT_EQ(1, variable.value(0));
+    variable.set_value(0, 2);
+    variable.set_order({"c", "b", "a"});
+    EXPECT_EQ(0, variable.value(0));
+    EXPECT_EQ("c", variable.label(0));
+    EXPECT_EQ("a", variable.label(1));
+
+    // Asking for the data objects switches to object storage.
+    Ptr<LabeledCategoricalData> element = variable[1];
+    EXPECT_EQ("a", element->label());
+    variable.set_value(1, 1);
+    EXPECT_EQ("b", element->label());
+    variable.push_back(0);
+    EXPECT_EQ(5, variable.size());
+    EXPECT_EQ("c", variable[4]->label());
+  }
+
+  // The const accessors create the data objects on first use.  Calling them
+  // from several threads at once must create the objects exactly once.
+  TEST(CategoricalVariableTest, ConcurrentConstAccess) {
+    std::vector<std::string> raw;
+    for (int i = 0; i < 5000; ++i) {
+      raw.push_back(i % 3 == 0 ? "x" : (i % 3 == 1 ? "y" : "z"));
+    }
+    const CategoricalVariable variable(raw);
+    int nthreads = 4;
+    std::vector<const LabeledCategoricalData *> first(nthreads);
+    std::vector<int> mismatches(nthreads, 0);
+    ThreadWorkerPool pool(nthreads - 1);
+    pool.parallel_for(0, nthreads, 1, [&](int begin, int end) {
+      for (int t = begin; t < end; ++t) {
+        const std::vector<Ptr<LabeledCategoricalData>> &data(
+            variable.data());
+        first[t] = data[0].get();
+        for (int i = 0; i < variable.size(); ++i) {
+          if (variable[i]->value() != variable.value(i)) ++mismatches[t];
+        }
+      }
+    });
+    for (int t = 0; t < nthreads; ++t) {
+      EXPECT_EQ(first[0], first[t]);
+      EXPECT_EQ(0, mismatches[t]);
+    }
+    EXPECT_EQ(5000, variable.size());
+    EXPECT_EQ("z", variable.label(2));
+
+    // Copies made after the objects exist share them.
+    CategoricalVariable copy(variable);
+    EXPECT_EQ(first[0], copy[0].get());
+  }
+
 }  // namespace
@@ -0,0 +1,166 @@
+#include "gtest/gtest.h"
+#include "stats/ChunkedDataSource.hpp"
+#include "stats/StreamingSufstat.hpp"
+#include "Models/GaussianModelBase.hpp"
+#include "Models/Glm/RegressionModel.hpp"
+#include "Models/MultinomialModel.hpp"
+#include "Models/MvnBase.hpp"
+#include "cpputil/BinaryDrawFile.hpp"
+#include "distributions.hpp"
+#include "test_utils/test_utils.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+namespace {
+  using namespace BOOM;
+  using std::endl;
+
+  class StreamingSufstatTest : public ::testing::Test {
+   protected:
+    StreamingSufstatTest()
+        : csv_filename_("streaming_sufstat_test.csv"),
+          draw_filename_("streaming_sufstat_test.draws"),
+          nobs_(1000) {
+      GlobalRng::rng.seed(8675309);
+      data_.resize(nobs_, 4);
+      for (int i = 0; i < nobs_; ++i) {
+        data_(i, 1) = rnorm();
+        data_(i, 2) = rnorm(1, 2);
+        data_(i, 3) = rmulti(0, 2);
+        data_(i, 0) = 3 + 2 * data_(i, 1) - data_(i, 2) + rnorm();
+      }
+      std::ofstream out(csv_filename_);
+      out.precision(17);
+      out << "y,x1,x2,level" << endl;
+      for (int i = 0; i < nobs_; ++i) {
+        out << data_(i, 0) << ", " << data_(i, 1) << "," << data_(i, 2)
+            << "," << data_(i, 3) << endl;
+        if (i == 10) {
+          // A row with a missing value, followed by a blank line.
+          out << "NA,1,2,0" << endl << endl;
+        }
+      }
+    }
+
+    ~StreamingSufstatTest() override {
+      std::remove(csv_filename_.c_str());
+      std::remove(draw_filename_.c_str());
+    }
+
+    std::string csv_filename_;
+    std::string draw_filename_;
+    int nobs_;
+    Matrix data_;
+  };
+
+  TEST_F(StreamingSufstatTest, GaussianSuf) {
+    GaussianSuf expected;
+    for (int i = 0; i < nobs_; ++i) expected.update_raw(data_(i, 0));
+
+    for (int nthreads : {1, 3}) {
+      CsvChunkReader reader(csv_filename_, true, ",", 64);
+      EXPECT_EQ(4, reader.ncol());
+      EXPECT_EQ("x2", reader.variable_names()[2]);
+      GaussianSuf suf;
+      EXPECT_EQ(nobs_, stream_sufstat(reader, 0, suf, nthreads));
+      EXPECT_DOUBLE_EQ(expected.n(), suf.n());
+      EXPECT_NEAR(expected.sum(), suf.sum(), 1e-8);
+      EXPECT_NEAR(expected.sumsq(), suf.sumsq(), 1e-8);
+    }
+  }
+
+  // The chunks are combined in the order they were read, so the result is
+  // the same for any number of threads greater than one.
+  TEST_F(StreamingSufstatTest, ThreadCountDoesNotChangeResult) {
+    Vector sums;
+    Vector sumsqs;
+    for (int nthreads : {2, 3, 5}) {
+      CsvChunkReader reader(csv_filename_, true, ",", 64);
+      GaussianSuf suf;
+      EXPECT_EQ(nobs_, stream_sufstat(reader, 0, suf, nthreads));
+      sums.push_back(suf.sum());
+      sumsqs.push_back(suf.sumsq());
+    }
+    EXPECT_EQ(sums[0], sums[1]);
+    EXPECT_EQ(sums[0], sums[2]);
+    EXPECT_EQ(sumsqs[0], sumsqs[1]);
+    EXPECT_EQ(sumsqs[0], sumsqs[2]);
+  }
+
+  TEST_F(StreamingSufstatTest, MvnAndMultinomialSuf) {
+    MvnSuf expected_mvn(2);
+    MultinomialSuf expected_multinomial(3);
+    for (int i = 0; i < nobs_; ++i) {
+      expected_mvn.update_raw(Vector{data_(i, 1), data_(i, 2)});
+      expected_multinomial.update_raw(lround(data_(i, 3)));
+    }
+
+    CsvChunkReader reader(csv_filename_, true, ",", 100);
+    MvnSuf mvn;
+    EXPECT_EQ(nobs_ + 1, stream_sufstat(reader, {1, 2}, mvn, 4));
+    // The row with a missing response is complete in these columns.
+    MvnSuf with_extra_row(expected_mvn);
+    with_extra_row.update_raw(Vector{1.0, 2.0});
+    EXPECT_TRUE(VectorEquals(with_extra_row.ybar(), mvn.ybar()));
+    EXPECT_TRUE(MatrixEquals(with_extra_row.center_sumsq(),
+                             mvn.center_sumsq(), 1e-6));
+
+    CsvChunkReader reader2(csv_filename_, true, ",", 100);
+    MultinomialSuf multinomial(3);
+    stream_sufstat(reader2, 3, multinomial, 2);
+    expected_multinomial.update_raw(0);
+    EXPECT_TRUE(VectorEquals(expected_multinomial.n(), multinomial.n()));
+  }
+
+  TEST_F(StreamingSufstatTest, RegressionSuf) {
+    NeRegSuf expected(3);
+    for (int i = 0; i < nobs_; ++i) {
+      expected.add_mixture_data(
+          data_(i, 0), Vector{1.0, data_(i, 1), data_(i, 2)}, 1.0);
+    }
+    CsvChunkReader reader(csv_filename_, true, ",", 128);
+    NeRegSuf suf(3);
+    EXPECT_EQ(nobs_, stream_sufstat(reader, 0, {1, 2}, true, suf, 3));
+    EXPECT_TRUE(MatrixEquals(expected.xtx(), suf.xtx(), 1e-6));
+    EXPECT_TRUE(VectorEquals(expected.xty(), suf.xty(), 1e-6));
+    EXPECT_NEAR(expected.yty(), suf.yty(), 1e-6);
+    EXPECT_DOUBLE_EQ(expected.n(), suf.n());
+  }
+
+  TEST_F(StreamingSufstatTest, DrawFileSource) {
+    {
+      DrawFileWriter writer(draw_filename_, {"y", "x"}, {1, 2}, 75);
+      for (int i = 0; i < nobs_; ++i) {
+        writer.write(Vector{data_(i, 0), data_(i, 1), data_(i, 2)});
+      }
+    }
+    NeRegSuf expected(2);
+    for (int i = 0; i < nobs_; ++i) {
+      expected.add_mixture_data(data_(i, 0),
+                                Vector{data_(i, 1), data_(i, 2)}, 1.0);
+    }
+    DrawFileChunkReader reader(draw_filename_, 64);
+    EXPECT_EQ(3, reader.ncol());
+    NeRegSuf suf(2);
+    EXPECT_EQ(nobs_, stream_sufstat(reader, 0, {1, 2}, false, suf, 2));
+    EXPECT_TRUE(MatrixEquals(expected.xtx(), suf.xtx(), 1e-6));
+    EXPECT_TRUE(VectorEquals(expected.xty(), suf.xty(), 1e-6));
+  }
+
+  TEST_F(StreamingSufstatTest, BadFieldsThrow) {
+    {
+      std::ofstream out(csv_filename_);
+      out << "1,2" << endl << "3,four" << endl;
+    }
+    for (int nthreads : {1, 2}) {
+      CsvChunkReader reader(csv_filename_, false, ",", 1);
+      GaussianSuf suf;
+      EXPECT_THROW(stream_sufstat(reader, 1, suf, nthreads), std::exception);
+    }
+    CsvChunkReader reader(csv_filename_);
+    GaussianSuf suf;
+    EXPECT_THROW(stream_sufstat(reader, 2, suf), std::exception);
+  }
+
+}  // namespace